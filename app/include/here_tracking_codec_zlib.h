@@ -0,0 +1,77 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/*
+ * Codec compressing request bodies and optionally decompressing response bodies with zlib.
+ * Supports the gzip and deflate content codings.
+ *
+ * Memory used by the compressor is (1 << (window_bits + 2)) + (1 << (mem_level + 9)) bytes, e.g.
+ * 6 KB with window_bits 10 and mem_level 3, or 256 KB with the zlib defaults 15 and 8. The
+ * decompressor must accept any window the server uses and takes about 40 KB more.
+ */
+
+#ifndef HERE_TRACKING_CODEC_ZLIB_H
+#define HERE_TRACKING_CODEC_ZLIB_H
+
+#include <stdbool.h>
+
+#include <zlib.h>
+
+#include "here_tracking_codec.h"
+
+typedef enum
+{
+    HERE_TRACKING_CODEC_ZLIB_GZIP    = 0,
+    HERE_TRACKING_CODEC_ZLIB_DEFLATE = 1
+} here_tracking_codec_zlib_format;
+
+typedef struct
+{
+    z_stream deflate_stream;
+    z_stream inflate_stream;
+    here_tracking_codec_zlib_format format;
+    bool decode;
+    here_tracking_codec codec;
+} here_tracking_codec_zlib;
+
+/**
+ * Initializes the codec. Pass zlib->codec to here_tracking_set_codec().
+ *
+ * level is the compression level from 1 to 9, window_bits from 9 to 15 and mem_level from 1 to 9.
+ */
+here_tracking_error here_tracking_codec_zlib_init(here_tracking_codec_zlib* zlib,
+                                                  here_tracking_codec_zlib_format format,
+                                                  int level,
+                                                  int window_bits,
+                                                  int mem_level);
+
+/**
+ * Enables decompressing of response bodies. The requests then ask the server to compress the
+ * responses with the format of the codec.
+ */
+here_tracking_error here_tracking_codec_zlib_enable_decode(here_tracking_codec_zlib* zlib);
+
+void here_tracking_codec_zlib_free(here_tracking_codec_zlib* zlib);
+
+#endif /* HERE_TRACKING_CODEC_ZLIB_H */
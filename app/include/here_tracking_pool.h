@@ -0,0 +1,188 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/*
+ * Client pool for gateways that send for many devices. Each device has its own client and
+ * credentials, but all clients share one TLS environment and the requests are driven with the
+ * non-blocking interface from a few worker threads, each with its own epoll loop. Requests of a
+ * device are queued to worker device_index % worker_count.
+ *
+ * Each worker runs at most slots_per_worker requests at a time. Requests wait in the order they
+ * were submitted, and a device has at most one request in progress, so devices with a lot of data
+ * can't starve the others. A worker with free slots and nothing queued takes the oldest queued
+ * requests of the other workers. The device stays with the worker until its request completes,
+ * so its client, access token and limiter are used by one thread at a time. Access tokens are
+ * renewed as part of the request of the device.
+ *
+ * The Authorization header is sent with each request, so a connection isn't tied to a device.
+ * Each worker owns one connection per slot, and a request borrows an idle one of them for its
+ * client, preferably one already open to the same endpoint. With persistent connections enabled
+ * in the clients, the connections stay open between the requests of different devices, otherwise
+ * they are closed after each request but keep their TLS sessions for resumption. Memory and
+ * connection count grow with the number of slots, not devices. Requests use HTTP/1.1, a connection
+ * carries one request at a time.
+ */
+
+#ifndef HERE_TRACKING_POOL_H
+#define HERE_TRACKING_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "here_tracking.h"
+#include "here_tracking_async.h"
+
+#define HERE_TRACKING_POOL_NONE UINT32_MAX
+
+typedef struct
+{
+    /* Initialized with here_tracking_init() before here_tracking_pool_init() */
+    here_tracking_client client;
+    here_tracking_send_cb send_cb;
+    here_tracking_recv_cb recv_cb;
+    here_tracking_req_type req_type;
+    here_tracking_resp_type resp_type;
+    void* user_data;
+    uint32_t next;
+    bool busy;
+    bool complete;
+} here_tracking_pool_device;
+
+typedef struct
+{
+    here_tracking_tls tls;
+    /* State of the connection given to the client while a request borrows it */
+    bool connected;
+    uint16_t port;
+    uint32_t last_used;
+    bool non_blocking;
+    /* Endpoint the connection was last opened to */
+    char host[HERE_TRACKING_BASE_URL_SIZE];
+    bool busy;
+} here_tracking_pool_connection;
+
+typedef struct
+{
+    here_tracking_async async;
+    here_tracking_pool_device* device;
+    here_tracking_pool_connection* connection;
+    int fd;
+} here_tracking_pool_slot;
+
+typedef struct
+{
+    here_tracking_pool_device* devices;
+    here_tracking_pool_slot* slots;
+    uint32_t slot_count;
+    uint32_t free_slots;
+    /* One per slot, borrowed by the requests of any device */
+    here_tracking_pool_connection* connections;
+    /* Position in the worker array, the other workers are found relative to it */
+    uint32_t index;
+    uint32_t worker_count;
+    /* Queue of submitted devices, also taken from by idle workers */
+    uint32_t queue_head;
+    uint32_t queue_tail;
+    /* Gateway limiter given to the clients of the requests this worker runs */
+    here_tracking_rate_limiter* rate_limiter;
+    /* CPU the thread runs on, -1 for any */
+    int cpu;
+    uint32_t completed_count;
+    uint32_t stolen_count;
+    int epoll_fd;
+    int event_fd;
+    bool stop;
+    pthread_t thread;
+    pthread_mutex_t lock;
+} here_tracking_pool_worker;
+
+typedef struct
+{
+    here_tracking_pool_device* devices;
+    uint32_t device_count;
+    here_tracking_pool_worker* workers;
+    uint32_t worker_count;
+    bool running;
+} here_tracking_pool;
+
+/**
+ * Initializes the pool. slots must hold worker_count * slots_per_worker entries. The clients of
+ * the devices are set to use tls_env, or a new TLS environment if it is NULL. While a request is
+ * in progress, its client uses a connection of the worker, so a TLS context set in the client
+ * before is released.
+ */
+here_tracking_error here_tracking_pool_init(here_tracking_pool* pool,
+                                            here_tracking_pool_device* devices,
+                                            uint32_t device_count,
+                                            here_tracking_pool_worker* workers,
+                                            uint32_t worker_count,
+                                            here_tracking_pool_slot* slots,
+                                            uint32_t slots_per_worker,
+                                            here_tracking_tls_env tls_env);
+
+/**
+ * Gives each worker its own gateway rate limiter, limiters holds worker_count entries. The client
+ * of a request uses the limiter of the worker running it, so a limiter is used from one thread
+ * only. Initialize each with its share of the gateway rate. Must be called before
+ * here_tracking_pool_start().
+ */
+here_tracking_error here_tracking_pool_set_rate_limiters(here_tracking_pool* pool,
+                                                         here_tracking_rate_limiter* limiters);
+
+/**
+ * Runs worker i on CPU i modulo the number of online CPUs. Must be called before
+ * here_tracking_pool_start().
+ */
+here_tracking_error here_tracking_pool_set_cpu_affinity(here_tracking_pool* pool, bool enabled);
+
+here_tracking_error here_tracking_pool_start(here_tracking_pool* pool);
+
+/**
+ * Queues a request for the device. Safe to call from any thread. The callbacks are called from
+ * the worker thread of the device, and recv_cb always gets HERE_TRACKING_RECV_EVT_RESP_COMPLETE
+ * last, also when the request fails before the response. Returns
+ * HERE_TRACKING_ERROR_WOULD_BLOCK if the device has a request in progress.
+ */
+here_tracking_error here_tracking_pool_submit(here_tracking_pool* pool,
+                                              uint32_t device_index,
+                                              here_tracking_send_cb send_cb,
+                                              here_tracking_recv_cb recv_cb,
+                                              here_tracking_req_type req_type,
+                                              here_tracking_resp_type resp_type,
+                                              void* user_data);
+
+/**
+ * Stops the workers. Requests in progress are cancelled and they and the queued requests complete
+ * with HERE_TRACKING_ERROR_CLIENT_INTERRUPT.
+ */
+here_tracking_error here_tracking_pool_stop(here_tracking_pool* pool);
+
+/**
+ * Stops the pool and releases its resources, including the connections. The clients are released
+ * separately with here_tracking_free().
+ */
+void here_tracking_pool_free(here_tracking_pool* pool);
+
+#endif /* HERE_TRACKING_POOL_H */
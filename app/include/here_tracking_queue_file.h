@@ -0,0 +1,62 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/*
+ * Sample queue kept in a file. The file is mapped to memory with mmap(), so samples pushed to the
+ * queue are written to the file by the kernel and are kept over restarts of the application.
+ * here_tracking_queue_file_sync() writes them to the disk right away, e.g. before a planned power
+ * off. Without it, samples pushed shortly before the system itself crashes may be lost.
+ */
+
+#ifndef HERE_TRACKING_QUEUE_FILE_H
+#define HERE_TRACKING_QUEUE_FILE_H
+
+#include <stdint.h>
+
+#include "here_tracking_queue.h"
+
+typedef struct
+{
+    here_tracking_queue queue;
+    int fd;
+    uint8_t* map;
+    uint32_t map_size;
+} here_tracking_queue_file;
+
+/**
+ * Opens the queue in the file at path, creating the file if needed. An existing queue file of a
+ * different size is formatted again. Use file->queue with the here_tracking_queue functions.
+ */
+here_tracking_error here_tracking_queue_file_open(here_tracking_queue_file* file,
+                                                  const char* path,
+                                                  uint32_t size);
+
+/**
+ * Writes the changes of the queue to the disk and waits for the write to complete.
+ */
+here_tracking_error here_tracking_queue_file_sync(here_tracking_queue_file* file);
+
+void here_tracking_queue_file_close(here_tracking_queue_file* file);
+
+#endif /* HERE_TRACKING_QUEUE_FILE_H */
@@ -0,0 +1,117 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/*
+ * Background sender. Samples are pushed from any number of producer threads into a bounded
+ * lock-free ring and a worker thread adds them to a batcher, which sends them with the client.
+ * Pushing never waits for the network: when the ring is full, the sample is dropped and counted.
+ * After failed requests the worker waits as told by the scheduler, samples keep being batched.
+ * A full batch that can't be sent is retried at most once per scheduler base delay.
+ *
+ * The worker owns the client while the sender runs, which includes renewing the access token.
+ * The application must not use the client between here_tracking_sender_start() and
+ * here_tracking_sender_stop().
+ */
+
+#ifndef HERE_TRACKING_SENDER_H
+#define HERE_TRACKING_SENDER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "here_tracking_batcher.h"
+#include "here_tracking_scheduler.h"
+
+#ifndef HERE_TRACKING_SENDER_SAMPLE_MAX_SIZE
+#define HERE_TRACKING_SENDER_SAMPLE_MAX_SIZE 512
+#endif
+
+/* Longest time the worker sleeps before it looks at the ring again, unless sending has failed */
+#define HERE_TRACKING_SENDER_MAX_WAIT_MS 1000
+
+typedef struct
+{
+    uint32_t seq;
+    uint32_t size;
+    uint8_t data[HERE_TRACKING_SENDER_SAMPLE_MAX_SIZE];
+} here_tracking_sender_slot;
+
+typedef struct
+{
+    here_tracking_batcher batcher;
+    here_tracking_scheduler scheduler;
+    here_tracking_sender_slot* slots;
+    uint32_t slot_mask;
+    uint32_t enqueue_pos;
+    uint32_t dequeue_pos;
+    uint32_t dropped;
+    bool stop;
+    bool running;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} here_tracking_sender;
+
+/**
+ * Initializes the sender. slot_count must be a power of two. The batcher limits can be changed
+ * with here_tracking_batcher_set_limits(&sender->batcher, ...) before the sender is started.
+ * recv_cb is called from the worker thread.
+ */
+here_tracking_error here_tracking_sender_init(here_tracking_sender* sender,
+                                              here_tracking_client* client,
+                                              here_tracking_req_type req_type,
+                                              here_tracking_sender_slot* slots,
+                                              uint32_t slot_count,
+                                              uint8_t* batch_buffer,
+                                              uint32_t batch_buffer_size,
+                                              here_tracking_recv_cb recv_cb,
+                                              void* user_data);
+
+here_tracking_error here_tracking_sender_start(here_tracking_sender* sender);
+
+/**
+ * Queues a sample for sending. Safe to call from any thread, never blocks. Returns
+ * HERE_TRACKING_ERROR_BUFFER_TOO_SMALL if the ring is full or the sample is larger than
+ * HERE_TRACKING_SENDER_SAMPLE_MAX_SIZE.
+ */
+here_tracking_error here_tracking_sender_push(here_tracking_sender* sender,
+                                              const uint8_t* sample,
+                                              uint32_t sample_size);
+
+/**
+ * Number of samples dropped because the ring was full, the sample didn't fit into a batch or it
+ * could not be sent when the sender was stopped.
+ */
+uint32_t here_tracking_sender_get_dropped(here_tracking_sender* sender);
+
+/**
+ * Stops the worker after it has sent the samples pushed before, ignoring the scheduler. Sending
+ * ends at the first batch that fails, the samples left are discarded and counted as dropped.
+ */
+here_tracking_error here_tracking_sender_stop(here_tracking_sender* sender);
+
+void here_tracking_sender_free(here_tracking_sender* sender);
+
+#endif /* HERE_TRACKING_SENDER_H */
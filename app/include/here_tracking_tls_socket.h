@@ -0,0 +1,150 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/*
+ * Socket handling shared by the TLS implementations: non-blocking connect, waiting for socket
+ * readiness until a deadline and caching of resolved host addresses.
+ *
+ * Define _POSIX_C_SOURCE 200112L or later before including this header.
+ */
+
+#ifndef HERE_TRACKING_TLS_SOCKET_H
+#define HERE_TRACKING_TLS_SOCKET_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include "here_tracking_error.h"
+
+#define HERE_TRACKING_TLS_DNS_CACHE_SIZE 4
+#define HERE_TRACKING_TLS_DNS_ADDR_MAX   4
+#define HERE_TRACKING_TLS_DNS_HOST_SIZE  256
+#define HERE_TRACKING_TLS_DNS_TTL_MAX    86400
+
+/* Time in milliseconds an address may take to answer before the next one is tried */
+#define HERE_TRACKING_TLS_SOCKET_ADDR_TIMEOUT 2000
+
+typedef struct
+{
+    int family;
+    int socktype;
+    int protocol;
+    socklen_t addr_len;
+    struct sockaddr_storage addr;
+} here_tracking_tls_dns_addr;
+
+typedef struct
+{
+    char host[HERE_TRACKING_TLS_DNS_HOST_SIZE];
+    uint16_t port;
+    uint32_t expiry; /**< Monotonic time in milliseconds when the addresses expire */
+    uint8_t addr_count; /**< Number of cached addresses, 0 if the entry is unused */
+    here_tracking_tls_dns_addr addrs[HERE_TRACKING_TLS_DNS_ADDR_MAX];
+} here_tracking_tls_dns_entry;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    uint32_t ttl; /**< Time in seconds the resolved addresses are cached, 0 to disable */
+    here_tracking_tls_dns_entry entries[HERE_TRACKING_TLS_DNS_CACHE_SIZE];
+} here_tracking_tls_dns_cache;
+
+/**
+ * Progress of a connect through the resolved addresses of a host.
+ */
+typedef struct
+{
+    here_tracking_tls_dns_addr addrs[HERE_TRACKING_TLS_DNS_ADDR_MAX];
+    uint8_t addr_count;
+    uint8_t addr_index; /**< Address being connected to */
+    uint32_t addr_deadline; /**< Monotonic time in milliseconds to give up the address, 0 if none */
+    bool cached; /**< Were the addresses taken from the cache */
+} here_tracking_tls_connector;
+
+here_tracking_error here_tracking_tls_dns_cache_init(here_tracking_tls_dns_cache* cache);
+
+void here_tracking_tls_dns_cache_free(here_tracking_tls_dns_cache* cache);
+
+void here_tracking_tls_dns_cache_set_ttl(here_tracking_tls_dns_cache* cache, uint32_t ttl);
+
+/**
+ * Drops the cached addresses of a host so that the next connect resolves it again.
+ */
+void here_tracking_tls_dns_cache_drop(here_tracking_tls_dns_cache* cache,
+                                      const char* host,
+                                      uint16_t port);
+
+/**
+ * Resolves the host and starts connecting a non-blocking TCP socket to its first address that
+ * doesn't fail right away.
+ *
+ * @return HERE_TRACKING_OK if connected, HERE_TRACKING_ERROR_WOULD_BLOCK if the connection is in
+ *         progress and the socket must be polled for writing, HERE_TRACKING_ERROR otherwise in
+ *         which case @p fd is set to -1.
+ */
+here_tracking_error here_tracking_tls_socket_connect(here_tracking_tls_connector* connector,
+                                                     here_tracking_tls_dns_cache* cache,
+                                                     const char* host,
+                                                     uint16_t port,
+                                                     int* fd);
+
+/**
+ * Checks the result of a connection started with here_tracking_tls_socket_connect() without
+ * blocking. When the address refuses the connection, or doesn't answer within
+ * HERE_TRACKING_TLS_SOCKET_ADDR_TIMEOUT and more addresses are left, the socket is closed and the
+ * next address is tried with a new one in @p fd. Fails only after the last address has failed.
+ */
+here_tracking_error here_tracking_tls_socket_connect_check(here_tracking_tls_connector* connector,
+                                                           int* fd);
+
+/**
+ * Waits until the connection started with here_tracking_tls_socket_connect() completes, its
+ * address times out or the monotonic deadline has passed, whichever comes first. A deadline of 0
+ * waits without limit.
+ *
+ * @return HERE_TRACKING_OK if here_tracking_tls_socket_connect_check() should be called,
+ *         HERE_TRACKING_ERROR_TIMEOUT or HERE_TRACKING_ERROR.
+ */
+here_tracking_error here_tracking_tls_socket_connect_poll(here_tracking_tls_connector* connector,
+                                                          int fd,
+                                                          uint32_t deadline);
+
+/**
+ * Waits until the socket is ready for the events, a combination of HERE_TRACKING_TLS_POLL_IN and
+ * HERE_TRACKING_TLS_POLL_OUT, or the monotonic deadline has passed. A deadline of 0 waits without
+ * limit.
+ *
+ * @return HERE_TRACKING_OK, HERE_TRACKING_ERROR_TIMEOUT or HERE_TRACKING_ERROR.
+ */
+here_tracking_error here_tracking_tls_socket_poll(int fd, uint8_t events, uint32_t deadline);
+
+/**
+ * Checks that nothing has been received on an idle connection, which would mean that the peer
+ * has closed it.
+ */
+bool here_tracking_tls_socket_idle(int fd);
+
+#endif /* HERE_TRACKING_TLS_SOCKET_H */
@@ -22,6 +22,7 @@
  * SOFTWARE.                                                                                      *
  **************************************************************************************************/
 
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,12 +37,15 @@
 
 #define HERE_TRACKING_APP_DATA_BUFFER_SIZE 4096
 
+#define HERE_TRACKING_APP_SESSION_BUFFER_SIZE 4096
+
 #define HERE_TRACKING_APP_USER_AGENT "here-tracking-c/"HERE_TRACKING_VERSION_STRING
 
 typedef struct
 {
     here_tracking_client client;
     uint8_t data_buffer[HERE_TRACKING_APP_DATA_BUFFER_SIZE];
+    uint8_t session_buffer[HERE_TRACKING_APP_SESSION_BUFFER_SIZE];
     bool send_complete;
 } here_tracking_app;
 
@@ -86,6 +90,72 @@ static here_tracking_error here_tracking_app_recv_cb(const here_tracking_recv_da
 
 /**************************************************************************************************/
 
+static void here_tracking_app_load_session(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+
+    if(file != NULL)
+    {
+        size_t size = fread(app.session_buffer, 1, HERE_TRACKING_APP_SESSION_BUFFER_SIZE, file);
+
+        /* A missing or stale session just means a full handshake on first connect */
+        if(size > 0)
+        {
+            here_tracking_set_tls_session(&app.client, app.session_buffer, (uint32_t)size);
+        }
+
+        fclose(file);
+    }
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_app_save_session(const char* path)
+{
+    uint32_t size = HERE_TRACKING_APP_SESSION_BUFFER_SIZE;
+
+    if(here_tracking_get_tls_session(&app.client, app.session_buffer, &size) == HERE_TRACKING_OK)
+    {
+        /* The session holds secret keys, keep it readable by the owner only */
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+
+        if(fd >= 0)
+        {
+            if(write(fd, app.session_buffer, size) != (ssize_t)size)
+            {
+                fprintf(stderr, "Failed to store TLS session to %s\n", path);
+            }
+
+            close(fd);
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_app_wait_next_sample(uint8_t sample_interval)
+{
+    uint32_t now = 0;
+
+    here_tracking_get_unixtime(&now);
+
+    /* Reconnect a dropped connection and refresh the access token shortly before the next sample
+       is due, so that sending it does not wait for the handshake. */
+    if(sample_interval > 1)
+    {
+        sleep(sample_interval - 1);
+        here_tracking_prewarm(&app.client, now + sample_interval);
+        sleep(1);
+    }
+    else
+    {
+        here_tracking_prewarm(&app.client, now + sample_interval);
+        sleep(sample_interval);
+    }
+}
+
+/**************************************************************************************************/
+
 int main(int argc, char** argv)
 {
     here_tracking_error err;
@@ -97,6 +167,7 @@ int main(int argc, char** argv)
         char* base_url = argv[3];
         uint8_t samples_to_send = 10; /* Default to 10 samples. */
         uint8_t sample_interval = 1; /* Default to 1 second interval */
+        char* session_file = (argc >= 7) ? argv[6] : NULL;
 
         if(argc >= 5)
         {
@@ -133,6 +204,14 @@ int main(int argc, char** argv)
         app.client.user_agent = HERE_TRACKING_APP_USER_AGENT;
         app.send_complete = false;
 
+        /* Keep the connection open between samples */
+        here_tracking_set_keep_alive(&app.client, true, sample_interval + 1);
+
+        if(session_file != NULL)
+        {
+            here_tracking_app_load_session(session_file);
+        }
+
         while(samples_to_send > 0)
         {
             err = here_tracking_send_stream(&app.client,
@@ -147,8 +226,17 @@ int main(int argc, char** argv)
                 break;
             }
 
-            sleep(sample_interval);
             samples_to_send--;
+
+            if(samples_to_send > 0)
+            {
+                here_tracking_app_wait_next_sample(sample_interval);
+            }
+        }
+
+        if(session_file != NULL)
+        {
+            here_tracking_app_save_session(session_file);
         }
 
         here_tracking_free(&app.client);
@@ -157,7 +245,7 @@ int main(int argc, char** argv)
     {
         fprintf(stderr,
                 "Usage: ./here_tracking_app device_id device_secret base_url "
-                "[sample_count] [sample_interval]\n");
+                "[sample_count] [sample_interval] [tls_session_file]\n");
         err = HERE_TRACKING_ERROR_INVALID_INPUT;
     }
 
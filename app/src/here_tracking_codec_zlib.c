@@ -0,0 +1,244 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+#include <string.h>
+
+#include "here_tracking_codec_zlib.h"
+
+/**************************************************************************************************/
+
+#define HERE_TRACKING_CODEC_ZLIB_GZIP_WINDOW_BITS_OFFSET 16
+
+#define HERE_TRACKING_CODEC_ZLIB_MAX_WINDOW_BITS 15
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_codec_zlib_begin(void* codec_data);
+
+static here_tracking_error here_tracking_codec_zlib_encode(const uint8_t* in,
+                                                          size_t* in_size,
+                                                          uint8_t* out,
+                                                          size_t* out_size,
+                                                          bool finish,
+                                                          bool* end,
+                                                          void* codec_data);
+
+static here_tracking_error here_tracking_codec_zlib_decode_begin(void* codec_data);
+
+static here_tracking_error here_tracking_codec_zlib_decode(const uint8_t* in,
+                                                          size_t* in_size,
+                                                          uint8_t* out,
+                                                          size_t* out_size,
+                                                          bool finish,
+                                                          bool* end,
+                                                          void* codec_data);
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_codec_zlib_init(here_tracking_codec_zlib* zlib,
+                                                  here_tracking_codec_zlib_format format,
+                                                  int level,
+                                                  int window_bits,
+                                                  int mem_level)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(zlib != NULL &&
+       (format == HERE_TRACKING_CODEC_ZLIB_GZIP || format == HERE_TRACKING_CODEC_ZLIB_DEFLATE) &&
+       level >= 1 && level <= 9 &&
+       window_bits >= 9 && window_bits <= 15 &&
+       mem_level >= 1 && mem_level <= 9)
+    {
+        memset(&zlib->deflate_stream, 0, sizeof(zlib->deflate_stream));
+        zlib->format = format;
+        zlib->decode = false;
+
+        if(format == HERE_TRACKING_CODEC_ZLIB_GZIP)
+        {
+            window_bits += HERE_TRACKING_CODEC_ZLIB_GZIP_WINDOW_BITS_OFFSET;
+        }
+
+        if(deflateInit2(&zlib->deflate_stream,
+                        level,
+                        Z_DEFLATED,
+                        window_bits,
+                        mem_level,
+                        Z_DEFAULT_STRATEGY) == Z_OK)
+        {
+            zlib->codec.content_encoding =
+                (format == HERE_TRACKING_CODEC_ZLIB_GZIP) ? "gzip" : "deflate";
+            zlib->codec.begin = here_tracking_codec_zlib_begin;
+            zlib->codec.encode = here_tracking_codec_zlib_encode;
+            zlib->codec.decode_begin = NULL;
+            zlib->codec.decode = NULL;
+            zlib->codec.codec_data = zlib;
+            err = HERE_TRACKING_OK;
+        }
+        else
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_codec_zlib_enable_decode(here_tracking_codec_zlib* zlib)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(zlib != NULL && !zlib->decode)
+    {
+        int window_bits = HERE_TRACKING_CODEC_ZLIB_MAX_WINDOW_BITS;
+
+        memset(&zlib->inflate_stream, 0, sizeof(zlib->inflate_stream));
+
+        if(zlib->format == HERE_TRACKING_CODEC_ZLIB_GZIP)
+        {
+            window_bits += HERE_TRACKING_CODEC_ZLIB_GZIP_WINDOW_BITS_OFFSET;
+        }
+
+        if(inflateInit2(&zlib->inflate_stream, window_bits) == Z_OK)
+        {
+            zlib->decode = true;
+            zlib->codec.decode_begin = here_tracking_codec_zlib_decode_begin;
+            zlib->codec.decode = here_tracking_codec_zlib_decode;
+            err = HERE_TRACKING_OK;
+        }
+        else
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+void here_tracking_codec_zlib_free(here_tracking_codec_zlib* zlib)
+{
+    if(zlib != NULL)
+    {
+        deflateEnd(&zlib->deflate_stream);
+
+        if(zlib->decode)
+        {
+            inflateEnd(&zlib->inflate_stream);
+            zlib->decode = false;
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_codec_zlib_begin(void* codec_data)
+{
+    here_tracking_codec_zlib* zlib = (here_tracking_codec_zlib*)codec_data;
+
+    return (deflateReset(&zlib->deflate_stream) == Z_OK) ? HERE_TRACKING_OK : HERE_TRACKING_ERROR;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_codec_zlib_encode(const uint8_t* in,
+                                                          size_t* in_size,
+                                                          uint8_t* out,
+                                                          size_t* out_size,
+                                                          bool finish,
+                                                          bool* end,
+                                                          void* codec_data)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_codec_zlib* zlib = (here_tracking_codec_zlib*)codec_data;
+    int res;
+
+    zlib->deflate_stream.next_in = (Bytef*)in;
+    zlib->deflate_stream.avail_in = (uInt)(*in_size);
+    zlib->deflate_stream.next_out = out;
+    zlib->deflate_stream.avail_out = (uInt)(*out_size);
+
+    res = deflate(&zlib->deflate_stream, finish ? Z_FINISH : Z_NO_FLUSH);
+
+    /* Z_BUF_ERROR only means that no progress was possible */
+    if(res == Z_OK || res == Z_STREAM_END || res == Z_BUF_ERROR)
+    {
+        (*in_size) -= zlib->deflate_stream.avail_in;
+        (*out_size) -= zlib->deflate_stream.avail_out;
+        (*end) = (res == Z_STREAM_END);
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_codec_zlib_decode_begin(void* codec_data)
+{
+    here_tracking_codec_zlib* zlib = (here_tracking_codec_zlib*)codec_data;
+
+    return (inflateReset(&zlib->inflate_stream) == Z_OK) ? HERE_TRACKING_OK : HERE_TRACKING_ERROR;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_codec_zlib_decode(const uint8_t* in,
+                                                          size_t* in_size,
+                                                          uint8_t* out,
+                                                          size_t* out_size,
+                                                          bool finish,
+                                                          bool* end,
+                                                          void* codec_data)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_codec_zlib* zlib = (here_tracking_codec_zlib*)codec_data;
+    int res;
+
+    zlib->inflate_stream.next_in = (Bytef*)in;
+    zlib->inflate_stream.avail_in = (uInt)(*in_size);
+    zlib->inflate_stream.next_out = out;
+    zlib->inflate_stream.avail_out = (uInt)(*out_size);
+
+    res = inflate(&zlib->inflate_stream, Z_NO_FLUSH);
+
+    /* Z_BUF_ERROR only means that no progress was possible, the caller detects truncated data */
+    if(res == Z_OK || res == Z_STREAM_END || res == Z_BUF_ERROR)
+    {
+        (*in_size) -= zlib->inflate_stream.avail_in;
+        (*out_size) -= zlib->inflate_stream.avail_out;
+        (*end) = (res == Z_STREAM_END);
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR;
+    }
+
+    return err;
+}
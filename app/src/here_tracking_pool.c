@@ -0,0 +1,906 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/* pthread_setaffinity_np() */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "here_tracking_pool.h"
+
+/**************************************************************************************************/
+
+/* Events handled per epoll_wait() call */
+#define HERE_TRACKING_POOL_MAX_EVENTS 64
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_pool_worker_init(here_tracking_pool_worker* worker,
+                                                          uint32_t index,
+                                                          uint32_t worker_count,
+                                                          here_tracking_pool_device* devices,
+                                                          here_tracking_pool_slot* slots,
+                                                          uint32_t slot_count);
+
+static void here_tracking_pool_worker_free(here_tracking_pool_worker* worker);
+
+static void here_tracking_pool_wake(here_tracking_pool_worker* worker);
+
+static void* here_tracking_pool_worker_run(void* arg);
+
+static here_tracking_pool_device* here_tracking_pool_pop(here_tracking_pool_worker* worker);
+
+static here_tracking_pool_device* here_tracking_pool_steal(here_tracking_pool_worker* worker);
+
+static void here_tracking_pool_start_ready(here_tracking_pool_worker* worker);
+
+static void here_tracking_pool_step(here_tracking_pool_worker* worker,
+                                    here_tracking_pool_slot* slot);
+
+static here_tracking_pool_connection* \
+    here_tracking_pool_borrow(here_tracking_pool_worker* worker, here_tracking_client* client);
+
+static void here_tracking_pool_give_back(here_tracking_pool_connection* connection,
+                                         here_tracking_client* client);
+
+static here_tracking_error here_tracking_pool_watch(here_tracking_pool_worker* worker,
+                                                   here_tracking_pool_slot* slot);
+
+static int here_tracking_pool_next_timeout(here_tracking_pool_worker* worker);
+
+static void here_tracking_pool_step_timed_out(here_tracking_pool_worker* worker);
+
+static void here_tracking_pool_cancel_all(here_tracking_pool_worker* worker);
+
+static void here_tracking_pool_finish(here_tracking_pool_worker* worker,
+                                      here_tracking_pool_slot* slot,
+                                      here_tracking_error err);
+
+static void here_tracking_pool_complete(here_tracking_pool_device* device,
+                                        here_tracking_error err);
+
+static here_tracking_error here_tracking_pool_send_cb(const uint8_t** data,
+                                                      size_t* data_size,
+                                                      void* user_data);
+
+static here_tracking_error here_tracking_pool_recv_cb(const here_tracking_recv_data* data,
+                                                      void* user_data);
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_pool_init(here_tracking_pool* pool,
+                                            here_tracking_pool_device* devices,
+                                            uint32_t device_count,
+                                            here_tracking_pool_worker* workers,
+                                            uint32_t worker_count,
+                                            here_tracking_pool_slot* slots,
+                                            uint32_t slots_per_worker,
+                                            here_tracking_tls_env tls_env)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(pool != NULL &&
+       devices != NULL &&
+       device_count > 0 &&
+       device_count < HERE_TRACKING_POOL_NONE &&
+       workers != NULL &&
+       worker_count > 0 &&
+       slots != NULL &&
+       slots_per_worker > 0)
+    {
+        here_tracking_tls_env env = tls_env;
+        uint32_t i, workers_ready = 0;
+
+        /* Pool holds its own reference while the clients take theirs */
+        err = (env == NULL) ? here_tracking_tls_env_init(&env) : here_tracking_tls_env_ref(env);
+
+        if(err == HERE_TRACKING_OK)
+        {
+            for(i = 0; err == HERE_TRACKING_OK && i < device_count; ++i)
+            {
+                devices[i].next = HERE_TRACKING_POOL_NONE;
+                devices[i].busy = false;
+                devices[i].complete = false;
+                err = here_tracking_set_tls_env(&(devices[i].client), env);
+            }
+
+            here_tracking_tls_env_free(&env);
+        }
+
+        for(i = 0; err == HERE_TRACKING_OK && i < worker_count; ++i)
+        {
+            err = here_tracking_pool_worker_init(&(workers[i]),
+                                                 i,
+                                                 worker_count,
+                                                 devices,
+                                                 &(slots[i * slots_per_worker]),
+                                                 slots_per_worker);
+
+            if(err == HERE_TRACKING_OK)
+            {
+                workers_ready++;
+            }
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            pool->devices = devices;
+            pool->device_count = device_count;
+            pool->workers = workers;
+            pool->worker_count = worker_count;
+            pool->running = false;
+        }
+        else
+        {
+            for(i = 0; i < workers_ready; ++i)
+            {
+                here_tracking_pool_worker_free(&(workers[i]));
+            }
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_pool_set_rate_limiters(here_tracking_pool* pool,
+                                                         here_tracking_rate_limiter* limiters)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(pool != NULL && !pool->running)
+    {
+        uint32_t i;
+
+        for(i = 0; i < pool->worker_count; ++i)
+        {
+            pool->workers[i].rate_limiter = (limiters != NULL) ? &(limiters[i]) : NULL;
+        }
+
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_pool_set_cpu_affinity(here_tracking_pool* pool, bool enabled)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(pool != NULL && !pool->running)
+    {
+        long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+        uint32_t i;
+
+        for(i = 0; i < pool->worker_count; ++i)
+        {
+            pool->workers[i].cpu = (enabled && cpu_count > 0) ? (int)(i % cpu_count) : -1;
+        }
+
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_pool_start(here_tracking_pool* pool)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(pool != NULL && !pool->running)
+    {
+        uint32_t i, started = 0;
+
+        err = HERE_TRACKING_OK;
+
+        for(i = 0; err == HERE_TRACKING_OK && i < pool->worker_count; ++i)
+        {
+            here_tracking_pool_worker* worker = &(pool->workers[i]);
+
+            worker->stop = false;
+
+            if(pthread_create(&(worker->thread), NULL, here_tracking_pool_worker_run, worker) == 0)
+            {
+                started++;
+            }
+            else
+            {
+                err = HERE_TRACKING_ERROR;
+            }
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            pool->running = true;
+        }
+        else
+        {
+            for(i = 0; i < started; ++i)
+            {
+                __atomic_store_n(&(pool->workers[i].stop), true, __ATOMIC_RELEASE);
+                here_tracking_pool_wake(&(pool->workers[i]));
+                pthread_join(pool->workers[i].thread, NULL);
+            }
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_pool_submit(here_tracking_pool* pool,
+                                              uint32_t device_index,
+                                              here_tracking_send_cb send_cb,
+                                              here_tracking_recv_cb recv_cb,
+                                              here_tracking_req_type req_type,
+                                              here_tracking_resp_type resp_type,
+                                              void* user_data)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(pool != NULL && device_index < pool->device_count && send_cb != NULL && recv_cb != NULL)
+    {
+        here_tracking_pool_device* device = &(pool->devices[device_index]);
+        here_tracking_pool_worker* worker = &(pool->workers[device_index % pool->worker_count]);
+
+        err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+
+        /* The worker owns the device until it clears the flag */
+        if(!__atomic_exchange_n(&(device->busy), true, __ATOMIC_ACQUIRE))
+        {
+            device->send_cb = send_cb;
+            device->recv_cb = recv_cb;
+            device->req_type = req_type;
+            device->resp_type = resp_type;
+            device->user_data = user_data;
+            device->complete = false;
+            device->next = HERE_TRACKING_POOL_NONE;
+
+            pthread_mutex_lock(&(worker->lock));
+
+            if(worker->queue_tail == HERE_TRACKING_POOL_NONE)
+            {
+                worker->queue_head = device_index;
+            }
+            else
+            {
+                pool->devices[worker->queue_tail].next = device_index;
+            }
+
+            worker->queue_tail = device_index;
+            pthread_mutex_unlock(&(worker->lock));
+            here_tracking_pool_wake(worker);
+
+            /* When the worker is full, an idle one takes the request */
+            if(__atomic_load_n(&(worker->free_slots), __ATOMIC_ACQUIRE) == 0)
+            {
+                uint32_t i;
+
+                for(i = 1; i < pool->worker_count; ++i)
+                {
+                    here_tracking_pool_worker* peer =
+                        &(pool->workers[(device_index + i) % pool->worker_count]);
+
+                    if(__atomic_load_n(&(peer->free_slots), __ATOMIC_ACQUIRE) > 0)
+                    {
+                        here_tracking_pool_wake(peer);
+                        break;
+                    }
+                }
+            }
+
+            err = HERE_TRACKING_OK;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_pool_stop(here_tracking_pool* pool)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(pool != NULL && pool->running)
+    {
+        uint32_t i;
+
+        for(i = 0; i < pool->worker_count; ++i)
+        {
+            __atomic_store_n(&(pool->workers[i].stop), true, __ATOMIC_RELEASE);
+            here_tracking_pool_wake(&(pool->workers[i]));
+        }
+
+        for(i = 0; i < pool->worker_count; ++i)
+        {
+            pthread_join(pool->workers[i].thread, NULL);
+        }
+
+        pool->running = false;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+void here_tracking_pool_free(here_tracking_pool* pool)
+{
+    if(pool != NULL)
+    {
+        uint32_t i;
+
+        (void)here_tracking_pool_stop(pool);
+
+        for(i = 0; i < pool->worker_count; ++i)
+        {
+            here_tracking_pool_worker_free(&(pool->workers[i]));
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_pool_worker_init(here_tracking_pool_worker* worker,
+                                                          uint32_t index,
+                                                          uint32_t worker_count,
+                                                          here_tracking_pool_device* devices,
+                                                          here_tracking_pool_slot* slots,
+                                                          uint32_t slot_count)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+    uint32_t i;
+
+    for(i = 0; i < slot_count; ++i)
+    {
+        slots[i].device = NULL;
+        slots[i].connection = NULL;
+        slots[i].fd = -1;
+    }
+
+    worker->devices = devices;
+    worker->slots = slots;
+    worker->slot_count = slot_count;
+    worker->free_slots = slot_count;
+    worker->connections = calloc(slot_count, sizeof(here_tracking_pool_connection));
+    worker->index = index;
+    worker->worker_count = worker_count;
+    worker->queue_head = HERE_TRACKING_POOL_NONE;
+    worker->queue_tail = HERE_TRACKING_POOL_NONE;
+    worker->rate_limiter = NULL;
+    worker->cpu = -1;
+    worker->completed_count = 0;
+    worker->stolen_count = 0;
+    worker->stop = false;
+    worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    worker->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if(worker->connections != NULL && worker->epoll_fd >= 0 && worker->event_fd >= 0)
+    {
+        struct epoll_event ev;
+
+        /* Submissions and stop requests wake the worker through the event fd */
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;
+
+        if(epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->event_fd, &ev) == 0 &&
+           pthread_mutex_init(&(worker->lock), NULL) == 0)
+        {
+            err = HERE_TRACKING_OK;
+        }
+    }
+
+    if(err != HERE_TRACKING_OK)
+    {
+        if(worker->epoll_fd >= 0)
+        {
+            close(worker->epoll_fd);
+        }
+
+        if(worker->event_fd >= 0)
+        {
+            close(worker->event_fd);
+        }
+
+        free(worker->connections);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_worker_free(here_tracking_pool_worker* worker)
+{
+    uint32_t i;
+
+    for(i = 0; i < worker->slot_count; ++i)
+    {
+        if(worker->connections[i].tls != NULL)
+        {
+            (void)here_tracking_tls_free(&(worker->connections[i].tls));
+        }
+    }
+
+    free(worker->connections);
+    close(worker->epoll_fd);
+    close(worker->event_fd);
+    pthread_mutex_destroy(&(worker->lock));
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_wake(here_tracking_pool_worker* worker)
+{
+    uint64_t value = 1;
+
+    /* Fails only if the counter is about to overflow, the worker is woken up anyway then */
+    if(write(worker->event_fd, &value, sizeof(value)) < 0)
+    {
+        /* ignored */
+    }
+}
+
+/**************************************************************************************************/
+
+static void* here_tracking_pool_worker_run(void* arg)
+{
+    here_tracking_pool_worker* worker = (here_tracking_pool_worker*)arg;
+    struct epoll_event events[HERE_TRACKING_POOL_MAX_EVENTS];
+
+    /* Runs unpinned if the CPU isn't available to the process */
+    if(worker->cpu >= 0)
+    {
+        cpu_set_t cpus;
+
+        CPU_ZERO(&cpus);
+        CPU_SET(worker->cpu, &cpus);
+        (void)pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+
+    while(!__atomic_load_n(&(worker->stop), __ATOMIC_ACQUIRE))
+    {
+        int count, i;
+
+        here_tracking_pool_start_ready(worker);
+        count = epoll_wait(worker->epoll_fd,
+                           events,
+                           HERE_TRACKING_POOL_MAX_EVENTS,
+                           here_tracking_pool_next_timeout(worker));
+
+        for(i = 0; i < count; ++i)
+        {
+            here_tracking_pool_slot* slot = (here_tracking_pool_slot*)events[i].data.ptr;
+
+            if(slot == NULL)
+            {
+                uint64_t value;
+
+                if(read(worker->event_fd, &value, sizeof(value)) != sizeof(value))
+                {
+                    value = 0;
+                }
+            }
+            else if(slot->device != NULL)
+            {
+                here_tracking_pool_step(worker, slot);
+            }
+        }
+
+        here_tracking_pool_step_timed_out(worker);
+    }
+
+    here_tracking_pool_cancel_all(worker);
+
+    return NULL;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_pool_device* here_tracking_pool_pop(here_tracking_pool_worker* worker)
+{
+    here_tracking_pool_device* device = NULL;
+
+    pthread_mutex_lock(&(worker->lock));
+
+    if(worker->queue_head != HERE_TRACKING_POOL_NONE)
+    {
+        device = &(worker->devices[worker->queue_head]);
+        worker->queue_head = device->next;
+
+        if(worker->queue_head == HERE_TRACKING_POOL_NONE)
+        {
+            worker->queue_tail = HERE_TRACKING_POOL_NONE;
+        }
+
+        device->next = HERE_TRACKING_POOL_NONE;
+    }
+
+    pthread_mutex_unlock(&(worker->lock));
+
+    return device;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_pool_device* here_tracking_pool_steal(here_tracking_pool_worker* worker)
+{
+    here_tracking_pool_worker* peers = worker - worker->index;
+    here_tracking_pool_device* device = NULL;
+    uint32_t i;
+
+    /* Start from the next worker so that the idle workers don't all go for the same queue */
+    for(i = 1; device == NULL && i < worker->worker_count; ++i)
+    {
+        device = here_tracking_pool_pop(&(peers[(worker->index + i) % worker->worker_count]));
+    }
+
+    if(device != NULL)
+    {
+        __atomic_add_fetch(&(worker->stolen_count), 1, __ATOMIC_RELAXED);
+    }
+
+    return device;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_start_ready(here_tracking_pool_worker* worker)
+{
+    uint32_t i;
+
+    /* Own requests first in the order they were submitted, then the ones of the others */
+    for(i = 0; i < worker->slot_count; ++i)
+    {
+        here_tracking_pool_slot* slot = &(worker->slots[i]);
+
+        if(slot->device == NULL)
+        {
+            here_tracking_pool_device* device = here_tracking_pool_pop(worker);
+            here_tracking_error err;
+
+            if(device == NULL)
+            {
+                device = here_tracking_pool_steal(worker);
+
+                if(device == NULL)
+                {
+                    break;
+                }
+            }
+
+            if(worker->rate_limiter != NULL)
+            {
+                device->client.gateway_rate_limiter = worker->rate_limiter;
+            }
+
+            __atomic_sub_fetch(&(worker->free_slots), 1, __ATOMIC_RELEASE);
+            slot->device = device;
+            slot->connection = here_tracking_pool_borrow(worker, &(device->client));
+            err = here_tracking_send_stream_async(&(slot->async),
+                                                  &(device->client),
+                                                  here_tracking_pool_send_cb,
+                                                  here_tracking_pool_recv_cb,
+                                                  device->req_type,
+                                                  device->resp_type,
+                                                  device);
+
+            if(err == HERE_TRACKING_OK)
+            {
+                here_tracking_pool_step(worker, slot);
+            }
+            else
+            {
+                here_tracking_pool_finish(worker, slot, err);
+            }
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_step(here_tracking_pool_worker* worker,
+                                    here_tracking_pool_slot* slot)
+{
+    here_tracking_error err = here_tracking_async_step(&(slot->async));
+
+    if(err == HERE_TRACKING_ERROR_WOULD_BLOCK)
+    {
+        err = here_tracking_pool_watch(worker, slot);
+
+        if(err != HERE_TRACKING_ERROR_WOULD_BLOCK)
+        {
+            (void)here_tracking_async_cancel(&(slot->async));
+        }
+    }
+
+    if(err != HERE_TRACKING_ERROR_WOULD_BLOCK)
+    {
+        here_tracking_pool_finish(worker, slot, err);
+    }
+}
+
+/**************************************************************************************************/
+
+static here_tracking_pool_connection* \
+    here_tracking_pool_borrow(here_tracking_pool_worker* worker, here_tracking_client* client)
+{
+    here_tracking_pool_connection* connection = NULL;
+    uint32_t i;
+
+    /* There is a connection for each slot, so one is always idle. An open connection to the same
+       endpoint is best, then a closed one that keeps its TLS session for resumption. */
+    for(i = 0; i < worker->slot_count; ++i)
+    {
+        here_tracking_pool_connection* candidate = &(worker->connections[i]);
+
+        if(!candidate->busy)
+        {
+            if(candidate->connected &&
+               strncmp(candidate->host, client->base_url, sizeof(candidate->host)) == 0)
+            {
+                connection = candidate;
+                break;
+            }
+            else if(connection == NULL || (connection->connected && !candidate->connected))
+            {
+                connection = candidate;
+            }
+        }
+    }
+
+    if(connection->connected &&
+       strncmp(connection->host, client->base_url, sizeof(connection->host)) != 0)
+    {
+        (void)here_tracking_tls_close(connection->tls);
+        connection->connected = false;
+    }
+
+    /* The client uses the connection of the worker instead of one of its own */
+    if(client->tls != NULL)
+    {
+        (void)here_tracking_tls_free(&(client->tls));
+    }
+
+    client->tls = connection->tls;
+    client->keep_alive.connected = connection->connected;
+    client->keep_alive.port = connection->port;
+    client->keep_alive.last_used = connection->last_used;
+    client->keep_alive.non_blocking = connection->non_blocking;
+    connection->busy = true;
+
+    return connection;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_give_back(here_tracking_pool_connection* connection,
+                                         here_tracking_client* client)
+{
+    /* The client may have created the TLS context and opened or closed the connection */
+    connection->tls = client->tls;
+    connection->connected = client->keep_alive.connected;
+    connection->port = client->keep_alive.port;
+    connection->last_used = client->keep_alive.last_used;
+    connection->non_blocking = client->keep_alive.non_blocking;
+    memcpy(connection->host, client->base_url, sizeof(connection->host));
+    connection->busy = false;
+    client->tls = NULL;
+    client->keep_alive.connected = false;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_pool_watch(here_tracking_pool_worker* worker,
+                                                   here_tracking_pool_slot* slot)
+{
+    here_tracking_error err;
+    uint8_t events;
+    int fd;
+
+    err = here_tracking_async_get_poll_info(&(slot->async), &fd, &events);
+
+    if(err == HERE_TRACKING_OK)
+    {
+        struct epoll_event ev;
+        int op = (fd == slot->fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = ((events & HERE_TRACKING_TLS_POLL_IN) ? EPOLLIN : 0) |
+                    ((events & HERE_TRACKING_TLS_POLL_OUT) ? EPOLLOUT : 0);
+        ev.data.ptr = slot;
+
+        /* A closed socket has left the epoll set by itself, so the old one is not removed. Its
+           number may have been reused for the new connection. */
+        if(epoll_ctl(worker->epoll_fd, op, fd, &ev) == 0 ||
+           (op == EPOLL_CTL_ADD &&
+            errno == EEXIST &&
+            epoll_ctl(worker->epoll_fd, EPOLL_CTL_MOD, fd, &ev) == 0))
+        {
+            slot->fd = fd;
+            err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+        }
+        else
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static int here_tracking_pool_next_timeout(here_tracking_pool_worker* worker)
+{
+    int timeout = -1;
+    uint32_t i;
+
+    for(i = 0; i < worker->slot_count; ++i)
+    {
+        int32_t slot_timeout;
+
+        if(worker->slots[i].device != NULL &&
+           here_tracking_async_get_timeout(&(worker->slots[i].async), &slot_timeout) ==
+               HERE_TRACKING_OK &&
+           slot_timeout >= 0 &&
+           (timeout < 0 || slot_timeout < timeout))
+        {
+            timeout = slot_timeout;
+        }
+    }
+
+    return timeout;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_step_timed_out(here_tracking_pool_worker* worker)
+{
+    uint32_t i;
+
+    /* The step fails the request with HERE_TRACKING_ERROR_TIMEOUT */
+    for(i = 0; i < worker->slot_count; ++i)
+    {
+        int32_t slot_timeout;
+
+        if(worker->slots[i].device != NULL &&
+           here_tracking_async_get_timeout(&(worker->slots[i].async), &slot_timeout) ==
+               HERE_TRACKING_OK &&
+           slot_timeout == 0)
+        {
+            here_tracking_pool_step(worker, &(worker->slots[i]));
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_cancel_all(here_tracking_pool_worker* worker)
+{
+    here_tracking_pool_device* device;
+    uint32_t i;
+
+    for(i = 0; i < worker->slot_count; ++i)
+    {
+        if(worker->slots[i].device != NULL)
+        {
+            (void)here_tracking_async_cancel(&(worker->slots[i].async));
+            here_tracking_pool_finish(worker,
+                                      &(worker->slots[i]),
+                                      HERE_TRACKING_ERROR_CLIENT_INTERRUPT);
+        }
+    }
+
+    for(device = here_tracking_pool_pop(worker);
+        device != NULL;
+        device = here_tracking_pool_pop(worker))
+    {
+        here_tracking_pool_complete(device, HERE_TRACKING_ERROR_CLIENT_INTERRUPT);
+    }
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_finish(here_tracking_pool_worker* worker,
+                                      here_tracking_pool_slot* slot,
+                                      here_tracking_error err)
+{
+    here_tracking_pool_device* device = slot->device;
+
+    if(slot->fd >= 0)
+    {
+        (void)epoll_ctl(worker->epoll_fd, EPOLL_CTL_DEL, slot->fd, NULL);
+        slot->fd = -1;
+    }
+
+    slot->device = NULL;
+    __atomic_add_fetch(&(worker->free_slots), 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&(worker->completed_count), 1, __ATOMIC_RELAXED);
+
+    here_tracking_pool_give_back(slot->connection, &(device->client));
+    slot->connection = NULL;
+    here_tracking_pool_complete(device, err);
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_complete(here_tracking_pool_device* device,
+                                        here_tracking_error err)
+{
+    if(!device->complete)
+    {
+        here_tracking_recv_data data;
+
+        data.err = err;
+        data.evt = HERE_TRACKING_RECV_EVT_RESP_COMPLETE;
+        data.data = NULL;
+        data.data_size = 0;
+        device->complete = true;
+        device->recv_cb(&data, device->user_data);
+    }
+
+    __atomic_store_n(&(device->busy), false, __ATOMIC_RELEASE);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_pool_send_cb(const uint8_t** data,
+                                                      size_t* data_size,
+                                                      void* user_data)
+{
+    here_tracking_pool_device* device = (here_tracking_pool_device*)user_data;
+
+    return device->send_cb(data, data_size, device->user_data);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_pool_recv_cb(const here_tracking_recv_data* data,
+                                                      void* user_data)
+{
+    here_tracking_pool_device* device = (here_tracking_pool_device*)user_data;
+
+    if(data->evt == HERE_TRACKING_RECV_EVT_RESP_COMPLETE)
+    {
+        device->complete = true;
+    }
+
+    return device->recv_cb(data, device->user_data);
+}
@@ -0,0 +1,410 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2019 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+/* clock_gettime(), nanosleep(), getopt() */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "here_tracking_pool.h"
+#include "here_tracking_version.h"
+
+/**************************************************************************************************/
+
+#define HERE_TRACKING_POOL_LOAD_USER_AGENT "here-tracking-c-load/"HERE_TRACKING_VERSION_STRING
+
+#define HERE_TRACKING_POOL_LOAD_SAMPLE_SIZE 128
+
+typedef struct
+{
+    uint8_t sample[HERE_TRACKING_POOL_LOAD_SAMPLE_SIZE];
+    bool send_complete;
+    uint32_t remaining;
+} here_tracking_pool_load_device;
+
+static uint32_t completed;
+static uint32_t failed;
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_pool_load_send_cb(const uint8_t** data,
+                                                           size_t* data_size,
+                                                           void* user_data)
+{
+    here_tracking_pool_load_device* device = (here_tracking_pool_load_device*)user_data;
+
+    if(!device->send_complete)
+    {
+        struct timespec now;
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        snprintf((char*)device->sample,
+                 HERE_TRACKING_POOL_LOAD_SAMPLE_SIZE,
+                 "[{\"payload\":{\"clientName\":\"here-tracking-c-load\"},\"timestamp\":%llu}]",
+                 ((unsigned long long)now.tv_sec) * 1000 + now.tv_nsec / 1000000);
+        *data = device->sample;
+        *data_size = strlen((char*)device->sample);
+        device->send_complete = true;
+    }
+    else
+    {
+        *data = NULL;
+        *data_size = 0;
+        device->send_complete = false;
+    }
+
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_pool_load_recv_cb(const here_tracking_recv_data* data,
+                                                           void* user_data)
+{
+    if(data->evt == HERE_TRACKING_RECV_EVT_RESP_COMPLETE)
+    {
+        if(data->err != HERE_TRACKING_OK)
+        {
+            __atomic_add_fetch(&failed, 1, __ATOMIC_RELAXED);
+        }
+
+        __atomic_add_fetch(&completed, 1, __ATOMIC_RELEASE);
+    }
+
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static char* here_tracking_pool_load_read_file(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    char* data = NULL;
+
+    if(file != NULL)
+    {
+        long size;
+
+        if(fseek(file, 0, SEEK_END) == 0 &&
+           (size = ftell(file)) >= 0 &&
+           fseek(file, 0, SEEK_SET) == 0 &&
+           (data = malloc(size + 1)) != NULL)
+        {
+            if(fread(data, 1, size, file) == (size_t)size)
+            {
+                data[size] = '\0';
+            }
+            else
+            {
+                free(data);
+                data = NULL;
+            }
+        }
+
+        fclose(file);
+    }
+
+    return data;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_pool_load_env_init(const char* ca_file,
+                                                            here_tracking_tls_env* env)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+
+    *env = NULL;
+
+    /* Without a CA file the pool creates an environment with the built-in certificates */
+    if(ca_file != NULL)
+    {
+        char* pem = here_tracking_pool_load_read_file(ca_file);
+
+        err = HERE_TRACKING_ERROR;
+
+        if(pem != NULL && here_tracking_tls_env_init(env) == HERE_TRACKING_OK)
+        {
+            err = here_tracking_tls_env_add_ca_cert(*env, pem);
+
+            if(err != HERE_TRACKING_OK)
+            {
+                here_tracking_tls_env_free(env);
+            }
+        }
+
+        free(pem);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_pool_load_read_devices(const char* path,
+                                                     const char* base_url,
+                                                     bool keep_alive,
+                                                     here_tracking_pool_device** devices)
+{
+    FILE* file = fopen(path, "r");
+    uint32_t count = 0;
+
+    *devices = NULL;
+
+    if(file != NULL)
+    {
+        char device_id[HERE_TRACKING_DEVICE_ID_SIZE + 1];
+        char device_secret[HERE_TRACKING_DEVICE_SECRET_SIZE + 1];
+        uint32_t capacity = 0;
+        bool ok = true;
+
+        /* One "device_id device_secret" pair per line */
+        while(ok && fscanf(file, "%36s %43s", device_id, device_secret) == 2)
+        {
+            if(count == capacity)
+            {
+                here_tracking_pool_device* grown;
+
+                capacity = (capacity == 0) ? 64 : capacity * 2;
+                grown = realloc(*devices, capacity * sizeof(here_tracking_pool_device));
+                ok = (grown != NULL);
+                *devices = ok ? grown : *devices;
+            }
+
+            if(ok)
+            {
+                here_tracking_client* client = &((*devices)[count].client);
+
+                ok = (here_tracking_init(client, device_id, device_secret, base_url) ==
+                      HERE_TRACKING_OK);
+
+                if(ok)
+                {
+                    client->user_agent = HERE_TRACKING_POOL_LOAD_USER_AGENT;
+                    here_tracking_set_keep_alive(client,
+                                                 keep_alive,
+                                                 HERE_TRACKING_KEEP_ALIVE_DEFAULT_IDLE_TIMEOUT);
+                    count++;
+                }
+            }
+        }
+
+        fclose(file);
+    }
+
+    return count;
+}
+
+/**************************************************************************************************/
+
+static double here_tracking_pool_load_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_pool_load_run(here_tracking_pool* pool,
+                                        here_tracking_pool_load_device* load_devices,
+                                        uint32_t device_count,
+                                        uint32_t total)
+{
+    struct timespec delay = { 0, 1000000 };
+
+    /* Keep every device busy until all of its requests are sent */
+    while(__atomic_load_n(&completed, __ATOMIC_ACQUIRE) < total)
+    {
+        bool submitted = false;
+        uint32_t i;
+
+        for(i = 0; i < device_count; ++i)
+        {
+            if(load_devices[i].remaining > 0 &&
+               here_tracking_pool_submit(pool,
+                                         i,
+                                         here_tracking_pool_load_send_cb,
+                                         here_tracking_pool_load_recv_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_STATUS_ONLY,
+                                         &(load_devices[i])) == HERE_TRACKING_OK)
+            {
+                load_devices[i].remaining--;
+                submitted = true;
+            }
+        }
+
+        if(!submitted)
+        {
+            nanosleep(&delay, NULL);
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+int main(int argc, char** argv)
+{
+    const char* ca_file = NULL;
+    bool keep_alive = false, options_ok = true;
+    int result = -1, opt;
+
+    while((opt = getopt(argc, argv, "kc:")) != -1)
+    {
+        if(opt == 'k')
+        {
+            keep_alive = true;
+        }
+        else if(opt == 'c')
+        {
+            ca_file = optarg;
+        }
+        else
+        {
+            options_ok = false;
+        }
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if(options_ok && argc >= 3)
+    {
+        uint32_t worker_count = (argc >= 4 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 1;
+        uint32_t slots_per_worker = (argc >= 5 && atoi(argv[4]) > 0) ? atoi(argv[4]) : 16;
+        uint32_t requests = (argc >= 6 && atoi(argv[5]) > 0) ? atoi(argv[5]) : 10;
+        bool pin_cpus = (argc >= 7 && atoi(argv[6]) != 0);
+        here_tracking_pool_device* devices;
+        uint32_t device_count = here_tracking_pool_load_read_devices(argv[1],
+                                                                     argv[2],
+                                                                     keep_alive,
+                                                                     &devices);
+        here_tracking_pool_load_device* load_devices =
+            calloc(device_count, sizeof(here_tracking_pool_load_device));
+        here_tracking_pool_worker* workers =
+            calloc(worker_count, sizeof(here_tracking_pool_worker));
+        here_tracking_pool_slot* slots =
+            calloc(worker_count * slots_per_worker, sizeof(here_tracking_pool_slot));
+        here_tracking_tls_env env = NULL;
+        here_tracking_pool pool;
+        uint32_t i;
+
+        if(device_count == 0)
+        {
+            fprintf(stderr, "No devices read from %s\n", argv[1]);
+        }
+        else if(here_tracking_pool_load_env_init(ca_file, &env) != HERE_TRACKING_OK)
+        {
+            fprintf(stderr, "No CA certificates read from %s\n", ca_file);
+        }
+        else if(load_devices != NULL &&
+                workers != NULL &&
+                slots != NULL &&
+                here_tracking_pool_init(&pool,
+                                        devices,
+                                        device_count,
+                                        workers,
+                                        worker_count,
+                                        slots,
+                                        slots_per_worker,
+                                        env) == HERE_TRACKING_OK)
+        {
+            double start;
+
+            for(i = 0; i < device_count; ++i)
+            {
+                load_devices[i].remaining = requests;
+            }
+
+            here_tracking_pool_set_cpu_affinity(&pool, pin_cpus);
+
+            if(here_tracking_pool_start(&pool) == HERE_TRACKING_OK)
+            {
+                double elapsed;
+
+                start = here_tracking_pool_load_now();
+                here_tracking_pool_load_run(&pool,
+                                            load_devices,
+                                            device_count,
+                                            device_count * requests);
+                elapsed = here_tracking_pool_load_now() - start;
+                here_tracking_pool_stop(&pool);
+                printf("devices: %u, workers: %u, slots per worker: %u, keep-alive: %s\n",
+                       device_count,
+                       worker_count,
+                       slots_per_worker,
+                       keep_alive ? "on" : "off");
+                printf("requests: %u, failed: %u, seconds: %.3f, requests/s: %.1f\n",
+                       completed,
+                       failed,
+                       elapsed,
+                       (elapsed > 0) ? completed / elapsed : 0.0);
+
+                for(i = 0; i < worker_count; ++i)
+                {
+                    printf("worker %u: completed %u, stolen %u\n",
+                           i,
+                           workers[i].completed_count,
+                           workers[i].stolen_count);
+                }
+
+                result = (failed == 0) ? 0 : -1;
+            }
+
+            here_tracking_pool_free(&pool);
+        }
+
+        /* The clients hold their own references to the environment */
+        if(env != NULL)
+        {
+            here_tracking_tls_env_free(&env);
+        }
+
+        for(i = 0; i < device_count; ++i)
+        {
+            here_tracking_free(&(devices[i].client));
+        }
+
+        free(slots);
+        free(workers);
+        free(load_devices);
+        free(devices);
+    }
+    else
+    {
+        fprintf(stderr,
+                "Usage: ./here_tracking_pool_load [-k] [-c ca_file] devices_file base_url "
+                "[worker_count] [slots_per_worker] [requests_per_device] [pin_cpus]\n"
+                "  -k          keep connections open between requests\n"
+                "  -c ca_file  trust the CA certificates in the PEM file\n");
+    }
+
+    return result;
+}
@@ -0,0 +1,110 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/* ftruncate(), msync() */
+#define _POSIX_C_SOURCE 200112L
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "here_tracking_queue_file.h"
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_queue_file_open(here_tracking_queue_file* file,
+                                                  const char* path,
+                                                  uint32_t size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(file != NULL && path != NULL && size >= HERE_TRACKING_QUEUE_MIN_SIZE)
+    {
+        struct stat st;
+        void* map = MAP_FAILED;
+
+        err = HERE_TRACKING_ERROR;
+        file->fd = open(path, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+        file->map = NULL;
+
+        /* Extending the file fills it with zeros, which is formatted as an empty queue */
+        if(file->fd >= 0 &&
+           fstat(file->fd, &st) == 0 &&
+           (st.st_size == size || ftruncate(file->fd, size) == 0))
+        {
+            map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+        }
+
+        if(map != MAP_FAILED)
+        {
+            file->map = (uint8_t*)map;
+            file->map_size = size;
+            err = here_tracking_queue_open(&(file->queue), file->map, size);
+        }
+
+        if(err != HERE_TRACKING_OK)
+        {
+            here_tracking_queue_file_close(file);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_queue_file_sync(here_tracking_queue_file* file)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(file != NULL && file->map != NULL)
+    {
+        err = (msync(file->map, file->map_size, MS_SYNC) == 0) ?
+            HERE_TRACKING_OK : HERE_TRACKING_ERROR;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+void here_tracking_queue_file_close(here_tracking_queue_file* file)
+{
+    if(file != NULL)
+    {
+        if(file->map != NULL)
+        {
+            (void)munmap(file->map, file->map_size);
+            file->map = NULL;
+        }
+
+        if(file->fd >= 0)
+        {
+            (void)close(file->fd);
+            file->fd = -1;
+        }
+    }
+}
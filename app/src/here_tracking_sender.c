@@ -0,0 +1,477 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/* clock_gettime(), pthread_condattr_setclock() */
+#define _POSIX_C_SOURCE 200112L
+
+#include <string.h>
+#include <time.h>
+
+#include "here_tracking_sender.h"
+
+/**************************************************************************************************/
+
+static here_tracking_sender_slot* here_tracking_sender_peek(here_tracking_sender* sender);
+
+static void here_tracking_sender_pop(here_tracking_sender* sender);
+
+static bool here_tracking_sender_drain(here_tracking_sender* sender, bool* allowed);
+
+static bool here_tracking_sender_sent(here_tracking_sender* sender, here_tracking_error err);
+
+static void here_tracking_sender_finish(here_tracking_sender* sender);
+
+static void here_tracking_sender_wait(here_tracking_sender* sender, uint32_t wait_ms, bool blocked);
+
+static void* here_tracking_sender_worker(void* arg);
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_sender_init(here_tracking_sender* sender,
+                                              here_tracking_client* client,
+                                              here_tracking_req_type req_type,
+                                              here_tracking_sender_slot* slots,
+                                              uint32_t slot_count,
+                                              uint8_t* batch_buffer,
+                                              uint32_t batch_buffer_size,
+                                              here_tracking_recv_cb recv_cb,
+                                              void* user_data)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(sender != NULL &&
+       slots != NULL &&
+       slot_count >= 2 &&
+       slot_count <= (UINT32_MAX / 2) + 1 &&
+       (slot_count & (slot_count - 1)) == 0)
+    {
+        err = here_tracking_batcher_init(&(sender->batcher),
+                                         client,
+                                         req_type,
+                                         batch_buffer,
+                                         batch_buffer_size,
+                                         recv_cb,
+                                         user_data);
+    }
+
+    if(err == HERE_TRACKING_OK)
+    {
+        err = here_tracking_scheduler_init(&(sender->scheduler),
+                                           client,
+                                           0,
+                                           0,
+                                           HERE_TRACKING_SCHEDULER_DEFAULT_SPREAD_MS);
+    }
+
+    if(err == HERE_TRACKING_OK)
+    {
+        pthread_condattr_t attr;
+        uint32_t i;
+
+        /* Slot is free for the producer at position seq and full for the consumer at seq - 1 */
+        for(i = 0; i < slot_count; ++i)
+        {
+            slots[i].seq = i;
+        }
+
+        sender->slots = slots;
+        sender->slot_mask = slot_count - 1;
+        sender->enqueue_pos = 0;
+        sender->dequeue_pos = 0;
+        sender->dropped = 0;
+        sender->stop = false;
+        sender->running = false;
+        err = HERE_TRACKING_ERROR;
+
+        if(pthread_condattr_init(&attr) == 0)
+        {
+            if(pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0 &&
+               pthread_cond_init(&(sender->cond), &attr) == 0)
+            {
+                if(pthread_mutex_init(&(sender->lock), NULL) == 0)
+                {
+                    err = HERE_TRACKING_OK;
+                }
+                else
+                {
+                    pthread_cond_destroy(&(sender->cond));
+                }
+            }
+
+            pthread_condattr_destroy(&attr);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_sender_start(here_tracking_sender* sender)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(sender != NULL && !sender->running)
+    {
+        sender->stop = false;
+        err = HERE_TRACKING_ERROR;
+
+        if(pthread_create(&(sender->thread), NULL, here_tracking_sender_worker, sender) == 0)
+        {
+            sender->running = true;
+            err = HERE_TRACKING_OK;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_sender_push(here_tracking_sender* sender,
+                                              const uint8_t* sample,
+                                              uint32_t sample_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(sender != NULL && sample != NULL && sample_size > 0)
+    {
+        err = HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+
+        if(sample_size <= HERE_TRACKING_SENDER_SAMPLE_MAX_SIZE)
+        {
+            uint32_t pos = __atomic_load_n(&(sender->enqueue_pos), __ATOMIC_RELAXED);
+            here_tracking_sender_slot* slot = NULL;
+            bool done = false;
+
+            /* Producers claim a slot by moving the enqueue position, the slot sequence tells
+               whether the consumer has released it yet */
+            while(!done)
+            {
+                int32_t diff;
+
+                slot = &(sender->slots[pos & sender->slot_mask]);
+                diff = (int32_t)(__atomic_load_n(&(slot->seq), __ATOMIC_ACQUIRE) - pos);
+
+                if(diff == 0)
+                {
+                    done = __atomic_compare_exchange_n(&(sender->enqueue_pos),
+                                                       &pos,
+                                                       pos + 1,
+                                                       true,
+                                                       __ATOMIC_RELAXED,
+                                                       __ATOMIC_RELAXED);
+                }
+                else if(diff < 0)
+                {
+                    slot = NULL;
+                    done = true;
+                }
+                else
+                {
+                    pos = __atomic_load_n(&(sender->enqueue_pos), __ATOMIC_RELAXED);
+                }
+            }
+
+            if(slot != NULL)
+            {
+                memcpy(slot->data, sample, sample_size);
+                slot->size = sample_size;
+                __atomic_store_n(&(slot->seq), pos + 1, __ATOMIC_RELEASE);
+                pthread_cond_signal(&(sender->cond));
+                err = HERE_TRACKING_OK;
+            }
+        }
+
+        if(err != HERE_TRACKING_OK)
+        {
+            __atomic_add_fetch(&(sender->dropped), 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+uint32_t here_tracking_sender_get_dropped(here_tracking_sender* sender)
+{
+    return (sender != NULL) ? __atomic_load_n(&(sender->dropped), __ATOMIC_RELAXED) : 0;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_sender_stop(here_tracking_sender* sender)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(sender != NULL && sender->running)
+    {
+        pthread_mutex_lock(&(sender->lock));
+        __atomic_store_n(&(sender->stop), true, __ATOMIC_RELEASE);
+        pthread_cond_signal(&(sender->cond));
+        pthread_mutex_unlock(&(sender->lock));
+        pthread_join(sender->thread, NULL);
+        sender->running = false;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+void here_tracking_sender_free(here_tracking_sender* sender)
+{
+    if(sender != NULL)
+    {
+        (void)here_tracking_sender_stop(sender);
+        pthread_cond_destroy(&(sender->cond));
+        pthread_mutex_destroy(&(sender->lock));
+    }
+}
+
+/**************************************************************************************************/
+
+static here_tracking_sender_slot* here_tracking_sender_peek(here_tracking_sender* sender)
+{
+    here_tracking_sender_slot* slot = &(sender->slots[sender->dequeue_pos & sender->slot_mask]);
+
+    if(__atomic_load_n(&(slot->seq), __ATOMIC_ACQUIRE) != sender->dequeue_pos + 1)
+    {
+        slot = NULL;
+    }
+
+    return slot;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_sender_pop(here_tracking_sender* sender)
+{
+    here_tracking_sender_slot* slot = &(sender->slots[sender->dequeue_pos & sender->slot_mask]);
+
+    /* Free for the producer one lap later */
+    __atomic_store_n(&(slot->seq), sender->dequeue_pos + sender->slot_mask + 1, __ATOMIC_RELEASE);
+    sender->dequeue_pos++;
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_sender_drain(here_tracking_sender* sender, bool* allowed)
+{
+    here_tracking_batcher* batcher = &(sender->batcher);
+    here_tracking_sender_slot* slot;
+    bool blocked = false;
+
+    while(!blocked && (slot = here_tracking_sender_peek(sender)) != NULL)
+    {
+        if(!here_tracking_batcher_has_room(batcher, slot->size))
+        {
+            /* A rejected batch is dropped, so only other errors leave it in place */
+            if(*allowed)
+            {
+                here_tracking_error err = here_tracking_batcher_flush(batcher);
+                (*allowed) = here_tracking_sender_sent(sender, err);
+            }
+
+            blocked = !here_tracking_batcher_has_room(batcher, slot->size);
+        }
+        else if(!(*allowed) &&
+                batcher->max_samples > 0 &&
+                batcher->count + 1 >= batcher->max_samples)
+        {
+            /* Adding the sample would send the batch */
+            blocked = true;
+        }
+
+        if(!blocked)
+        {
+            here_tracking_error err = here_tracking_batcher_add(batcher, slot->data, slot->size);
+
+            if(err == HERE_TRACKING_ERROR_BUFFER_TOO_SMALL)
+            {
+                __atomic_add_fetch(&(sender->dropped), 1, __ATOMIC_RELAXED);
+            }
+            else if(err != HERE_TRACKING_OK || batcher->count == 0)
+            {
+                /* Errors from sending a full batch leave the batch for a later try */
+                (*allowed) = here_tracking_sender_sent(sender, err);
+            }
+
+            here_tracking_sender_pop(sender);
+        }
+    }
+
+    return blocked;
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_sender_sent(here_tracking_sender* sender, here_tracking_error err)
+{
+    (void)here_tracking_scheduler_update(&(sender->scheduler), err);
+
+    return (here_tracking_scheduler_ready(&(sender->scheduler), NULL) !=
+            HERE_TRACKING_ERROR_WOULD_BLOCK);
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_sender_finish(here_tracking_sender* sender)
+{
+    here_tracking_batcher* batcher = &(sender->batcher);
+    here_tracking_sender_slot* slot;
+    uint32_t dropped;
+    bool blocked;
+
+    /* Last chance, so the scheduler is ignored. A batch that is neither sent nor rejected stays
+       in the batcher and ends the loop. */
+    do
+    {
+        bool allowed = true;
+        uint32_t count;
+        here_tracking_error err;
+
+        blocked = here_tracking_sender_drain(sender, &allowed);
+        count = batcher->count;
+        err = here_tracking_batcher_flush(batcher);
+
+        if(count > 0)
+        {
+            (void)here_tracking_sender_sent(sender, err);
+        }
+    } while(blocked && batcher->count == 0);
+
+    /* The rest is discarded so that it isn't sent after a restart */
+    dropped = batcher->count;
+    batcher->count = 0;
+    batcher->size = 0;
+
+    while((slot = here_tracking_sender_peek(sender)) != NULL)
+    {
+        here_tracking_sender_pop(sender);
+        dropped++;
+    }
+
+    if(dropped > 0)
+    {
+        __atomic_add_fetch(&(sender->dropped), dropped, __ATOMIC_RELAXED);
+    }
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_sender_wait(here_tracking_sender* sender, uint32_t wait_ms, bool blocked)
+{
+    struct timespec deadline;
+    int res = 0;
+
+    if(!blocked && wait_ms > HERE_TRACKING_SENDER_MAX_WAIT_MS)
+    {
+        wait_ms = HERE_TRACKING_SENDER_MAX_WAIT_MS;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += wait_ms / 1000;
+    deadline.tv_nsec += (long)(wait_ms % 1000) * 1000000L;
+
+    if(deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&(sender->lock));
+
+    /* While the batch can't be sent, new samples don't need to wake the worker up. A sample
+       pushed just before the wait starts is picked up at the latest when the wait times out. */
+    while(res == 0 &&
+          !__atomic_load_n(&(sender->stop), __ATOMIC_ACQUIRE) &&
+          (blocked || here_tracking_sender_peek(sender) == NULL))
+    {
+        res = pthread_cond_timedwait(&(sender->cond), &(sender->lock), &deadline);
+    }
+
+    pthread_mutex_unlock(&(sender->lock));
+}
+
+/**************************************************************************************************/
+
+static void* here_tracking_sender_worker(void* arg)
+{
+    here_tracking_sender* sender = (here_tracking_sender*)arg;
+    bool stop = false;
+
+    while(!stop)
+    {
+        uint32_t wait_ms = HERE_TRACKING_SENDER_MAX_WAIT_MS, scheduler_wait_ms = 0;
+        bool allowed, blocked;
+
+        /* Samples pushed before the stop are sent or counted as dropped */
+        stop = __atomic_load_n(&(sender->stop), __ATOMIC_ACQUIRE);
+        allowed = (here_tracking_scheduler_ready(&(sender->scheduler), NULL) !=
+                   HERE_TRACKING_ERROR_WOULD_BLOCK);
+        blocked = here_tracking_sender_drain(sender, &allowed);
+
+        if(stop)
+        {
+            here_tracking_sender_finish(sender);
+        }
+        else if(allowed && !blocked)
+        {
+            uint32_t count = sender->batcher.count;
+            here_tracking_error err = here_tracking_batcher_poll(&(sender->batcher), &wait_ms);
+
+            if(count > 0 && (err != HERE_TRACKING_OK || sender->batcher.count == 0))
+            {
+                (void)here_tracking_sender_sent(sender, err);
+            }
+        }
+
+        if(!stop)
+        {
+            if(here_tracking_scheduler_ready(&(sender->scheduler), &scheduler_wait_ms) ==
+               HERE_TRACKING_ERROR_WOULD_BLOCK)
+            {
+                wait_ms = scheduler_wait_ms;
+            }
+            else if(blocked)
+            {
+                wait_ms = sender->batcher.max_linger_ms;
+            }
+
+            /* Neither the linger time nor a jittered delay may be 0, retry no faster than after
+               the first failure while the batch is stuck */
+            if(blocked && wait_ms < sender->scheduler.base_delay_ms)
+            {
+                wait_ms = sender->scheduler.base_delay_ms;
+            }
+
+            here_tracking_sender_wait(sender, wait_ms, blocked);
+        }
+    }
+
+    return NULL;
+}
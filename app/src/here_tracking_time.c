@@ -22,6 +22,8 @@
 * SOFTWARE.                                                                                       *
 **************************************************************************************************/
 
+#define _POSIX_C_SOURCE 199309L
+
 #include <time.h>
 
 #include "here_tracking_time.h"
@@ -45,3 +47,23 @@ here_tracking_error here_tracking_get_unixtime(uint32_t* ts)
 
     return err;
 }
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_get_monotonic_ms(uint32_t* ms)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(ms != NULL)
+    {
+        struct timespec ts;
+
+        if(clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        {
+            (*ms) = (uint32_t)(((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000));
+            err = HERE_TRACKING_OK;
+        }
+    }
+
+    return err;
+}
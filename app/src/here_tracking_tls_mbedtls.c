@@ -22,6 +22,10 @@
 * SOFTWARE.                                                                                       *
 **************************************************************************************************/
 
+/* POSIX sockets */
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -37,24 +41,56 @@
 #endif
 
 #include "here_tracking_log.h"
+#include "here_tracking_time.h"
 #include "here_tracking_tls.h"
 #include "here_tracking_tls_cert.h"
+#include "here_tracking_tls_socket.h"
 
 /**************************************************************************************************/
 
+#define HERE_TRACKING_TLS_CONNECT_IDLE      0
+#define HERE_TRACKING_TLS_CONNECT_TCP       1
+#define HERE_TRACKING_TLS_CONNECT_HANDSHAKE 2
+
 typedef struct
 {
+    pthread_mutex_t lock;
+    uint32_t ref_count;
+    here_tracking_tls_dns_cache dns_cache;
     mbedtls_ctr_drbg_context ctr_drbg_ctx;
     mbedtls_entropy_context entropy_ctx;
+    mbedtls_ssl_config ssl_conf;
+    mbedtls_x509_crt crt_ctx;
+} here_tracking_tls_mbedtls_env;
+
+typedef struct
+{
+    here_tracking_tls_mbedtls_env* env;
     mbedtls_net_context net_ctx;
     mbedtls_ssl_context ssl_ctx;
-    mbedtls_ssl_config ssl_conf;
     mbedtls_ssl_session ssl_session;
-    mbedtls_x509_crt crt_ctx;
+    bool session_valid; /**< Has a session been negotiated or restored */
+    bool non_blocking; /**< Was the connection opened with here_tracking_tls_connect_async() */
+    uint8_t connect_state; /**< Progress of here_tracking_tls_connect_async() */
+    uint8_t poll_events; /**< Events the non-blocking connection is waiting for */
+    uint32_t deadline; /**< Deadline of blocking operations, 0 if there is none */
+    here_tracking_tls_connector connector; /**< Addresses of the current connect */
+    bool dns_retry; /**< Connecting to cached addresses failed, resolve the host again */
+    const char** alpn; /**< Protocols offered with ALPN, NULL if none */
+#if defined MBEDTLS_SSL_ALPN
+    mbedtls_ssl_config alpn_conf; /**< Copy of the shared configuration with the ALPN protocols */
+#endif
 } here_tracking_tls_mbedtls;
 
 /**************************************************************************************************/
 
+static pthread_mutex_t here_tracking_tls_default_env_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Created on first use and kept for the lifetime of the process. */
+static here_tracking_tls_env here_tracking_tls_default_env = NULL;
+
+/**************************************************************************************************/
+
 #if defined MBEDTLS_DEBUG_C && HERE_TRACKING_LOG_LEVEL <= HERE_TRACKING_LOG_LEVEL_ERROR
 
 static void here_tracking_tls_debug_cb(void* ctx,
@@ -82,52 +118,258 @@ static void here_tracking_tls_debug_cb(void* ctx,
 
 /**************************************************************************************************/
 
-here_tracking_error here_tracking_tls_init(here_tracking_tls* tls)
+static int here_tracking_tls_ssl_setup(here_tracking_tls_mbedtls* tls_ctx, const char* host);
+
+static here_tracking_error here_tracking_tls_wait(here_tracking_tls_mbedtls* tls_ctx, int res);
+
+static here_tracking_error here_tracking_tls_poll(here_tracking_tls_mbedtls* tls_ctx);
+
+static void here_tracking_tls_dns_failed(here_tracking_tls_mbedtls* tls_ctx,
+                                         const char* host,
+                                         uint16_t port);
+
+/**************************************************************************************************/
+
+static int here_tracking_tls_env_random(void* p_rng, unsigned char* output, size_t output_len)
+{
+    here_tracking_tls_mbedtls_env* env_ctx = (here_tracking_tls_mbedtls_env*)p_rng;
+    int res;
+
+    /* The DRBG is shared by all connections using the environment, possibly from many threads. */
+    pthread_mutex_lock(&(env_ctx->lock));
+    res = mbedtls_ctr_drbg_random(&(env_ctx->ctr_drbg_ctx), output, output_len);
+    pthread_mutex_unlock(&(env_ctx->lock));
+    return res;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_tls_env_release(here_tracking_tls_mbedtls_env* env_ctx)
+{
+    mbedtls_ssl_config_free(&(env_ctx->ssl_conf));
+    mbedtls_x509_crt_free(&(env_ctx->crt_ctx));
+    mbedtls_ctr_drbg_free(&(env_ctx->ctr_drbg_ctx));
+    mbedtls_entropy_free(&(env_ctx->entropy_ctx));
+    here_tracking_tls_dns_cache_free(&(env_ctx->dns_cache));
+    pthread_mutex_destroy(&(env_ctx->lock));
+    free(env_ctx);
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_init(here_tracking_tls_env* env)
 {
     here_tracking_error err = HERE_TRACKING_ERROR;
 
-    if(tls != NULL)
+    if(env != NULL)
     {
-        here_tracking_tls_mbedtls* tls_ctx = malloc(sizeof(here_tracking_tls_mbedtls));
+        here_tracking_tls_mbedtls_env* env_ctx = malloc(sizeof(here_tracking_tls_mbedtls_env));
 
-        if(tls_ctx != NULL)
+        if(env_ctx != NULL &&
+           pthread_mutex_init(&(env_ctx->lock), NULL) == 0 &&
+           here_tracking_tls_dns_cache_init(&(env_ctx->dns_cache)) == HERE_TRACKING_OK)
         {
             int res;
 
-            mbedtls_ctr_drbg_init(&(tls_ctx->ctr_drbg_ctx));
-            mbedtls_entropy_init(&(tls_ctx->entropy_ctx));
-            mbedtls_net_init(&(tls_ctx->net_ctx));
-            mbedtls_ssl_init(&(tls_ctx->ssl_ctx));
-            mbedtls_ssl_config_init(&(tls_ctx->ssl_conf));
-            mbedtls_ssl_session_init(&(tls_ctx->ssl_session));
-            mbedtls_x509_crt_init(&(tls_ctx->crt_ctx));
-            res = mbedtls_ctr_drbg_seed(&(tls_ctx->ctr_drbg_ctx),
+            env_ctx->ref_count = 1;
+            mbedtls_ctr_drbg_init(&(env_ctx->ctr_drbg_ctx));
+            mbedtls_entropy_init(&(env_ctx->entropy_ctx));
+            mbedtls_ssl_config_init(&(env_ctx->ssl_conf));
+            mbedtls_x509_crt_init(&(env_ctx->crt_ctx));
+            res = mbedtls_ctr_drbg_seed(&(env_ctx->ctr_drbg_ctx),
                                         mbedtls_entropy_func,
-                                        &(tls_ctx->entropy_ctx),
+                                        &(env_ctx->entropy_ctx),
                                         NULL,
                                         0);
 
             if(res == 0)
             {
-                res = mbedtls_x509_crt_parse(&(tls_ctx->crt_ctx),
+                res = mbedtls_x509_crt_parse(&(env_ctx->crt_ctx),
                                     (unsigned char*)here_tracking_tls_cert_globalsign_root_r3,
                                     strlen(here_tracking_tls_cert_globalsign_root_r3) + 1);
             }
 
             if(res == 0)
             {
+                res = mbedtls_ssl_config_defaults(&(env_ctx->ssl_conf),
+                                                  MBEDTLS_SSL_IS_CLIENT,
+                                                  MBEDTLS_SSL_TRANSPORT_STREAM,
+                                                  MBEDTLS_SSL_PRESET_DEFAULT);
+            }
+
+            if(res == 0)
+            {
+#if defined MBEDTLS_DEBUG_C
+                /*
+                 * mbedtls debug levels are defined and mapped to HERE_TRACKING_LOG_LEVEL as follows:
+                 *    0 - none         - HERE_TRACKING_LOG_LEVEL_NONE, HERE_TRACKING_LOG_LEVEL_FATAL
+                 *    1 - error        - HERE_TRACKING_LOG_LEVEL_ERROR
+                 *    2 - state change - HERE_TRACKING_LOG_LEVEL_INFO
+                 *    3 - info         - HERE_TRACKING_LOG_LEVEL_INFO
+                 *    4 - verbose      - Never enabled
+                 */
+#if HERE_TRACKING_LOG_LEVEL <= HERE_TRACKING_LOG_LEVEL_ERROR
+                mbedtls_ssl_conf_dbg(&(env_ctx->ssl_conf), here_tracking_tls_debug_cb, NULL);
+#if HERE_TRACKING_LOG_LEVEL == HERE_TRACKING_LOG_LEVEL_ERROR
+                mbedtls_debug_set_threshold(1);
+#elif HERE_TRACKING_LOG_LEVEL == HERE_TRACKING_LOG_LEVEL_WARNING
+                mbedtls_debug_set_threshold(1);
+#elif HERE_TRACKING_LOG_LEVEL == HERE_TRACKING_LOG_LEVEL_INFO
+                mbedtls_debug_set_threshold(3);
+#endif
+#endif /* HERE_TRACKING_LOG_LEVEL != HERE_TRACKING_LOG_LEVEL_NONE */
+#endif /* MBEDTLS_DEBUG_C */
+                mbedtls_ssl_conf_ca_chain(&(env_ctx->ssl_conf), &(env_ctx->crt_ctx), NULL);
+                mbedtls_ssl_conf_rng(&(env_ctx->ssl_conf), here_tracking_tls_env_random, env_ctx);
+                *env = (here_tracking_tls_env)env_ctx;
+                err = HERE_TRACKING_OK;
+            }
+            else
+            {
+                here_tracking_tls_env_release(env_ctx);
+            }
+        }
+        else
+        {
+            free(env_ctx);
+        }
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_ref(here_tracking_tls_env env)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(env != NULL)
+    {
+        here_tracking_tls_mbedtls_env* env_ctx = (here_tracking_tls_mbedtls_env*)env;
+
+        pthread_mutex_lock(&(env_ctx->lock));
+        env_ctx->ref_count++;
+        pthread_mutex_unlock(&(env_ctx->lock));
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_free(here_tracking_tls_env* env)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(env != NULL && *env != NULL)
+    {
+        here_tracking_tls_mbedtls_env* env_ctx = (here_tracking_tls_mbedtls_env*)(*env);
+        uint32_t ref_count;
+
+        pthread_mutex_lock(&(env_ctx->lock));
+        ref_count = --(env_ctx->ref_count);
+        pthread_mutex_unlock(&(env_ctx->lock));
+
+        if(ref_count == 0)
+        {
+            here_tracking_tls_env_release(env_ctx);
+        }
+
+        *env = NULL;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_set_dns_cache_ttl(here_tracking_tls_env env, uint32_t ttl)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(env != NULL)
+    {
+        here_tracking_tls_dns_cache_set_ttl(&(((here_tracking_tls_mbedtls_env*)env)->dns_cache),
+                                            ttl);
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_add_ca_cert(here_tracking_tls_env env, const char* pem)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(env != NULL && pem != NULL)
+    {
+        here_tracking_tls_mbedtls_env* env_ctx = (here_tracking_tls_mbedtls_env*)env;
+        int res;
+
+        /* The chain is already configured as the CA chain, parsed certificates are appended */
+        res = mbedtls_x509_crt_parse(&(env_ctx->crt_ctx),
+                                     (const unsigned char*)pem,
+                                     strlen(pem) + 1);
+        err = (res == 0) ? HERE_TRACKING_OK : HERE_TRACKING_ERROR;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_init(here_tracking_tls* tls, here_tracking_tls_env env)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(tls != NULL)
+    {
+        here_tracking_tls_mbedtls* tls_ctx = malloc(sizeof(here_tracking_tls_mbedtls));
+
+        if(tls_ctx != NULL)
+        {
+            if(env == NULL)
+            {
+                pthread_mutex_lock(&here_tracking_tls_default_env_lock);
+
+                if(here_tracking_tls_default_env == NULL)
+                {
+                    here_tracking_tls_env_init(&here_tracking_tls_default_env);
+                }
+
+                env = here_tracking_tls_default_env;
+                pthread_mutex_unlock(&here_tracking_tls_default_env_lock);
+            }
+
+            if(here_tracking_tls_env_ref(env) == HERE_TRACKING_OK)
+            {
+                tls_ctx->env = (here_tracking_tls_mbedtls_env*)env;
+                mbedtls_net_init(&(tls_ctx->net_ctx));
+                mbedtls_ssl_init(&(tls_ctx->ssl_ctx));
+                mbedtls_ssl_session_init(&(tls_ctx->ssl_session));
+                tls_ctx->session_valid = false;
+                tls_ctx->non_blocking = false;
+                tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
+                tls_ctx->poll_events = 0;
+                tls_ctx->deadline = 0;
+                tls_ctx->connector.addr_count = 0;
+                tls_ctx->connector.cached = false;
+                tls_ctx->dns_retry = false;
+                tls_ctx->alpn = NULL;
                 *tls = (here_tracking_tls)tls_ctx;
                 err = HERE_TRACKING_OK;
             }
             else
             {
-                mbedtls_x509_crt_free(&(tls_ctx->crt_ctx));
-                mbedtls_ssl_session_free(&(tls_ctx->ssl_session));
-                mbedtls_ssl_config_free(&(tls_ctx->ssl_conf));
-                mbedtls_ssl_free(&(tls_ctx->ssl_ctx));
-                mbedtls_net_free(&(tls_ctx->net_ctx));
-                mbedtls_entropy_free(&(tls_ctx->entropy_ctx));
-                mbedtls_ctr_drbg_free(&(tls_ctx->ctr_drbg_ctx));
                 free(tls_ctx);
             }
         }
@@ -151,12 +393,11 @@ here_tracking_error here_tracking_tls_free(here_tracking_tls* tls)
         if(*tls != NULL)
         {
             here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)(*tls);
+            here_tracking_tls_env env = (here_tracking_tls_env)tls_ctx->env;
 
             here_tracking_tls_close(*tls);
-            mbedtls_entropy_free(&(tls_ctx->entropy_ctx));
-            mbedtls_ctr_drbg_free(&(tls_ctx->ctr_drbg_ctx));
-            mbedtls_x509_crt_free(&(tls_ctx->crt_ctx));
             mbedtls_ssl_session_free(&(tls_ctx->ssl_session));
+            here_tracking_tls_env_free(&env);
             free(tls_ctx);
             *tls = NULL;
             err = HERE_TRACKING_OK;
@@ -181,90 +422,154 @@ here_tracking_error here_tracking_tls_connect(here_tracking_tls tls,
     if(tls != NULL && host != NULL && strlen(host) > 0)
     {
         here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)tls;
-        char port_string[6];
-        int res;
 
-        snprintf(port_string, 6, "%u", port);
-        res = mbedtls_net_connect(&(tls_ctx->net_ctx), host, port_string, MBEDTLS_NET_PROTO_TCP);
+        bool retry;
 
-        if(res == 0)
+        do
         {
-            res = mbedtls_ssl_config_defaults(&(tls_ctx->ssl_conf),
-                                              MBEDTLS_SSL_IS_CLIENT,
-                                              MBEDTLS_SSL_TRANSPORT_STREAM,
-                                              MBEDTLS_SSL_PRESET_DEFAULT);
-#if defined MBEDTLS_DEBUG_C
-            /*
-             * mbedtls debug levels are defined and mapped to HERE_TRACKING_LOG_LEVEL as follows:
-             *    0 - none         - HERE_TRACKING_LOG_LEVEL_NONE, HERE_TRACKING_LOG_LEVEL_FATAL
-             *    1 - error        - HERE_TRACKING_LOG_LEVEL_ERROR
-             *    2 - state change - HERE_TRACKING_LOG_LEVEL_INFO
-             *    3 - info         - HERE_TRACKING_LOG_LEVEL_INFO
-             *    4 - verbose      - Never enabled
-             */
-#if HERE_TRACKING_LOG_LEVEL <= HERE_TRACKING_LOG_LEVEL_ERROR
-            mbedtls_ssl_conf_dbg(&(tls_ctx->ssl_conf), here_tracking_tls_debug_cb, NULL);
-#if HERE_TRACKING_LOG_LEVEL == HERE_TRACKING_LOG_LEVEL_ERROR
-            mbedtls_debug_set_threshold(1);
-#elif HERE_TRACKING_LOG_LEVEL == HERE_TRACKING_LOG_LEVEL_WARNING
-            mbedtls_debug_set_threshold(1);
-#elif HERE_TRACKING_LOG_LEVEL == HERE_TRACKING_LOG_LEVEL_INFO
-            mbedtls_debug_set_threshold(3);
-#endif
-#endif /* HERE_TRACKING_LOG_LEVEL != HERE_TRACKING_LOG_LEVEL_NONE */
-#endif /* MBEDTLS_DEBUG_C */
-        }
+            /* The socket is always non-blocking so that the connect, the handshake and later
+               reads and writes can wait in poll() until the deadline instead of blocking
+               indefinitely. */
+            tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
+            err = here_tracking_tls_connect_async(tls, host, port);
+
+            while(err == HERE_TRACKING_ERROR_WOULD_BLOCK)
+            {
+                err = here_tracking_tls_poll(tls_ctx);
+
+                if(err == HERE_TRACKING_OK)
+                {
+                    err = here_tracking_tls_connect_async(tls, host, port);
+                }
+                else
+                {
+                    tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
+                    mbedtls_ssl_free(&(tls_ctx->ssl_ctx));
+                    mbedtls_net_free(&(tls_ctx->net_ctx));
+                }
+            }
+
+            /* Cached addresses may be stale, try once more with freshly resolved ones */
+            retry = (err == HERE_TRACKING_ERROR && tls_ctx->dns_retry);
+            tls_ctx->dns_retry = false;
+        } while(retry);
 
-        if(res == 0)
+        tls_ctx->non_blocking = false;
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_connect_async(here_tracking_tls tls,
+                                                    const char* host,
+                                                    uint16_t port)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && host != NULL && strlen(host) > 0)
+    {
+        here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)tls;
+
+        err = HERE_TRACKING_OK;
+
+        if(tls_ctx->connect_state == HERE_TRACKING_TLS_CONNECT_IDLE)
         {
-            mbedtls_ssl_conf_ca_chain(&(tls_ctx->ssl_conf), &(tls_ctx->crt_ctx), NULL);
-            mbedtls_ssl_conf_rng(&(tls_ctx->ssl_conf),
-                                 mbedtls_ctr_drbg_random,
-                                 &(tls_ctx->ctr_drbg_ctx));
-            res = mbedtls_ssl_setup(&(tls_ctx->ssl_ctx), &(tls_ctx->ssl_conf));
+            tls_ctx->non_blocking = true;
+            tls_ctx->dns_retry = false;
+            err = here_tracking_tls_socket_connect(&(tls_ctx->connector),
+                                                   &(tls_ctx->env->dns_cache),
+                                                   host,
+                                                   port,
+                                                   &(tls_ctx->net_ctx.fd));
+
+            if(err == HERE_TRACKING_OK || err == HERE_TRACKING_ERROR_WOULD_BLOCK)
+            {
+                tls_ctx->poll_events = HERE_TRACKING_TLS_POLL_OUT;
+                tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_TCP;
+            }
+            else
+            {
+                here_tracking_tls_dns_failed(tls_ctx, host, port);
+            }
         }
 
-        if(res == 0)
+        if(err == HERE_TRACKING_ERROR_WOULD_BLOCK)
         {
-            res = mbedtls_ssl_set_hostname(&(tls_ctx->ssl_ctx), host);
+            /* Connection just started, no point in checking it yet */
         }
-
-        if(res == 0)
+        else if(tls_ctx->connect_state == HERE_TRACKING_TLS_CONNECT_TCP)
         {
-            res = mbedtls_ssl_set_session(&(tls_ctx->ssl_ctx), &(tls_ctx->ssl_session));
+            err = here_tracking_tls_socket_connect_check(&(tls_ctx->connector),
+                                                         &(tls_ctx->net_ctx.fd));
+
+            if(err == HERE_TRACKING_OK)
+            {
+                err = (here_tracking_tls_ssl_setup(tls_ctx, host) == 0) ?
+                    HERE_TRACKING_OK : HERE_TRACKING_ERROR;
+                tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_HANDSHAKE;
+            }
+            else if(err == HERE_TRACKING_ERROR)
+            {
+                here_tracking_tls_dns_failed(tls_ctx, host, port);
+            }
         }
 
-        if(res == 0)
+        if(err == HERE_TRACKING_OK &&
+           tls_ctx->connect_state == HERE_TRACKING_TLS_CONNECT_HANDSHAKE)
         {
-            mbedtls_ssl_set_bio(&(tls_ctx->ssl_ctx),
-                                &(tls_ctx->net_ctx),
-                                mbedtls_net_send,
-                                mbedtls_net_recv,
-                                NULL);
+            err = here_tracking_tls_wait(tls_ctx, mbedtls_ssl_handshake(&(tls_ctx->ssl_ctx)));
 
-            while((res = mbedtls_ssl_handshake(&(tls_ctx->ssl_ctx))) != 0)
+            if(err == HERE_TRACKING_OK)
             {
-                if(res != MBEDTLS_ERR_SSL_WANT_READ && res != MBEDTLS_ERR_SSL_WANT_WRITE)
+                /* Available for here_tracking_tls_get_session() while the connection is open */
+                if(mbedtls_ssl_get_session(&(tls_ctx->ssl_ctx), &(tls_ctx->ssl_session)) == 0)
                 {
-                    break;
+                    tls_ctx->session_valid = true;
                 }
+
+                tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
             }
         }
 
-        if(res == 0)
-        {
-            err = HERE_TRACKING_OK;
-        }
-        else
+        if(err != HERE_TRACKING_OK && err != HERE_TRACKING_ERROR_WOULD_BLOCK)
         {
+            tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
             mbedtls_ssl_free(&(tls_ctx->ssl_ctx));
-            mbedtls_ssl_config_free(&(tls_ctx->ssl_conf));
             mbedtls_net_free(&(tls_ctx->net_ctx));
         }
     }
-    else
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_get_poll_info(here_tracking_tls tls,
+                                                    int* fd,
+                                                    uint8_t* events)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && fd != NULL && events != NULL)
     {
-        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+        here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)tls;
+
+        if(tls_ctx->non_blocking && tls_ctx->net_ctx.fd >= 0)
+        {
+            (*fd) = tls_ctx->net_ctx.fd;
+            (*events) = tls_ctx->poll_events;
+            err = HERE_TRACKING_OK;
+        }
+        else
+        {
+            err = HERE_TRACKING_ERROR;
+        }
     }
 
     return err;
@@ -280,10 +585,15 @@ here_tracking_error here_tracking_tls_close(here_tracking_tls tls)
     {
         here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)tls;
         mbedtls_ssl_close_notify((&tls_ctx->ssl_ctx));
-        mbedtls_ssl_get_session(&(tls_ctx->ssl_ctx), &(tls_ctx->ssl_session));
+
+        if(mbedtls_ssl_get_session(&(tls_ctx->ssl_ctx), &(tls_ctx->ssl_session)) == 0)
+        {
+            tls_ctx->session_valid = true;
+        }
+
         mbedtls_ssl_free(&(tls_ctx->ssl_ctx));
-        mbedtls_ssl_config_free(&(tls_ctx->ssl_conf));
         mbedtls_net_free(&(tls_ctx->net_ctx));
+        tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
         err = HERE_TRACKING_OK;
     }
     else
@@ -296,6 +606,165 @@ here_tracking_error here_tracking_tls_close(here_tracking_tls tls)
 
 /**************************************************************************************************/
 
+here_tracking_error here_tracking_tls_check_connection(here_tracking_tls tls)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(tls != NULL)
+    {
+        here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)tls;
+
+        if(mbedtls_ssl_get_bytes_avail(&(tls_ctx->ssl_ctx)) == 0 &&
+           here_tracking_tls_socket_idle(tls_ctx->net_ctx.fd))
+        {
+            err = HERE_TRACKING_OK;
+        }
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_set_deadline(here_tracking_tls tls, uint32_t deadline)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL)
+    {
+        ((here_tracking_tls_mbedtls*)tls)->deadline = deadline;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_get_session(here_tracking_tls tls,
+                                                  uint8_t* session,
+                                                  uint32_t* session_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && session_size != NULL && (session != NULL || (*session_size) == 0))
+    {
+        here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)tls;
+        size_t size = 0;
+        int res;
+
+        err = HERE_TRACKING_ERROR;
+
+        if(tls_ctx->session_valid)
+        {
+            res = mbedtls_ssl_session_save(&(tls_ctx->ssl_session),
+                                           session,
+                                           (*session_size),
+                                           &size);
+
+            if(res == 0)
+            {
+                err = HERE_TRACKING_OK;
+            }
+            else if(res == MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL)
+            {
+                err = HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+            }
+
+            (*session_size) = (uint32_t)size;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_set_session(here_tracking_tls tls,
+                                                  const uint8_t* session,
+                                                  uint32_t session_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && session != NULL && session_size > 0)
+    {
+        here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)tls;
+
+        mbedtls_ssl_session_free(&(tls_ctx->ssl_session));
+        mbedtls_ssl_session_init(&(tls_ctx->ssl_session));
+        tls_ctx->session_valid =
+            (mbedtls_ssl_session_load(&(tls_ctx->ssl_session), session, session_size) == 0);
+
+        if(tls_ctx->session_valid)
+        {
+            err = HERE_TRACKING_OK;
+        }
+        else
+        {
+            /* Content is unspecified after a failed load */
+            mbedtls_ssl_session_free(&(tls_ctx->ssl_session));
+            mbedtls_ssl_session_init(&(tls_ctx->ssl_session));
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_set_alpn(here_tracking_tls tls, const char** protocols)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL)
+    {
+        ((here_tracking_tls_mbedtls*)tls)->alpn = protocols;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_get_alpn(here_tracking_tls tls, const char** protocol)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && protocol != NULL)
+    {
+        (*protocol) = NULL;
+
+#if defined MBEDTLS_SSL_ALPN
+        {
+            here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)tls;
+            const char* selected = mbedtls_ssl_get_alpn_protocol(&(tls_ctx->ssl_ctx));
+            const char** p;
+
+            for(p = tls_ctx->alpn; p != NULL && (*p) != NULL && selected != NULL; ++p)
+            {
+                if(strcmp(*p, selected) == 0)
+                {
+                    (*protocol) = (*p);
+                    break;
+                }
+            }
+        }
+#endif
+
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
 here_tracking_error here_tracking_tls_read(here_tracking_tls tls, char* data, uint32_t* data_size)
 {
     here_tracking_error err = HERE_TRACKING_ERROR;
@@ -303,38 +772,48 @@ here_tracking_error here_tracking_tls_read(here_tracking_tls tls, char* data, ui
     if(tls != NULL && data != NULL && data_size != NULL && (*data_size) > 0)
     {
         here_tracking_tls_mbedtls* tls_ctx = (here_tracking_tls_mbedtls*)tls;
-        uint32_t read = 0;
 
         while(true)
         {
-            int res = mbedtls_ssl_read(&(tls_ctx->ssl_ctx),
-                                       (unsigned char*)(data + read),
-                                       (*data_size) - read);
+            int res = mbedtls_ssl_read(&(tls_ctx->ssl_ctx), (unsigned char*)data, (*data_size));
 
             if(res == MBEDTLS_ERR_SSL_WANT_READ || res == MBEDTLS_ERR_SSL_WANT_WRITE)
             {
-                continue;
+                err = here_tracking_tls_wait(tls_ctx, res);
+
+                if(!tls_ctx->non_blocking)
+                {
+                    /* Wait for the socket instead of retrying right away */
+                    err = here_tracking_tls_poll(tls_ctx);
+                }
+
+                if(err == HERE_TRACKING_OK)
+                {
+                    continue;
+                }
+
+                break;
             }
 
             if(res == 0 || res == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY)
             {
-                (*data_size) = read;
+                (*data_size) = 0;
                 err = HERE_TRACKING_OK;
                 break;
             }
 
-            if(res < 0)
+            if(res > 0)
             {
-                break;
+                /* Return what is available, the connection may stay open after the response. */
+                (*data_size) = (uint32_t)res;
+                err = HERE_TRACKING_OK;
             }
-
-            read += res;
-
-            if(read == (*data_size))
+            else
             {
-                err = HERE_TRACKING_OK;
-                break;
+                err = HERE_TRACKING_ERROR;
             }
+
+            break;
         }
     }
 
@@ -362,11 +841,29 @@ here_tracking_error here_tracking_tls_write(here_tracking_tls tls,
 
             if(res == MBEDTLS_ERR_SSL_WANT_READ || res == MBEDTLS_ERR_SSL_WANT_WRITE)
             {
-                continue;
+                err = here_tracking_tls_wait(tls_ctx, res);
+
+                if(tls_ctx->non_blocking)
+                {
+                    /* Report what was written so far, the rest must be retried by the caller */
+                    (*data_size) = written;
+                    err = (written > 0) ? HERE_TRACKING_OK : err;
+                    break;
+                }
+
+                err = here_tracking_tls_poll(tls_ctx);
+
+                if(err == HERE_TRACKING_OK)
+                {
+                    continue;
+                }
+
+                break;
             }
 
             if(res <= 0)
             {
+                err = HERE_TRACKING_ERROR;
                 break;
             }
 
@@ -382,3 +879,110 @@ here_tracking_error here_tracking_tls_write(here_tracking_tls tls,
 
     return err;
 }
+
+/**************************************************************************************************/
+
+static int here_tracking_tls_ssl_setup(here_tracking_tls_mbedtls* tls_ctx, const char* host)
+{
+    /* The configuration is shared and read-only, only the SSL context is per connection. */
+    const mbedtls_ssl_config* conf = &(tls_ctx->env->ssl_conf);
+    int res = 0;
+
+#if defined MBEDTLS_SSL_ALPN
+    if(tls_ctx->alpn != NULL && tls_ctx->alpn[0] != NULL)
+    {
+        /* The protocols are part of the configuration. The copy shares everything else with the
+           environment, so it is never freed. */
+        tls_ctx->alpn_conf = tls_ctx->env->ssl_conf;
+        res = mbedtls_ssl_conf_alpn_protocols(&(tls_ctx->alpn_conf), tls_ctx->alpn);
+        conf = &(tls_ctx->alpn_conf);
+    }
+#endif
+
+    if(res == 0)
+    {
+        res = mbedtls_ssl_setup(&(tls_ctx->ssl_ctx), conf);
+    }
+
+    if(res == 0)
+    {
+        res = mbedtls_ssl_set_hostname(&(tls_ctx->ssl_ctx), host);
+    }
+
+    if(res == 0)
+    {
+        res = mbedtls_ssl_set_session(&(tls_ctx->ssl_ctx), &(tls_ctx->ssl_session));
+    }
+
+    if(res == 0)
+    {
+        mbedtls_ssl_set_bio(&(tls_ctx->ssl_ctx),
+                            &(tls_ctx->net_ctx),
+                            mbedtls_net_send,
+                            mbedtls_net_recv,
+                            NULL);
+    }
+
+    return res;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_wait(here_tracking_tls_mbedtls* tls_ctx, int res)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(res == 0)
+    {
+        err = HERE_TRACKING_OK;
+    }
+    else if(res == MBEDTLS_ERR_SSL_WANT_READ)
+    {
+        tls_ctx->poll_events = HERE_TRACKING_TLS_POLL_IN;
+        err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+    }
+    else if(res == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+        tls_ctx->poll_events = HERE_TRACKING_TLS_POLL_OUT;
+        err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_poll(here_tracking_tls_mbedtls* tls_ctx)
+{
+    here_tracking_error err;
+
+    /* While connecting, also wake up to give up an address that doesn't answer */
+    if(tls_ctx->connect_state == HERE_TRACKING_TLS_CONNECT_TCP)
+    {
+        err = here_tracking_tls_socket_connect_poll(&(tls_ctx->connector),
+                                                    tls_ctx->net_ctx.fd,
+                                                    tls_ctx->deadline);
+    }
+    else
+    {
+        err = here_tracking_tls_socket_poll(tls_ctx->net_ctx.fd,
+                                            tls_ctx->poll_events,
+                                            tls_ctx->deadline);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_tls_dns_failed(here_tracking_tls_mbedtls* tls_ctx,
+                                         const char* host,
+                                         uint16_t port)
+{
+    if(tls_ctx->connector.cached)
+    {
+        here_tracking_tls_dns_cache_drop(&(tls_ctx->env->dns_cache), host, port);
+        tls_ctx->connector.cached = false;
+        tls_ctx->dns_retry = true;
+    }
+}
@@ -0,0 +1,1015 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/* POSIX sockets */
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include "here_tracking_log.h"
+#include "here_tracking_tls.h"
+#include "here_tracking_tls_cert.h"
+#include "here_tracking_tls_socket.h"
+
+#if OPENSSL_VERSION_NUMBER < 0x10101000L
+#error "OpenSSL 1.1.1 or later is required"
+#endif
+
+/**************************************************************************************************/
+
+#define HERE_TRACKING_TLS_CONNECT_IDLE      0
+#define HERE_TRACKING_TLS_CONNECT_TCP       1
+#define HERE_TRACKING_TLS_CONNECT_HANDSHAKE 2
+
+/**************************************************************************************************/
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    uint32_t ref_count;
+    here_tracking_tls_dns_cache dns_cache;
+    SSL_CTX* ssl_ctx;
+} here_tracking_tls_openssl_env;
+
+typedef struct
+{
+    here_tracking_tls_openssl_env* env;
+    SSL* ssl;
+    int fd;
+    SSL_SESSION* session; /**< Last session received from the server, resumed on next connect */
+    bool non_blocking; /**< Was the connection opened with here_tracking_tls_connect_async() */
+    uint8_t connect_state; /**< Progress of here_tracking_tls_connect_async() */
+    uint8_t poll_events; /**< Events the non-blocking connection is waiting for */
+    uint32_t deadline; /**< Deadline of blocking operations, 0 if there is none */
+    here_tracking_tls_connector connector; /**< Addresses of the current connect */
+    bool dns_retry; /**< Connecting to cached addresses failed, resolve the host again */
+    const char** alpn; /**< Protocols offered with ALPN, NULL if none */
+} here_tracking_tls_openssl;
+
+/**************************************************************************************************/
+
+static pthread_mutex_t here_tracking_tls_default_env_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Created on first use and kept for the lifetime of the process. */
+static here_tracking_tls_env here_tracking_tls_default_env = NULL;
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_load_ca(SSL_CTX* ssl_ctx, const char* pem);
+
+static here_tracking_error here_tracking_tls_ssl_setup(here_tracking_tls_openssl* tls_ctx,
+                                                       const char* host);
+
+static here_tracking_error here_tracking_tls_alpn_setup(here_tracking_tls_openssl* tls_ctx);
+
+static void here_tracking_tls_release(here_tracking_tls_openssl* tls_ctx);
+
+static here_tracking_error here_tracking_tls_wait(here_tracking_tls_openssl* tls_ctx, int res);
+
+static here_tracking_error here_tracking_tls_poll(here_tracking_tls_openssl* tls_ctx);
+
+static void here_tracking_tls_dns_failed(here_tracking_tls_openssl* tls_ctx,
+                                         const char* host,
+                                         uint16_t port);
+
+/**************************************************************************************************/
+
+static int here_tracking_tls_new_session_cb(SSL* ssl, SSL_SESSION* session)
+{
+    here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)SSL_get_app_data(ssl);
+
+    /* TLS 1.3 servers send the session tickets after the handshake, keep the latest one */
+    if(tls_ctx->session != NULL)
+    {
+        SSL_SESSION_free(tls_ctx->session);
+    }
+
+    tls_ctx->session = session;
+    return 1;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_tls_env_release(here_tracking_tls_openssl_env* env_ctx)
+{
+    SSL_CTX_free(env_ctx->ssl_ctx);
+    here_tracking_tls_dns_cache_free(&(env_ctx->dns_cache));
+    pthread_mutex_destroy(&(env_ctx->lock));
+    free(env_ctx);
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_init(here_tracking_tls_env* env)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(env != NULL)
+    {
+        here_tracking_tls_openssl_env* env_ctx = malloc(sizeof(here_tracking_tls_openssl_env));
+
+        if(env_ctx != NULL &&
+           pthread_mutex_init(&(env_ctx->lock), NULL) == 0 &&
+           here_tracking_tls_dns_cache_init(&(env_ctx->dns_cache)) == HERE_TRACKING_OK)
+        {
+            env_ctx->ref_count = 1;
+            /* The SSL_CTX is shared by all connections using the environment. It holds the CA
+               store and the configuration, both are only read after initialization. */
+            env_ctx->ssl_ctx = SSL_CTX_new(TLS_client_method());
+
+            if(env_ctx->ssl_ctx != NULL &&
+               SSL_CTX_set_min_proto_version(env_ctx->ssl_ctx, TLS1_2_VERSION) == 1 &&
+               here_tracking_tls_load_ca(env_ctx->ssl_ctx,
+                                         here_tracking_tls_cert_globalsign_root_r3) ==
+                   HERE_TRACKING_OK)
+            {
+                SSL_CTX_set_verify(env_ctx->ssl_ctx, SSL_VERIFY_PEER, NULL);
+                SSL_CTX_set_mode(env_ctx->ssl_ctx,
+                                 SSL_MODE_ENABLE_PARTIAL_WRITE |
+                                 SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+                /* Servers may close the connection without a close notify alert */
+                SSL_CTX_set_options(env_ctx->ssl_ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+                /* Sessions are kept by each TLS handle, not in the internal cache */
+                SSL_CTX_set_session_cache_mode(env_ctx->ssl_ctx,
+                                               SSL_SESS_CACHE_CLIENT |
+                                               SSL_SESS_CACHE_NO_INTERNAL_STORE);
+                SSL_CTX_sess_set_new_cb(env_ctx->ssl_ctx, here_tracking_tls_new_session_cb);
+                *env = (here_tracking_tls_env)env_ctx;
+                err = HERE_TRACKING_OK;
+            }
+            else
+            {
+                here_tracking_tls_env_release(env_ctx);
+            }
+        }
+        else
+        {
+            free(env_ctx);
+        }
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_ref(here_tracking_tls_env env)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(env != NULL)
+    {
+        here_tracking_tls_openssl_env* env_ctx = (here_tracking_tls_openssl_env*)env;
+
+        pthread_mutex_lock(&(env_ctx->lock));
+        env_ctx->ref_count++;
+        pthread_mutex_unlock(&(env_ctx->lock));
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_free(here_tracking_tls_env* env)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(env != NULL && *env != NULL)
+    {
+        here_tracking_tls_openssl_env* env_ctx = (here_tracking_tls_openssl_env*)(*env);
+        uint32_t ref_count;
+
+        pthread_mutex_lock(&(env_ctx->lock));
+        ref_count = --(env_ctx->ref_count);
+        pthread_mutex_unlock(&(env_ctx->lock));
+
+        if(ref_count == 0)
+        {
+            here_tracking_tls_env_release(env_ctx);
+        }
+
+        *env = NULL;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_set_dns_cache_ttl(here_tracking_tls_env env, uint32_t ttl)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(env != NULL)
+    {
+        here_tracking_tls_dns_cache_set_ttl(&(((here_tracking_tls_openssl_env*)env)->dns_cache),
+                                            ttl);
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_env_add_ca_cert(here_tracking_tls_env env, const char* pem)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(env != NULL && pem != NULL)
+    {
+        err = here_tracking_tls_load_ca(((here_tracking_tls_openssl_env*)env)->ssl_ctx, pem);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_init(here_tracking_tls* tls, here_tracking_tls_env env)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(tls != NULL)
+    {
+        here_tracking_tls_openssl* tls_ctx = malloc(sizeof(here_tracking_tls_openssl));
+
+        if(tls_ctx != NULL)
+        {
+            if(env == NULL)
+            {
+                pthread_mutex_lock(&here_tracking_tls_default_env_lock);
+
+                if(here_tracking_tls_default_env == NULL)
+                {
+                    here_tracking_tls_env_init(&here_tracking_tls_default_env);
+                }
+
+                env = here_tracking_tls_default_env;
+                pthread_mutex_unlock(&here_tracking_tls_default_env_lock);
+            }
+
+            if(here_tracking_tls_env_ref(env) == HERE_TRACKING_OK)
+            {
+                tls_ctx->env = (here_tracking_tls_openssl_env*)env;
+                tls_ctx->ssl = NULL;
+                tls_ctx->fd = -1;
+                tls_ctx->session = NULL;
+                tls_ctx->non_blocking = false;
+                tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
+                tls_ctx->poll_events = 0;
+                tls_ctx->deadline = 0;
+                tls_ctx->connector.addr_count = 0;
+                tls_ctx->connector.cached = false;
+                tls_ctx->dns_retry = false;
+                tls_ctx->alpn = NULL;
+                *tls = (here_tracking_tls)tls_ctx;
+                err = HERE_TRACKING_OK;
+            }
+            else
+            {
+                free(tls_ctx);
+            }
+        }
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_free(here_tracking_tls* tls)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(tls != NULL)
+    {
+        if(*tls != NULL)
+        {
+            here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)(*tls);
+            here_tracking_tls_env env = (here_tracking_tls_env)tls_ctx->env;
+
+            here_tracking_tls_close(*tls);
+
+            if(tls_ctx->session != NULL)
+            {
+                SSL_SESSION_free(tls_ctx->session);
+            }
+
+            here_tracking_tls_env_free(&env);
+            free(tls_ctx);
+            *tls = NULL;
+            err = HERE_TRACKING_OK;
+        }
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_connect(here_tracking_tls tls,
+                                              const char* host,
+                                              uint16_t port)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(tls != NULL && host != NULL && strlen(host) > 0)
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+        bool retry;
+
+        do
+        {
+            /* The socket is always non-blocking so that the connect, the handshake and later
+               reads and writes can wait in poll() until the deadline instead of blocking
+               indefinitely. */
+            tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
+            err = here_tracking_tls_connect_async(tls, host, port);
+
+            while(err == HERE_TRACKING_ERROR_WOULD_BLOCK)
+            {
+                err = here_tracking_tls_poll(tls_ctx);
+
+                if(err == HERE_TRACKING_OK)
+                {
+                    err = here_tracking_tls_connect_async(tls, host, port);
+                }
+                else
+                {
+                    here_tracking_tls_release(tls_ctx);
+                }
+            }
+
+            /* Cached addresses may be stale, try once more with freshly resolved ones */
+            retry = (err == HERE_TRACKING_ERROR && tls_ctx->dns_retry);
+            tls_ctx->dns_retry = false;
+        } while(retry);
+
+        tls_ctx->non_blocking = false;
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_connect_async(here_tracking_tls tls,
+                                                    const char* host,
+                                                    uint16_t port)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && host != NULL && strlen(host) > 0)
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+
+        err = HERE_TRACKING_OK;
+
+        if(tls_ctx->connect_state == HERE_TRACKING_TLS_CONNECT_IDLE)
+        {
+            tls_ctx->non_blocking = true;
+            tls_ctx->dns_retry = false;
+            err = here_tracking_tls_socket_connect(&(tls_ctx->connector),
+                                                   &(tls_ctx->env->dns_cache),
+                                                   host,
+                                                   port,
+                                                   &(tls_ctx->fd));
+
+            if(err == HERE_TRACKING_OK || err == HERE_TRACKING_ERROR_WOULD_BLOCK)
+            {
+                tls_ctx->poll_events = HERE_TRACKING_TLS_POLL_OUT;
+                tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_TCP;
+            }
+            else
+            {
+                here_tracking_tls_dns_failed(tls_ctx, host, port);
+            }
+        }
+
+        if(err == HERE_TRACKING_ERROR_WOULD_BLOCK)
+        {
+            /* Connection just started, no point in checking it yet */
+        }
+        else if(tls_ctx->connect_state == HERE_TRACKING_TLS_CONNECT_TCP)
+        {
+            err = here_tracking_tls_socket_connect_check(&(tls_ctx->connector), &(tls_ctx->fd));
+
+            if(err == HERE_TRACKING_OK)
+            {
+                err = here_tracking_tls_ssl_setup(tls_ctx, host);
+                tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_HANDSHAKE;
+            }
+            else if(err == HERE_TRACKING_ERROR)
+            {
+                here_tracking_tls_dns_failed(tls_ctx, host, port);
+            }
+        }
+
+        if(err == HERE_TRACKING_OK &&
+           tls_ctx->connect_state == HERE_TRACKING_TLS_CONNECT_HANDSHAKE)
+        {
+            ERR_clear_error();
+            err = here_tracking_tls_wait(tls_ctx, SSL_connect(tls_ctx->ssl));
+
+            if(err == HERE_TRACKING_OK)
+            {
+                HERE_TRACKING_LOGI("%s handshake done, session %s",
+                                   SSL_get_version(tls_ctx->ssl),
+                                   SSL_session_reused(tls_ctx->ssl) ? "resumed" : "new");
+                tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
+            }
+            else if(err == HERE_TRACKING_ERROR)
+            {
+                HERE_TRACKING_LOGE("TLS handshake failed: %s",
+                                   ERR_reason_error_string(ERR_peek_last_error()));
+            }
+        }
+
+        if(err != HERE_TRACKING_OK && err != HERE_TRACKING_ERROR_WOULD_BLOCK)
+        {
+            here_tracking_tls_release(tls_ctx);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_get_poll_info(here_tracking_tls tls,
+                                                    int* fd,
+                                                    uint8_t* events)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && fd != NULL && events != NULL)
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+
+        if(tls_ctx->non_blocking && tls_ctx->fd >= 0)
+        {
+            (*fd) = tls_ctx->fd;
+            (*events) = tls_ctx->poll_events;
+            err = HERE_TRACKING_OK;
+        }
+        else
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_close(here_tracking_tls tls)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(tls != NULL)
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+
+        if(tls_ctx->ssl != NULL && SSL_is_init_finished(tls_ctx->ssl))
+        {
+            /* Best effort close notify, the session stays resumable without it */
+            ERR_clear_error();
+            SSL_shutdown(tls_ctx->ssl);
+        }
+
+        here_tracking_tls_release(tls_ctx);
+        err = HERE_TRACKING_OK;
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_check_connection(here_tracking_tls tls)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(tls != NULL)
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+
+        if(tls_ctx->ssl != NULL && SSL_pending(tls_ctx->ssl) == 0)
+        {
+            if(here_tracking_tls_socket_idle(tls_ctx->fd))
+            {
+                err = HERE_TRACKING_OK;
+            }
+            else
+            {
+                char byte;
+                size_t size;
+
+                /* TLS 1.3 session tickets arrive after the handshake and make an idle socket
+                   readable. Process them, any other data or a close means the connection is no
+                   longer usable. */
+                ERR_clear_error();
+
+                if(SSL_peek_ex(tls_ctx->ssl, &byte, 1, &size) != 1 &&
+                   SSL_get_error(tls_ctx->ssl, 0) == SSL_ERROR_WANT_READ)
+                {
+                    err = HERE_TRACKING_OK;
+                }
+            }
+        }
+    }
+    else
+    {
+        err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_set_deadline(here_tracking_tls tls, uint32_t deadline)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL)
+    {
+        ((here_tracking_tls_openssl*)tls)->deadline = deadline;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_get_session(here_tracking_tls tls,
+                                                  uint8_t* session,
+                                                  uint32_t* session_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && session_size != NULL && (session != NULL || (*session_size) == 0))
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+        int size;
+
+        err = HERE_TRACKING_ERROR;
+
+        if(tls_ctx->session != NULL && (size = i2d_SSL_SESSION(tls_ctx->session, NULL)) > 0)
+        {
+            if((uint32_t)size <= (*session_size))
+            {
+                unsigned char* out = session;
+
+                i2d_SSL_SESSION(tls_ctx->session, &out);
+                err = HERE_TRACKING_OK;
+            }
+            else
+            {
+                err = HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+            }
+
+            (*session_size) = (uint32_t)size;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_set_session(here_tracking_tls tls,
+                                                  const uint8_t* session,
+                                                  uint32_t session_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && session != NULL && session_size > 0 && session_size <= INT32_MAX)
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+        const unsigned char* in = session;
+        SSL_SESSION* ssl_session = d2i_SSL_SESSION(NULL, &in, (long)session_size);
+
+        err = HERE_TRACKING_ERROR;
+
+        if(ssl_session != NULL)
+        {
+            if(tls_ctx->session != NULL)
+            {
+                SSL_SESSION_free(tls_ctx->session);
+            }
+
+            tls_ctx->session = ssl_session;
+            err = HERE_TRACKING_OK;
+        }
+
+        ERR_clear_error();
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_set_alpn(here_tracking_tls tls, const char** protocols)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL)
+    {
+        ((here_tracking_tls_openssl*)tls)->alpn = protocols;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_get_alpn(here_tracking_tls tls, const char** protocol)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(tls != NULL && protocol != NULL)
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+        const unsigned char* selected = NULL;
+        unsigned int selected_size = 0;
+        const char** p;
+
+        (*protocol) = NULL;
+
+        if(tls_ctx->ssl != NULL)
+        {
+            SSL_get0_alpn_selected(tls_ctx->ssl, &selected, &selected_size);
+        }
+
+        for(p = tls_ctx->alpn; p != NULL && (*p) != NULL && selected_size > 0; ++p)
+        {
+            if(strlen(*p) == selected_size && memcmp(*p, selected, selected_size) == 0)
+            {
+                (*protocol) = (*p);
+                break;
+            }
+        }
+
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_read(here_tracking_tls tls, char* data, uint32_t* data_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(tls != NULL && data != NULL && data_size != NULL && (*data_size) > 0)
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+
+        while(tls_ctx->ssl != NULL)
+        {
+            size_t size = 0;
+            int res;
+
+            ERR_clear_error();
+            res = SSL_read_ex(tls_ctx->ssl, data, (*data_size), &size);
+
+            if(res == 1)
+            {
+                /* Return what is available, the connection may stay open after the response. */
+                (*data_size) = (uint32_t)size;
+                err = HERE_TRACKING_OK;
+                break;
+            }
+
+            if(SSL_get_error(tls_ctx->ssl, res) == SSL_ERROR_ZERO_RETURN)
+            {
+                (*data_size) = 0;
+                err = HERE_TRACKING_OK;
+                break;
+            }
+
+            err = here_tracking_tls_wait(tls_ctx, res);
+
+            if(err == HERE_TRACKING_ERROR_WOULD_BLOCK && !tls_ctx->non_blocking)
+            {
+                /* Wait for the socket instead of retrying right away */
+                err = here_tracking_tls_poll(tls_ctx);
+
+                if(err == HERE_TRACKING_OK)
+                {
+                    continue;
+                }
+            }
+
+            break;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_write(here_tracking_tls tls,
+                                            const char* data,
+                                            uint32_t* data_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(tls != NULL && data != NULL && data_size != NULL && (*data_size) > 0)
+    {
+        here_tracking_tls_openssl* tls_ctx = (here_tracking_tls_openssl*)tls;
+        uint32_t written = 0;
+
+        while(tls_ctx->ssl != NULL)
+        {
+            size_t size = 0;
+            int res;
+
+            ERR_clear_error();
+            res = SSL_write_ex(tls_ctx->ssl, data + written, (*data_size) - written, &size);
+
+            if(res == 1)
+            {
+                written += (uint32_t)size;
+
+                if(written == (*data_size))
+                {
+                    err = HERE_TRACKING_OK;
+                    break;
+                }
+
+                continue;
+            }
+
+            err = here_tracking_tls_wait(tls_ctx, res);
+
+            if(err != HERE_TRACKING_ERROR_WOULD_BLOCK)
+            {
+                break;
+            }
+
+            if(tls_ctx->non_blocking)
+            {
+                /* Report what was written so far, the rest must be retried by the caller */
+                (*data_size) = written;
+                err = (written > 0) ? HERE_TRACKING_OK : err;
+                break;
+            }
+
+            err = here_tracking_tls_poll(tls_ctx);
+
+            if(err != HERE_TRACKING_OK)
+            {
+                break;
+            }
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_load_ca(SSL_CTX* ssl_ctx, const char* pem)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+    X509_STORE* store = SSL_CTX_get_cert_store(ssl_ctx);
+    BIO* bio = BIO_new_mem_buf(pem, -1);
+    X509* cert;
+
+    if(bio != NULL)
+    {
+        while((cert = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL)
+        {
+            if(X509_STORE_add_cert(store, cert) == 1)
+            {
+                err = HERE_TRACKING_OK;
+            }
+
+            X509_free(cert);
+        }
+
+        BIO_free(bio);
+    }
+
+    /* Reading stops with an end of data error */
+    ERR_clear_error();
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_ssl_setup(here_tracking_tls_openssl* tls_ctx,
+                                                       const char* host)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    tls_ctx->ssl = SSL_new(tls_ctx->env->ssl_ctx);
+
+    if(tls_ctx->ssl != NULL &&
+       SSL_set_fd(tls_ctx->ssl, tls_ctx->fd) == 1 &&
+       SSL_set_app_data(tls_ctx->ssl, tls_ctx) == 1)
+    {
+        /* IP addresses are matched against the certificate as such and not sent as SNI */
+        if(X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(tls_ctx->ssl), host) == 1 ||
+           (SSL_set_tlsext_host_name(tls_ctx->ssl, host) == 1 &&
+            SSL_set1_host(tls_ctx->ssl, host) == 1))
+        {
+            err = HERE_TRACKING_OK;
+        }
+
+        if(err == HERE_TRACKING_OK && tls_ctx->alpn != NULL && tls_ctx->alpn[0] != NULL)
+        {
+            err = here_tracking_tls_alpn_setup(tls_ctx);
+        }
+
+        if(err == HERE_TRACKING_OK && tls_ctx->session != NULL)
+        {
+            /* Resumption is skipped by OpenSSL if the session doesn't fit the connection */
+            SSL_set_session(tls_ctx->ssl, tls_ctx->session);
+        }
+
+        SSL_set_connect_state(tls_ctx->ssl);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_alpn_setup(here_tracking_tls_openssl* tls_ctx)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+    unsigned char wire[256];
+    size_t size = 0, len;
+    const char** p;
+
+    /* Protocol list in wire format, each name prefixed with its length */
+    for(p = tls_ctx->alpn; (*p) != NULL; ++p)
+    {
+        len = strlen(*p);
+
+        if(len == 0 || len > 255 || size + 1 + len > sizeof(wire))
+        {
+            size = 0;
+            break;
+        }
+
+        wire[size++] = (unsigned char)len;
+        memcpy(wire + size, *p, len);
+        size += len;
+    }
+
+    /* Unlike most OpenSSL functions this one returns 0 on success */
+    if(size > 0 && SSL_set_alpn_protos(tls_ctx->ssl, wire, (unsigned int)size) == 0)
+    {
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_tls_release(here_tracking_tls_openssl* tls_ctx)
+{
+    if(tls_ctx->ssl != NULL)
+    {
+        SSL_free(tls_ctx->ssl);
+        tls_ctx->ssl = NULL;
+    }
+
+    if(tls_ctx->fd >= 0)
+    {
+        close(tls_ctx->fd);
+        tls_ctx->fd = -1;
+    }
+
+    tls_ctx->connect_state = HERE_TRACKING_TLS_CONNECT_IDLE;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_wait(here_tracking_tls_openssl* tls_ctx, int res)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    switch(SSL_get_error(tls_ctx->ssl, res))
+    {
+        case SSL_ERROR_NONE:
+            err = HERE_TRACKING_OK;
+            break;
+        case SSL_ERROR_WANT_READ:
+            tls_ctx->poll_events = HERE_TRACKING_TLS_POLL_IN;
+            err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+            break;
+        case SSL_ERROR_WANT_WRITE:
+            tls_ctx->poll_events = HERE_TRACKING_TLS_POLL_OUT;
+            err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+            break;
+        default:
+            break;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_poll(here_tracking_tls_openssl* tls_ctx)
+{
+    here_tracking_error err;
+
+    /* While connecting, also wake up to give up an address that doesn't answer */
+    if(tls_ctx->connect_state == HERE_TRACKING_TLS_CONNECT_TCP)
+    {
+        err = here_tracking_tls_socket_connect_poll(&(tls_ctx->connector),
+                                                    tls_ctx->fd,
+                                                    tls_ctx->deadline);
+    }
+    else
+    {
+        err = here_tracking_tls_socket_poll(tls_ctx->fd, tls_ctx->poll_events, tls_ctx->deadline);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_tls_dns_failed(here_tracking_tls_openssl* tls_ctx,
+                                         const char* host,
+                                         uint16_t port)
+{
+    if(tls_ctx->connector.cached)
+    {
+        here_tracking_tls_dns_cache_drop(&(tls_ctx->env->dns_cache), host, port);
+        tls_ctx->connector.cached = false;
+        tls_ctx->dns_retry = true;
+    }
+}
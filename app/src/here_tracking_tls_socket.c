@@ -0,0 +1,459 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/* getaddrinfo() */
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "here_tracking_log.h"
+#include "here_tracking_time.h"
+#include "here_tracking_tls.h"
+#include "here_tracking_tls_socket.h"
+
+/**************************************************************************************************/
+
+static uint8_t here_tracking_tls_dns_resolve(here_tracking_tls_dns_cache* cache,
+                                             const char* host,
+                                             uint16_t port,
+                                             here_tracking_tls_dns_addr* addrs,
+                                             bool* cached);
+
+static here_tracking_error here_tracking_tls_connect_next(here_tracking_tls_connector* connector,
+                                                          int* fd);
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_dns_cache_init(here_tracking_tls_dns_cache* cache)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(pthread_mutex_init(&(cache->lock), NULL) == 0)
+    {
+        cache->ttl = HERE_TRACKING_TLS_DNS_CACHE_DEFAULT_TTL;
+        memset(cache->entries, 0, sizeof(cache->entries));
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+void here_tracking_tls_dns_cache_free(here_tracking_tls_dns_cache* cache)
+{
+    pthread_mutex_destroy(&(cache->lock));
+}
+
+/**************************************************************************************************/
+
+void here_tracking_tls_dns_cache_set_ttl(here_tracking_tls_dns_cache* cache, uint32_t ttl)
+{
+    uint8_t i;
+
+    pthread_mutex_lock(&(cache->lock));
+    /* Expiry times are compared on a wrapping millisecond clock */
+    cache->ttl = (ttl < HERE_TRACKING_TLS_DNS_TTL_MAX) ? ttl : HERE_TRACKING_TLS_DNS_TTL_MAX;
+
+    /* Entries were cached with the old time, resolve again on next use */
+    for(i = 0; i < HERE_TRACKING_TLS_DNS_CACHE_SIZE; ++i)
+    {
+        cache->entries[i].addr_count = 0;
+    }
+
+    pthread_mutex_unlock(&(cache->lock));
+}
+
+/**************************************************************************************************/
+
+void here_tracking_tls_dns_cache_drop(here_tracking_tls_dns_cache* cache,
+                                      const char* host,
+                                      uint16_t port)
+{
+    uint8_t i;
+
+    pthread_mutex_lock(&(cache->lock));
+
+    for(i = 0; i < HERE_TRACKING_TLS_DNS_CACHE_SIZE; ++i)
+    {
+        if(cache->entries[i].port == port && strcmp(cache->entries[i].host, host) == 0)
+        {
+            cache->entries[i].addr_count = 0;
+        }
+    }
+
+    pthread_mutex_unlock(&(cache->lock));
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_socket_connect(here_tracking_tls_connector* connector,
+                                                     here_tracking_tls_dns_cache* cache,
+                                                     const char* host,
+                                                     uint16_t port,
+                                                     int* fd)
+{
+    connector->addr_count = here_tracking_tls_dns_resolve(cache,
+                                                          host,
+                                                          port,
+                                                          connector->addrs,
+                                                          &(connector->cached));
+    connector->addr_index = 0;
+    (*fd) = -1;
+
+    return here_tracking_tls_connect_next(connector, fd);
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_socket_connect_check(here_tracking_tls_connector* connector,
+                                                           int* fd)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+    struct pollfd pfd;
+    int res;
+
+    pfd.fd = (*fd);
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    res = poll(&pfd, 1, 0);
+
+    if(res == 0)
+    {
+        uint32_t now;
+
+        err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+
+        /* A silently dropped connection would otherwise take the whole connect timeout */
+        if(connector->addr_deadline != 0 &&
+           here_tracking_get_monotonic_ms(&now) == HERE_TRACKING_OK &&
+           (int32_t)(connector->addr_deadline - now) <= 0)
+        {
+            HERE_TRACKING_LOGW("Address %u didn't answer, trying the next one",
+                               connector->addr_index);
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+    else if(res > 0)
+    {
+        int sock_err = 0;
+        socklen_t sock_err_len = sizeof(sock_err);
+
+        /* Socket becomes writable also when the connection fails */
+        if(getsockopt((*fd), SOL_SOCKET, SO_ERROR, &sock_err, &sock_err_len) == 0 && sock_err == 0)
+        {
+            err = HERE_TRACKING_OK;
+        }
+    }
+
+    if(err == HERE_TRACKING_ERROR)
+    {
+        close(*fd);
+        (*fd) = -1;
+        connector->addr_index++;
+        err = here_tracking_tls_connect_next(connector, fd);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_socket_connect_poll(here_tracking_tls_connector* connector,
+                                                          int fd,
+                                                          uint32_t deadline)
+{
+    here_tracking_error err;
+    uint32_t wait = deadline;
+
+    if(connector->addr_deadline != 0 &&
+       (deadline == 0 || (int32_t)(connector->addr_deadline - deadline) < 0))
+    {
+        wait = connector->addr_deadline;
+    }
+
+    err = here_tracking_tls_socket_poll(fd, HERE_TRACKING_TLS_POLL_OUT, wait);
+
+    /* Only the address has timed out, the check moves on to the next one */
+    if(err == HERE_TRACKING_ERROR_TIMEOUT && wait != deadline)
+    {
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_tls_socket_poll(int fd, uint8_t events, uint32_t deadline)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+    struct pollfd pfd;
+    uint32_t now;
+    int timeout = -1;
+    int res;
+
+    pfd.fd = fd;
+    pfd.events = 0;
+
+    if(events & HERE_TRACKING_TLS_POLL_IN)
+    {
+        pfd.events |= POLLIN;
+    }
+
+    if(events & HERE_TRACKING_TLS_POLL_OUT)
+    {
+        pfd.events |= POLLOUT;
+    }
+
+    while(err == HERE_TRACKING_ERROR_WOULD_BLOCK)
+    {
+        if(deadline != 0)
+        {
+            if(here_tracking_get_monotonic_ms(&now) != HERE_TRACKING_OK)
+            {
+                err = HERE_TRACKING_ERROR;
+                break;
+            }
+
+            /* Signed difference handles the wrap-around of the millisecond clock */
+            timeout = (int)(int32_t)(deadline - now);
+
+            if(timeout <= 0)
+            {
+                HERE_TRACKING_LOGE("TLS operation timed out");
+                err = HERE_TRACKING_ERROR_TIMEOUT;
+                break;
+            }
+        }
+
+        pfd.revents = 0;
+        res = poll(&pfd, 1, timeout);
+
+        if(res > 0)
+        {
+            /* Errors and hang-ups are reported by the following TLS operation */
+            err = HERE_TRACKING_OK;
+        }
+        else if(res < 0 && errno != EINTR)
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+bool here_tracking_tls_socket_idle(int fd)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    /* Nothing is expected on an idle connection. If the socket is readable the peer has either
+       closed the connection or sent a close notify alert. */
+    return (fd >= 0 && poll(&pfd, 1, 0) == 0);
+}
+
+/**************************************************************************************************/
+
+static uint8_t here_tracking_tls_dns_resolve(here_tracking_tls_dns_cache* cache,
+                                             const char* host,
+                                             uint16_t port,
+                                             here_tracking_tls_dns_addr* addrs,
+                                             bool* cached)
+{
+    here_tracking_tls_dns_entry* entry = NULL;
+    struct addrinfo hints;
+    struct addrinfo* addr_list;
+    struct addrinfo* addr;
+    char port_string[6];
+    uint8_t addr_count = 0;
+    uint32_t now;
+    bool cacheable = (strlen(host) < HERE_TRACKING_TLS_DNS_HOST_SIZE &&
+                      here_tracking_get_monotonic_ms(&now) == HERE_TRACKING_OK);
+    uint8_t i;
+
+    (*cached) = false;
+
+    if(cacheable)
+    {
+        pthread_mutex_lock(&(cache->lock));
+
+        for(i = 0; i < HERE_TRACKING_TLS_DNS_CACHE_SIZE && addr_count == 0; ++i)
+        {
+            entry = &(cache->entries[i]);
+
+            if(entry->addr_count > 0 &&
+               entry->port == port &&
+               (int32_t)(entry->expiry - now) > 0 &&
+               strcmp(entry->host, host) == 0)
+            {
+                addr_count = entry->addr_count;
+                memcpy(addrs, entry->addrs, addr_count * sizeof(here_tracking_tls_dns_addr));
+                (*cached) = true;
+            }
+        }
+
+        pthread_mutex_unlock(&(cache->lock));
+    }
+
+    if(addr_count == 0)
+    {
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+        snprintf(port_string, 6, "%u", port);
+
+        /* Name resolution is blocking, only the connection itself is established asynchronously */
+        if(getaddrinfo(host, port_string, &hints, &addr_list) == 0)
+        {
+            for(addr = addr_list;
+                addr != NULL && addr_count < HERE_TRACKING_TLS_DNS_ADDR_MAX;
+                addr = addr->ai_next)
+            {
+                if(addr->ai_addrlen <= sizeof(struct sockaddr_storage))
+                {
+                    addrs[addr_count].family = addr->ai_family;
+                    addrs[addr_count].socktype = addr->ai_socktype;
+                    addrs[addr_count].protocol = addr->ai_protocol;
+                    addrs[addr_count].addr_len = addr->ai_addrlen;
+                    memcpy(&(addrs[addr_count].addr), addr->ai_addr, addr->ai_addrlen);
+                    addr_count++;
+                }
+            }
+
+            freeaddrinfo(addr_list);
+        }
+
+        if(cacheable && addr_count > 0)
+        {
+            pthread_mutex_lock(&(cache->lock));
+
+            if(cache->ttl > 0)
+            {
+                /* Replace the entry of the same host, an unused entry or the oldest entry */
+                entry = &(cache->entries[0]);
+
+                for(i = 0; i < HERE_TRACKING_TLS_DNS_CACHE_SIZE; ++i)
+                {
+                    here_tracking_tls_dns_entry* candidate = &(cache->entries[i]);
+
+                    if(candidate->addr_count == 0 ||
+                       (candidate->port == port && strcmp(candidate->host, host) == 0))
+                    {
+                        entry = candidate;
+                        break;
+                    }
+
+                    if((int32_t)(candidate->expiry - entry->expiry) < 0)
+                    {
+                        entry = candidate;
+                    }
+                }
+
+                strcpy(entry->host, host);
+                entry->port = port;
+                entry->expiry = now + (cache->ttl * 1000);
+                entry->addr_count = addr_count;
+                memcpy(entry->addrs, addrs, addr_count * sizeof(here_tracking_tls_dns_addr));
+            }
+
+            pthread_mutex_unlock(&(cache->lock));
+        }
+    }
+
+    return addr_count;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_connect_next(here_tracking_tls_connector* connector,
+                                                          int* fd)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    while(err == HERE_TRACKING_ERROR && connector->addr_index < connector->addr_count)
+    {
+        here_tracking_tls_dns_addr* addr = &(connector->addrs[connector->addr_index]);
+        int flags;
+
+        (*fd) = socket(addr->family, addr->socktype, addr->protocol);
+
+        if((*fd) >= 0 &&
+           (flags = fcntl((*fd), F_GETFL)) >= 0 &&
+           fcntl((*fd), F_SETFL, flags | O_NONBLOCK) == 0)
+        {
+            if(connect((*fd), (struct sockaddr*)&(addr->addr), addr->addr_len) == 0)
+            {
+                err = HERE_TRACKING_OK;
+            }
+            else if(errno == EINPROGRESS)
+            {
+                err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+            }
+        }
+
+        if(err == HERE_TRACKING_ERROR)
+        {
+            if((*fd) >= 0)
+            {
+                close(*fd);
+                (*fd) = -1;
+            }
+
+            connector->addr_index++;
+        }
+    }
+
+    connector->addr_deadline = 0;
+
+    /* The last address may take the whole connect timeout */
+    if(err == HERE_TRACKING_ERROR_WOULD_BLOCK &&
+       connector->addr_index + 1 < connector->addr_count &&
+       here_tracking_get_monotonic_ms(&(connector->addr_deadline)) == HERE_TRACKING_OK)
+    {
+        connector->addr_deadline += HERE_TRACKING_TLS_SOCKET_ADDR_TIMEOUT;
+
+        if(connector->addr_deadline == 0)
+        {
+            connector->addr_deadline = 1;
+        }
+    }
+
+    return err;
+}
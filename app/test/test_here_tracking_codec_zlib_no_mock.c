@@ -0,0 +1,298 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <check.h>
+
+#include "here_tracking_codec_zlib.h"
+
+#define TEST_NAME "here_tracking_codec_zlib_no_mock"
+
+#define TEST_OUT_BUFFER_SIZE 16
+#define TEST_DATA_SIZE 4096
+
+/**************************************************************************************************/
+
+static size_t test_encode(here_tracking_codec* codec,
+                          const uint8_t* in,
+                          size_t in_size,
+                          uint8_t* enc,
+                          size_t enc_size)
+{
+    uint8_t out[TEST_OUT_BUFFER_SIZE];
+    size_t enc_pos = 0;
+    bool end = false;
+    ck_assert(codec->begin(codec->codec_data) == HERE_TRACKING_OK);
+
+    while(!end)
+    {
+        size_t consumed = in_size;
+        size_t produced = sizeof(out);
+        ck_assert(codec->encode(in,
+                                &consumed,
+                                out,
+                                &produced,
+                                (in_size == 0),
+                                &end,
+                                codec->codec_data) == HERE_TRACKING_OK);
+        in += consumed;
+        in_size -= consumed;
+        ck_assert(enc_pos + produced <= enc_size);
+        memcpy(enc + enc_pos, out, produced);
+        enc_pos += produced;
+    }
+
+    return enc_pos;
+}
+
+/**************************************************************************************************/
+
+static size_t test_inflate(const uint8_t* enc, size_t enc_size, uint8_t* dec, size_t dec_size)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    ck_assert(inflateInit2(&stream, 15 + 32) == Z_OK);
+    stream.next_in = (Bytef*)enc;
+    stream.avail_in = (uInt)enc_size;
+    stream.next_out = dec;
+    stream.avail_out = (uInt)dec_size;
+    ck_assert(inflate(&stream, Z_FINISH) == Z_STREAM_END);
+    inflateEnd(&stream);
+    return dec_size - stream.avail_out;
+}
+
+/**************************************************************************************************/
+
+static size_t test_decode(here_tracking_codec* codec,
+                          const uint8_t* in,
+                          size_t in_size,
+                          uint8_t* dec,
+                          size_t dec_size)
+{
+    uint8_t out[TEST_OUT_BUFFER_SIZE];
+    size_t dec_pos = 0, pos = 0;
+    bool end = false;
+    ck_assert(codec->decode_begin(codec->codec_data) == HERE_TRACKING_OK);
+
+    while(!end)
+    {
+        /* Input is passed in small parts as if it was arriving from the network */
+        size_t consumed = ((in_size - pos) < 7) ? (in_size - pos) : 7;
+        size_t produced = sizeof(out);
+        ck_assert(codec->decode(in + pos,
+                                &consumed,
+                                out,
+                                &produced,
+                                (pos + consumed == in_size),
+                                &end,
+                                codec->codec_data) == HERE_TRACKING_OK);
+        ck_assert(consumed > 0 || produced > 0 || end);
+        pos += consumed;
+        ck_assert(dec_pos + produced <= dec_size);
+        memcpy(dec + dec_pos, out, produced);
+        dec_pos += produced;
+    }
+
+    ck_assert(pos == in_size);
+    return dec_pos;
+}
+
+/**************************************************************************************************/
+
+static void test_fill_data(uint8_t* data, size_t size)
+{
+    size_t i;
+    const char pattern[] = "{\"lat\":52.5308,\"lng\":13.3847,\"accuracy\":10}";
+
+    for(i = 0; i < size; i++)
+    {
+        data[i] = (uint8_t)pattern[i % (sizeof(pattern) - 1)];
+    }
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_codec_zlib_no_mock_gzip)
+{
+    here_tracking_codec_zlib zlib;
+    uint8_t* data = malloc(TEST_DATA_SIZE);
+    uint8_t* enc = malloc(TEST_DATA_SIZE);
+    uint8_t* dec = malloc(TEST_DATA_SIZE);
+    size_t enc_size, dec_size;
+    ck_assert(data != NULL && enc != NULL && dec != NULL);
+    test_fill_data(data, TEST_DATA_SIZE);
+    ck_assert(here_tracking_codec_zlib_init(&zlib, HERE_TRACKING_CODEC_ZLIB_GZIP, 6, 10, 3) ==
+              HERE_TRACKING_OK);
+    ck_assert_str_eq(zlib.codec.content_encoding, "gzip");
+    ck_assert(zlib.codec.decode == NULL);
+
+    /* The codec is reused between requests */
+    enc_size = test_encode(&zlib.codec, data, TEST_DATA_SIZE, enc, TEST_DATA_SIZE);
+    enc_size = test_encode(&zlib.codec, data, TEST_DATA_SIZE, enc, TEST_DATA_SIZE);
+    ck_assert(enc_size > 2 && enc_size < (TEST_DATA_SIZE / 4));
+    ck_assert(enc[0] == 0x1f && enc[1] == 0x8b);
+    dec_size = test_inflate(enc, enc_size, dec, TEST_DATA_SIZE);
+    ck_assert(dec_size == TEST_DATA_SIZE);
+    ck_assert(memcmp(dec, data, TEST_DATA_SIZE) == 0);
+    here_tracking_codec_zlib_free(&zlib);
+    free(data);
+    free(enc);
+    free(dec);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_codec_zlib_no_mock_deflate)
+{
+    here_tracking_codec_zlib zlib;
+    uint8_t data[100];
+    uint8_t enc[200];
+    uint8_t dec[100];
+    size_t enc_size, dec_size;
+    test_fill_data(data, sizeof(data));
+    ck_assert(here_tracking_codec_zlib_init(&zlib, HERE_TRACKING_CODEC_ZLIB_DEFLATE, 9, 15, 8) ==
+              HERE_TRACKING_OK);
+    ck_assert_str_eq(zlib.codec.content_encoding, "deflate");
+    enc_size = test_encode(&zlib.codec, data, sizeof(data), enc, sizeof(enc));
+    ck_assert(enc[0] != 0x1f);
+    dec_size = test_inflate(enc, enc_size, dec, sizeof(dec));
+    ck_assert(dec_size == sizeof(data));
+    ck_assert(memcmp(dec, data, sizeof(data)) == 0);
+    here_tracking_codec_zlib_free(&zlib);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_codec_zlib_no_mock_decode)
+{
+    here_tracking_codec_zlib zlib;
+    here_tracking_codec_zlib_format formats[2] =
+    {
+        HERE_TRACKING_CODEC_ZLIB_GZIP,
+        HERE_TRACKING_CODEC_ZLIB_DEFLATE
+    };
+    uint8_t data[1000];
+    uint8_t enc[1000];
+    uint8_t dec[1000];
+    size_t enc_size, dec_size;
+    uint8_t i;
+    test_fill_data(data, sizeof(data));
+
+    for(i = 0; i < 2; ++i)
+    {
+        ck_assert(here_tracking_codec_zlib_init(&zlib, formats[i], 6, 9, 1) == HERE_TRACKING_OK);
+        ck_assert(here_tracking_codec_zlib_enable_decode(&zlib) == HERE_TRACKING_OK);
+        ck_assert(here_tracking_codec_zlib_enable_decode(&zlib) ==
+                  HERE_TRACKING_ERROR_INVALID_INPUT);
+        ck_assert(zlib.codec.decode_begin != NULL && zlib.codec.decode != NULL);
+
+        /* Decoder is reused between responses */
+        enc_size = test_encode(&zlib.codec, data, sizeof(data), enc, sizeof(enc));
+        dec_size = test_decode(&zlib.codec, enc, enc_size, dec, sizeof(dec));
+        ck_assert(dec_size == sizeof(data));
+        dec_size = test_decode(&zlib.codec, enc, enc_size, dec, sizeof(dec));
+        ck_assert(dec_size == sizeof(data));
+        ck_assert(memcmp(dec, data, sizeof(data)) == 0);
+        here_tracking_codec_zlib_free(&zlib);
+    }
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_codec_zlib_no_mock_decode_err)
+{
+    here_tracking_codec_zlib zlib;
+    uint8_t bad[] = { 0x1f, 0x8b, 0x00, 0x00 };
+    uint8_t out[TEST_OUT_BUFFER_SIZE];
+    size_t in_size = sizeof(bad);
+    size_t out_size = sizeof(out);
+    bool end = false;
+    ck_assert(here_tracking_codec_zlib_init(&zlib, HERE_TRACKING_CODEC_ZLIB_GZIP, 6, 10, 3) ==
+              HERE_TRACKING_OK);
+    ck_assert(here_tracking_codec_zlib_enable_decode(&zlib) == HERE_TRACKING_OK);
+    ck_assert(zlib.codec.decode_begin(zlib.codec.codec_data) == HERE_TRACKING_OK);
+
+    /* Compression method 0 is not deflate */
+    ck_assert(zlib.codec.decode(bad,
+                                &in_size,
+                                out,
+                                &out_size,
+                                true,
+                                &end,
+                                zlib.codec.codec_data) == HERE_TRACKING_ERROR);
+    ck_assert(here_tracking_codec_zlib_enable_decode(NULL) == HERE_TRACKING_ERROR_INVALID_INPUT);
+    here_tracking_codec_zlib_free(&zlib);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_codec_zlib_no_mock_init_err)
+{
+    here_tracking_codec_zlib zlib;
+    ck_assert(here_tracking_codec_zlib_init(NULL, HERE_TRACKING_CODEC_ZLIB_GZIP, 6, 10, 3) ==
+              HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert(here_tracking_codec_zlib_init(&zlib, 2, 6, 10, 3) ==
+              HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert(here_tracking_codec_zlib_init(&zlib, HERE_TRACKING_CODEC_ZLIB_GZIP, 0, 10, 3) ==
+              HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert(here_tracking_codec_zlib_init(&zlib, HERE_TRACKING_CODEC_ZLIB_GZIP, 6, 16, 3) ==
+              HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert(here_tracking_codec_zlib_init(&zlib, HERE_TRACKING_CODEC_ZLIB_GZIP, 6, 10, 10) ==
+              HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+Suite* test_here_tracking_codec_zlib_no_mock_suite(void)
+{
+    Suite* s = suite_create(TEST_NAME);
+    TCase* tc = tcase_create(TEST_NAME);
+    tcase_add_test(tc, test_here_tracking_codec_zlib_no_mock_gzip);
+    tcase_add_test(tc, test_here_tracking_codec_zlib_no_mock_deflate);
+    tcase_add_test(tc, test_here_tracking_codec_zlib_no_mock_decode);
+    tcase_add_test(tc, test_here_tracking_codec_zlib_no_mock_decode_err);
+    tcase_add_test(tc, test_here_tracking_codec_zlib_no_mock_init_err);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+/**************************************************************************************************/
+
+int main()
+{
+    int failed;
+    SRunner* sr = srunner_create(test_here_tracking_codec_zlib_no_mock_suite());
+    srunner_set_xml(sr, TEST_NAME"_test_result.xml");
+    srunner_run_all(sr, CK_VERBOSE);
+    failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
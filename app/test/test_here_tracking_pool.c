@@ -0,0 +1,718 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/* sched_yield(), nanosleep() */
+#define _POSIX_C_SOURCE 200112L
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <check.h>
+#include <fff.h>
+
+#include "here_tracking_pool.h"
+#include "here_tracking_test.h"
+
+#include "mock_here_tracking_tls.h"
+
+#define TEST_NAME "here_tracking_pool"
+
+#define TEST_DEVICE_COUNT      48
+#define TEST_WORKER_COUNT      3
+#define TEST_SLOTS_PER_WORKER  4
+#define TEST_ROUNDS            5
+#define TEST_TLS_MAX           (TEST_WORKER_COUNT * TEST_SLOTS_PER_WORKER)
+
+/* Request state of the stubs, kept in the storage of here_tracking_async */
+typedef struct
+{
+    here_tracking_send_cb send_cb;
+    here_tracking_recv_cb recv_cb;
+    void* user_data;
+    uint32_t steps;
+} test_async;
+
+#define TEST_ASYNC(ASYNC) ((test_async*)(void*)(ASYNC))
+
+typedef enum
+{
+    TEST_MODE_OK,
+    TEST_MODE_START_FAIL,
+    TEST_MODE_TIMEOUT,
+    TEST_MODE_HANG
+} test_mode;
+
+/**************************************************************************************************/
+
+DEFINE_FFF_GLOBALS;
+
+FAKE_VALUE_FUNC7(here_tracking_error,
+                 here_tracking_send_stream_async,
+                 here_tracking_async*,
+                 here_tracking_client*,
+                 here_tracking_send_cb,
+                 here_tracking_recv_cb,
+                 here_tracking_req_type,
+                 here_tracking_resp_type,
+                 void*);
+
+FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_async_step, here_tracking_async*);
+
+FAKE_VALUE_FUNC3(here_tracking_error,
+                 here_tracking_async_get_poll_info,
+                 const here_tracking_async*,
+                 int*,
+                 uint8_t*);
+
+FAKE_VALUE_FUNC2(here_tracking_error,
+                 here_tracking_async_get_timeout,
+                 const here_tracking_async*,
+                 int32_t*);
+
+FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_async_cancel, here_tracking_async*);
+
+FAKE_VALUE_FUNC2(here_tracking_error,
+                 here_tracking_set_tls_env,
+                 here_tracking_client*,
+                 here_tracking_tls_env);
+
+#define TEST_HERE_TRACKING_POOL_FAKE_LIST(FAKE) \
+    MOCK_HERE_TRACKING_TLS_FAKE_LIST(FAKE) \
+    FAKE(here_tracking_send_stream_async) \
+    FAKE(here_tracking_async_step) \
+    FAKE(here_tracking_async_get_poll_info) \
+    FAKE(here_tracking_async_get_timeout) \
+    FAKE(here_tracking_async_cancel) \
+    FAKE(here_tracking_set_tls_env)
+
+/**************************************************************************************************/
+
+static here_tracking_pool pool;
+static here_tracking_pool_device devices[TEST_DEVICE_COUNT];
+static here_tracking_pool_worker workers[TEST_WORKER_COUNT];
+static here_tracking_pool_slot slots[TEST_WORKER_COUNT * TEST_SLOTS_PER_WORKER];
+static int device_fds[TEST_DEVICE_COUNT];
+static int idle_fd;
+static int fake_env;
+static int fake_tls[TEST_TLS_MAX];
+static test_mode modes[TEST_DEVICE_COUNT];
+static uint32_t completions[TEST_DEVICE_COUNT];
+static here_tracking_error results[TEST_DEVICE_COUNT];
+static uint32_t device_ids[TEST_DEVICE_COUNT];
+static uint32_t send_count;
+static uint32_t tls_init_count;
+static uint32_t tls_free_count;
+static uint32_t reused_count;
+static uint32_t in_flight;
+static uint32_t max_in_flight;
+
+/**************************************************************************************************/
+
+static uint32_t test_device_index(const here_tracking_async* async)
+{
+    const test_async* state = (const test_async*)(const void*)async;
+
+    return (uint32_t)((here_tracking_pool_device*)state->user_data - devices);
+}
+
+/**************************************************************************************************/
+
+/* Requests take two steps, the I/O is tested with the client */
+static here_tracking_error test_send_stream_async_custom(here_tracking_async* async,
+                                                         here_tracking_client* client,
+                                                         here_tracking_send_cb send_cb,
+                                                         here_tracking_recv_cb recv_cb,
+                                                         here_tracking_req_type req_type,
+                                                         here_tracking_resp_type resp_type,
+                                                         void* user_data)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t index = (uint32_t)((here_tracking_pool_device*)user_data - devices);
+
+    (void)req_type;
+    (void)resp_type;
+
+    if(modes[index] == TEST_MODE_START_FAIL)
+    {
+        err = HERE_TRACKING_ERROR_TOO_MANY_REQUESTS;
+    }
+    else
+    {
+        uint32_t count = __atomic_add_fetch(&in_flight, 1, __ATOMIC_SEQ_CST);
+        uint32_t max = __atomic_load_n(&max_in_flight, __ATOMIC_SEQ_CST);
+
+        while(count > max &&
+              !__atomic_compare_exchange_n(&max_in_flight,
+                                           &max,
+                                           count,
+                                           false,
+                                           __ATOMIC_SEQ_CST,
+                                           __ATOMIC_SEQ_CST));
+
+        TEST_ASYNC(async)->send_cb = send_cb;
+        TEST_ASYNC(async)->recv_cb = recv_cb;
+        TEST_ASYNC(async)->user_data = user_data;
+        TEST_ASYNC(async)->steps = 0;
+
+        if(client->tls == NULL)
+        {
+            uint32_t created = __atomic_fetch_add(&tls_init_count, 1, __ATOMIC_SEQ_CST);
+
+            ck_assert_uint_lt(created, TEST_TLS_MAX);
+            client->tls = (here_tracking_tls)&(fake_tls[created]);
+        }
+        else if(client->keep_alive.connected)
+        {
+            __atomic_add_fetch(&reused_count, 1, __ATOMIC_SEQ_CST);
+        }
+
+        /* The connection stays open after the request if the client keeps it */
+        client->keep_alive.connected = client->keep_alive.enabled;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_async_step_custom(here_tracking_async* async)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+    uint32_t index = test_device_index(async);
+    test_async* state = TEST_ASYNC(async);
+
+    state->steps++;
+
+    if(modes[index] == TEST_MODE_TIMEOUT && state->steps > 1)
+    {
+        err = HERE_TRACKING_ERROR_TIMEOUT;
+    }
+    else if(modes[index] == TEST_MODE_OK && state->steps > 1)
+    {
+        here_tracking_recv_data data;
+        const uint8_t* chunk;
+        size_t chunk_size;
+
+        state->send_cb(&chunk, &chunk_size, state->user_data);
+        data.evt = HERE_TRACKING_RECV_EVT_RESP_COMPLETE;
+        data.err = HERE_TRACKING_OK;
+        data.data = NULL;
+        data.data_size = 0;
+        err = state->recv_cb(&data, state->user_data);
+    }
+
+    if(err != HERE_TRACKING_ERROR_WOULD_BLOCK)
+    {
+        __atomic_sub_fetch(&in_flight, 1, __ATOMIC_SEQ_CST);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_async_get_poll_info_custom(const here_tracking_async* async,
+                                                           int* fd,
+                                                           uint8_t* events)
+{
+    uint32_t index = test_device_index(async);
+
+    /* Requests that don't finish wait on a socket that never gets ready */
+    *fd = (modes[index] == TEST_MODE_OK) ? device_fds[index] : idle_fd;
+    *events = (modes[index] == TEST_MODE_OK) ? HERE_TRACKING_TLS_POLL_OUT :
+                                               HERE_TRACKING_TLS_POLL_IN;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_async_get_timeout_custom(const here_tracking_async* async,
+                                                         int32_t* timeout)
+{
+    *timeout = (modes[test_device_index(async)] == TEST_MODE_TIMEOUT) ? 0 : -1;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_async_cancel_custom(here_tracking_async* async)
+{
+    (void)async;
+    __atomic_sub_fetch(&in_flight, 1, __ATOMIC_SEQ_CST);
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_set_tls_env_custom(here_tracking_client* client,
+                                                   here_tracking_tls_env env)
+{
+    client->tls_env = env;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_tls_env_init_custom(here_tracking_tls_env* env)
+{
+    *env = &fake_env;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_tls_env_free_custom(here_tracking_tls_env* env)
+{
+    *env = NULL;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_tls_free_custom(here_tracking_tls* tls)
+{
+    __atomic_add_fetch(&tls_free_count, 1, __ATOMIC_SEQ_CST);
+    *tls = NULL;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_send_cb(const uint8_t** data, size_t* data_size, void* user_data)
+{
+    static const uint8_t body[] = "[]";
+
+    ck_assert_uint_lt(*(uint32_t*)user_data, TEST_DEVICE_COUNT);
+    __atomic_add_fetch(&send_count, 1, __ATOMIC_SEQ_CST);
+    *data = body;
+    *data_size = sizeof(body) - 1;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_recv_cb(const here_tracking_recv_data* data, void* user_data)
+{
+    uint32_t index = *(uint32_t*)user_data;
+
+    if(data->evt == HERE_TRACKING_RECV_EVT_RESP_COMPLETE)
+    {
+        results[index] = data->err;
+        __atomic_add_fetch(&(completions[index]), 1, __ATOMIC_SEQ_CST);
+    }
+
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static void test_submit(uint32_t index)
+{
+    /* Device may still be finishing its previous request */
+    while(here_tracking_pool_submit(&pool,
+                                    index,
+                                    test_send_cb,
+                                    test_recv_cb,
+                                    HERE_TRACKING_REQ_DATA_JSON,
+                                    HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                    &(device_ids[index])) == HERE_TRACKING_ERROR_WOULD_BLOCK)
+    {
+        sched_yield();
+    }
+}
+
+/**************************************************************************************************/
+
+static void test_wait_completions(uint32_t device_count, uint32_t expected)
+{
+    struct timespec delay = { 0, 1000000 };
+    uint32_t i, waited;
+
+    for(i = 0, waited = 0; i < device_count && waited < 10000; )
+    {
+        if(__atomic_load_n(&(completions[i]), __ATOMIC_SEQ_CST) >= expected)
+        {
+            ++i;
+        }
+        else
+        {
+            nanosleep(&delay, NULL);
+            ++waited;
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_pool_tc_setup(void)
+{
+    TEST_HERE_TRACKING_POOL_FAKE_LIST(RESET_FAKE);
+    FFF_RESET_HISTORY();
+    here_tracking_send_stream_async_fake.custom_fake = test_send_stream_async_custom;
+    here_tracking_async_step_fake.custom_fake = test_async_step_custom;
+    here_tracking_async_get_poll_info_fake.custom_fake = test_async_get_poll_info_custom;
+    here_tracking_async_get_timeout_fake.custom_fake = test_async_get_timeout_custom;
+    here_tracking_async_cancel_fake.custom_fake = test_async_cancel_custom;
+    here_tracking_set_tls_env_fake.custom_fake = test_set_tls_env_custom;
+    here_tracking_tls_env_init_fake.custom_fake = test_tls_env_init_custom;
+    here_tracking_tls_env_ref_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_tls_env_free_fake.custom_fake = test_tls_env_free_custom;
+    here_tracking_tls_close_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_tls_free_fake.custom_fake = test_tls_free_custom;
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_pool_tc_teardown(void)
+{
+}
+
+/**************************************************************************************************/
+
+static void test_init(uint32_t worker_count, uint32_t slots_per_worker)
+{
+    uint32_t i;
+
+    memset(devices, 0, sizeof(devices));
+    memset(modes, 0, sizeof(modes));
+    memset(completions, 0, sizeof(completions));
+    memset(results, 0xff, sizeof(results));
+    send_count = 0;
+    tls_init_count = 0;
+    tls_free_count = 0;
+    reused_count = 0;
+    in_flight = 0;
+    max_in_flight = 0;
+    idle_fd = eventfd(0, EFD_NONBLOCK);
+    ck_assert_int_ge(idle_fd, 0);
+
+    for(i = 0; i < TEST_DEVICE_COUNT; ++i)
+    {
+        device_ids[i] = i;
+        device_fds[i] = eventfd(1, EFD_NONBLOCK);
+        ck_assert_int_ge(device_fds[i], 0);
+    }
+
+    ck_assert_int_eq(here_tracking_pool_init(&pool,
+                                             devices,
+                                             TEST_DEVICE_COUNT,
+                                             workers,
+                                             worker_count,
+                                             slots,
+                                             slots_per_worker,
+                                             NULL),
+                     HERE_TRACKING_OK);
+
+    /* Devices share one environment */
+    ck_assert_uint_eq(here_tracking_tls_env_init_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_set_tls_env_fake.call_count, TEST_DEVICE_COUNT);
+
+    for(i = 0; i < TEST_DEVICE_COUNT; ++i)
+    {
+        ck_assert_ptr_eq(devices[i].client.tls_env, &fake_env);
+    }
+}
+
+/**************************************************************************************************/
+
+static void test_free(void)
+{
+    uint32_t i;
+
+    here_tracking_pool_free(&pool);
+    ck_assert_uint_eq(here_tracking_tls_env_free_fake.call_count, 1);
+    close(idle_fd);
+
+    for(i = 0; i < TEST_DEVICE_COUNT; ++i)
+    {
+        close(device_fds[i]);
+    }
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_pool_devices)
+{
+    uint32_t i, round;
+
+    test_init(TEST_WORKER_COUNT, TEST_SLOTS_PER_WORKER);
+    ck_assert_int_eq(here_tracking_pool_set_cpu_affinity(&pool, true), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_pool_start(&pool), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_pool_set_cpu_affinity(&pool, false),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+
+    for(round = 0; round < TEST_ROUNDS; ++round)
+    {
+        for(i = 0; i < TEST_DEVICE_COUNT; ++i)
+        {
+            test_submit(i);
+        }
+    }
+
+    test_wait_completions(TEST_DEVICE_COUNT, TEST_ROUNDS);
+    ck_assert_int_eq(here_tracking_pool_stop(&pool), HERE_TRACKING_OK);
+
+    for(i = 0; i < TEST_DEVICE_COUNT; ++i)
+    {
+        ck_assert_uint_eq(completions[i], TEST_ROUNDS);
+        ck_assert_int_eq(results[i], HERE_TRACKING_OK);
+        ck_assert_ptr_eq(devices[i].client.tls, NULL);
+    }
+
+    ck_assert_uint_eq(send_count, TEST_DEVICE_COUNT * TEST_ROUNDS);
+    ck_assert_uint_eq(workers[0].completed_count +
+                      workers[1].completed_count +
+                      workers[2].completed_count,
+                      TEST_DEVICE_COUNT * TEST_ROUNDS);
+    ck_assert_uint_le(max_in_flight, TEST_WORKER_COUNT * TEST_SLOTS_PER_WORKER);
+    ck_assert_uint_eq(in_flight, 0);
+
+    /* TLS contexts belong to the connections of the workers, not to the devices */
+    ck_assert_uint_le(tls_init_count, TEST_WORKER_COUNT * TEST_SLOTS_PER_WORKER);
+    ck_assert_uint_eq(tls_free_count, 0);
+    test_free();
+    ck_assert_uint_eq(tls_free_count, tls_init_count);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_pool_errors)
+{
+    test_init(1, 2);
+    modes[0] = TEST_MODE_START_FAIL;
+    modes[1] = TEST_MODE_TIMEOUT;
+    ck_assert_int_eq(here_tracking_pool_start(&pool), HERE_TRACKING_OK);
+    test_submit(0);
+    test_submit(1);
+    test_submit(2);
+    test_wait_completions(3, 1);
+    ck_assert_int_eq(here_tracking_pool_stop(&pool), HERE_TRACKING_OK);
+    ck_assert_uint_eq(completions[0], 1);
+    ck_assert_int_eq(results[0], HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(completions[1], 1);
+    ck_assert_int_eq(results[1], HERE_TRACKING_ERROR_TIMEOUT);
+    ck_assert_uint_eq(completions[2], 1);
+    ck_assert_int_eq(results[2], HERE_TRACKING_OK);
+    ck_assert_uint_eq(send_count, 1);
+    ck_assert_uint_eq(in_flight, 0);
+    test_free();
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_pool_stop)
+{
+    struct timespec delay = { 0, 10000000 };
+    uint32_t i;
+
+    test_init(1, 2);
+
+    for(i = 0; i < 4; ++i)
+    {
+        modes[i] = TEST_MODE_HANG;
+        test_submit(i);
+    }
+
+    /* Queued before the start, two run and two wait for a slot */
+    ck_assert_int_eq(here_tracking_pool_submit(&pool,
+                                               0,
+                                               test_send_cb,
+                                               test_recv_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               &(device_ids[0])),
+                     HERE_TRACKING_ERROR_WOULD_BLOCK);
+    ck_assert_int_eq(here_tracking_pool_start(&pool), HERE_TRACKING_OK);
+    nanosleep(&delay, NULL);
+    ck_assert_uint_eq(in_flight, 2);
+    ck_assert_uint_eq(completions[0] + completions[1] + completions[2] + completions[3], 0);
+    ck_assert_int_eq(here_tracking_pool_stop(&pool), HERE_TRACKING_OK);
+
+    for(i = 0; i < 4; ++i)
+    {
+        ck_assert_uint_eq(completions[i], 1);
+        ck_assert_int_eq(results[i], HERE_TRACKING_ERROR_CLIENT_INTERRUPT);
+        ck_assert(!devices[i].busy);
+    }
+
+    ck_assert_uint_eq(in_flight, 0);
+    ck_assert_uint_eq(tls_init_count, 2);
+    ck_assert_int_eq(here_tracking_pool_stop(&pool), HERE_TRACKING_ERROR_INVALID_INPUT);
+    test_free();
+    ck_assert_uint_eq(tls_free_count, 2);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_pool_steal)
+{
+    struct timespec delay = { 0, 10000000 };
+    here_tracking_rate_limiter limiters[2];
+    uint32_t i, on_second = 0;
+
+    /* All four devices are queued to the first worker, which has room for two */
+    test_init(2, 2);
+    ck_assert_int_eq(here_tracking_pool_set_rate_limiters(&pool, limiters), HERE_TRACKING_OK);
+
+    for(i = 0; i < 8; i += 2)
+    {
+        modes[i] = TEST_MODE_HANG;
+        test_submit(i);
+    }
+
+    ck_assert_int_eq(here_tracking_pool_start(&pool), HERE_TRACKING_OK);
+    nanosleep(&delay, NULL);
+    ck_assert_uint_eq(in_flight, 4);
+    ck_assert_uint_eq(workers[0].stolen_count, 0);
+    ck_assert_uint_eq(workers[1].stolen_count, 2);
+    ck_assert_uint_eq(workers[0].free_slots + workers[1].free_slots, 0);
+
+    /* The clients use the limiter of the worker running the request */
+    for(i = 0; i < 8; i += 2)
+    {
+        ck_assert(devices[i].client.gateway_rate_limiter == &(limiters[0]) ||
+                  devices[i].client.gateway_rate_limiter == &(limiters[1]));
+        on_second += (devices[i].client.gateway_rate_limiter == &(limiters[1])) ? 1 : 0;
+    }
+
+    ck_assert_uint_eq(on_second, 2);
+    ck_assert_int_eq(here_tracking_pool_set_rate_limiters(&pool, NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_pool_stop(&pool), HERE_TRACKING_OK);
+
+    for(i = 0; i < 8; i += 2)
+    {
+        ck_assert_uint_eq(completions[i], 1);
+        ck_assert_int_eq(results[i], HERE_TRACKING_ERROR_CLIENT_INTERRUPT);
+    }
+
+    ck_assert_uint_eq(in_flight, 0);
+    test_free();
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_pool_shared_connections)
+{
+    uint32_t i, round;
+
+    test_init(1, 2);
+
+    for(i = 0; i < TEST_DEVICE_COUNT; ++i)
+    {
+        devices[i].client.keep_alive.enabled = true;
+    }
+
+    ck_assert_int_eq(here_tracking_pool_start(&pool), HERE_TRACKING_OK);
+
+    for(round = 0; round < TEST_ROUNDS; ++round)
+    {
+        for(i = 0; i < TEST_DEVICE_COUNT; ++i)
+        {
+            test_submit(i);
+        }
+    }
+
+    test_wait_completions(TEST_DEVICE_COUNT, TEST_ROUNDS);
+    ck_assert_int_eq(here_tracking_pool_stop(&pool), HERE_TRACKING_OK);
+
+    /* Two connections carry the requests of all devices, only their first requests connect */
+    ck_assert_uint_eq(tls_init_count, 2);
+    ck_assert_uint_eq(reused_count, TEST_DEVICE_COUNT * TEST_ROUNDS - 2);
+
+    for(i = 0; i < TEST_DEVICE_COUNT; ++i)
+    {
+        ck_assert_uint_eq(completions[i], TEST_ROUNDS);
+        ck_assert_ptr_eq(devices[i].client.tls, NULL);
+        ck_assert(!devices[i].client.keep_alive.connected);
+    }
+
+    test_free();
+    ck_assert_uint_eq(tls_free_count, 2);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_pool_invalid)
+{
+    ck_assert_int_eq(here_tracking_pool_init(NULL, devices, 1, workers, 1, slots, 1, NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_pool_init(&pool, devices, 0, workers, 1, slots, 1, NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_pool_init(&pool, devices, 1, workers, 0, slots, 1, NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_pool_init(&pool, devices, 1, workers, 1, slots, 0, NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_pool_start(NULL), HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_pool_stop(NULL), HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_pool_set_rate_limiters(NULL, NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_pool_set_cpu_affinity(NULL, true),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    test_init(1, 1);
+    ck_assert_int_eq(here_tracking_pool_submit(&pool,
+                                               TEST_DEVICE_COUNT,
+                                               test_send_cb,
+                                               test_recv_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_pool_submit(&pool,
+                                               0,
+                                               NULL,
+                                               test_recv_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    test_free();
+}
+END_TEST
+
+/**************************************************************************************************/
+
+TEST_SUITE_BEGIN(TEST_NAME)
+    TEST_SUITE_ADD_SETUP_TEARDOWN_FN(test_here_tracking_pool_tc_setup,
+                                     test_here_tracking_pool_tc_teardown)
+    TEST_SUITE_ADD_TEST(test_here_tracking_pool_devices)
+    TEST_SUITE_ADD_TEST(test_here_tracking_pool_errors)
+    TEST_SUITE_ADD_TEST(test_here_tracking_pool_stop)
+    TEST_SUITE_ADD_TEST(test_here_tracking_pool_steal)
+    TEST_SUITE_ADD_TEST(test_here_tracking_pool_shared_connections)
+    TEST_SUITE_ADD_TEST(test_here_tracking_pool_invalid)
+TEST_SUITE_END
+
+/**************************************************************************************************/
+
+TEST_MAIN(TEST_NAME)
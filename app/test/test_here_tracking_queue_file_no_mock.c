@@ -0,0 +1,190 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/* mkstemp() */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <check.h>
+
+#include "here_tracking_queue_file.h"
+
+#define TEST_NAME "here_tracking_queue_file_no_mock"
+
+#define TEST_QUEUE_SIZE 4096
+
+/**************************************************************************************************/
+
+/* Sending is not tested here, the queue only needs the symbol */
+here_tracking_error here_tracking_send_stream(here_tracking_client* client,
+                                              here_tracking_send_cb send_cb,
+                                              here_tracking_recv_cb recv_cb,
+                                              here_tracking_req_type req_type,
+                                              here_tracking_resp_type resp_type,
+                                              void* user_data)
+{
+    return HERE_TRACKING_ERROR;
+}
+
+/**************************************************************************************************/
+
+static void test_create_path(char* path)
+{
+    int fd;
+    strcpy(path, "/tmp/here_tracking_queue_XXXXXX");
+    fd = mkstemp(path);
+    ck_assert_int_ge(fd, 0);
+    close(fd);
+}
+
+/**************************************************************************************************/
+
+static void test_check_samples(here_tracking_queue* queue, uint32_t first, uint32_t count)
+{
+    here_tracking_queue_iter iter;
+    const uint8_t* sample;
+    uint32_t sample_size, i;
+    ck_assert_uint_eq(queue->count, count);
+    here_tracking_queue_iter_init(queue, &iter);
+
+    for(i = 0; i < count; ++i)
+    {
+        ck_assert(here_tracking_queue_iter_next(queue, &iter, &sample, &sample_size));
+        ck_assert_uint_eq(sample_size, sizeof(uint32_t));
+        ck_assert(memcmp(sample, &first, sizeof(first)) == 0);
+        first++;
+    }
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_file_no_mock_reopen)
+{
+    here_tracking_queue_file file;
+    char path[64];
+    uint32_t i;
+    test_create_path(path);
+    ck_assert_int_eq(here_tracking_queue_file_open(&file, path, TEST_QUEUE_SIZE),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(file.queue.count, 0);
+
+    for(i = 0; i < 100; ++i)
+    {
+        ck_assert_int_eq(here_tracking_queue_push(&(file.queue), (uint8_t*)&i, sizeof(i)),
+                         HERE_TRACKING_OK);
+    }
+
+    ck_assert_int_eq(here_tracking_queue_pop(&(file.queue), 40), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_queue_file_sync(&file), HERE_TRACKING_OK);
+    here_tracking_queue_file_close(&file);
+
+    /* Samples are read back from the file */
+    ck_assert_int_eq(here_tracking_queue_file_open(&file, path, TEST_QUEUE_SIZE),
+                     HERE_TRACKING_OK);
+    test_check_samples(&(file.queue), 40, 60);
+    here_tracking_queue_file_close(&file);
+
+    /* File of a different size starts empty */
+    ck_assert_int_eq(here_tracking_queue_file_open(&file, path, TEST_QUEUE_SIZE * 2),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(file.queue.count, 0);
+    here_tracking_queue_file_close(&file);
+    unlink(path);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_file_no_mock_torn_tail)
+{
+    here_tracking_queue_file file;
+    char path[64];
+    uint32_t i, tail = 0;
+    test_create_path(path);
+    ck_assert_int_eq(here_tracking_queue_file_open(&file, path, TEST_QUEUE_SIZE),
+                     HERE_TRACKING_OK);
+
+    for(i = 0; i < 10; ++i)
+    {
+        tail = file.queue.tail;
+        ck_assert_int_eq(here_tracking_queue_push(&(file.queue), (uint8_t*)&i, sizeof(i)),
+                         HERE_TRACKING_OK);
+    }
+
+    /* Last sample was not completely written before the power went off */
+    file.map[tail + HERE_TRACKING_QUEUE_RECORD_HDR_SIZE] ^= 0xff;
+    here_tracking_queue_file_close(&file);
+    ck_assert_int_eq(here_tracking_queue_file_open(&file, path, TEST_QUEUE_SIZE),
+                     HERE_TRACKING_OK);
+    test_check_samples(&(file.queue), 0, 9);
+    here_tracking_queue_file_close(&file);
+    unlink(path);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_file_no_mock_invalid)
+{
+    here_tracking_queue_file file;
+    ck_assert_int_eq(here_tracking_queue_file_open(NULL, "/tmp/x", TEST_QUEUE_SIZE),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_file_open(&file, NULL, TEST_QUEUE_SIZE),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_file_open(&file, "/tmp/x", 1),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_file_open(&file, "/nonexistent/dir/q", TEST_QUEUE_SIZE),
+                     HERE_TRACKING_ERROR);
+    ck_assert_int_eq(here_tracking_queue_file_sync(NULL), HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+Suite* test_here_tracking_queue_file_no_mock_suite(void)
+{
+    Suite* s = suite_create(TEST_NAME);
+    TCase* tc = tcase_create(TEST_NAME);
+    tcase_add_test(tc, test_here_tracking_queue_file_no_mock_reopen);
+    tcase_add_test(tc, test_here_tracking_queue_file_no_mock_torn_tail);
+    tcase_add_test(tc, test_here_tracking_queue_file_no_mock_invalid);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+/**************************************************************************************************/
+
+int main()
+{
+    int failed;
+    SRunner* sr = srunner_create(test_here_tracking_queue_file_no_mock_suite());
+    srunner_set_xml(sr, TEST_NAME"_test_result.xml");
+    srunner_run_all(sr, CK_VERBOSE);
+    failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
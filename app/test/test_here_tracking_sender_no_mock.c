@@ -0,0 +1,329 @@
+/**************************************************************************************************
+* Copyright (C) 2017-2019 HERE Europe B.V.                                                        *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/* sched_yield(), nanosleep() */
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <check.h>
+
+#include "here_tracking_sender.h"
+#include "here_tracking_time.h"
+
+#define TEST_NAME "here_tracking_sender_no_mock"
+
+#define TEST_PRODUCERS            4
+#define TEST_SAMPLES_PER_PRODUCER 5000
+#define TEST_SLOT_COUNT           64
+
+/**************************************************************************************************/
+
+static here_tracking_client client;
+static here_tracking_sender sender;
+static here_tracking_sender_slot slots[TEST_SLOT_COUNT];
+static uint8_t batch_buffer[1024];
+static uint8_t received[TEST_PRODUCERS][TEST_SAMPLES_PER_PRODUCER];
+static uint32_t send_count;
+static uint32_t sample_count;
+static here_tracking_error send_result;
+
+/**************************************************************************************************/
+
+/* Records the samples of each request, sending itself is tested with the client */
+here_tracking_error here_tracking_send_stream(here_tracking_client* c,
+                                              here_tracking_send_cb send_cb,
+                                              here_tracking_recv_cb recv_cb,
+                                              here_tracking_req_type req_type,
+                                              here_tracking_resp_type resp_type,
+                                              void* user_data)
+{
+    here_tracking_recv_data data;
+    const uint8_t* chunk;
+    size_t chunk_size;
+
+    if(send_result == HERE_TRACKING_OK)
+    {
+        do
+        {
+            send_cb(&chunk, &chunk_size, user_data);
+
+            if(chunk_size > 2)
+            {
+                const char* p = (const char*)chunk;
+                const char* end = p + chunk_size;
+
+                while(p < end && (p = memchr(p, '{', end - p)) != NULL)
+                {
+                    unsigned producer, index;
+
+                    if(sscanf(p, "{\"p\":%u,\"i\":%u}", &producer, &index) == 2 &&
+                       producer < TEST_PRODUCERS &&
+                       index < TEST_SAMPLES_PER_PRODUCER)
+                    {
+                        received[producer][index]++;
+                        sample_count++;
+                    }
+
+                    p++;
+                }
+            }
+        } while(chunk_size > 0);
+    }
+
+    /* Rate limited for a minute */
+    if(send_result == HERE_TRACKING_ERROR_TOO_MANY_REQUESTS)
+    {
+        uint32_t now = 0;
+        here_tracking_get_unixtime(&now);
+        c->retry_after = now + 60;
+    }
+
+    send_count++;
+    data.evt = HERE_TRACKING_RECV_EVT_RESP_COMPLETE;
+    data.err = send_result;
+    data.data = NULL;
+    data.data_size = 0;
+    return recv_cb(&data, user_data);
+}
+
+/**************************************************************************************************/
+
+static void* test_producer(void* arg)
+{
+    unsigned producer = (unsigned)(uintptr_t)arg;
+    unsigned i;
+
+    for(i = 0; i < TEST_SAMPLES_PER_PRODUCER; ++i)
+    {
+        char sample[32];
+        int size = snprintf(sample, sizeof(sample), "{\"p\":%u,\"i\":%u}", producer, i);
+
+        /* The worker sends while the producers keep pushing, retry when the ring is full */
+        while(here_tracking_sender_push(&sender, (const uint8_t*)sample, size) != HERE_TRACKING_OK)
+        {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/**************************************************************************************************/
+
+static void test_init(void)
+{
+    memset(&client, 0, sizeof(client));
+    memset(received, 0, sizeof(received));
+    send_count = 0;
+    sample_count = 0;
+    send_result = HERE_TRACKING_OK;
+    ck_assert_int_eq(here_tracking_sender_init(&sender,
+                                               &client,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               slots,
+                                               TEST_SLOT_COUNT,
+                                               batch_buffer,
+                                               sizeof(batch_buffer),
+                                               NULL,
+                                               NULL),
+                     HERE_TRACKING_OK);
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_sender_no_mock_producers)
+{
+    pthread_t threads[TEST_PRODUCERS];
+    uintptr_t i, j;
+    test_init();
+    ck_assert_int_eq(here_tracking_sender_start(&sender), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_sender_start(&sender), HERE_TRACKING_ERROR_INVALID_INPUT);
+
+    for(i = 0; i < TEST_PRODUCERS; ++i)
+    {
+        ck_assert(pthread_create(&(threads[i]), NULL, test_producer, (void*)i) == 0);
+    }
+
+    for(i = 0; i < TEST_PRODUCERS; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    ck_assert_int_eq(here_tracking_sender_stop(&sender), HERE_TRACKING_OK);
+
+    /* Every sample was sent exactly once, in batches */
+    ck_assert_uint_eq(sample_count, TEST_PRODUCERS * TEST_SAMPLES_PER_PRODUCER);
+
+    for(i = 0; i < TEST_PRODUCERS; ++i)
+    {
+        for(j = 0; j < TEST_SAMPLES_PER_PRODUCER; ++j)
+        {
+            ck_assert_uint_eq(received[i][j], 1);
+        }
+    }
+
+    ck_assert_uint_lt(send_count, sample_count / 10);
+    here_tracking_sender_free(&sender);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_sender_no_mock_ring_full)
+{
+    const uint8_t sample[] = "{\"p\":0,\"i\":0}";
+    uint8_t big[HERE_TRACKING_SENDER_SAMPLE_MAX_SIZE + 1];
+    uint32_t i;
+    test_init();
+    memset(big, 'x', sizeof(big));
+
+    /* Not started, nothing takes samples out of the ring */
+    for(i = 0; i < TEST_SLOT_COUNT; ++i)
+    {
+        ck_assert_int_eq(here_tracking_sender_push(&sender, sample, sizeof(sample) - 1),
+                         HERE_TRACKING_OK);
+    }
+
+    ck_assert_int_eq(here_tracking_sender_push(&sender, sample, sizeof(sample) - 1),
+                     HERE_TRACKING_ERROR_BUFFER_TOO_SMALL);
+    ck_assert_int_eq(here_tracking_sender_push(&sender, big, sizeof(big)),
+                     HERE_TRACKING_ERROR_BUFFER_TOO_SMALL);
+    ck_assert_uint_eq(here_tracking_sender_get_dropped(&sender), 2);
+
+    /* Samples that can't be sent at the stop are dropped */
+    send_result = HERE_TRACKING_ERROR_TIMEOUT;
+    ck_assert_int_eq(here_tracking_sender_start(&sender), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_sender_stop(&sender), HERE_TRACKING_OK);
+    ck_assert_uint_eq(sample_count, 0);
+    ck_assert_uint_gt(send_count, 0);
+    ck_assert_uint_eq(here_tracking_sender_get_dropped(&sender), TEST_SLOT_COUNT + 2);
+    ck_assert_uint_eq(sender.batcher.count, 0);
+    send_result = HERE_TRACKING_OK;
+    ck_assert_int_eq(here_tracking_sender_push(&sender, sample, sizeof(sample) - 1),
+                     HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_sender_start(&sender), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_sender_stop(&sender), HERE_TRACKING_OK);
+    ck_assert_uint_eq(sample_count, 1);
+    ck_assert_uint_eq(received[0][0], 1);
+    ck_assert_uint_eq(here_tracking_sender_get_dropped(&sender), TEST_SLOT_COUNT + 2);
+    here_tracking_sender_free(&sender);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_sender_no_mock_rate_limited)
+{
+    const uint8_t sample[] = "{\"p\":0,\"i\":0}";
+    struct timespec delay = { 0, 300000000L };
+    test_init();
+    ck_assert_int_eq(here_tracking_batcher_set_limits(&(sender.batcher), 0, 0, 10),
+                     HERE_TRACKING_OK);
+    send_result = HERE_TRACKING_ERROR_TOO_MANY_REQUESTS;
+    ck_assert_int_eq(here_tracking_sender_start(&sender), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_sender_push(&sender, sample, sizeof(sample) - 1),
+                     HERE_TRACKING_OK);
+
+    /* Batch is not sent again before the time given by the server, not every linger time */
+    nanosleep(&delay, NULL);
+    ck_assert_uint_eq(send_count, 1);
+    ck_assert(sender.scheduler.waiting);
+    ck_assert_int_eq(here_tracking_sender_push(&sender, sample, sizeof(sample) - 1),
+                     HERE_TRACKING_OK);
+    nanosleep(&delay, NULL);
+    ck_assert_uint_eq(send_count, 1);
+    ck_assert_uint_eq(sender.batcher.count, 2);
+
+    /* The stop doesn't wait for the scheduler */
+    send_result = HERE_TRACKING_OK;
+    ck_assert_int_eq(here_tracking_sender_stop(&sender), HERE_TRACKING_OK);
+    ck_assert_uint_eq(send_count, 2);
+    ck_assert_uint_eq(sample_count, 2);
+    ck_assert_uint_eq(here_tracking_sender_get_dropped(&sender), 0);
+    here_tracking_sender_free(&sender);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_sender_no_mock_invalid)
+{
+    ck_assert_int_eq(here_tracking_sender_init(&sender,
+                                               &client,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               slots,
+                                               TEST_SLOT_COUNT - 1,
+                                               batch_buffer,
+                                               sizeof(batch_buffer),
+                                               NULL,
+                                               NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_sender_init(&sender,
+                                               &client,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               NULL,
+                                               TEST_SLOT_COUNT,
+                                               batch_buffer,
+                                               sizeof(batch_buffer),
+                                               NULL,
+                                               NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_sender_push(NULL, batch_buffer, 1),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_sender_stop(NULL), HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+Suite* test_here_tracking_sender_no_mock_suite(void)
+{
+    Suite* s = suite_create(TEST_NAME);
+    TCase* tc = tcase_create(TEST_NAME);
+    tcase_add_test(tc, test_here_tracking_sender_no_mock_producers);
+    tcase_add_test(tc, test_here_tracking_sender_no_mock_ring_full);
+    tcase_add_test(tc, test_here_tracking_sender_no_mock_rate_limited);
+    tcase_add_test(tc, test_here_tracking_sender_no_mock_invalid);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+/**************************************************************************************************/
+
+int main()
+{
+    int failed;
+    SRunner* sr = srunner_create(test_here_tracking_sender_no_mock_suite());
+    srunner_set_xml(sr, TEST_NAME"_test_result.xml");
+    srunner_run_all(sr, CK_VERBOSE);
+    failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -22,7 +22,11 @@
 * SOFTWARE.                                                                                       *
 **************************************************************************************************/
 
+/* clock_gettime() */
+#define _POSIX_C_SOURCE 199309L
+
 #include <stdlib.h>
+#include <time.h>
 
 #include <check.h>
 #include <fff.h>
@@ -33,6 +37,17 @@
 
 DEFINE_FFF_GLOBALS;
 FAKE_VALUE_FUNC1(time_t, time, time_t*);
+FAKE_VALUE_FUNC2(int, clock_gettime, clockid_t, struct timespec*);
+
+/**************************************************************************************************/
+
+static struct timespec clock_gettime_result;
+
+static int clock_gettime_custom(clockid_t clk_id, struct timespec* tp)
+{
+    (*tp) = clock_gettime_result;
+    return clock_gettime_fake.return_val;
+}
 
 /**************************************************************************************************/
 
@@ -68,6 +83,51 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_time_monotonic_ms_ok)
+{
+    uint32_t ms;
+    RESET_FAKE(clock_gettime);
+    clock_gettime_fake.custom_fake = clock_gettime_custom;
+    clock_gettime_result.tv_sec = 1234;
+    clock_gettime_result.tv_nsec = 567890123;
+    here_tracking_error res = here_tracking_get_monotonic_ms(&ms);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert_uint_eq(ms, 1234567);
+    ck_assert(clock_gettime_fake.arg0_val == CLOCK_MONOTONIC);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_time_monotonic_ms_wrap)
+{
+    uint32_t ms;
+    RESET_FAKE(clock_gettime);
+    clock_gettime_fake.custom_fake = clock_gettime_custom;
+    clock_gettime_result.tv_sec = 4294968; /* 2^32 ms is 4294967.296 s */
+    clock_gettime_result.tv_nsec = 0;
+    here_tracking_error res = here_tracking_get_monotonic_ms(&ms);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert_uint_eq(ms, 704);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_time_monotonic_ms_fail)
+{
+    uint32_t ms;
+    RESET_FAKE(clock_gettime);
+    clock_gettime_fake.return_val = -1;
+    here_tracking_error res = here_tracking_get_monotonic_ms(&ms);
+    ck_assert(res == HERE_TRACKING_ERROR);
+    res = here_tracking_get_monotonic_ms(NULL);
+    ck_assert(res == HERE_TRACKING_ERROR);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 Suite* test_here_tracking_time_suite(void)
 {
     Suite* s = suite_create(TEST_NAME);
@@ -75,6 +135,9 @@ Suite* test_here_tracking_time_suite(void)
     tcase_add_test(tc, test_here_tracking_time_ok);
     tcase_add_test(tc, test_here_tracking_time_fail);
     tcase_add_test(tc, test_here_tracking_time_invalid_input);
+    tcase_add_test(tc, test_here_tracking_time_monotonic_ms_ok);
+    tcase_add_test(tc, test_here_tracking_time_monotonic_ms_wrap);
+    tcase_add_test(tc, test_here_tracking_time_monotonic_ms_fail);
     suite_add_tcase(s, tc);
     return s;
 }
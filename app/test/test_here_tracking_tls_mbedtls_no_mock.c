@@ -0,0 +1,423 @@
+/**************************************************************************************************
+* Copyright (C) 2017 HERE Europe B.V.                                                             *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+/* POSIX sockets */
+#define _POSIX_C_SOURCE 200112L
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <check.h>
+
+#include "here_tracking_time.h"
+#include "here_tracking_tls.h"
+
+#define TEST_NAME "here_tracking_tls_mbedtls_no_mock"
+
+#define TEST_THREAD_COUNT 8
+
+#define TEST_TLS_PER_THREAD 16
+
+/**************************************************************************************************/
+
+static void* test_here_tracking_tls_mbedtls_no_mock_thread(void* arg)
+{
+    here_tracking_tls_env env = (here_tracking_tls_env)arg;
+    here_tracking_tls tls[TEST_TLS_PER_THREAD];
+    here_tracking_error res = HERE_TRACKING_OK;
+    uint32_t i;
+
+    for(i = 0; i < TEST_TLS_PER_THREAD && res == HERE_TRACKING_OK; ++i)
+    {
+        res = here_tracking_tls_init(&(tls[i]), env);
+    }
+
+    while(i > 0)
+    {
+        here_tracking_tls_free(&(tls[--i]));
+    }
+
+    return (res == HERE_TRACKING_OK) ? arg : NULL;
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_mbedtls_no_mock_env)
+{
+    here_tracking_tls_env env = NULL;
+    here_tracking_tls tls1 = NULL;
+    here_tracking_tls tls2 = NULL;
+    here_tracking_error res = here_tracking_tls_env_init(&env);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(env != NULL);
+    res = here_tracking_tls_init(&tls1, env);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_init(&tls2, env);
+    ck_assert(res == HERE_TRACKING_OK);
+
+    /* The TLS handles keep the environment alive after the creator releases it */
+    res = here_tracking_tls_env_free(&env);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(env == NULL);
+    res = here_tracking_tls_free(&tls1);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(tls1 == NULL);
+    res = here_tracking_tls_free(&tls2);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(tls2 == NULL);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_mbedtls_no_mock_env_default)
+{
+    here_tracking_tls tls1 = NULL;
+    here_tracking_tls tls2 = NULL;
+    here_tracking_error res = here_tracking_tls_init(&tls1, NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_init(&tls2, NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_free(&tls1);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_free(&tls2);
+    ck_assert(res == HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_mbedtls_no_mock_env_threads)
+{
+    here_tracking_tls_env env = NULL;
+    pthread_t threads[TEST_THREAD_COUNT];
+    uint32_t i;
+    here_tracking_error res = here_tracking_tls_env_init(&env);
+    ck_assert(res == HERE_TRACKING_OK);
+
+    for(i = 0; i < TEST_THREAD_COUNT; ++i)
+    {
+        ck_assert(pthread_create(&(threads[i]),
+                                 NULL,
+                                 test_here_tracking_tls_mbedtls_no_mock_thread,
+                                 env) == 0);
+    }
+
+    for(i = 0; i < TEST_THREAD_COUNT; ++i)
+    {
+        void* thread_res = NULL;
+        ck_assert(pthread_join(threads[i], &thread_res) == 0);
+        ck_assert(thread_res == env);
+    }
+
+    res = here_tracking_tls_env_free(&env);
+    ck_assert(res == HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_mbedtls_no_mock_env_invalid_input)
+{
+    here_tracking_tls_env env = NULL;
+    here_tracking_error res = here_tracking_tls_env_init(NULL);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_env_ref(NULL);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_env_free(NULL);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_env_free(&env);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_init(NULL, NULL);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_mbedtls_no_mock_connect_async)
+{
+    here_tracking_tls tls;
+    here_tracking_error res;
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    struct pollfd pfd;
+    int listen_fd, fd = -1;
+    uint8_t events = 0;
+    uint32_t i;
+
+    /* Local server that accepts the connection but never answers the handshake */
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    ck_assert(listen_fd >= 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    ck_assert(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    ck_assert(listen(listen_fd, 1) == 0);
+    ck_assert(getsockname(listen_fd, (struct sockaddr*)&addr, &addr_len) == 0);
+
+    res = here_tracking_tls_init(&tls, NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_get_poll_info(tls, &fd, &events);
+    ck_assert(res == HERE_TRACKING_ERROR);
+
+    /* Step until the client hello has been sent and the client waits for the server */
+    for(i = 0; i < 100; ++i)
+    {
+        res = here_tracking_tls_connect_async(tls, "127.0.0.1", ntohs(addr.sin_port));
+        ck_assert(res == HERE_TRACKING_ERROR_WOULD_BLOCK);
+        res = here_tracking_tls_get_poll_info(tls, &fd, &events);
+        ck_assert(res == HERE_TRACKING_OK);
+        ck_assert(fd >= 0);
+
+        if(events == HERE_TRACKING_TLS_POLL_IN)
+        {
+            break;
+        }
+
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        poll(&pfd, 1, 100);
+    }
+
+    ck_assert(events == HERE_TRACKING_TLS_POLL_IN);
+
+    /* Server closes the connection, handshake fails */
+    close(listen_fd);
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    poll(&pfd, 1, 1000);
+    res = here_tracking_tls_connect_async(tls, "127.0.0.1", ntohs(addr.sin_port));
+    ck_assert(res == HERE_TRACKING_ERROR);
+    res = here_tracking_tls_free(&tls);
+    ck_assert(res == HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_mbedtls_no_mock_connect_timeout)
+{
+    here_tracking_tls tls;
+    here_tracking_error res;
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int listen_fd;
+    uint32_t start, end;
+
+    /* Local server that accepts the connection but never answers the handshake */
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    ck_assert(listen_fd >= 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    ck_assert(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    ck_assert(listen(listen_fd, 1) == 0);
+    ck_assert(getsockname(listen_fd, (struct sockaddr*)&addr, &addr_len) == 0);
+
+    res = here_tracking_tls_init(&tls, NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(here_tracking_get_monotonic_ms(&start) == HERE_TRACKING_OK);
+    res = here_tracking_tls_set_deadline(tls, start + 200);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_connect(tls, "127.0.0.1", ntohs(addr.sin_port));
+    ck_assert(res == HERE_TRACKING_ERROR_TIMEOUT);
+    ck_assert(here_tracking_get_monotonic_ms(&end) == HERE_TRACKING_OK);
+    ck_assert(end - start >= 200);
+    ck_assert(end - start < 2000);
+
+    /* Deadline already passed */
+    res = here_tracking_tls_connect(tls, "127.0.0.1", ntohs(addr.sin_port));
+    ck_assert(res == HERE_TRACKING_ERROR_TIMEOUT);
+
+    close(listen_fd);
+    res = here_tracking_tls_set_deadline(NULL, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_free(&tls);
+    ck_assert(res == HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_mbedtls_no_mock_dns_cache)
+{
+    here_tracking_tls_env env = NULL;
+    here_tracking_tls tls;
+    here_tracking_error res;
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int listen_fd;
+    uint32_t now;
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    ck_assert(listen_fd >= 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    ck_assert(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    ck_assert(listen(listen_fd, 2) == 0);
+    ck_assert(getsockname(listen_fd, (struct sockaddr*)&addr, &addr_len) == 0);
+
+    res = here_tracking_tls_env_init(&env);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_env_set_dns_cache_ttl(env, 600);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_init(&tls, env);
+    ck_assert(res == HERE_TRACKING_OK);
+
+    /* Resolved on first connect, taken from the cache on the second */
+    res = here_tracking_tls_connect_async(tls, "127.0.0.1", ntohs(addr.sin_port));
+    ck_assert(res == HERE_TRACKING_ERROR_WOULD_BLOCK);
+    res = here_tracking_tls_close(tls);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_connect_async(tls, "127.0.0.1", ntohs(addr.sin_port));
+    ck_assert(res == HERE_TRACKING_ERROR_WOULD_BLOCK);
+    res = here_tracking_tls_close(tls);
+    ck_assert(res == HERE_TRACKING_OK);
+
+    /* Connecting to the cached address fails, resolved again and fails for real */
+    close(listen_fd);
+    ck_assert(here_tracking_get_monotonic_ms(&now) == HERE_TRACKING_OK);
+    res = here_tracking_tls_set_deadline(tls, now + 1000);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_connect(tls, "127.0.0.1", ntohs(addr.sin_port));
+    ck_assert(res == HERE_TRACKING_ERROR);
+
+    res = here_tracking_tls_env_set_dns_cache_ttl(NULL, 600);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_free(&tls);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_env_free(&env);
+    ck_assert(res == HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_mbedtls_no_mock_connect_async_invalid_input)
+{
+    here_tracking_tls tls;
+    here_tracking_error res;
+    int fd;
+    uint8_t events;
+
+    res = here_tracking_tls_init(&tls, NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_tls_connect_async(NULL, "127.0.0.1", 443);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_connect_async(tls, NULL, 443);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_connect_async(tls, "", 443);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_get_poll_info(NULL, &fd, &events);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_get_poll_info(tls, NULL, &events);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_get_poll_info(tls, &fd, NULL);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_free(&tls);
+    ck_assert(res == HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_mbedtls_no_mock_session)
+{
+    here_tracking_tls tls;
+    here_tracking_error res;
+    uint8_t session[16];
+    uint32_t session_size = sizeof(session);
+
+    res = here_tracking_tls_init(&tls, NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+
+    /* Nothing negotiated or restored yet */
+    res = here_tracking_tls_get_session(tls, session, &session_size);
+    ck_assert(res == HERE_TRACKING_ERROR);
+    memset(session, 0xAA, sizeof(session));
+    res = here_tracking_tls_set_session(tls, session, sizeof(session));
+    ck_assert(res == HERE_TRACKING_ERROR);
+    res = here_tracking_tls_get_session(tls, session, &session_size);
+    ck_assert(res == HERE_TRACKING_ERROR);
+
+    res = here_tracking_tls_get_session(NULL, session, &session_size);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_get_session(tls, NULL, &session_size);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_get_session(tls, session, NULL);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_set_session(NULL, session, sizeof(session));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_set_session(tls, NULL, sizeof(session));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_set_session(tls, session, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_tls_free(&tls);
+    ck_assert(res == HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+Suite* test_here_tracking_tls_mbedtls_no_mock_suite(void)
+{
+    Suite* s = suite_create(TEST_NAME);
+    TCase* tc = tcase_create(TEST_NAME);
+    tcase_add_test(tc, test_here_tracking_tls_mbedtls_no_mock_env);
+    tcase_add_test(tc, test_here_tracking_tls_mbedtls_no_mock_env_default);
+    tcase_add_test(tc, test_here_tracking_tls_mbedtls_no_mock_env_threads);
+    tcase_add_test(tc, test_here_tracking_tls_mbedtls_no_mock_env_invalid_input);
+    tcase_add_test(tc, test_here_tracking_tls_mbedtls_no_mock_connect_async);
+    tcase_add_test(tc, test_here_tracking_tls_mbedtls_no_mock_connect_timeout);
+    tcase_add_test(tc, test_here_tracking_tls_mbedtls_no_mock_dns_cache);
+    tcase_add_test(tc, test_here_tracking_tls_mbedtls_no_mock_connect_async_invalid_input);
+    tcase_add_test(tc, test_here_tracking_tls_mbedtls_no_mock_session);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+/**************************************************************************************************/
+
+int main()
+{
+    int failed;
+    SRunner* sr = srunner_create(test_here_tracking_tls_mbedtls_no_mock_suite());
+    srunner_set_xml(sr, TEST_NAME"_test_result.xml");
+    srunner_run_all(sr, CK_VERBOSE);
+    failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
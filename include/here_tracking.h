@@ -49,9 +49,12 @@
 #ifndef HERE_TRACKING_H
 #define HERE_TRACKING_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "here_tracking_error.h"
+#include "here_tracking_codec.h"
+#include "here_tracking_rate_limiter.h"
 #include "here_tracking_tls.h"
 
 #ifdef __cplusplus
@@ -82,6 +85,36 @@ extern "C" {
  */
 #define HERE_TRACKING_DEVICE_SECRET_SIZE 43
 
+/**
+ * @brief The default time in seconds after which an idle persistent connection is closed instead of
+ *        reused. See here_tracking_set_keep_alive().
+ */
+#define HERE_TRACKING_KEEP_ALIVE_DEFAULT_IDLE_TIMEOUT 30
+
+/**
+ * @brief The default time in milliseconds for establishing a connection including the TLS
+ *        handshake. See here_tracking_set_timeouts().
+ */
+#define HERE_TRACKING_DEFAULT_CONNECT_TIMEOUT 30000
+
+/**
+ * @brief The default time in milliseconds to wait for progress when sending or receiving data. See
+ *        here_tracking_set_timeouts().
+ */
+#define HERE_TRACKING_DEFAULT_IO_TIMEOUT 30000
+
+/**
+ * @brief The minimum size in bytes of the send and receive buffers set with
+ *        here_tracking_set_io_buffers(). This is also the size of the buffer used by default. A
+ *        response header line must fit in the receive buffer.
+ */
+#define HERE_TRACKING_IO_BUFFER_MIN_SIZE 256
+
+/**
+ * @brief The default total time in milliseconds for a request. 0 means no limit. See
+ *        here_tracking_set_timeouts().
+ */
+#define HERE_TRACKING_DEFAULT_REQUEST_TIMEOUT 0
 
 /**
  * @brief HERE Tracking request data format
@@ -170,7 +203,9 @@ typedef here_tracking_error (*here_tracking_send_cb)(const uint8_t** data,
 typedef enum
 {
     /**
-     * @brief Event informing the total size of response in bytes.
+     * @brief Event informing the total size of response in bytes. Not sent if the server doesn't
+     *        tell the size in advance and sends the response in chunks, or if the response is
+     *        decompressed by the codec set with here_tracking_set_codec().
      */
     HERE_TRACKING_RECV_EVT_RESP_SIZE     = 0,
 
@@ -228,6 +263,173 @@ typedef struct
 typedef here_tracking_error (*here_tracking_recv_cb)(const here_tracking_recv_data* data,
                                                      void* user_data);
 
+/**
+ * @brief A request sent with here_tracking_send_stream_pipelined().
+ */
+typedef struct
+{
+    /** @brief Callback function that will be called to request data for sending. */
+    here_tracking_send_cb send_cb;
+
+    /** @brief Callback function that will be called when the response data is received. */
+    here_tracking_recv_cb recv_cb;
+
+    /** @brief Format of data that will be sent to HERE Tracking server. */
+    here_tracking_req_type req_type;
+
+    /** @brief Response type to use. */
+    here_tracking_resp_type resp_type;
+
+    /** @brief User data to pass back as an argument in send and recv callbacks. */
+    void* user_data;
+} here_tracking_stream_req;
+
+/**
+ * @brief Persistent connection settings and state of the HERE Tracking client.
+ */
+typedef struct
+{
+    /** @brief Keep the TLS connection open between requests. Disabled by default. */
+    bool enabled;
+
+    /** @brief Time in seconds after which an idle connection is closed instead of reused. */
+    uint32_t idle_timeout;
+
+    /** @brief Is a persistent connection to the HERE Tracking service currently open. */
+    bool connected;
+
+    /** @brief Port number of the open persistent connection. */
+    uint16_t port;
+
+    /** @brief Time when the open persistent connection was last used. */
+    uint32_t last_used;
+
+    /** @brief Was the open persistent connection established in non-blocking mode. */
+    bool non_blocking;
+} here_tracking_keep_alive;
+
+/**
+ * @brief Timeouts of the HERE Tracking client in milliseconds. 0 means no limit.
+ */
+typedef struct
+{
+    /** @brief Maximum time for the TCP connect and the TLS handshake. */
+    uint32_t connect_timeout;
+
+    /** @brief Maximum time to wait for a single read or write to make progress. */
+    uint32_t io_timeout;
+
+    /** @brief Maximum total time for a request including connecting. */
+    uint32_t request_timeout;
+} here_tracking_timeouts;
+
+/**
+ * @brief Send and receive buffers of the HERE Tracking client.
+ */
+typedef struct
+{
+    /** @brief Buffer for collecting request data before writing it. NULL to use the default. */
+    uint8_t* send_buffer;
+
+    /** @brief Size of the send buffer in bytes. */
+    uint32_t send_buffer_size;
+
+    /** @brief Buffer for reading and parsing the response. NULL to use the default. */
+    uint8_t* recv_buffer;
+
+    /** @brief Size of the receive buffer in bytes. */
+    uint32_t recv_buffer_size;
+} here_tracking_io_buffers;
+
+/**
+ * @brief Cached request header block of the HERE Tracking client.
+ *
+ * Holds the headers of the last request that stay the same from one request to the next. The
+ * cache is emptied when the access token changes.
+ */
+typedef struct
+{
+    /** @brief Buffer for the header block. NULL disables the cache. */
+    uint8_t* buffer;
+
+    /** @brief Size of the buffer in bytes. */
+    uint32_t buffer_size;
+
+    /** @brief Size of the cached header block in bytes. 0 if the cache is empty. */
+    uint32_t size;
+
+    /** @brief Request type of the cached header block. */
+    here_tracking_req_type req_type;
+
+    /** @brief Response type of the cached header block. */
+    here_tracking_resp_type resp_type;
+
+    /** @brief User agent of the cached header block. */
+    const char* user_agent;
+
+    /** @brief The header block of the types and user agent above did not fit in the buffer. */
+    bool too_small;
+} here_tracking_hdr_cache;
+
+/**
+ * @brief HTTP/2 settings and connection state of the HERE Tracking client.
+ *
+ * The state describes the open connection and is reset when a new connection is established.
+ */
+typedef struct
+{
+    /** @brief Offer HTTP/2 when connecting. Disabled by default. */
+    bool enabled;
+
+    /** @brief Buffer for the HPACK dynamic table of the request headers. NULL if not indexed. */
+    uint8_t* hpack_buffer;
+
+    /** @brief Size of the HPACK buffer in bytes. */
+    uint32_t hpack_buffer_size;
+
+    /** @brief Does the open connection use HTTP/2. */
+    bool active;
+
+    /** @brief Has the connection preface been sent on the open connection. */
+    bool preface_sent;
+
+    /** @brief Has the server announced that it closes the open connection. */
+    bool goaway;
+
+    /** @brief Identifier of the next stream. */
+    uint32_t next_stream_id;
+
+    /** @brief Connection flow control window for sending in bytes. */
+    int32_t send_window;
+
+    /** @brief Received data not yet acknowledged with a window update in bytes. */
+    uint32_t recv_unacked;
+
+    /** @brief Initial stream flow control window for sending set by the server. */
+    uint32_t initial_window;
+
+    /** @brief Maximum frame payload size accepted by the server. */
+    uint32_t max_frame_size;
+
+    /** @brief Maximum number of concurrent streams accepted by the server. */
+    uint32_t max_streams;
+
+    /** @brief Maximum size of the HPACK dynamic table accepted by the server. */
+    uint32_t table_limit;
+
+    /** @brief Maximum size of the HPACK dynamic table in use. */
+    uint32_t table_max;
+
+    /** @brief Size of the HPACK dynamic table as defined by HPACK. */
+    uint32_t table_size;
+
+    /** @brief Bytes of the HPACK buffer used by the table entries. */
+    uint32_t table_used;
+
+    /** @brief Must the next header block start with a dynamic table size update. */
+    bool table_update;
+} here_tracking_http2;
+
 /**
  * @brief The HERE Tracking Client Structure.
  */
@@ -259,6 +461,12 @@ typedef struct
     /** @brief The TLS connection handle used by the client. */
     here_tracking_tls tls;
 
+    /**
+     * @brief TLS environment set in here_tracking_set_tls_env(). NULL to use the default
+     *        environment of the TLS implementation.
+     */
+    here_tracking_tls_env tls_env;
+
     /**
      * @brief Data callback function that has been set in here_tracking_set_recv_data_cb().
      *        NULL if the callback hasn't been set.
@@ -271,12 +479,49 @@ typedef struct
     /** @brief Correlation id set by the user. You must terminate the string with `\0`.*/
     const char* correlation_id;
 
-    /** @brief User agent set by the user. You must terminate the string with `\0`. */
+    /**
+     * @brief User agent set by the user. You must terminate the string with `\0`.
+     *
+     * With a header cache set, point this to a new string instead of modifying the current one.
+     */
     const char* user_agent;
 
     /** @brief Indicates time when client can make requests again after being rate-limited. */
     uint32_t retry_after;
 
+    /** @brief Persistent connection settings set in here_tracking_set_keep_alive(). */
+    here_tracking_keep_alive keep_alive;
+
+    /** @brief Timeouts set in here_tracking_set_timeouts(). */
+    here_tracking_timeouts timeouts;
+
+    /** @brief Send and receive buffers set in here_tracking_set_io_buffers(). */
+    here_tracking_io_buffers io_buffers;
+
+    /** @brief Request header cache set in here_tracking_set_hdr_cache(). */
+    here_tracking_hdr_cache hdr_cache;
+
+    /** @brief Codec set in here_tracking_set_codec(). NULL if bodies are not compressed. */
+    const here_tracking_codec* codec;
+
+    /** @brief Buffer for the codec output set in here_tracking_set_codec(). */
+    uint8_t* codec_buffer;
+
+    /** @brief Size of the buffer for the codec output in bytes. */
+    uint32_t codec_buffer_size;
+
+    /** @brief HTTP/2 settings and state set in here_tracking_set_http2(). */
+    here_tracking_http2 http2;
+
+    /** @brief Rate limiter of the client set in here_tracking_set_rate_limiters(). */
+    here_tracking_rate_limiter* rate_limiter;
+
+    /**
+     * @brief Rate limiter shared by the clients of a gateway set in
+     *        here_tracking_set_rate_limiters().
+     */
+    here_tracking_rate_limiter* gateway_rate_limiter;
+
 } here_tracking_client;
 
 /**
@@ -326,6 +571,248 @@ here_tracking_error here_tracking_set_recv_data_cb(here_tracking_client* client,
                                                    here_tracking_recv_data_cb cb,
                                                    void* user_data);
 
+/**
+ * @brief Enables or disables persistent connections.
+ *
+ * When enabled, the client keeps its TLS connection to the HERE Tracking service open after a
+ * request completes and reuses it for the next request, which saves a TCP connect and a TLS
+ * handshake per request. The connection is closed and transparently re-established when it has
+ * been idle longer than @p idle_timeout, when the server closes it or when a request fails.
+ *
+ * Disabling persistent connections closes the open connection, if any.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] enable true to enable persistent connections, false to disable.
+ * @param[in] idle_timeout Time in seconds after which an idle connection is not reused anymore.
+ *                         Set to 0 to use #HERE_TRACKING_KEEP_ALIVE_DEFAULT_IDLE_TIMEOUT.
+ * @return ::HERE_TRACKING_OK Persistent connection settings were successfully updated.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_set_keep_alive(here_tracking_client* client,
+                                                 bool enable,
+                                                 uint32_t idle_timeout);
+
+/**
+ * @brief Sets the buffers the client uses for sending requests and receiving responses.
+ *
+ * By default the client uses a buffer of #HERE_TRACKING_IO_BUFFER_MIN_SIZE bytes on the stack for
+ * both. Larger buffers mean fewer TLS reads and writes per request, e.g. a buffer the size of a
+ * TLS record (16 KB). The same memory can be given for both buffers. The memory is owned by the
+ * caller and must stay valid until the client is freed or the buffers are reset.
+ *
+ * Requests started with here_tracking_send_stream_async() keep using their own buffer.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] send_buffer Buffer for sending, NULL to use the default buffer.
+ * @param[in] send_buffer_size Size of @p send_buffer in bytes. At least
+ *                             #HERE_TRACKING_IO_BUFFER_MIN_SIZE.
+ * @param[in] recv_buffer Buffer for receiving, NULL to use the default buffer.
+ * @param[in] recv_buffer_size Size of @p recv_buffer in bytes. At least
+ *                             #HERE_TRACKING_IO_BUFFER_MIN_SIZE.
+ * @return ::HERE_TRACKING_OK Buffers were successfully updated.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_set_io_buffers(here_tracking_client* client,
+                                                 uint8_t* send_buffer,
+                                                 uint32_t send_buffer_size,
+                                                 uint8_t* recv_buffer,
+                                                 uint32_t recv_buffer_size);
+
+/**
+ * @brief Sets a buffer for caching the request header block of the client.
+ *
+ * The request line, host, content type, user agent and authorization headers are built once
+ * and then written as one block for the following requests of the same type. The cache is rebuilt
+ * when the request or response type changes, the access token is renewed or
+ * ::here_tracking_client::user_agent is set to a different string. The user agent is compared by
+ * pointer, so changing the contents of the same string requires calling this function again.
+ *
+ * The header block contains the access token, so the buffer should be
+ * #HERE_TRACKING_ACCESS_TOKEN_SIZE + 256 bytes. If the header block does not fit, the headers are
+ * written without the cache, and building the block is tried again only when the cache would be
+ * rebuilt. The memory is owned by the caller and must stay valid until the client
+ * is freed or the cache is disabled.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] buffer Buffer for the header block, NULL to disable the cache.
+ * @param[in] buffer_size Size of @p buffer in bytes.
+ * @return ::HERE_TRACKING_OK Cache was successfully set.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_set_hdr_cache(here_tracking_client* client,
+                                                uint8_t* buffer,
+                                                uint32_t buffer_size);
+
+/**
+ * @brief Sets the codec for compressing request bodies and decompressing response bodies.
+ *
+ * If the codec can compress, the data from the send callback of here_tracking_send_stream() and
+ * the other synchronous requests is passed through the codec and sent in chunks of at most
+ * @p buffer_size bytes. The whole body is never held in memory.
+ *
+ * If the codec can decompress, the same requests ask the server for responses with the content
+ * coding of the codec. Response bodies sent with it are decompressed in parts of at most
+ * @p buffer_size bytes before they are passed to the receive callback. The decompressed size is
+ * not known in advance, so ::HERE_TRACKING_RECV_EVT_RESP_SIZE is not sent for these responses.
+ * If the body can't be decompressed, ::HERE_TRACKING_RECV_EVT_RESP_COMPLETE is sent with
+ * ::HERE_TRACKING_ERROR.
+ *
+ * Requests started with here_tracking_send_stream_async() are sent uncompressed and ask for
+ * uncompressed responses.
+ *
+ * The codec and the buffer are owned by the caller and must stay valid until the client is freed
+ * or the codec is removed.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] codec The codec, NULL to send request bodies uncompressed.
+ * @param[in] buffer Buffer for the codec output. Not used if @p codec is NULL.
+ * @param[in] buffer_size Size of @p buffer in bytes.
+ * @return ::HERE_TRACKING_OK Codec was successfully set.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_set_codec(here_tracking_client* client,
+                                            const here_tracking_codec* codec,
+                                            uint8_t* buffer,
+                                            uint32_t buffer_size);
+
+/**
+ * @brief Enables or disables HTTP/2.
+ *
+ * When enabled, the client offers HTTP/2 with ALPN when it connects and falls back to HTTP/1.1 if
+ * the server or the TLS implementation doesn't support it. On an HTTP/2 connection the request
+ * headers are compressed with HPACK, and the requests of one here_tracking_send_stream_pipelined()
+ * call are sent as concurrent streams, so a slow response doesn't hold back the others. Other
+ * requests use the connection one at a time, there is no multiplexing between calls or clients.
+ * With @p hpack_buffer the headers that repeat from one request to the next, like the
+ * authorization header with the access token, are sent in full only once per connection. This
+ * works best with persistent connections, see here_tracking_set_keep_alive().
+ *
+ * The request header cache of here_tracking_set_hdr_cache() is not used on HTTP/2 connections.
+ * Requests started with here_tracking_send_stream_async(), including the ones of a gateway pool,
+ * always use HTTP/1.1. Changing the setting closes the open connection, if any.
+ *
+ * The buffer is owned by the caller and must stay valid until the client is freed or HTTP/2 is
+ * disabled. Servers accept a table of 4096 bytes by default, a larger buffer is not used.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] enable true to offer HTTP/2, false to use HTTP/1.1 only.
+ * @param[in] hpack_buffer Buffer for the HPACK dynamic table, NULL to not index headers.
+ * @param[in] hpack_buffer_size Size of @p hpack_buffer in bytes.
+ * @return ::HERE_TRACKING_OK HTTP/2 settings were successfully updated.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_set_http2(here_tracking_client* client,
+                                            bool enable,
+                                            uint8_t* hpack_buffer,
+                                            uint32_t hpack_buffer_size);
+
+/**
+ * @brief Sets the rate limiters of the client.
+ *
+ * Requests are sent only when both limiters have a token, otherwise they fail with
+ * ::HERE_TRACKING_ERROR_TOO_MANY_REQUESTS before connecting. Each request of
+ * here_tracking_send_stream_pipelined() takes a token. Rate limited responses slow down both
+ * limiters, the time given in their Retry-After header pauses only @p limiter.
+ * here_tracking_prewarm() doesn't take tokens but is not done while a limiter is paused.
+ *
+ * The limiters are owned by the caller and must stay valid until the client is freed or the
+ * limiters are removed.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] limiter Rate limiter of this client only, NULL for none.
+ * @param[in] gateway_limiter Rate limiter shared with other clients of the same gateway, NULL for
+ *                            none.
+ * @return ::HERE_TRACKING_OK Rate limiters were successfully set.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_set_rate_limiters(here_tracking_client* client,
+                                                    here_tracking_rate_limiter* limiter,
+                                                    here_tracking_rate_limiter* gateway_limiter);
+
+/**
+ * @brief Sets the timeouts of the client.
+ *
+ * The connect and I/O timeouts bound the individual network operations, the request timeout bounds
+ * each HTTP request to the HERE Tracking service from connecting to receiving the whole response.
+ * A request that doesn't complete in time fails with ::HERE_TRACKING_ERROR_TIMEOUT and its
+ * connection is closed. The defaults are #HERE_TRACKING_DEFAULT_CONNECT_TIMEOUT,
+ * #HERE_TRACKING_DEFAULT_IO_TIMEOUT and #HERE_TRACKING_DEFAULT_REQUEST_TIMEOUT.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] connect_timeout Time in milliseconds for the TCP connect and the TLS handshake.
+ *                            Set to 0 for no limit.
+ * @param[in] io_timeout Time in milliseconds a read or write may wait for progress.
+ *                       Set to 0 for no limit.
+ * @param[in] request_timeout Total time in milliseconds for a request. Set to 0 for no limit.
+ * @return ::HERE_TRACKING_OK Timeouts were successfully updated.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_set_timeouts(here_tracking_client* client,
+                                               uint32_t connect_timeout,
+                                               uint32_t io_timeout,
+                                               uint32_t request_timeout);
+
+/**
+ * @brief Sets the TLS environment used by the client.
+ *
+ * Clients that use the same TLS environment share the trusted CA certificates, the TLS
+ * configuration and the random number generator instead of setting them up for each client. The
+ * client holds a reference to the environment until here_tracking_free() is called or another
+ * environment is set, so the caller may release its own reference at any time.
+ *
+ * Setting the environment releases the TLS connection of the client, if any, and the new
+ * environment is used for the next connection.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] env The TLS environment created with here_tracking_tls_env_init(). Set to NULL to use
+ *                the default environment of the TLS implementation.
+ * @return ::HERE_TRACKING_OK The TLS environment was successfully set.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR An unknown error occurred.
+ */
+here_tracking_error here_tracking_set_tls_env(here_tracking_client* client,
+                                              here_tracking_tls_env env);
+
+/**
+ * @brief Gets the TLS session of the client for storing it across restarts.
+ *
+ * Store the session, for example to a file, before the client is released and restore it with
+ * here_tracking_set_tls_session() after a restart. The first connection can then resume the
+ * session instead of doing a full TLS handshake. The session contains secret key material and
+ * must be stored securely.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[out] session The buffer to write the serialized session to. May be NULL if
+ *                     @p session_size is 0 to query the size of the session.
+ * @param[in,out] session_size On input this parameter specifies the size of the buffer in bytes.
+ *                             On output it is set to the size of the serialized session, also
+ *                             when the buffer was too small.
+ * @return ::HERE_TRACKING_OK The session was successfully written to the buffer.
+ * @return ::HERE_TRACKING_ERROR_BUFFER_TOO_SMALL The session doesn't fit the buffer.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR The client hasn't negotiated a TLS session.
+ */
+here_tracking_error here_tracking_get_tls_session(here_tracking_client* client,
+                                                  uint8_t* session,
+                                                  uint32_t* session_size);
+
+/**
+ * @brief Restores a TLS session stored with here_tracking_get_tls_session().
+ *
+ * The session is offered to the server on the next connection. Setting a TLS environment with
+ * here_tracking_set_tls_env() discards the session, so set the environment first.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] session The serialized session.
+ * @param[in] session_size The size of the serialized session in bytes.
+ * @return ::HERE_TRACKING_OK The session was successfully restored.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR The session is invalid or the TLS handle couldn't be initialized.
+ */
+here_tracking_error here_tracking_set_tls_session(here_tracking_client* client,
+                                                  const uint8_t* session,
+                                                  uint32_t session_size);
+
 /**
  * @brief Requests an access token for your device from HERE Tracking.
  *
@@ -343,6 +830,30 @@ here_tracking_error here_tracking_set_recv_data_cb(here_tracking_client* client,
  */
 here_tracking_error here_tracking_auth(here_tracking_client* client);
 
+/**
+ * @brief Prepares the client for sending by a given time.
+ *
+ * Requests a new access token if the current one expires before @p ready_by and opens the
+ * persistent connection to HERE Tracking including the TLS handshake, so that a send at
+ * @p ready_by only has to write the request. Call it while the device is otherwise idle, for
+ * example right after the previous send, instead of paying the connection setup as send latency.
+ *
+ * The connection is reused if it is still open and usable when the data is sent. Call the function
+ * less than the idle timeout set with here_tracking_set_keep_alive() before @p ready_by, otherwise
+ * the connection is considered idle for too long and reopened on send. The server may also close
+ * an idle connection earlier, in which case the send connects again.
+ *
+ * @param[in] client Pointer to the initialized client structure with persistent connections
+ *                   enabled with here_tracking_set_keep_alive().
+ * @param[in] ready_by Unix time in seconds when the next send is expected. Set to 0 for now.
+ * @return ::HERE_TRACKING_OK The client is ready for sending.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR_TOO_MANY_REQUESTS The client is rate limited.
+ * @return ::HERE_TRACKING_ERROR_TIMEOUT Connecting didn't complete in time.
+ * @return ::HERE_TRACKING_ERROR Persistent connections are disabled or connecting failed.
+ */
+here_tracking_error here_tracking_prewarm(here_tracking_client* client, uint32_t ready_by);
+
 /**
  * @deprecated Will be removed in ::HERE_TRACKING_VERSION_MAJOR 2.
  *
@@ -395,6 +906,37 @@ here_tracking_error here_tracking_send_stream(here_tracking_client* client,
                                               here_tracking_resp_type resp_type,
                                               void* user_data);
 
+/**
+ * @brief Sends several requests to HERE Tracking back-to-back on one connection.
+ *
+ * All requests are written before waiting for the first response, so sending a backlog of data
+ * takes one round trip instead of one per request. The responses are passed to the receive
+ * callbacks of the requests in the order the requests were given.
+ *
+ * The server may close the connection after any response, in which case the requests after it
+ * were not processed and must be sent again. @p completed tells how many requests got a
+ * response, including responses with an error status. If a response indicates that the access
+ * token is no longer valid, a new one is requested with the next send.
+ *
+ * This method also requests a new access token if there isn't one available yet or if the current
+ * one has expired.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] reqs Requests to send.
+ * @param[in] req_count Number of requests in @p reqs.
+ * @param[out] completed Number of requests at the start of @p reqs whose response was received.
+ * @return ::HERE_TRACKING_OK The requests were sent and the responses read until the server
+ *         closed the connection or all responses were received.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR_TIME_MISMATCH The time on the device doesn't match the time on the
+ *         HERE Tracking server.
+ * @return ::HERE_TRACKING_ERROR An unknown error occurred.
+ */
+here_tracking_error here_tracking_send_stream_pipelined(here_tracking_client* client,
+                                                        const here_tracking_stream_req* reqs,
+                                                        uint8_t req_count,
+                                                        uint8_t* completed);
+
 #ifdef __cplusplus
 }
 #endif
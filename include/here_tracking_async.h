@@ -0,0 +1,184 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2019 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+/**
+ * @file here_tracking_async.h
+ *
+ * @brief Interface definition for non-blocking requests.
+ *
+ * @defgroup async_if Asynchronous interface
+ * @{
+ *
+ * @brief Interface definition for non-blocking requests.
+ *
+ * A non-blocking request is started with here_tracking_send_stream_async() and then advanced with
+ * here_tracking_async_step() whenever the socket returned by here_tracking_async_get_poll_info()
+ * is ready, so that requests of many clients can be driven from a single event loop. Each step
+ * does as much work as possible without blocking and returns ::HERE_TRACKING_ERROR_WOULD_BLOCK
+ * until the request is complete.
+ *
+ * Only one request per client can be in progress at a time. Host name resolution is still
+ * blocking.
+ */
+
+#ifndef HERE_TRACKING_ASYNC_H
+#define HERE_TRACKING_ASYNC_H
+
+#include <stdint.h>
+
+#include "here_tracking.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Size of the buffer used by an asynchronous request for the request headers and the
+ *        response. Must fit the request headers including the access token.
+ */
+#ifndef HERE_TRACKING_HTTP_ASYNC_BUFFER_SIZE
+#define HERE_TRACKING_HTTP_ASYNC_BUFFER_SIZE 2048
+#endif
+
+/**
+ * @brief Size of the state of a non-blocking request, the buffer and the connection and parser
+ *        state of the request.
+ */
+#define HERE_TRACKING_ASYNC_STATE_SIZE (HERE_TRACKING_HTTP_ASYNC_BUFFER_SIZE + 512)
+
+/**
+ * @brief State of a non-blocking request.
+ *
+ * The structure is allocated by the caller and must not be moved or released while the request
+ * is in progress. Its contents are private to the library.
+ */
+typedef struct
+{
+    /** @brief Private state of the request, aligned for any of its members. */
+    union
+    {
+        uint64_t align_u64;
+        void* align_ptr;
+        uint8_t data[HERE_TRACKING_ASYNC_STATE_SIZE];
+    } state;
+} here_tracking_async;
+
+/**
+ * @brief Starts sending data to HERE Tracking without blocking.
+ *
+ * This method also requests a new access token before sending the data if there isn't one
+ * available yet or if the current one is about to expire. No I/O is done before the first call to
+ * here_tracking_async_step(). The data returned from the send callback is written directly from
+ * the caller's buffer, so it must stay valid until the send callback is called again or the request
+ * is complete.
+ *
+ * @param[out] async Request state.
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] send_cb Callback function that will be called by the library to request data for
+ *                    sending.
+ * @param[in] recv_cb Callback function that will be called by the library when response data is
+ *                    received from HERE Tracking server.
+ * @param[in] req_type Format of data that will be sent to HERE Tracking server.
+ * @param[in] resp_type Response type to use.
+ * @param[in] user_data User data to pass back as an argument in send and recv callbacks.
+ * @return ::HERE_TRACKING_OK Request was started.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR_TOO_MANY_REQUESTS Request was rate limited by the server and the
+ *         retry time hasn't passed yet.
+ * @return ::HERE_TRACKING_ERROR An unknown error occurred.
+ */
+here_tracking_error here_tracking_send_stream_async(here_tracking_async* async,
+                                                    here_tracking_client* client,
+                                                    here_tracking_send_cb send_cb,
+                                                    here_tracking_recv_cb recv_cb,
+                                                    here_tracking_req_type req_type,
+                                                    here_tracking_resp_type resp_type,
+                                                    void* user_data);
+
+/**
+ * @brief Advances a non-blocking request as far as possible without blocking.
+ *
+ * @param[in] async Request state.
+ * @return ::HERE_TRACKING_ERROR_WOULD_BLOCK Request is waiting for the connection. Call again
+ *         when the socket returned by here_tracking_async_get_poll_info() is ready or when the
+ *         time returned by here_tracking_async_get_timeout() has passed.
+ * @return ::HERE_TRACKING_ERROR_TIMEOUT Request didn't complete within the timeouts set with
+ *         here_tracking_set_timeouts(). The connection has been closed.
+ * @return ::HERE_TRACKING_OK HERE Tracking client has successfully sent the data to HERE Tracking.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR_TIME_MISMATCH The time on the device doesn't match the time on the
+ *         HERE Tracking server.
+ * @return ::HERE_TRACKING_ERROR An unknown error occurred.
+ */
+here_tracking_error here_tracking_async_step(here_tracking_async* async);
+
+/**
+ * @brief Gets the socket and the events a non-blocking request is waiting for.
+ *
+ * @param[in] async Request state.
+ * @param[out] fd Socket file descriptor.
+ * @param[out] events Combination of #HERE_TRACKING_TLS_POLL_IN and #HERE_TRACKING_TLS_POLL_OUT.
+ * @return ::HERE_TRACKING_OK Poll information returned.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR Request isn't waiting for the connection.
+ */
+here_tracking_error here_tracking_async_get_poll_info(const here_tracking_async* async,
+                                                      int* fd,
+                                                      uint8_t* events);
+
+/**
+ * @brief Gets the time until the current wait of a non-blocking request times out.
+ *
+ * Use the value as the timeout when waiting for the socket returned by
+ * here_tracking_async_get_poll_info() and call here_tracking_async_step() when it expires so that
+ * the request can fail with ::HERE_TRACKING_ERROR_TIMEOUT.
+ *
+ * @param[in] async Request state.
+ * @param[out] timeout Time in milliseconds, 0 if the wait has already timed out and -1 if there is
+ *                     no limit.
+ * @return ::HERE_TRACKING_OK Timeout returned.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR Could not get the current time.
+ */
+here_tracking_error here_tracking_async_get_timeout(const here_tracking_async* async,
+                                                    int32_t* timeout);
+
+/**
+ * @brief Cancels a non-blocking request.
+ *
+ * The connection of the client is closed if the request was still in progress.
+ *
+ * @param[in] async Request state.
+ * @return ::HERE_TRACKING_OK Request was cancelled or already complete.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_async_cancel(here_tracking_async* async);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HERE_TRACKING_ASYNC_H */
+
+/** @} */
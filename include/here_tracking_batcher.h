@@ -0,0 +1,221 @@
+/**************************************************************************************************
+ * Copyright (C) 2017 HERE Europe B.V.                                                            *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+/**
+ * @file here_tracking_batcher.h
+ *
+ * @brief Batching of samples.
+ *
+ * @defgroup batcher Sample batcher
+ * @{
+ *
+ * @brief Collects single samples and sends them to HERE Tracking in one request.
+ *
+ * Each request has a fixed cost in headers, round trips and server side processing, so sending
+ * many samples in one request is much cheaper than sending them one by one. The batcher collects
+ * samples into a buffer given by the caller and sends the batch with here_tracking_send_stream()
+ * when it has #here_tracking_batcher::max_samples samples, when the next sample would make the
+ * request bigger than #here_tracking_batcher::max_bytes, or when the oldest sample has waited
+ * #here_tracking_batcher::max_linger_ms milliseconds. The last one is checked by
+ * here_tracking_batcher_poll(), which the application calls regularly.
+ *
+ * JSON samples are sent as a JSON array. Protobuf samples must each be a serialized request
+ * message with one sample. They are sent concatenated, which protobuf parses as one message
+ * with all the samples.
+ *
+ * The batcher is not thread-safe.
+ */
+
+#ifndef HERE_TRACKING_BATCHER_H
+#define HERE_TRACKING_BATCHER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "here_tracking.h"
+#include "here_tracking_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default time in milliseconds a sample waits for more samples before it is sent.
+ */
+#define HERE_TRACKING_BATCHER_DEFAULT_LINGER_MS 10000
+
+/**
+ * @brief Sample batcher state.
+ *
+ * The fields are read-only for the user. Use here_tracking_batcher_set_limits() to change the
+ * limits.
+ */
+typedef struct
+{
+    /** @brief Client used for sending. */
+    here_tracking_client* client;
+
+    /** @brief Buffer for the batch. */
+    uint8_t* buffer;
+
+    /** @brief Size of the batch buffer in bytes. */
+    uint32_t buffer_size;
+
+    /** @brief Number of bytes used in the batch buffer. */
+    uint32_t size;
+
+    /** @brief Number of samples in the batch. */
+    uint32_t count;
+
+    /** @brief Maximum number of samples in a batch, 0 for no limit. */
+    uint32_t max_samples;
+
+    /** @brief Maximum size of a request body in bytes. */
+    uint32_t max_bytes;
+
+    /** @brief Maximum time in milliseconds the oldest sample waits before the batch is sent. */
+    uint32_t max_linger_ms;
+
+    /** @brief Monotonic time in milliseconds when the oldest sample was added. */
+    uint32_t first_ms;
+
+    /** @brief Format of the samples. */
+    here_tracking_req_type req_type;
+
+    /** @brief Callback for the responses, NULL if not needed. */
+    here_tracking_recv_cb recv_cb;
+
+    /** @brief User data to pass back as an argument in recv_cb. */
+    void* user_data;
+} here_tracking_batcher;
+
+/**
+ * @brief Initializes a batcher.
+ *
+ * The limits are set to no limit for the number of samples, @p buffer_size bytes and
+ * #HERE_TRACKING_BATCHER_DEFAULT_LINGER_MS.
+ *
+ * @param[out] batcher Pointer to the batcher structure to initialize.
+ * @param[in] client Pointer to the initialized client structure used for sending.
+ * @param[in] req_type Format of the samples.
+ * @param[in] buffer Buffer for the batch. The memory is owned by the caller and must stay valid as
+ *                   long as the batcher is used.
+ * @param[in] buffer_size Size of @p buffer in bytes.
+ * @param[in] recv_cb Callback for the responses, NULL if not needed.
+ * @param[in] user_data User data to pass back as an argument in @p recv_cb.
+ * @return ::HERE_TRACKING_OK The batcher was successfully initialized.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_batcher_init(here_tracking_batcher* batcher,
+                                               here_tracking_client* client,
+                                               here_tracking_req_type req_type,
+                                               uint8_t* buffer,
+                                               uint32_t buffer_size,
+                                               here_tracking_recv_cb recv_cb,
+                                               void* user_data);
+
+/**
+ * @brief Sets the limits that trigger sending of a batch.
+ *
+ * @param[in] batcher Pointer to the initialized batcher.
+ * @param[in] max_samples Maximum number of samples in a batch, 0 for no limit.
+ * @param[in] max_bytes Maximum size of a request body in bytes, at most the size of the batch
+ *                      buffer. 0 to use the size of the batch buffer.
+ * @param[in] max_linger_ms Maximum time in milliseconds the oldest sample waits before the batch
+ *                          is sent.
+ * @return ::HERE_TRACKING_OK The limits were successfully set.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_batcher_set_limits(here_tracking_batcher* batcher,
+                                                     uint32_t max_samples,
+                                                     uint32_t max_bytes,
+                                                     uint32_t max_linger_ms);
+
+/**
+ * @brief Adds a sample to the batch.
+ *
+ * The sample is copied to the batch buffer. If the sample doesn't fit into the batch anymore, the
+ * batch is sent first. If the batch then has #here_tracking_batcher::max_samples samples, it is
+ * sent right away.
+ *
+ * @param[in] batcher Pointer to the initialized batcher.
+ * @param[in] sample The sample data, a JSON object or a serialized protobuf request message.
+ * @param[in] sample_size Size of @p sample in bytes.
+ * @return ::HERE_TRACKING_OK The sample was successfully added.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR_BUFFER_TOO_SMALL The sample doesn't fit even into an empty batch.
+ * @return Other error code from here_tracking_batcher_flush() if sending the batch failed. The
+ *         batch stays in the batcher. The sample was not added if the batch was sent to make room
+ *         for it, which the caller can tell from #here_tracking_batcher::count.
+ */
+here_tracking_error here_tracking_batcher_add(here_tracking_batcher* batcher,
+                                              const uint8_t* sample,
+                                              uint32_t sample_size);
+
+/**
+ * @brief Checks if a sample can be added without sending the batch first.
+ *
+ * @param[in] batcher Pointer to the initialized batcher.
+ * @param[in] sample_size Size of the sample in bytes.
+ * @return true if here_tracking_batcher_add() would add the sample without sending the batch.
+ */
+bool here_tracking_batcher_has_room(const here_tracking_batcher* batcher, uint32_t sample_size);
+
+/**
+ * @brief Sends the batch if the oldest sample has waited long enough.
+ *
+ * @param[in] batcher Pointer to the initialized batcher.
+ * @param[out] wait_ms Set to the time in milliseconds until the batch must be sent, UINT32_MAX if
+ *                     the batch is empty. NULL if not needed.
+ * @return ::HERE_TRACKING_OK The batch was sent or doesn't need to be sent yet.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return Other error code from here_tracking_batcher_flush() if sending the batch failed. The
+ *         batch stays in the batcher and is tried again after another
+ *         #here_tracking_batcher::max_linger_ms milliseconds.
+ */
+here_tracking_error here_tracking_batcher_poll(here_tracking_batcher* batcher, uint32_t* wait_ms);
+
+/**
+ * @brief Sends the batch now.
+ *
+ * The batch is emptied when HERE Tracking has accepted it. A batch that the server rejects with
+ * ::HERE_TRACKING_ERROR_BAD_REQUEST is dropped too, since sending it again would fail the same
+ * way.
+ *
+ * @param[in] batcher Pointer to the initialized batcher.
+ * @return ::HERE_TRACKING_OK The batch was sent or was empty.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR_BAD_REQUEST The server rejected the batch and it was dropped.
+ * @return Other error code of here_tracking_send_stream() or of the response if sending failed.
+ *         The batch stays in the batcher.
+ */
+here_tracking_error here_tracking_batcher_flush(here_tracking_batcher* batcher);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HERE_TRACKING_BATCHER_H */
+
+/** @} */
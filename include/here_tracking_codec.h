@@ -0,0 +1,166 @@
+/**************************************************************************************************
+ * Copyright (C) 2017 HERE Europe B.V.                                                            *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+/**
+ * @file here_tracking_codec.h
+ *
+ * @brief Interface for compressing and decompressing HTTP message bodies.
+ *
+ * @defgroup codec_if Codec interface
+ * @{
+ *
+ * @brief Interface for compressing HTTP message bodies.
+ *
+ * A codec is optional. When one is set with here_tracking_set_codec(), the request bodies are
+ * compressed on the fly as they are read from the send callback and sent with the
+ * Content-Encoding header of the codec. If the codec can also decode, the requests advertise the
+ * coding in the Accept-Encoding header and response bodies sent with it are decompressed before
+ * they are passed to the receive callback. The codec keeps its own compression state. Its memory
+ * use is decided by the implementation, e.g. by the window size of the compression algorithm.
+ */
+
+#ifndef HERE_TRACKING_CODEC_H
+#define HERE_TRACKING_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "here_tracking_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Starts compressing a new message body.
+ *
+ * Called before each request body. Any state left from the previous body must be reset.
+ *
+ * @param[in] codec_data Codec data from ::here_tracking_codec.
+ * @return ::HERE_TRACKING_OK Codec is ready to compress.
+ * @return Other error code if the codec could not be reset.
+ */
+typedef here_tracking_error (*here_tracking_codec_begin_cb)(void* codec_data);
+
+/**
+ * @brief Compresses a part of the message body.
+ *
+ * Each call must either consume input or produce output, unless the whole body has been
+ * compressed.
+ *
+ * @param[in] in The data to compress. NULL if @p finish is set.
+ * @param[in,out] in_size On input the size of @p in in bytes. Set to the number of bytes
+ *                        consumed.
+ * @param[out] out The buffer for compressed data.
+ * @param[in,out] out_size On input the size of @p out in bytes. Set to the number of bytes
+ *                         written.
+ * @param[in] finish Set when all the data has been passed in. The codec must write out all the
+ *                   data it holds.
+ * @param[out] end Set to true when @p finish is set and all compressed data has been written.
+ * @param[in] codec_data Codec data from ::here_tracking_codec.
+ * @return ::HERE_TRACKING_OK The data was successfully compressed.
+ * @return Other error code if compressing failed.
+ */
+typedef here_tracking_error (*here_tracking_codec_encode_cb)(const uint8_t* in,
+                                                             size_t* in_size,
+                                                             uint8_t* out,
+                                                             size_t* out_size,
+                                                             bool finish,
+                                                             bool* end,
+                                                             void* codec_data);
+
+/**
+ * @brief Starts decompressing a new message body.
+ *
+ * Called before each response body sent with the content coding of the codec. Any state left
+ * from the previous body must be reset.
+ *
+ * @param[in] codec_data Codec data from ::here_tracking_codec.
+ * @return ::HERE_TRACKING_OK Codec is ready to decompress.
+ * @return Other error code if the codec could not be reset.
+ */
+typedef here_tracking_error (*here_tracking_codec_decode_begin_cb)(void* codec_data);
+
+/**
+ * @brief Decompresses a part of the message body.
+ *
+ * Each call must either consume input or produce output, unless the whole body has been
+ * decompressed.
+ *
+ * @param[in] in The data to decompress. May be NULL if @p in_size is 0.
+ * @param[in,out] in_size On input the size of @p in in bytes. Set to the number of bytes
+ *                        consumed.
+ * @param[out] out The buffer for decompressed data.
+ * @param[in,out] out_size On input the size of @p out in bytes. Set to the number of bytes
+ *                         written.
+ * @param[in] finish Set when @p in contains the end of the body.
+ * @param[out] end Set to true when the end of the compressed data has been reached and all
+ *                 decompressed data has been written.
+ * @param[in] codec_data Codec data from ::here_tracking_codec.
+ * @return ::HERE_TRACKING_OK The data was successfully decompressed.
+ * @return Other error code if the data is not valid.
+ */
+typedef here_tracking_error (*here_tracking_codec_decode_cb)(const uint8_t* in,
+                                                             size_t* in_size,
+                                                             uint8_t* out,
+                                                             size_t* out_size,
+                                                             bool finish,
+                                                             bool* end,
+                                                             void* codec_data);
+
+/**
+ * @brief Codec for compressing and decompressing HTTP message bodies.
+ *
+ * The encoding and the decoding callbacks are both optional, but a codec must implement at least
+ * one of them.
+ */
+typedef struct
+{
+    /** @brief Value of the Content-Encoding header, e.g. "gzip". */
+    const char* content_encoding;
+
+    /** @brief Called before each request body. NULL if the codec can't compress. */
+    here_tracking_codec_begin_cb begin;
+
+    /** @brief Called to compress the request body. NULL if the codec can't compress. */
+    here_tracking_codec_encode_cb encode;
+
+    /** @brief Called before each response body. NULL if the codec can't decompress. */
+    here_tracking_codec_decode_begin_cb decode_begin;
+
+    /** @brief Called to decompress the response body. NULL if the codec can't decompress. */
+    here_tracking_codec_decode_cb decode;
+
+    /** @brief Data passed to the codec callbacks. */
+    void* codec_data;
+} here_tracking_codec;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HERE_TRACKING_CODEC_H */
+
+/** @} */
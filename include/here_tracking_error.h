@@ -76,7 +76,13 @@ typedef enum
     HERE_TRACKING_ERROR_NOT_FOUND         = -11,
 
     /** @brief Client has made too many requests and is being rate-limited */
-    HERE_TRACKING_ERROR_TOO_MANY_REQUESTS = -12
+    HERE_TRACKING_ERROR_TOO_MANY_REQUESTS = -12,
+
+    /** @brief Operation can't proceed without blocking, retry when the connection is ready */
+    HERE_TRACKING_ERROR_WOULD_BLOCK       = -13,
+
+    /** @brief Operation didn't complete within the configured timeout */
+    HERE_TRACKING_ERROR_TIMEOUT           = -14
 } here_tracking_error;
 
 #ifdef __cplusplus
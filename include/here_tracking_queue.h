@@ -0,0 +1,229 @@
+/**************************************************************************************************
+ * Copyright (C) 2017 HERE Europe B.V.                                                            *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+/**
+ * @file here_tracking_queue.h
+ *
+ * @brief Persistent store-and-forward queue for samples.
+ *
+ * @defgroup queue Sample queue
+ * @{
+ *
+ * @brief Queue that keeps samples until HERE Tracking has accepted them.
+ *
+ * Samples that can't be sent right away, because the device is offline or the client is rate
+ * limited, are pushed to the queue and later sent in batches with here_tracking_queue_send(), one
+ * request per batch instead of one per sample.
+ *
+ * The queue is an append-only log in memory given by the caller. When the memory is a shared
+ * memory mapping of a file, the queue survives restarts of the application. Each sample is
+ * stored with a sequence number and a CRC that also covers the sample before it, so a sample that
+ * was only partly written when the device lost power is detected and dropped when the queue is
+ * opened again, together with the samples after it. The position of the oldest sample is kept in
+ * two alternating header slots, so a crash while removing samples at worst sends some of them
+ * again.
+ *
+ * The queue is not thread-safe.
+ */
+
+#ifndef HERE_TRACKING_QUEUE_H
+#define HERE_TRACKING_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "here_tracking.h"
+#include "here_tracking_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Size of the header at the start of the queue memory in bytes.
+ */
+#define HERE_TRACKING_QUEUE_HDR_SIZE 64
+
+/**
+ * @brief Size of the record header stored before each sample in bytes.
+ */
+#define HERE_TRACKING_QUEUE_RECORD_HDR_SIZE 12
+
+/**
+ * @brief Minimum size of the queue memory in bytes.
+ */
+#define HERE_TRACKING_QUEUE_MIN_SIZE 256
+
+/**
+ * @brief Sample queue state.
+ *
+ * The fields are read-only for the user.
+ */
+typedef struct
+{
+    /** @brief Memory holding the queue. */
+    uint8_t* storage;
+
+    /** @brief Size of the queue memory in bytes. */
+    uint32_t storage_size;
+
+    /** @brief Number of samples in the queue. */
+    uint32_t count;
+
+    /** @brief Offset of the oldest sample. */
+    uint32_t head;
+
+    /** @brief Sequence number of the oldest sample. */
+    uint32_t head_seq;
+
+    /** @brief CRC of the sample before the oldest one. */
+    uint32_t head_crc;
+
+    /** @brief Offset where the next sample is written. */
+    uint32_t tail;
+
+    /** @brief CRC of the newest sample. */
+    uint32_t tail_crc;
+
+    /** @brief Generation of the last header slot written. */
+    uint32_t generation;
+} here_tracking_queue;
+
+/**
+ * @brief Position of a sample in the queue, used for reading the samples without removing them.
+ */
+typedef struct
+{
+    /** @brief Offset of the next sample. */
+    uint32_t offset;
+
+    /** @brief Number of samples left. */
+    uint32_t remaining;
+} here_tracking_queue_iter;
+
+/**
+ * @brief Opens a queue.
+ *
+ * If the memory contains a queue of the same size, the samples in it are recovered up to the
+ * first one that is not intact. Otherwise the memory is formatted as an empty queue.
+ *
+ * @param[out] queue Pointer to the queue structure to initialize.
+ * @param[in] storage Memory for the queue, aligned to 4 bytes. The memory is owned by the caller
+ *                    and must stay valid as long as the queue is used.
+ * @param[in] storage_size Size of @p storage in bytes. At least #HERE_TRACKING_QUEUE_MIN_SIZE.
+ * @return ::HERE_TRACKING_OK The queue was successfully opened.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_queue_open(here_tracking_queue* queue,
+                                             uint8_t* storage,
+                                             uint32_t storage_size);
+
+/**
+ * @brief Adds a sample to the end of the queue.
+ *
+ * The sample is copied to the queue. Samples sent with here_tracking_queue_send() must be JSON
+ * objects in the format of a single element of the samples array of HERE Tracking.
+ *
+ * @param[in] queue Pointer to the opened queue.
+ * @param[in] sample The sample data.
+ * @param[in] sample_size Size of @p sample in bytes.
+ * @return ::HERE_TRACKING_OK The sample was successfully added.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR_BUFFER_TOO_SMALL The queue is full. Remove or send samples first.
+ */
+here_tracking_error here_tracking_queue_push(here_tracking_queue* queue,
+                                             const uint8_t* sample,
+                                             uint32_t sample_size);
+
+/**
+ * @brief Removes samples from the start of the queue.
+ *
+ * @param[in] queue Pointer to the opened queue.
+ * @param[in] count Number of samples to remove. At most the number of samples in the queue.
+ * @return ::HERE_TRACKING_OK The samples were successfully removed.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_queue_pop(here_tracking_queue* queue, uint32_t count);
+
+/**
+ * @brief Starts reading the samples from the oldest one.
+ *
+ * @param[in] queue Pointer to the opened queue.
+ * @param[out] iter Position to initialize.
+ */
+void here_tracking_queue_iter_init(const here_tracking_queue* queue,
+                                   here_tracking_queue_iter* iter);
+
+/**
+ * @brief Reads the next sample.
+ *
+ * The sample stays valid until it is removed from the queue.
+ *
+ * @param[in] queue Pointer to the opened queue.
+ * @param[in,out] iter Position of the sample, moved to the next sample.
+ * @param[out] sample Set to point to the sample data in the queue memory.
+ * @param[out] sample_size Set to the size of the sample in bytes.
+ * @return true if a sample was read, false if there are no more samples.
+ */
+bool here_tracking_queue_iter_next(const here_tracking_queue* queue,
+                                   here_tracking_queue_iter* iter,
+                                   const uint8_t** sample,
+                                   uint32_t* sample_size);
+
+/**
+ * @brief Sends the samples in the queue to HERE Tracking.
+ *
+ * The samples are sent in batches of at most @p max_batch samples with
+ * here_tracking_send_stream(), until the queue is empty or a batch fails. A batch is removed from
+ * the queue when HERE Tracking has accepted it. A batch that the server rejects with
+ * ::HERE_TRACKING_ERROR_BAD_REQUEST is removed too, since sending it again would fail the same
+ * way, and sending continues with the next batch.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] queue Pointer to the opened queue.
+ * @param[in] max_batch Maximum number of samples in one request, 0 for no limit.
+ * @param[in] recv_cb Callback for the responses, NULL if not needed.
+ * @param[in] user_data User data to pass back as an argument in @p recv_cb.
+ * @param[out] sent Number of samples removed from the queue.
+ * @return ::HERE_TRACKING_OK All samples were sent.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR_TOO_MANY_REQUESTS The client is rate limited, the remaining
+ *         samples stay in the queue.
+ * @return Other error code of here_tracking_send_stream() or of the response if a batch failed.
+ *         The batch and the samples after it stay in the queue.
+ */
+here_tracking_error here_tracking_queue_send(here_tracking_client* client,
+                                             here_tracking_queue* queue,
+                                             uint32_t max_batch,
+                                             here_tracking_recv_cb recv_cb,
+                                             void* user_data,
+                                             uint32_t* sent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HERE_TRACKING_QUEUE_H */
+
+/** @} */
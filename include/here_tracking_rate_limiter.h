@@ -0,0 +1,170 @@
+/**************************************************************************************************
+ * Copyright (C) 2017 HERE Europe B.V.                                                            *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+/**
+ * @file here_tracking_rate_limiter.h
+ *
+ * @brief Client-side rate limiting of requests.
+ *
+ * @defgroup rate_limiter Rate limiter
+ * @{
+ *
+ * @brief Token bucket that keeps the client below the rate limit of the server.
+ *
+ * The server answers requests over its rate limit with HTTP status 429, but only after the
+ * connection and the TLS handshake have been paid for. A rate limiter set with
+ * here_tracking_set_rate_limiters() rejects such requests before connecting with
+ * ::HERE_TRACKING_ERROR_TOO_MANY_REQUESTS.
+ *
+ * The bucket holds up to #here_tracking_rate_limiter::burst tokens and gets one token back every
+ * #here_tracking_rate_limiter::interval_ms. Each request takes one token. When the server still
+ * answers with status 429, the interval is doubled, up to #HERE_TRACKING_RATE_LIMITER_MAX_BACKOFF
+ * times the configured interval, and a Retry-After time pauses the bucket until then. Each
+ * accepted request moves the interval back towards the configured one.
+ *
+ * A client can have its own limiter and share a second one with the other clients of a gateway.
+ * The library is not thread-safe, so clients sharing a limiter must be used from one thread.
+ */
+
+#ifndef HERE_TRACKING_RATE_LIMITER_H
+#define HERE_TRACKING_RATE_LIMITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "here_tracking_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief How many times the interval may grow after rate limited requests.
+ */
+#define HERE_TRACKING_RATE_LIMITER_MAX_BACKOFF 64
+
+/**
+ * @brief Rate limiter state.
+ *
+ * The fields are read-only for the user.
+ */
+typedef struct
+{
+    /** @brief Configured time in milliseconds to get one token back. */
+    uint32_t base_interval_ms;
+
+    /** @brief Current time in milliseconds to get one token back, adapted to the server. */
+    uint32_t interval_ms;
+
+    /** @brief Maximum number of tokens. */
+    uint32_t burst;
+
+    /** @brief Number of tokens left. */
+    uint32_t tokens;
+
+    /** @brief Monotonic time in milliseconds when the tokens were last refilled. */
+    uint32_t refill_ms;
+
+    /** @brief Monotonic time in milliseconds until which the bucket is paused. */
+    uint32_t pause_ms;
+
+    /** @brief Is the bucket paused until pause_ms. */
+    bool paused;
+} here_tracking_rate_limiter;
+
+/**
+ * @brief Initializes a rate limiter with a full bucket.
+ *
+ * @param[out] limiter Pointer to the rate limiter structure to initialize.
+ * @param[in] interval_ms Time in milliseconds to get one token back, e.g. 60000 for one request
+ *                        per minute.
+ * @param[in] burst Maximum number of tokens, i.e. requests that can be sent in a row.
+ * @return ::HERE_TRACKING_OK The rate limiter was successfully initialized.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR Could not get the current time.
+ */
+here_tracking_error here_tracking_rate_limiter_init(here_tracking_rate_limiter* limiter,
+                                                    uint32_t interval_ms,
+                                                    uint32_t burst);
+
+/**
+ * @brief Checks if there are tokens for the given number of requests.
+ *
+ * @param[in] limiter Pointer to the initialized rate limiter.
+ * @param[in] requests Number of requests, at most #here_tracking_rate_limiter::burst are required.
+ *                     0 to only check if the bucket is paused.
+ * @param[out] wait_ms Set to the time in milliseconds until there are tokens, 0 if there are
+ *                     tokens now. NULL if not needed.
+ * @return ::HERE_TRACKING_OK There are enough tokens.
+ * @return ::HERE_TRACKING_ERROR_TOO_MANY_REQUESTS Not enough tokens.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR Could not get the current time.
+ */
+here_tracking_error here_tracking_rate_limiter_check(here_tracking_rate_limiter* limiter,
+                                                     uint32_t requests,
+                                                     uint32_t* wait_ms);
+
+/**
+ * @brief Takes the tokens for the given number of requests.
+ *
+ * Must follow a successful here_tracking_rate_limiter_check() with the same number of requests.
+ *
+ * @param[in] limiter Pointer to the initialized rate limiter.
+ * @param[in] requests Number of requests.
+ */
+void here_tracking_rate_limiter_take(here_tracking_rate_limiter* limiter, uint32_t requests);
+
+/**
+ * @brief Adapts the rate to the response of the server.
+ *
+ * @param[in] limiter Pointer to the initialized rate limiter.
+ * @param[in] result Error of the response.
+ * @return ::HERE_TRACKING_OK The rate was successfully updated.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR Could not get the current time.
+ */
+here_tracking_error here_tracking_rate_limiter_update(here_tracking_rate_limiter* limiter,
+                                                      here_tracking_error result);
+
+/**
+ * @brief Pauses the bucket for the time given by the server.
+ *
+ * The bucket is empty after the pause.
+ *
+ * @param[in] limiter Pointer to the initialized rate limiter.
+ * @param[in] retry_after Time in seconds from the Retry-After header.
+ * @return ::HERE_TRACKING_OK The bucket was successfully paused.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR Could not get the current time.
+ */
+here_tracking_error here_tracking_rate_limiter_pause(here_tracking_rate_limiter* limiter,
+                                                     uint32_t retry_after);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HERE_TRACKING_RATE_LIMITER_H */
+
+/** @} */
@@ -0,0 +1,169 @@
+/**************************************************************************************************
+ * Copyright (C) 2017 HERE Europe B.V.                                                            *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+/**
+ * @file here_tracking_scheduler.h
+ *
+ * @brief Scheduling of requests after failures and rate limiting.
+ *
+ * @defgroup scheduler Request scheduler
+ * @{
+ *
+ * @brief Decides when a client may send its next request.
+ *
+ * Requests that are sure to be rejected only add load to the server and to the network. Before
+ * each request the application asks here_tracking_scheduler_ready() whether the client may send,
+ * and after it reports the result with here_tracking_scheduler_update().
+ *
+ * - After ::HERE_TRACKING_ERROR_TOO_MANY_REQUESTS the next request is sent at the time given by
+ *   the server in the Retry-After header, never earlier. Clients that were rate limited together
+ *   would all retry at the same second, so a random delay of up to
+ *   #here_tracking_scheduler::spread_ms is added.
+ * - After network errors, timeouts and server errors the delay grows exponentially from
+ *   #here_tracking_scheduler::base_delay_ms up to #here_tracking_scheduler::max_delay_ms, and
+ *   the actual delay is a random time between zero and that value ("full jitter"). Clients that
+ *   lost the connection at the same time then don't reconnect at the same time.
+ * - Any other result lets the next request be sent right away.
+ *
+ * The random delays are seeded from the device id, so that devices sharing a gateway get
+ * different delays.
+ */
+
+#ifndef HERE_TRACKING_SCHEDULER_H
+#define HERE_TRACKING_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "here_tracking.h"
+#include "here_tracking_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default delay in milliseconds after the first failure.
+ */
+#define HERE_TRACKING_SCHEDULER_DEFAULT_BASE_DELAY_MS 1000
+
+/**
+ * @brief Default maximum delay in milliseconds after repeated failures.
+ */
+#define HERE_TRACKING_SCHEDULER_DEFAULT_MAX_DELAY_MS 300000
+
+/**
+ * @brief Default time in milliseconds over which retries after Retry-After are spread.
+ */
+#define HERE_TRACKING_SCHEDULER_DEFAULT_SPREAD_MS 5000
+
+/**
+ * @brief Request scheduler state.
+ *
+ * The fields are read-only for the user.
+ */
+typedef struct
+{
+    /** @brief Client whose requests are scheduled. */
+    here_tracking_client* client;
+
+    /** @brief Delay in milliseconds after the first failure. */
+    uint32_t base_delay_ms;
+
+    /** @brief Maximum delay in milliseconds after repeated failures. */
+    uint32_t max_delay_ms;
+
+    /** @brief Maximum random delay in milliseconds added to the time given in Retry-After. */
+    uint32_t spread_ms;
+
+    /** @brief Number of failures in a row. */
+    uint32_t failures;
+
+    /** @brief Monotonic time in milliseconds when the next request may be sent. */
+    uint32_t next_ms;
+
+    /** @brief Is the client waiting for next_ms. */
+    bool waiting;
+
+    /** @brief State of the random number generator. */
+    uint32_t rand_state;
+} here_tracking_scheduler;
+
+/**
+ * @brief Initializes a scheduler.
+ *
+ * @param[out] scheduler Pointer to the scheduler structure to initialize.
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] base_delay_ms Delay in milliseconds after the first failure, 0 for
+ *                          #HERE_TRACKING_SCHEDULER_DEFAULT_BASE_DELAY_MS.
+ * @param[in] max_delay_ms Maximum delay in milliseconds after repeated failures, 0 for
+ *                         #HERE_TRACKING_SCHEDULER_DEFAULT_MAX_DELAY_MS.
+ * @param[in] spread_ms Maximum random delay in milliseconds added to the time given in
+ *                      Retry-After, 0 to send exactly at that time.
+ * @return ::HERE_TRACKING_OK The scheduler was successfully initialized.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_scheduler_init(here_tracking_scheduler* scheduler,
+                                                 here_tracking_client* client,
+                                                 uint32_t base_delay_ms,
+                                                 uint32_t max_delay_ms,
+                                                 uint32_t spread_ms);
+
+/**
+ * @brief Checks if the client may send a request now.
+ *
+ * Besides the results reported with here_tracking_scheduler_update(), the client must also wait
+ * for tokens of the rate limiters set with here_tracking_set_rate_limiters().
+ *
+ * @param[in] scheduler Pointer to the initialized scheduler.
+ * @param[out] wait_ms Set to the time in milliseconds until the client may send, 0 if it may send
+ *                     now. NULL if not needed.
+ * @return ::HERE_TRACKING_OK The client may send a request.
+ * @return ::HERE_TRACKING_ERROR_WOULD_BLOCK The client must wait @p wait_ms milliseconds.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR Could not get the current time.
+ */
+here_tracking_error here_tracking_scheduler_ready(here_tracking_scheduler* scheduler,
+                                                  uint32_t* wait_ms);
+
+/**
+ * @brief Reports the result of a request.
+ *
+ * @param[in] scheduler Pointer to the initialized scheduler.
+ * @param[in] result Return value of the request function, or the error of the response if the
+ *                   request function succeeded.
+ * @return ::HERE_TRACKING_OK The result was successfully reported.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR Could not get the current time.
+ */
+here_tracking_error here_tracking_scheduler_update(here_tracking_scheduler* scheduler,
+                                                   here_tracking_error result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HERE_TRACKING_SCHEDULER_H */
+
+/** @} */
@@ -56,6 +56,18 @@ extern "C" {
  */
 here_tracking_error here_tracking_get_unixtime(uint32_t* ts);
 
+/**
+ * @brief Gets the current time of a monotonic clock in milliseconds.
+ *
+ * The clock must not jump when the wall clock time is changed. The starting point is arbitrary and
+ * the value is allowed to wrap around.
+ *
+ * @param[out] ms The current monotonic time in milliseconds.
+ * @return ::HERE_TRACKING_OK The monotonic time was successfully received.
+ * @return ::HERE_TRACKING_ERROR Could not get the monotonic time.
+ */
+here_tracking_error here_tracking_get_monotonic_ms(uint32_t* ms);
+
 #ifdef __cplusplus
 }
 #endif
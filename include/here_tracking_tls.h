@@ -49,14 +49,105 @@ extern "C" {
 
 typedef void* here_tracking_tls; /**< @brief TLS handle */
 
+typedef void* here_tracking_tls_env; /**< @brief TLS environment handle */
+
+/** @brief The connection is waiting for incoming data. See here_tracking_tls_get_poll_info(). */
+#define HERE_TRACKING_TLS_POLL_IN  0x01
+
+/** @brief The connection is waiting to send data. See here_tracking_tls_get_poll_info(). */
+#define HERE_TRACKING_TLS_POLL_OUT 0x02
+
+/**
+ * @brief The default time in seconds resolved host addresses are cached. See
+ *        here_tracking_tls_env_set_dns_cache_ttl().
+ */
+#define HERE_TRACKING_TLS_DNS_CACHE_DEFAULT_TTL 60
+
+/**
+ * @brief Creates a TLS environment.
+ *
+ * The TLS environment holds the state that doesn't change between connections, such as the
+ * trusted CA certificates, the TLS configuration and the random number generator. It can be shared
+ * by any number of TLS handles and HERE Tracking clients, also from different threads, so the setup
+ * is done only once per process instead of once per client or connection.
+ *
+ * The environment is reference counted. The created environment has one reference which is
+ * released with here_tracking_tls_env_free().
+ *
+ * @param[out] env Pointer to the uninitialized TLS environment handle.
+ * @return ::HERE_TRACKING_OK The TLS environment was successfully created.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR An unknown error occurred.
+ */
+here_tracking_error here_tracking_tls_env_init(here_tracking_tls_env* env);
+
+/**
+ * @brief Adds a reference to a TLS environment.
+ *
+ * @param[in] env The initialized TLS environment handle.
+ * @return ::HERE_TRACKING_OK The reference was successfully added.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_tls_env_ref(here_tracking_tls_env env);
+
+/**
+ * @brief Releases a reference to a TLS environment.
+ *
+ * The resources of the environment are released when the last reference is released.
+ *
+ * @param[in,out] env Pointer to the initialized TLS environment handle. Set to NULL on return.
+ * @return ::HERE_TRACKING_OK The reference was successfully released.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_tls_env_free(here_tracking_tls_env* env);
+
+/**
+ * @brief Sets how long the TLS environment caches resolved host addresses.
+ *
+ * Host names are resolved on connect. The resolved addresses are shared by all TLS handles using
+ * the environment so that a new connection to the same host doesn't wait for the resolver again
+ * until the cached addresses expire. The cached addresses of a host are dropped when connecting to
+ * them fails, so the next connect resolves the host again. The default is
+ * #HERE_TRACKING_TLS_DNS_CACHE_DEFAULT_TTL.
+ *
+ * @param[in] env The initialized TLS environment handle.
+ * @param[in] ttl Time in seconds the resolved addresses are reused. Set to 0 to disable caching.
+ *                Implementations may limit the time, the mbedtls and OpenSSL implementations to
+ *                one day.
+ * @return ::HERE_TRACKING_OK The cache time was successfully set.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_tls_env_set_dns_cache_ttl(here_tracking_tls_env env,
+                                                            uint32_t ttl);
+
+/**
+ * @brief Adds trusted CA certificates to the TLS environment.
+ *
+ * Server certificates are verified against the root certificate of the HERE Tracking service and
+ * the certificates added with this function. Add the certificates before the environment is used
+ * for connecting.
+ *
+ * @param[in] env The initialized TLS environment handle.
+ * @param[in] pem One or more certificates in PEM format as a NULL terminated string.
+ * @return ::HERE_TRACKING_OK The certificates were successfully added.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR No valid certificate was found.
+ */
+here_tracking_error here_tracking_tls_env_add_ca_cert(here_tracking_tls_env env, const char* pem);
+
 /**
  * @brief Initializes the TLS implementation.
  *
+ * The TLS handle holds a reference to the TLS environment until it is released with
+ * here_tracking_tls_free().
+ *
  * @param[in] tls Pointer to the uninitialized TLS handle.
+ * @param[in] env The TLS environment to use. If NULL the TLS implementation uses its own default
+ *                environment which is shared by all TLS handles initialized without one.
  * @return ::HERE_TRACKING_OK The TLS implementation was successfully initialized.
  * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
  */
-here_tracking_error here_tracking_tls_init(here_tracking_tls* tls);
+here_tracking_error here_tracking_tls_init(here_tracking_tls* tls, here_tracking_tls_env env);
 
 /**
  * @brief Releases resources that were allocated the TLS implementation.
@@ -74,6 +165,8 @@ here_tracking_error here_tracking_tls_free(here_tracking_tls* tls);
  * @param[in] host The address of the host to connect to. You must terminate the string with `\0`.
  * @param[in] port The port number to connect to.
  * @return ::HERE_TRACKING_OK A TLS connection was successfully established.
+ * @return ::HERE_TRACKING_ERROR_TIMEOUT The deadline set with here_tracking_tls_set_deadline()
+ *                                       passed before the connection was established.
  * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
  * @return ::HERE_TRACKING_ERROR An unknown error occurred.
  */
@@ -81,6 +174,47 @@ here_tracking_error here_tracking_tls_connect(here_tracking_tls tls,
                                               const char* host,
                                               uint16_t port);
 
+/**
+ * @brief Establishes a non-blocking TLS connection.
+ *
+ * Starts establishing the connection on the first call and continues it on subsequent calls. The
+ * function must not block on network I/O. When it returns ::HERE_TRACKING_ERROR_WOULD_BLOCK the
+ * caller waits for the events returned by here_tracking_tls_get_poll_info() and calls it again with
+ * the same parameters.
+ *
+ * On a connection established with this function here_tracking_tls_read() and
+ * here_tracking_tls_write() return ::HERE_TRACKING_ERROR_WOULD_BLOCK instead of blocking.
+ *
+ * @param[in] tls The initialized TLS handle.
+ * @param[in] host The address of the host to connect to. You must terminate the string with `\0`.
+ * @param[in] port The port number to connect to.
+ * @return ::HERE_TRACKING_OK A TLS connection was successfully established.
+ * @return ::HERE_TRACKING_ERROR_WOULD_BLOCK The connection is not established yet.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR An unknown error occurred.
+ */
+here_tracking_error here_tracking_tls_connect_async(here_tracking_tls tls,
+                                                    const char* host,
+                                                    uint16_t port);
+
+/**
+ * @brief Gets the socket and the events a non-blocking TLS connection is waiting for.
+ *
+ * The events are valid after here_tracking_tls_connect_async(), here_tracking_tls_read() or
+ * here_tracking_tls_write() has returned ::HERE_TRACKING_ERROR_WOULD_BLOCK. Note that a TLS
+ * connection may need to send data in order to receive data and vice versa.
+ *
+ * @param[in] tls The initialized TLS handle.
+ * @param[out] fd The socket file descriptor of the connection.
+ * @param[out] events Bitmask of ::HERE_TRACKING_TLS_POLL_IN and ::HERE_TRACKING_TLS_POLL_OUT.
+ * @return ::HERE_TRACKING_OK The socket and events were successfully returned.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR The TLS handle is not connected.
+ */
+here_tracking_error here_tracking_tls_get_poll_info(here_tracking_tls tls,
+                                                    int* fd,
+                                                    uint8_t* events);
+
 /**
  * @brief Closes the TLS connection.
  *
@@ -91,14 +225,119 @@ here_tracking_error here_tracking_tls_connect(here_tracking_tls tls,
  */
 here_tracking_error here_tracking_tls_close(here_tracking_tls tls);
 
+/**
+ * @brief Checks whether an idle TLS connection can still be used.
+ *
+ * Called before an open connection is reused for a new request. The connection is idle between
+ * requests, so any pending incoming data or a closed socket means that the peer has closed the
+ * connection and it must not be reused. The check must not block.
+ *
+ * @param[in] tls The initialized TLS handle.
+ * @return ::HERE_TRACKING_OK The connection is open and can be reused.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR The connection has been closed or is otherwise unusable.
+ */
+here_tracking_error here_tracking_tls_check_connection(here_tracking_tls tls);
+
+/**
+ * @brief Sets the deadline for the blocking operations of a TLS connection.
+ *
+ * here_tracking_tls_connect(), here_tracking_tls_read() and here_tracking_tls_write() on a
+ * blocking connection return ::HERE_TRACKING_ERROR_TIMEOUT if they can't complete before the
+ * deadline. The deadline applies to all subsequent operations until it is changed. The
+ * implementation should wait for socket readiness instead of busy looping.
+ *
+ * @param[in] tls The initialized TLS handle.
+ * @param[in] deadline Absolute time in milliseconds as returned by
+ *                     here_tracking_get_monotonic_ms(). Set to 0 to wait without limit.
+ * @return ::HERE_TRACKING_OK The deadline was successfully set.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_tls_set_deadline(here_tracking_tls tls, uint32_t deadline);
+
+/**
+ * @brief Gets the TLS session of the handle in serialized form.
+ *
+ * The session is the one negotiated on the last successful connection, or the one restored with
+ * here_tracking_tls_set_session(). The caller can store it, for example to a file, and restore it
+ * after a restart so that the first connection resumes the session instead of doing a full
+ * handshake. The serialized session contains secret key material and must be stored securely.
+ *
+ * @param[in] tls The initialized TLS handle.
+ * @param[out] session The buffer to write the serialized session to. May be NULL if
+ *                     @p session_size is 0 to query the size of the session.
+ * @param[in,out] session_size On input this parameter specifies the size of the buffer in bytes.
+ *                             On output it is set to the size of the serialized session, also
+ *                             when the buffer was too small.
+ * @return ::HERE_TRACKING_OK The session was successfully written to the buffer.
+ * @return ::HERE_TRACKING_ERROR_BUFFER_TOO_SMALL The session doesn't fit the buffer.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR The handle has no session.
+ */
+here_tracking_error here_tracking_tls_get_session(here_tracking_tls tls,
+                                                  uint8_t* session,
+                                                  uint32_t* session_size);
+
+/**
+ * @brief Restores a TLS session serialized with here_tracking_tls_get_session().
+ *
+ * The next connection offers the session to the server which may resume it. The session is only
+ * resumed with the host it was negotiated with.
+ *
+ * @param[in] tls The initialized TLS handle.
+ * @param[in] session The serialized session.
+ * @param[in] session_size The size of the serialized session in bytes.
+ * @return ::HERE_TRACKING_OK The session was successfully restored.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ * @return ::HERE_TRACKING_ERROR The session is invalid or was serialized by an incompatible
+ *                               implementation.
+ */
+here_tracking_error here_tracking_tls_set_session(here_tracking_tls tls,
+                                                  const uint8_t* session,
+                                                  uint32_t session_size);
+
+/**
+ * @brief Sets the application protocols offered with ALPN on the following connections.
+ *
+ * The protocols are offered in the TLS handshake in the given order and the server selects one of
+ * them or none. An implementation without ALPN support may ignore the protocols, in which case no
+ * protocol is ever selected.
+ *
+ * @param[in] tls The initialized TLS handle.
+ * @param[in] protocols NULL-terminated list of protocol names, e.g. "h2" and "http/1.1". NULL to
+ *                      offer no protocols. The list is owned by the caller and must stay valid
+ *                      until it is replaced.
+ * @return ::HERE_TRACKING_OK The protocols were successfully set.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_tls_set_alpn(here_tracking_tls tls, const char** protocols);
+
+/**
+ * @brief Gets the application protocol selected by the server on the current connection.
+ *
+ * @param[in] tls The initialized TLS handle.
+ * @param[out] protocol The entry of the list set with here_tracking_tls_set_alpn() that the server
+ *                      selected. NULL if the server didn't select any protocol.
+ * @return ::HERE_TRACKING_OK The protocol was successfully returned.
+ * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
+ */
+here_tracking_error here_tracking_tls_get_alpn(here_tracking_tls tls, const char** protocol);
+
 /**
  * @brief Reads data from a connected TLS socket.
  *
+ * The function returns as soon as some data has been read, it must not wait for the buffer to fill
+ * up. The connection may be kept open after the response has been received so the end of the
+ * response is not necessarily signalled by the peer closing the connection.
+ *
  * @param[in] tls The initialized TLS handle.
  * @param[out] data The buffer to read the incoming data to.
  * @param[in,out] data_size On input this parameter specifies the maximum number of bytes to read.
- *                          On output it is set to the actual number of bytes read.
+ *                          On output it is set to the actual number of bytes read. Set to 0 if the
+ *                          peer has closed the connection.
  * @return ::HERE_TRACKING_OK The data was successfully received from the TLS socket.
+ * @return ::HERE_TRACKING_ERROR_WOULD_BLOCK No data is available on a non-blocking connection.
+ * @return ::HERE_TRACKING_ERROR_TIMEOUT No data was received before the deadline.
  * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
  * @return ::HERE_TRACKING_ERROR An unknown error occurred.
  */
@@ -112,8 +351,12 @@ here_tracking_error here_tracking_tls_read(here_tracking_tls tls,
  * @param[in] tls The initialized TLS handle.
  * @param[in] data The buffer to write the outgoing data from.
  * @param[in,out] data_size On input this parameter specifies maximum number of bytes to write.
- *                          On output it is set to the actual number of bytes written.
+ *                          On output it is set to the actual number of bytes written. On a
+ *                          non-blocking connection this may be less than requested.
  * @return ::HERE_TRACKING_OK The data was successfully written to the TLS socket.
+ * @return ::HERE_TRACKING_ERROR_WOULD_BLOCK No data can be written on a non-blocking connection
+ *                                           right now. The same data must be written again.
+ * @return ::HERE_TRACKING_ERROR_TIMEOUT No data could be written before the deadline.
  * @return ::HERE_TRACKING_ERROR_INVALID_INPUT One or more input parameters were invalid.
  * @return ::HERE_TRACKING_ERROR An unknown error occurred.
  */
@@ -25,7 +25,11 @@
 #ifndef HERE_TRACKING_HTTP_H
 #define HERE_TRACKING_HTTP_H
 
+#include <stdbool.h>
+
 #include "here_tracking.h"
+#include "here_tracking_async.h"
+#include "here_tracking_http_parser.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -64,8 +68,142 @@ typedef struct
     uint8_t header_count;
 } here_tracking_http_request;
 
+#define HERE_TRACKING_HTTP_ASYNC_CHUNK_HDR_SIZE 16
+
+#define HERE_TRACKING_HTTP_AUTH_SEARCH_KEY_COUNT 2
+
+typedef struct
+{
+    const char* key; /**< Key to search for */
+    bool found; /**< Has key been found */
+    uint8_t chars; /**< Number of chars matched for the key */
+    uint8_t next_state; /**< State to move to after key has been found */
+} here_tracking_http_search_key;
+
+typedef struct
+{
+    here_tracking_client* client;
+    uint8_t state;
+    uint16_t chars;
+    here_tracking_error status_code;
+    here_tracking_http_search_key search_keys[HERE_TRACKING_HTTP_AUTH_SEARCH_KEY_COUNT];
+} here_tracking_http_auth_data;
+
+typedef struct
+{
+    here_tracking_client* client;
+    here_tracking_error status_code;
+    here_tracking_recv_cb recv_cb;
+    void* user_data;
+    /** Codec for decoding the response body, NULL if the request didn't ask for encoded data */
+    const here_tracking_codec* codec;
+    /** Is the body of the current response decoded with the codec */
+    bool decode;
+    /** Has the decoder reached the end of the encoded data */
+    bool decode_end;
+    /** Is a body size waiting to be reported once it is known whether the body is decoded */
+    bool size_pending;
+    /** Pending body size */
+    uint32_t body_size;
+} here_tracking_http_recv_ctx;
+
+typedef struct
+{
+    here_tracking_http_parser_evt_cb resp_cb;
+    void* resp_cb_data;
+    bool interrupted;
+} here_tracking_http_drain_ctx;
+
+/**
+ * @brief States of an asynchronous request
+ */
+typedef enum
+{
+    /** Reuse the open connection or start a new one */
+    HERE_TRACKING_HTTP_ASYNC_STATE_CONNECT    = 0,
+    /** Waiting for the TCP connection and the TLS handshake */
+    HERE_TRACKING_HTTP_ASYNC_STATE_CONNECTING = 1,
+    /** Sending the request line and headers */
+    HERE_TRACKING_HTTP_ASYNC_STATE_SEND_HDR   = 2,
+    /** Sending the chunked request body */
+    HERE_TRACKING_HTTP_ASYNC_STATE_SEND_BODY  = 3,
+    /** Receiving and parsing the response */
+    HERE_TRACKING_HTTP_ASYNC_STATE_RECV       = 4,
+    /** Request completed */
+    HERE_TRACKING_HTTP_ASYNC_STATE_DONE       = 5
+} here_tracking_http_async_state;
+
+/**
+ * @brief State of an asynchronous request.
+ *
+ * The request first fetches a new access token if needed and then sends the data. Callbacks
+ * registered in the response parser point into this structure so it must not be moved while the
+ * request is in progress.
+ */
+typedef struct
+{
+    /** Client making the request */
+    here_tracking_client* client;
+    /** Current state */
+    here_tracking_http_async_state state;
+    /** Result of the request, valid in state HERE_TRACKING_HTTP_ASYNC_STATE_DONE */
+    here_tracking_error result;
+    /** Is the current exchange the access token request */
+    bool auth;
+    /** Has the access token request been retried after a time mismatch */
+    bool auth_retried;
+    /** Send callback providing the request body */
+    here_tracking_send_cb send_cb;
+    /** Request data type */
+    here_tracking_req_type req_type;
+    /** Response data type */
+    here_tracking_resp_type resp_type;
+    /** Response handling of the send request */
+    here_tracking_http_recv_ctx recv_ctx;
+    /** Response handling of the access token request */
+    here_tracking_http_auth_data auth_data;
+    /** Response draining on a persistent connection */
+    here_tracking_http_drain_ctx drain_ctx;
+    /** Response parser */
+    here_tracking_http_parser parser;
+    /** Data currently being written */
+    const uint8_t* out_data;
+    /** Size of data currently being written */
+    size_t out_size;
+    /** Number of bytes of the current data written so far */
+    size_t out_pos;
+    /** Position in writing the current body chunk */
+    uint8_t chunk_state;
+    /** Body chunk currently being written */
+    const uint8_t* chunk_data;
+    /** Size of the body chunk currently being written */
+    size_t chunk_size;
+    /** Size line of the body chunk currently being written */
+    uint8_t chunk_hdr[HERE_TRACKING_HTTP_ASYNC_CHUNK_HDR_SIZE];
+    /** Position of the first unparsed response byte in the buffer */
+    uint32_t in_pos;
+    /** Number of response bytes in the buffer */
+    uint32_t in_size;
+    /** Monotonic time when the whole request times out, 0 if there is no limit */
+    uint32_t request_deadline;
+    /** Monotonic time when the current wait times out, 0 if there is no limit */
+    uint32_t deadline;
+    /** Monotonic time when a connecting request is stepped next even without socket events */
+    uint32_t step_deadline;
+    /** Buffer for the request headers and the response */
+    uint8_t buffer[HERE_TRACKING_HTTP_ASYNC_BUFFER_SIZE];
+} here_tracking_http_async;
+
 here_tracking_error here_tracking_http_auth(here_tracking_client* client);
 
+/**
+ * @brief Opens the persistent connection to the HERE Tracking service unless one is open already.
+ *
+ * @param[in] client Pointer to the initialized client structure with persistent connections
+ *                   enabled.
+ */
+here_tracking_error here_tracking_http_prewarm(here_tracking_client* client);
+
 here_tracking_error here_tracking_http_send(here_tracking_client* client,
                                             char* data,
                                             uint32_t send_size,
@@ -78,6 +216,20 @@ here_tracking_error here_tracking_http_send_stream(here_tracking_client* client,
                                                    here_tracking_resp_type resp_type,
                                                    void* user_data);
 
+/**
+ * @brief Send requests without waiting for the responses in between and read the responses in
+ *        order.
+ *
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] reqs Requests to send.
+ * @param[in] req_count Number of requests in @p reqs.
+ * @param[out] completed Number of requests whose response was received.
+ */
+here_tracking_error here_tracking_http_send_stream_pipelined(here_tracking_client* client,
+                                                             const here_tracking_stream_req* reqs,
+                                                             uint8_t req_count,
+                                                             uint8_t* completed);
+
 /**
  * @brief Make HTTP GET request
  *
@@ -91,6 +243,54 @@ here_tracking_error here_tracking_http_get(here_tracking_client* client,
                                            here_tracking_recv_cb recv_cb,
                                            void* user_data);
 
+/**
+ * @brief Initialize an asynchronous send request. No I/O is done until
+ *        here_tracking_http_async_step() is called.
+ *
+ * @param[in] async Asynchronous request state.
+ * @param[in] client Pointer to the initialized client structure.
+ * @param[in] auth Fetch a new access token before sending the data.
+ * @param[in] send_cb Callback providing the request body.
+ * @param[in] recv_cb Callback receiving the response.
+ * @param[in] req_type Request data type.
+ * @param[in] resp_type Response data type.
+ * @param[in] user_data User data to pass back in the callbacks.
+ */
+here_tracking_error here_tracking_http_send_stream_async(here_tracking_http_async* async,
+                                                         here_tracking_client* client,
+                                                         bool auth,
+                                                         here_tracking_send_cb send_cb,
+                                                         here_tracking_recv_cb recv_cb,
+                                                         here_tracking_req_type req_type,
+                                                         here_tracking_resp_type resp_type,
+                                                         void* user_data);
+
+/**
+ * @brief Advance an asynchronous request as far as possible without blocking.
+ *
+ * @return HERE_TRACKING_ERROR_WOULD_BLOCK if the request is waiting for the connection, otherwise
+ *         the result of the completed request.
+ */
+here_tracking_error here_tracking_http_async_step(here_tracking_http_async* async);
+
+/**
+ * @brief Get the socket and events an asynchronous request is waiting for.
+ */
+here_tracking_error here_tracking_http_async_get_poll_info(const here_tracking_http_async* async,
+                                                           int* fd,
+                                                           uint8_t* events);
+
+/**
+ * @brief Get the time until the current wait of an asynchronous request times out.
+ */
+here_tracking_error here_tracking_http_async_get_timeout(const here_tracking_http_async* async,
+                                                         int32_t* timeout);
+
+/**
+ * @brief Cancel an asynchronous request and close its connection.
+ */
+here_tracking_error here_tracking_http_async_cancel(here_tracking_http_async* async);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,286 @@
+/**************************************************************************************************
+* Copyright (C) 2017 HERE Europe B.V.                                                             *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+#ifndef HERE_TRACKING_HTTP2_H
+#define HERE_TRACKING_HTTP2_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "here_tracking.h"
+#include "here_tracking_error.h"
+#include "here_tracking_http_parser.h"
+#include "here_tracking_tls_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of concurrent streams of one reader */
+#ifndef HERE_TRACKING_HTTP2_MAX_STREAMS
+#define HERE_TRACKING_HTTP2_MAX_STREAMS 8
+#endif
+
+/** Size of the header block fragment sent in one HEADERS or CONTINUATION frame */
+#define HERE_TRACKING_HTTP2_BLOCK_FRAME_SIZE 256
+
+/** Size of the buffer for Huffman decoded response header names and values */
+#define HERE_TRACKING_HTTP2_HDR_BUFFER_SIZE 128
+
+/** HPACK dynamic table size before the server says otherwise */
+#define HERE_TRACKING_HTTP2_TABLE_SIZE_DEFAULT 4096
+
+/** Header field flags */
+#define HERE_TRACKING_HTTP2_HDR_INDEX     0x01 /**< Add the field to the dynamic table */
+#define HERE_TRACKING_HTTP2_HDR_SENSITIVE 0x02 /**< Never index the field, not even by proxies */
+
+/**
+ * Protocols offered with ALPN, HTTP/2 first
+ */
+extern const char* here_tracking_http2_alpn[];
+
+/**
+ * HTTP/2 stream of one request
+ */
+typedef struct
+{
+    /** Stream identifier */
+    uint32_t id;
+    /** Flow control window for sending in bytes */
+    int32_t send_window;
+    /** Received data not yet acknowledged with a window update in bytes */
+    uint32_t recv_unacked;
+    /** Response event callback, called with the same events as the HTTP/1.1 parser */
+    here_tracking_http_parser_evt_cb resp_cb;
+    /** Data pointer passed in event callback */
+    void* resp_cb_data;
+    /** Result of the stream, HERE_TRACKING_ERROR if the server reset it or didn't process it */
+    here_tracking_error err;
+    /** Has the response ended */
+    bool closed;
+    /** Has the callback asked to stop, the rest of the response is read without events */
+    bool interrupted;
+    /** Has the final response header block been received */
+    bool headers_done;
+    /** Is the current header block an informational response or trailers */
+    bool skip_block;
+    /** Has the body size been reported */
+    bool size_reported;
+    /** Has the body been reported empty, which completes the response */
+    bool body_empty;
+    /** Has body data been received */
+    bool data_received;
+} here_tracking_http2_stream;
+
+/**
+ * HTTP/2 frame reader
+ */
+typedef struct
+{
+    /** Streams of the responses being read */
+    here_tracking_http2_stream* streams[HERE_TRACKING_HTTP2_MAX_STREAMS];
+    /** Number of streams */
+    uint8_t stream_count;
+    /** Is a frame being read */
+    bool in_frame;
+    /** Type of the current frame */
+    uint8_t type;
+    /** Flags of the current frame */
+    uint8_t flags;
+    /** Stream identifier of the current frame */
+    uint32_t stream_id;
+    /** Stream of the current frame, NULL if it is not one of the streams of the reader */
+    here_tracking_http2_stream* stream;
+    /** Payload bytes of the current frame left, not including padding */
+    uint32_t length;
+    /** Padding bytes of the current frame left */
+    uint8_t padding;
+    /** Is a header block continued in a CONTINUATION frame */
+    bool header_block;
+    /** Does the stream end with the current header block */
+    bool block_end_stream;
+    /** Buffer for Huffman decoded header names and values */
+    char hdr_buffer[HERE_TRACKING_HTTP2_HDR_BUFFER_SIZE];
+} here_tracking_http2_reader;
+
+/**
+ * HPACK header block of a request, sent in frames while it is written
+ */
+typedef struct
+{
+    here_tracking_http2* conn;
+    here_tracking_tls_writer* tls_writer;
+    uint32_t stream_id;
+    /** Does the request end with the header block */
+    bool end_stream;
+    /** Is the next frame the HEADERS frame */
+    bool first;
+    /** Bytes of the current fragment in the buffer */
+    uint16_t size;
+    uint8_t buffer[HERE_TRACKING_HTTP2_BLOCK_FRAME_SIZE];
+} here_tracking_http2_block;
+
+/**
+ *  Reset the connection state for a new connection that uses HTTP/2
+ *
+ *  @param conn HTTP/2 state of the client
+ */
+void here_tracking_http2_conn_init(here_tracking_http2* conn);
+
+/**
+ *  Write the connection preface and the client settings
+ *
+ *  @param conn HTTP/2 state of the client
+ *  @param tls_writer Writer of the connection
+ *  @return Code defining operation success
+ */
+here_tracking_error here_tracking_http2_start(here_tracking_http2* conn,
+                                              here_tracking_tls_writer* tls_writer);
+
+/**
+ *  Initialize a frame reader without streams
+ *
+ *  @param reader Pointer to the reader
+ */
+void here_tracking_http2_reader_init(here_tracking_http2_reader* reader);
+
+/**
+ *  Remove all streams from a reader. The reading position is kept, so frames that continue in the
+ *  following data are still read correctly.
+ *
+ *  @param reader Pointer to initialized reader
+ */
+void here_tracking_http2_reader_clear(here_tracking_http2_reader* reader);
+
+/**
+ *  Open a new stream and add it to the reader
+ *
+ *  @param conn HTTP/2 state of the client
+ *  @param reader Reader of the responses
+ *  @param stream Stream to open
+ *  @param resp_cb Response event callback
+ *  @param resp_cb_data Data pointer passed in event callback
+ *  @return Code defining operation success
+ */
+here_tracking_error here_tracking_http2_stream_open(here_tracking_http2* conn,
+                                                    here_tracking_http2_reader* reader,
+                                                    here_tracking_http2_stream* stream,
+                                                    here_tracking_http_parser_evt_cb resp_cb,
+                                                    void* resp_cb_data);
+
+/**
+ *  Start the request header block of a stream
+ *
+ *  @param block Block to start
+ *  @param conn HTTP/2 state of the client
+ *  @param tls_writer Writer of the connection
+ *  @param stream Open stream
+ *  @param end_stream true if the request has no body
+ *  @return Code defining operation success
+ */
+here_tracking_error here_tracking_http2_block_begin(here_tracking_http2_block* block,
+                                                    here_tracking_http2* conn,
+                                                    here_tracking_tls_writer* tls_writer,
+                                                    const here_tracking_http2_stream* stream,
+                                                    bool end_stream);
+
+/**
+ *  Add a header field to a request header block. The name is sent in lower case.
+ *
+ *  @param block Started block
+ *  @param name Header name
+ *  @param value_prefix String sent before the value, NULL if none
+ *  @param value Header value
+ *  @param value_size Size of the value in bytes, not including the prefix
+ *  @param flags HERE_TRACKING_HTTP2_HDR_INDEX or HERE_TRACKING_HTTP2_HDR_SENSITIVE, 0 for neither
+ *  @return Code defining operation success
+ */
+here_tracking_error here_tracking_http2_block_add(here_tracking_http2_block* block,
+                                                  const char* name,
+                                                  const char* value_prefix,
+                                                  const char* value,
+                                                  uint32_t value_size,
+                                                  uint8_t flags);
+
+/**
+ *  Complete a request header block
+ *
+ *  @param block Started block
+ *  @return Code defining operation success
+ */
+here_tracking_error here_tracking_http2_block_end(here_tracking_http2_block* block);
+
+/**
+ *  Write request body data of a stream as far as the flow control windows allow
+ *
+ *  @param conn HTTP/2 state of the client
+ *  @param tls_writer Writer of the connection
+ *  @param stream Open stream
+ *  @param data Body data
+ *  @param[in,out] data_size Size of the data in bytes. Set to number of bytes written in return.
+ *  @param end_stream true if the data ends the request body
+ *  @return Code defining operation success
+ *          HERE_TRACKING_OK - the data was written or the windows are used up
+ *          HERE_TRACKING_ERROR - the server has reset the stream
+ */
+here_tracking_error here_tracking_http2_write_data(here_tracking_http2* conn,
+                                                   here_tracking_tls_writer* tls_writer,
+                                                   here_tracking_http2_stream* stream,
+                                                   const uint8_t* data,
+                                                   uint32_t* data_size,
+                                                   bool end_stream);
+
+/**
+ *  Read frames from the server.
+ *
+ *  Response events are passed to the callbacks of the streams. Settings, pings and flow control
+ *  are handled internally, the frames sent in reply are written with the writer. A frame part
+ *  that can't be handled before more data arrives is left unread and must be passed in again at
+ *  the start of the next call. The data may be modified.
+ *
+ *  @param conn HTTP/2 state of the client
+ *  @param reader Initialized reader
+ *  @param tls_writer Writer of the connection
+ *  @param data Received data
+ *  @param[in,out] data_size Size of data in bytes. Set to number of bytes read in return.
+ *  @return Code defining operation success
+ */
+here_tracking_error here_tracking_http2_read(here_tracking_http2* conn,
+                                             here_tracking_http2_reader* reader,
+                                             here_tracking_tls_writer* tls_writer,
+                                             uint8_t* data,
+                                             uint32_t* data_size);
+
+/**
+ *  Check if the responses of all streams of a reader have ended
+ *
+ *  @param reader Initialized reader
+ *  @return true if all responses have ended
+ */
+bool here_tracking_http2_reader_done(const here_tracking_http2_reader* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HERE_TRACKING_HTTP2_H */
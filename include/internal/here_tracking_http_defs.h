@@ -35,12 +35,15 @@
 #define HERE_TRACKING_HTTP_STATUS_TOO_MANY_REQUESTS   429
 
 extern const char* here_tracking_http_connection_close;
+extern const char* here_tracking_http_connection_keep_alive;
 extern const char* here_tracking_http_content_type_json;
 extern const char* here_tracking_http_content_type_octet_stream;
 extern const char* here_tracking_http_crlf;
 extern const char* here_tracking_http_header_accept;
+extern const char* here_tracking_http_header_accept_encoding;
 extern const char* here_tracking_http_header_authorization;
 extern const char* here_tracking_http_header_connection;
+extern const char* here_tracking_http_header_content_encoding;
 extern const char* here_tracking_http_header_content_length;
 extern const char* here_tracking_http_header_content_type;
 extern const char* here_tracking_http_header_transfer_encoding;
@@ -50,6 +53,12 @@ extern const char* here_tracking_http_method_post;
 extern const char* here_tracking_http_path_token;
 extern const char* here_tracking_http_path_version;
 extern const char* here_tracking_http_protocol_https;
+extern const char* here_tracking_http_pseudo_header_authority;
+extern const char* here_tracking_http_pseudo_header_method;
+extern const char* here_tracking_http_pseudo_header_path;
+extern const char* here_tracking_http_pseudo_header_scheme;
+extern const char* here_tracking_http_pseudo_header_status;
+extern const char* here_tracking_http_scheme_https;
 extern const char* here_tracking_http_transfer_encoding_chunked;
 
 #endif /* HERE_TRACKING_HTTP_DEFS_H */
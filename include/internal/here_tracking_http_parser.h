@@ -53,7 +53,7 @@ typedef enum
     HERE_TRACKING_HTTP_PARSER_EVT_HDR         = 3,
     /** HTTP response body */
     HERE_TRACKING_HTTP_PARSER_EVT_BODY        = 4,
-    /** HTTP response body size */
+    /** HTTP response body size, not known in advance for chunked bodies */
     HERE_TRACKING_HTTP_PARSER_EVT_BODY_SIZE   = 5
 } here_tracking_http_parser_evt_id;
 
@@ -118,6 +118,23 @@ typedef struct
     here_tracking_http_parser_evt_data data;
 } here_tracking_http_parser_evt;
 
+/**
+ * Position in a chunked response body
+ */
+typedef enum
+{
+    /** Chunk size line */
+    HERE_TRACKING_HTTP_PARSER_CHUNK_SIZE     = 0,
+    /** Chunk data */
+    HERE_TRACKING_HTTP_PARSER_CHUNK_DATA     = 1,
+    /** Line break after chunk data */
+    HERE_TRACKING_HTTP_PARSER_CHUNK_DATA_END = 2,
+    /** Trailer section after the last chunk */
+    HERE_TRACKING_HTTP_PARSER_CHUNK_TRAILER  = 3,
+    /** Whole body parsed */
+    HERE_TRACKING_HTTP_PARSER_CHUNK_DONE     = 4
+} here_tracking_http_parser_chunk_state;
+
 /**
  * Parser event callback
  *
@@ -134,8 +151,16 @@ typedef struct
 {
     /** Current event parser is in */
     here_tracking_http_parser_evt_id evt_state;
-    /** Expected content size */
+    /** Expected content size, or size left in the current chunk of a chunked body */
     int32_t content_size;
+    /** Is the body sent with chunked transfer coding */
+    bool chunked;
+    /** Position in a chunked body */
+    here_tracking_http_parser_chunk_state chunk_state;
+    /** Can the connection be reused after the response, based on HTTP version and headers */
+    bool keep_alive;
+    /** Bytes of the current incomplete line already searched for the line end */
+    uint32_t scan_pos;
     /** Event callback */
     here_tracking_http_parser_evt_cb cb;
     /** Data pointer passed in event callback */
@@ -157,6 +182,9 @@ here_tracking_error here_tracking_http_parser_init(here_tracking_http_parser* pa
 /**
  *  Parse HTTP response data.
  *
+ *  Data that was not parsed must be passed in again at the start of the next call. An incomplete
+ *  line is not searched again from the start, the search continues where the previous call ended.
+ *
  *  @param parser Pointer to initialized HTTP parser
  *  @param data Response data buffer.
  *  @param[in,out] data_size Size of data buffer in bytes. Set to number of bytes parsed in return.
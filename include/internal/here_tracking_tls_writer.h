@@ -43,6 +43,14 @@ here_tracking_error here_tracking_tls_writer_init(here_tracking_tls_writer* writ
                                                   uint8_t* write_buf,
                                                   size_t write_buf_size);
 
+/**
+ * Initialize a writer that only collects data to the write buffer without a TLS connection. Writing
+ * more data than fits into the buffer fails with HERE_TRACKING_ERROR_BUFFER_TOO_SMALL.
+ */
+here_tracking_error here_tracking_tls_writer_init_buffered(here_tracking_tls_writer* writer,
+                                                           uint8_t* write_buf,
+                                                           size_t write_buf_size);
+
 here_tracking_error here_tracking_tls_writer_write_char(here_tracking_tls_writer* writer,
                                                         char c);
 
@@ -26,6 +26,7 @@
 #define HERE_TRACKING_UTILS_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -34,14 +35,20 @@ extern "C" {
 
 int32_t here_tracking_utils_atoi(const char* str, size_t n);
 
+uint32_t here_tracking_utils_crc32(uint32_t crc, const uint8_t* data, size_t n);
+
 uint32_t here_tracking_utils_atou(const char* str, size_t n);
 
+uint32_t here_tracking_utils_xtou(const char* str, size_t n);
+
 bool here_tracking_utils_isalnum(const char c);
 
 bool here_tracking_utils_isalpha(const char c);
 
 bool here_tracking_utils_isdigit(const char c);
 
+bool here_tracking_utils_isxdigit(const char c);
+
 int32_t here_tracking_utils_memcasecmp(const uint8_t* b1, const uint8_t* b2, size_t n);
 
 int32_t here_tracking_utils_strcasecmp(const char* s1, const char* s2);
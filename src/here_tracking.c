@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include "here_tracking.h"
+#include "here_tracking_async.h"
 #include "here_tracking_http.h"
 #include "here_tracking_time.h"
 
@@ -33,9 +34,24 @@
 /* Update token if about to expire within offset. In seconds. */
 #define HERE_TRACKING_TOKEN_EXPIRY_OFFSET (600)
 
+/* The state of a non-blocking request is kept in the storage reserved by the caller */
+#define HERE_TRACKING_HTTP_ASYNC(ASYNC) ((here_tracking_http_async*)(void*)(ASYNC))
+
+#define HERE_TRACKING_HTTP_ASYNC_CONST(ASYNC) \
+    ((const here_tracking_http_async*)(const void*)(ASYNC))
+
+/* Fails to compile if HERE_TRACKING_ASYNC_STATE_SIZE is too small for the internal state */
+typedef char here_tracking_async_size_check[(sizeof(here_tracking_http_async) <=
+                                             sizeof(here_tracking_async)) ? 1 : -1];
+
 static here_tracking_error here_tracking_update_token_if_needed(here_tracking_client* client);
 
-static here_tracking_error here_tracking_check_rate_limit(here_tracking_client* client);
+static here_tracking_error here_tracking_token_update_needed(here_tracking_client* client,
+                                                             uint32_t ready_by,
+                                                             bool* needed);
+
+static here_tracking_error here_tracking_check_rate_limit(here_tracking_client* client,
+                                                          uint32_t requests);
 
 /**************************************************************************************************/
 
@@ -59,11 +75,38 @@ here_tracking_error here_tracking_init(here_tracking_client* client,
         client->srv_time_diff = 0;
         client->token_expiry = 0;
         client->tls = NULL;
+        client->tls_env = NULL;
         client->data_cb = NULL;
         client->data_cb_user_data = NULL;
         client->correlation_id = NULL;
         client->user_agent = NULL;
         client->retry_after = 0;
+        client->keep_alive.enabled = false;
+        client->keep_alive.idle_timeout = HERE_TRACKING_KEEP_ALIVE_DEFAULT_IDLE_TIMEOUT;
+        client->keep_alive.connected = false;
+        client->keep_alive.port = 0;
+        client->keep_alive.last_used = 0;
+        client->keep_alive.non_blocking = false;
+        client->timeouts.connect_timeout = HERE_TRACKING_DEFAULT_CONNECT_TIMEOUT;
+        client->timeouts.io_timeout = HERE_TRACKING_DEFAULT_IO_TIMEOUT;
+        client->timeouts.request_timeout = HERE_TRACKING_DEFAULT_REQUEST_TIMEOUT;
+        client->io_buffers.send_buffer = NULL;
+        client->io_buffers.send_buffer_size = 0;
+        client->io_buffers.recv_buffer = NULL;
+        client->io_buffers.recv_buffer_size = 0;
+        client->hdr_cache.buffer = NULL;
+        client->hdr_cache.buffer_size = 0;
+        client->hdr_cache.size = 0;
+        client->hdr_cache.too_small = false;
+        client->codec = NULL;
+        client->codec_buffer = NULL;
+        client->codec_buffer_size = 0;
+        client->http2.enabled = false;
+        client->http2.hpack_buffer = NULL;
+        client->http2.hpack_buffer_size = 0;
+        client->http2.active = false;
+        client->rate_limiter = NULL;
+        client->gateway_rate_limiter = NULL;
         err = HERE_TRACKING_OK;
     }
 
@@ -83,6 +126,14 @@ here_tracking_error here_tracking_free(here_tracking_client* client)
             err = here_tracking_tls_free(&client->tls);
             client->tls = NULL;
         }
+
+        if(client->tls_env != NULL)
+        {
+            here_tracking_tls_env_free(&client->tls_env);
+            client->tls_env = NULL;
+        }
+
+        client->keep_alive.connected = false;
     }
 
     return err;
@@ -108,6 +159,258 @@ here_tracking_error here_tracking_set_recv_data_cb(here_tracking_client* client,
 
 /**************************************************************************************************/
 
+here_tracking_error here_tracking_set_keep_alive(here_tracking_client* client,
+                                                 bool enable,
+                                                 uint32_t idle_timeout)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL)
+    {
+        if(!enable && client->keep_alive.connected)
+        {
+            here_tracking_tls_close(client->tls);
+            client->keep_alive.connected = false;
+        }
+
+        client->keep_alive.enabled = enable;
+        client->keep_alive.idle_timeout =
+            (idle_timeout > 0) ? idle_timeout : HERE_TRACKING_KEEP_ALIVE_DEFAULT_IDLE_TIMEOUT;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_set_io_buffers(here_tracking_client* client,
+                                                 uint8_t* send_buffer,
+                                                 uint32_t send_buffer_size,
+                                                 uint8_t* recv_buffer,
+                                                 uint32_t recv_buffer_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL &&
+       (send_buffer == NULL || send_buffer_size >= HERE_TRACKING_IO_BUFFER_MIN_SIZE) &&
+       (recv_buffer == NULL || recv_buffer_size >= HERE_TRACKING_IO_BUFFER_MIN_SIZE))
+    {
+        client->io_buffers.send_buffer = send_buffer;
+        client->io_buffers.send_buffer_size = (send_buffer != NULL) ? send_buffer_size : 0;
+        client->io_buffers.recv_buffer = recv_buffer;
+        client->io_buffers.recv_buffer_size = (recv_buffer != NULL) ? recv_buffer_size : 0;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_set_hdr_cache(here_tracking_client* client,
+                                                uint8_t* buffer,
+                                                uint32_t buffer_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL && (buffer == NULL || buffer_size > 0))
+    {
+        client->hdr_cache.buffer = buffer;
+        client->hdr_cache.buffer_size = (buffer != NULL) ? buffer_size : 0;
+        client->hdr_cache.size = 0;
+        client->hdr_cache.too_small = false;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_set_codec(here_tracking_client* client,
+                                            const here_tracking_codec* codec,
+                                            uint8_t* buffer,
+                                            uint32_t buffer_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL && codec == NULL)
+    {
+        client->codec = NULL;
+        client->codec_buffer = NULL;
+        client->codec_buffer_size = 0;
+        err = HERE_TRACKING_OK;
+    }
+    else if(client != NULL &&
+            codec->content_encoding != NULL &&
+            (codec->begin != NULL) == (codec->encode != NULL) &&
+            (codec->decode_begin != NULL) == (codec->decode != NULL) &&
+            (codec->encode != NULL || codec->decode != NULL) &&
+            buffer != NULL &&
+            buffer_size > 0)
+    {
+        client->codec = codec;
+        client->codec_buffer = buffer;
+        client->codec_buffer_size = buffer_size;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_set_http2(here_tracking_client* client,
+                                            bool enable,
+                                            uint8_t* hpack_buffer,
+                                            uint32_t hpack_buffer_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL && (hpack_buffer == NULL || hpack_buffer_size > 0))
+    {
+        /* The protocol is negotiated when connecting */
+        if(client->keep_alive.connected)
+        {
+            here_tracking_tls_close(client->tls);
+            client->keep_alive.connected = false;
+        }
+
+        client->http2.enabled = enable;
+        client->http2.hpack_buffer = hpack_buffer;
+        client->http2.hpack_buffer_size = (hpack_buffer != NULL) ? hpack_buffer_size : 0;
+        client->http2.active = false;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_set_rate_limiters(here_tracking_client* client,
+                                                    here_tracking_rate_limiter* limiter,
+                                                    here_tracking_rate_limiter* gateway_limiter)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL && (limiter == NULL || limiter != gateway_limiter))
+    {
+        client->rate_limiter = limiter;
+        client->gateway_rate_limiter = gateway_limiter;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_set_timeouts(here_tracking_client* client,
+                                               uint32_t connect_timeout,
+                                               uint32_t io_timeout,
+                                               uint32_t request_timeout)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL)
+    {
+        client->timeouts.connect_timeout = connect_timeout;
+        client->timeouts.io_timeout = io_timeout;
+        client->timeouts.request_timeout = request_timeout;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_set_tls_env(here_tracking_client* client,
+                                              here_tracking_tls_env env)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL)
+    {
+        err = HERE_TRACKING_OK;
+
+        if(env != NULL)
+        {
+            err = here_tracking_tls_env_ref(env);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            /* The TLS handle is bound to the environment it was initialized with. */
+            if(client->tls != NULL)
+            {
+                here_tracking_tls_free(&client->tls);
+                client->tls = NULL;
+            }
+
+            client->keep_alive.connected = false;
+
+            if(client->tls_env != NULL)
+            {
+                here_tracking_tls_env_free(&client->tls_env);
+            }
+
+            client->tls_env = env;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_get_tls_session(here_tracking_client* client,
+                                                  uint8_t* session,
+                                                  uint32_t* session_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL && session_size != NULL)
+    {
+        err = (client->tls != NULL) ?
+            here_tracking_tls_get_session(client->tls, session, session_size) :
+            HERE_TRACKING_ERROR;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_set_tls_session(here_tracking_client* client,
+                                                  const uint8_t* session,
+                                                  uint32_t session_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL && session != NULL && session_size > 0)
+    {
+        err = HERE_TRACKING_OK;
+
+        /* The session is kept by the TLS handle, create it ahead of the first connection */
+        if(client->tls == NULL)
+        {
+            err = here_tracking_tls_init(&(client->tls), client->tls_env);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_tls_set_session(client->tls, session, session_size);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
 here_tracking_error here_tracking_auth(here_tracking_client* client)
 {
     here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
@@ -129,6 +432,43 @@ here_tracking_error here_tracking_auth(here_tracking_client* client)
 
 /**************************************************************************************************/
 
+here_tracking_error here_tracking_prewarm(here_tracking_client* client, uint32_t ready_by)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL)
+    {
+        bool auth = false;
+
+        err = client->keep_alive.enabled ? HERE_TRACKING_OK : HERE_TRACKING_ERROR;
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_check_rate_limit(client, 0);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_token_update_needed(client, ready_by, &auth);
+        }
+
+        /* Authentication leaves the connection open, no need to connect separately */
+        if(err == HERE_TRACKING_OK && auth)
+        {
+            err = here_tracking_auth(client);
+        }
+
+        if(err == HERE_TRACKING_OK && (!auth || !client->keep_alive.connected))
+        {
+            err = here_tracking_http_prewarm(client);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
 here_tracking_error here_tracking_send(here_tracking_client* client,
                                        char* data,
                                        uint32_t send_size,
@@ -138,7 +478,7 @@ here_tracking_error here_tracking_send(here_tracking_client* client,
 
     if(client != NULL && data != NULL && send_size > 0 && recv_size > 0)
     {
-        err = here_tracking_check_rate_limit(client);
+        err = here_tracking_check_rate_limit(client, 1);
 
         if(err == HERE_TRACKING_OK)
         {
@@ -167,7 +507,7 @@ here_tracking_error here_tracking_send_stream(here_tracking_client* client,
 
     if(client != NULL && send_cb != NULL && recv_cb != NULL)
     {
-        err = here_tracking_check_rate_limit(client);
+        err = here_tracking_check_rate_limit(client, 1);
 
         if(err == HERE_TRACKING_OK)
         {
@@ -190,26 +530,164 @@ here_tracking_error here_tracking_send_stream(here_tracking_client* client,
 
 /**************************************************************************************************/
 
+here_tracking_error here_tracking_send_stream_pipelined(here_tracking_client* client,
+                                                        const here_tracking_stream_req* reqs,
+                                                        uint8_t req_count,
+                                                        uint8_t* completed)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL && reqs != NULL && req_count > 0 && completed != NULL)
+    {
+        uint8_t i;
+
+        err = HERE_TRACKING_OK;
+        (*completed) = 0;
+
+        for(i = 0; i < req_count; ++i)
+        {
+            if(reqs[i].send_cb == NULL || reqs[i].recv_cb == NULL)
+            {
+                err = HERE_TRACKING_ERROR_INVALID_INPUT;
+            }
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_check_rate_limit(client, req_count);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_update_token_if_needed(client);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_http_send_stream_pipelined(client, reqs, req_count, completed);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_send_stream_async(here_tracking_async* async,
+                                                    here_tracking_client* client,
+                                                    here_tracking_send_cb send_cb,
+                                                    here_tracking_recv_cb recv_cb,
+                                                    here_tracking_req_type req_type,
+                                                    here_tracking_resp_type resp_type,
+                                                    void* user_data)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(async != NULL && client != NULL && send_cb != NULL && recv_cb != NULL)
+    {
+        bool auth = false;
+
+        err = here_tracking_check_rate_limit(client, 1);
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_token_update_needed(client, 0, &auth);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_http_send_stream_async(HERE_TRACKING_HTTP_ASYNC(async),
+                                                       client,
+                                                       auth,
+                                                       send_cb,
+                                                       recv_cb,
+                                                       req_type,
+                                                       resp_type,
+                                                       user_data);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_async_step(here_tracking_async* async)
+{
+    return here_tracking_http_async_step(HERE_TRACKING_HTTP_ASYNC(async));
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_async_get_poll_info(const here_tracking_async* async,
+                                                      int* fd,
+                                                      uint8_t* events)
+{
+    return here_tracking_http_async_get_poll_info(HERE_TRACKING_HTTP_ASYNC_CONST(async),
+                                                  fd,
+                                                  events);
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_async_get_timeout(const here_tracking_async* async,
+                                                    int32_t* timeout)
+{
+    return here_tracking_http_async_get_timeout(HERE_TRACKING_HTTP_ASYNC_CONST(async), timeout);
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_async_cancel(here_tracking_async* async)
+{
+    return here_tracking_http_async_cancel(HERE_TRACKING_HTTP_ASYNC(async));
+}
+
+/**************************************************************************************************/
+
 static here_tracking_error here_tracking_update_token_if_needed(here_tracking_client* client)
+{
+    here_tracking_error err;
+    bool needed;
+
+    err = here_tracking_token_update_needed(client, 0, &needed);
+
+    if(err == HERE_TRACKING_OK && needed)
+    {
+        err = here_tracking_auth(client);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_token_update_needed(here_tracking_client* client,
+                                                             uint32_t ready_by,
+                                                             bool* needed)
 {
     here_tracking_error err;
     uint32_t ts;
 
     err = here_tracking_get_unixtime(&ts);
 
-    if(err == HERE_TRACKING_OK &&
-       (strlen(client->access_token) == 0 ||
-        client->token_expiry < (ts + HERE_TRACKING_TOKEN_EXPIRY_OFFSET)))
+    /* Token must stay valid until the time it is going to be used */
+    if(ready_by > ts)
     {
-        err = here_tracking_auth(client);
+        ts = ready_by;
     }
 
+    (*needed) = (err == HERE_TRACKING_OK &&
+                 (strlen(client->access_token) == 0 ||
+                  client->token_expiry < (ts + HERE_TRACKING_TOKEN_EXPIRY_OFFSET)));
+
     return err;
 }
 
 /**************************************************************************************************/
 
-static here_tracking_error here_tracking_check_rate_limit(here_tracking_client* client)
+static here_tracking_error here_tracking_check_rate_limit(here_tracking_client* client,
+                                                          uint32_t requests)
 {
     here_tracking_error err;
     uint32_t ts;
@@ -221,5 +699,22 @@ static here_tracking_error here_tracking_check_rate_limit(here_tracking_client*
         err = HERE_TRACKING_ERROR_TOO_MANY_REQUESTS;
     }
 
+    if(err == HERE_TRACKING_OK && client->rate_limiter != NULL)
+    {
+        err = here_tracking_rate_limiter_check(client->rate_limiter, requests, NULL);
+    }
+
+    if(err == HERE_TRACKING_OK && client->gateway_rate_limiter != NULL)
+    {
+        err = here_tracking_rate_limiter_check(client->gateway_rate_limiter, requests, NULL);
+    }
+
+    /* Tokens are taken only when both limiters have them */
+    if(err == HERE_TRACKING_OK)
+    {
+        here_tracking_rate_limiter_take(client->rate_limiter, requests);
+        here_tracking_rate_limiter_take(client->gateway_rate_limiter, requests);
+    }
+
     return err;
 }
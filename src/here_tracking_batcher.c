@@ -0,0 +1,343 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <string.h>
+
+#include "here_tracking_batcher.h"
+#include "here_tracking_time.h"
+
+/**************************************************************************************************/
+
+typedef struct
+{
+    here_tracking_batcher* batcher;
+    bool body_sent;
+    bool end_sent;
+    here_tracking_error resp_err;
+} here_tracking_batcher_send_ctx;
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_batcher_body_size(const here_tracking_batcher* batcher,
+                                                uint32_t batch_size,
+                                                uint32_t sample_size);
+
+static here_tracking_error here_tracking_batcher_send_cb(const uint8_t** data,
+                                                         size_t* data_size,
+                                                         void* user_data);
+
+static here_tracking_error here_tracking_batcher_recv_cb(const here_tracking_recv_data* data,
+                                                         void* user_data);
+
+/**************************************************************************************************/
+
+static const uint8_t here_tracking_batcher_array_end[] = "]";
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_batcher_init(here_tracking_batcher* batcher,
+                                               here_tracking_client* client,
+                                               here_tracking_req_type req_type,
+                                               uint8_t* buffer,
+                                               uint32_t buffer_size,
+                                               here_tracking_recv_cb recv_cb,
+                                               void* user_data)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(batcher != NULL &&
+       client != NULL &&
+       (req_type == HERE_TRACKING_REQ_DATA_JSON || req_type == HERE_TRACKING_REQ_DATA_PROTOBUF) &&
+       buffer != NULL &&
+       buffer_size > 0)
+    {
+        batcher->client = client;
+        batcher->buffer = buffer;
+        batcher->buffer_size = buffer_size;
+        batcher->size = 0;
+        batcher->count = 0;
+        batcher->max_samples = 0;
+        batcher->max_bytes = buffer_size;
+        batcher->max_linger_ms = HERE_TRACKING_BATCHER_DEFAULT_LINGER_MS;
+        batcher->first_ms = 0;
+        batcher->req_type = req_type;
+        batcher->recv_cb = recv_cb;
+        batcher->user_data = user_data;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_batcher_set_limits(here_tracking_batcher* batcher,
+                                                     uint32_t max_samples,
+                                                     uint32_t max_bytes,
+                                                     uint32_t max_linger_ms)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(batcher != NULL && batcher->buffer != NULL && max_bytes <= batcher->buffer_size)
+    {
+        batcher->max_samples = max_samples;
+        batcher->max_bytes = (max_bytes > 0) ? max_bytes : batcher->buffer_size;
+        batcher->max_linger_ms = max_linger_ms;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_batcher_add(here_tracking_batcher* batcher,
+                                              const uint8_t* sample,
+                                              uint32_t sample_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(batcher != NULL && batcher->buffer != NULL && sample != NULL && sample_size > 0)
+    {
+        err = (here_tracking_batcher_body_size(batcher, 0, sample_size) <= batcher->max_bytes) ?
+            HERE_TRACKING_OK : HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+
+        if(err == HERE_TRACKING_OK && !here_tracking_batcher_has_room(batcher, sample_size))
+        {
+            err = here_tracking_batcher_flush(batcher);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            if(batcher->count == 0)
+            {
+                if(here_tracking_get_monotonic_ms(&(batcher->first_ms)) != HERE_TRACKING_OK)
+                {
+                    batcher->first_ms = 0;
+                }
+
+                if(batcher->req_type == HERE_TRACKING_REQ_DATA_JSON)
+                {
+                    batcher->buffer[batcher->size++] = '[';
+                }
+            }
+            else if(batcher->req_type == HERE_TRACKING_REQ_DATA_JSON)
+            {
+                batcher->buffer[batcher->size++] = ',';
+            }
+
+            memcpy(batcher->buffer + batcher->size, sample, sample_size);
+            batcher->size += sample_size;
+            batcher->count++;
+
+            if(batcher->max_samples > 0 && batcher->count >= batcher->max_samples)
+            {
+                err = here_tracking_batcher_flush(batcher);
+            }
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+bool here_tracking_batcher_has_room(const here_tracking_batcher* batcher, uint32_t sample_size)
+{
+    bool res = false;
+
+    if(batcher != NULL && batcher->buffer != NULL)
+    {
+        res = (batcher->count == 0) ||
+              (here_tracking_batcher_body_size(batcher, batcher->size, sample_size) <=
+               batcher->max_bytes &&
+               (batcher->max_samples == 0 || batcher->count < batcher->max_samples));
+    }
+
+    return res;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_batcher_poll(here_tracking_batcher* batcher, uint32_t* wait_ms)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(batcher != NULL && batcher->buffer != NULL)
+    {
+        uint32_t wait = UINT32_MAX;
+
+        err = HERE_TRACKING_OK;
+
+        if(batcher->count > 0)
+        {
+            uint32_t now = 0, elapsed;
+
+            /* Without a clock the batch is sent on every poll */
+            if(here_tracking_get_monotonic_ms(&now) != HERE_TRACKING_OK)
+            {
+                now = batcher->first_ms + batcher->max_linger_ms;
+            }
+
+            elapsed = now - batcher->first_ms;
+
+            if(elapsed >= batcher->max_linger_ms)
+            {
+                err = here_tracking_batcher_flush(batcher);
+
+                if(batcher->count > 0)
+                {
+                    /* Try again after another linger time */
+                    batcher->first_ms = now;
+                    wait = batcher->max_linger_ms;
+                }
+            }
+            else
+            {
+                wait = batcher->max_linger_ms - elapsed;
+            }
+        }
+
+        if(wait_ms != NULL)
+        {
+            (*wait_ms) = wait;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_batcher_flush(here_tracking_batcher* batcher)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(batcher != NULL && batcher->buffer != NULL)
+    {
+        err = HERE_TRACKING_OK;
+
+        if(batcher->count > 0)
+        {
+            here_tracking_batcher_send_ctx ctx;
+            here_tracking_resp_type resp_type = HERE_TRACKING_RESP_STATUS_ONLY;
+
+            ctx.batcher = batcher;
+            ctx.body_sent = false;
+            ctx.end_sent = (batcher->req_type != HERE_TRACKING_REQ_DATA_JSON);
+            ctx.resp_err = HERE_TRACKING_ERROR;
+
+            if(batcher->recv_cb != NULL)
+            {
+                resp_type = (batcher->req_type == HERE_TRACKING_REQ_DATA_JSON) ?
+                    HERE_TRACKING_RESP_WITH_DATA_JSON : HERE_TRACKING_RESP_WITH_DATA_PROTOBUF;
+            }
+
+            err = here_tracking_send_stream(batcher->client,
+                                            here_tracking_batcher_send_cb,
+                                            here_tracking_batcher_recv_cb,
+                                            batcher->req_type,
+                                            resp_type,
+                                            &ctx);
+
+            if(err == HERE_TRACKING_OK)
+            {
+                err = ctx.resp_err;
+            }
+
+            if(err == HERE_TRACKING_OK || err == HERE_TRACKING_ERROR_BAD_REQUEST)
+            {
+                batcher->count = 0;
+                batcher->size = 0;
+            }
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_batcher_body_size(const here_tracking_batcher* batcher,
+                                                uint32_t batch_size,
+                                                uint32_t sample_size)
+{
+    uint64_t size = (uint64_t)batch_size + sample_size;
+
+    /* Opening bracket or separator, and the closing bracket */
+    if(batcher->req_type == HERE_TRACKING_REQ_DATA_JSON)
+    {
+        size += 2;
+    }
+
+    return (size > UINT32_MAX) ? UINT32_MAX : (uint32_t)size;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_batcher_send_cb(const uint8_t** data,
+                                                         size_t* data_size,
+                                                         void* user_data)
+{
+    here_tracking_batcher_send_ctx* ctx = (here_tracking_batcher_send_ctx*)user_data;
+
+    (*data) = NULL;
+    (*data_size) = 0;
+
+    if(!ctx->body_sent)
+    {
+        (*data) = ctx->batcher->buffer;
+        (*data_size) = ctx->batcher->size;
+        ctx->body_sent = true;
+    }
+    else if(!ctx->end_sent)
+    {
+        (*data) = here_tracking_batcher_array_end;
+        (*data_size) = 1;
+        ctx->end_sent = true;
+    }
+
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_batcher_recv_cb(const here_tracking_recv_data* data,
+                                                         void* user_data)
+{
+    here_tracking_batcher_send_ctx* ctx = (here_tracking_batcher_send_ctx*)user_data;
+    here_tracking_error err = HERE_TRACKING_OK;
+
+    if(data->evt == HERE_TRACKING_RECV_EVT_RESP_COMPLETE)
+    {
+        ctx->resp_err = data->err;
+    }
+
+    if(ctx->batcher->recv_cb != NULL)
+    {
+        err = ctx->batcher->recv_cb(data, ctx->batcher->user_data);
+    }
+
+    return err;
+}
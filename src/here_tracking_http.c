@@ -26,6 +26,7 @@
 
 #include "here_tracking_data_buffer.h"
 #include "here_tracking_http.h"
+#include "here_tracking_http2.h"
 #include "here_tracking_http_defs.h"
 #include "here_tracking_http_parser.h"
 #include "here_tracking_log.h"
@@ -39,15 +40,24 @@
 
 #define HERE_TRACKING_HTTP_PORT_HTTPS 443
 
+/* Colon and up to five digits */
+#define HERE_TRACKING_HTTP_PORT_SIZE 6
+
 /**************************************************************************************************/
 
 static const char* here_tracking_http_query_async = "?async=true";
+static const char* here_tracking_http_path_async =  "/?async=true";
+static const char* here_tracking_http_path_root =   "/";
 
 /**************************************************************************************************/
 
 static const char* here_tracking_http_header_bearer =           "Bearer";
+static const char* here_tracking_http_header_bearer_prefix =    "Bearer ";
 static const char* here_tracking_http_header_host =             "Host";
+static const char* here_tracking_http_header_keep_alive =       "Keep-Alive";
+static const char* here_tracking_http_header_proxy_connection = "Proxy-Connection";
 static const char* here_tracking_http_header_retry_after =      "Retry-After";
+static const char* here_tracking_http_header_upgrade =          "Upgrade";
 static const char* here_tracking_http_header_x_here_timestamp = "x-here-timestamp";
 static const char* here_tracking_http_header_x_request_id =     "x-request-id";
 
@@ -67,36 +77,30 @@ static const char* here_tracking_http_expires_in =   "\"expiresIn\"";
     TRY((here_tracking_tls_writer_write_string((WRITER), VAL))); \
     TRY((here_tracking_tls_writer_write_string((WRITER), here_tracking_http_crlf)))
 
+#define HERE_TRACKING_HTTP2_ADD_HEADER(BLOCK, KEY, VAL, FLAGS) \
+    TRY((here_tracking_http2_block_add((BLOCK), KEY, NULL, VAL, (uint32_t)strlen(VAL), FLAGS)))
+
 /**************************************************************************************************/
 
 #define HERE_TRACKING_HTTP_TLS_BUFFER_SIZE 256
 
 /**************************************************************************************************/
 
-#define HERE_TRACKING_HTTP_AUTH_SEARCH_KEY_COUNT 2
-
 #define HERE_TRACKING_HTTP_AUTH_FIND_KEY          0
 #define HERE_TRACKING_HTTP_AUTH_TOKEN_FIND_START  1
 #define HERE_TRACKING_HTTP_AUTH_TOKEN_WRITE       2
 #define HERE_TRACKING_HTTP_AUTH_EXPIRY_FIND_START 3
 #define HERE_TRACKING_HTTP_AUTH_EXPIRY_WRITE      4
 
-typedef struct
-{
-    const char* key; /**< Key to search for */
-    bool found; /**< Has key been found */
-    uint8_t chars; /**< Number of chars matched for the key */
-    uint8_t next_state; /**< State to move to after key has been found */
-} here_tracking_http_search_key;
+#define HERE_TRACKING_HTTP_ASYNC_CHUNK_NEXT 0
+#define HERE_TRACKING_HTTP_ASYNC_CHUNK_HDR  1
+#define HERE_TRACKING_HTTP_ASYNC_CHUNK_DATA 2
+#define HERE_TRACKING_HTTP_ASYNC_CHUNK_END  3
+#define HERE_TRACKING_HTTP_ASYNC_CHUNK_DONE 4
 
-typedef struct
-{
-    here_tracking_client* client;
-    uint8_t state;
-    uint16_t chars;
-    here_tracking_error status_code;
-    here_tracking_http_search_key search_keys[HERE_TRACKING_HTTP_AUTH_SEARCH_KEY_COUNT];
-} here_tracking_http_auth_data;
+/* Longest wait between steps while connecting, so that the TLS implementation can give up an
+   address that doesn't answer and try the next one. In milliseconds. */
+#define HERE_TRACKING_HTTP_ASYNC_CONNECT_STEP 500
 
 typedef struct
 {
@@ -109,11 +113,16 @@ typedef struct
 
 typedef struct
 {
-    here_tracking_client* client;
-    here_tracking_error status_code;
-    here_tracking_recv_cb recv_cb;
-    void* user_data;
-} here_tracking_http_recv_ctx;
+    here_tracking_tls_writer* tls_writer;
+    here_tracking_http2_reader reader;
+    uint8_t* recv_buffer;
+    uint32_t recv_buffer_size;
+    /** Bytes of a frame part left unread at the start of the receive buffer */
+    uint32_t recv_size;
+    uint32_t request_deadline;
+    /** Stream whose request body is being written */
+    here_tracking_http2_stream* stream;
+} here_tracking_http_h2_ctx;
 
 /**************************************************************************************************/
 
@@ -125,19 +134,60 @@ static bool here_tracking_http_send_resp_cb(const here_tracking_http_parser_evt*
                                             bool last,
                                             void* cb_data);
 
+static bool here_tracking_http_send_resp_decode(here_tracking_http_recv_ctx* recv_ctx,
+                                                const here_tracking_http_parser_evt_body* body,
+                                                bool last);
+
+static void here_tracking_http_send_resp_complete(here_tracking_http_recv_ctx* recv_ctx,
+                                                  here_tracking_error err);
+
+static void here_tracking_http_update_rate_limiters(here_tracking_client* client,
+                                                    here_tracking_error err);
+
 static here_tracking_error here_tracking_http_connect(here_tracking_client* client,
                                                       const char* host,
-                                                      uint16_t port);
+                                                      uint16_t port,
+                                                      uint32_t request_deadline);
+
+static bool here_tracking_http_reuse_connection(here_tracking_client* client,
+                                                const char* host,
+                                                uint16_t port,
+                                                bool non_blocking);
+
+static void here_tracking_http_release(here_tracking_client* client, bool reusable);
+
+static const char* here_tracking_http_connection_hdr_val(const here_tracking_client* client);
 
 static here_tracking_error here_tracking_http_recv_resp(here_tracking_client* client,
                                                         uint8_t* recv_buffer,
                                                         size_t recv_buffer_size,
                                                         here_tracking_http_parser_evt_cb resp_cb,
-                                                        void* resp_cb_data);
+                                                        void* resp_cb_data,
+                                                        uint32_t request_deadline,
+                                                        uint32_t* in_size,
+                                                        bool* reusable);
+
+static uint32_t here_tracking_http_deadline(uint32_t timeout, uint32_t request_deadline);
+
+static void here_tracking_http_io_buffers(const here_tracking_client* client,
+                                          uint8_t* default_buffer,
+                                          here_tracking_io_buffers* io_buffers);
+
+static bool here_tracking_http_deadline_passed(uint32_t deadline);
+
+static here_tracking_error here_tracking_http_set_deadline(here_tracking_client* client,
+                                                           uint32_t timeout,
+                                                           uint32_t request_deadline);
+
+static bool here_tracking_http_drain_cb(const here_tracking_http_parser_evt* evt,
+                                        bool last,
+                                        void* cb_data);
 
 static void here_tracking_http_auth_data_init(here_tracking_http_auth_data* auth_data,
                                               here_tracking_client* client);
 
+static void here_tracking_http_clear_token(here_tracking_client* client);
+
 static bool here_tracking_http_auth_done(here_tracking_http_auth_data* auth_data);
 
 static here_tracking_error here_tracking_http_status_code_to_err(uint16_t http_status_code);
@@ -146,6 +196,12 @@ static here_tracking_error here_tracking_http_send_chunk(here_tracking_tls_write
                                                          const uint8_t* chunk_data,
                                                          size_t chunk_size);
 
+static here_tracking_error here_tracking_http_write_body_data(here_tracking_tls_writer* tls_writer,
+                                                              here_tracking_client* client,
+                                                              here_tracking_http_h2_ctx* h2_ctx,
+                                                              const uint8_t* data,
+                                                              size_t data_size);
+
 static here_tracking_error here_tracking_http_send_cb(const uint8_t** data,
                                                       size_t* data_size,
                                                       void* user_data);
@@ -153,93 +209,161 @@ static here_tracking_error here_tracking_http_send_cb(const uint8_t** data,
 static here_tracking_error here_tracking_http_recv_cb(const here_tracking_recv_data* data,
                                                       void* user_data);
 
+static here_tracking_error here_tracking_http_write_auth_req(here_tracking_tls_writer* tls_writer,
+                                                             here_tracking_client* client);
+
+static here_tracking_error \
+    here_tracking_http_write_send_stream_hdr(here_tracking_tls_writer* tls_writer,
+                                             here_tracking_client* client,
+                                             here_tracking_req_type req_type,
+                                             here_tracking_resp_type resp_type,
+                                             const char* connection,
+                                             const here_tracking_codec* codec);
+
+static here_tracking_error \
+    here_tracking_http_write_static_hdr(here_tracking_tls_writer* tls_writer,
+                                        const here_tracking_client* client,
+                                        here_tracking_req_type req_type,
+                                        here_tracking_resp_type resp_type);
+
+static here_tracking_error \
+    here_tracking_http_write_cached_hdr(here_tracking_tls_writer* tls_writer,
+                                        here_tracking_client* client,
+                                        here_tracking_req_type req_type,
+                                        here_tracking_resp_type resp_type);
+
+static here_tracking_error \
+    here_tracking_http_write_send_stream_body(here_tracking_tls_writer* tls_writer,
+                                              here_tracking_client* client,
+                                              here_tracking_send_cb send_cb,
+                                              void* user_data,
+                                              uint32_t request_deadline,
+                                              here_tracking_http_h2_ctx* h2_ctx);
+
+static here_tracking_error \
+    here_tracking_http_write_encoded_body(here_tracking_tls_writer* tls_writer,
+                                          here_tracking_client* client,
+                                          here_tracking_send_cb send_cb,
+                                          void* user_data,
+                                          uint32_t request_deadline,
+                                          here_tracking_http_h2_ctx* h2_ctx);
+
 static here_tracking_error \
     here_tracking_http_get_write_auth_header(here_tracking_tls_writer* tls_writer,
                                              const here_tracking_http_header* auth_header);
 
 
 static here_tracking_error here_tracking_http_get_correlation_id(here_tracking_client* client,
-                                                                 char* buffer, size_t buff_size);
+                                                                 char* buffer, size_t buff_size,
+                                                                 const char** correlation_id);
+
+static here_tracking_error here_tracking_http_auth_h2(here_tracking_client* client,
+                                                      uint32_t request_deadline);
+
+static here_tracking_error \
+    here_tracking_http_send_stream_pipelined_h2(here_tracking_client* client,
+                                                const here_tracking_stream_req* reqs,
+                                                uint8_t req_count,
+                                                uint8_t* completed,
+                                                uint32_t request_deadline);
+
+static here_tracking_error here_tracking_http_get_h2(here_tracking_client* client,
+                                                     const here_tracking_http_request* request,
+                                                     here_tracking_recv_cb recv_cb,
+                                                     void* user_data,
+                                                     uint32_t request_deadline);
+
+static here_tracking_error here_tracking_http_h2_begin(here_tracking_client* client,
+                                                       here_tracking_http_h2_ctx* h2_ctx,
+                                                       here_tracking_tls_writer* tls_writer,
+                                                       uint8_t* tls_buffer,
+                                                       uint8_t* h2_buffer,
+                                                       uint32_t request_deadline);
+
+static void here_tracking_http_h2_end(here_tracking_client* client,
+                                      here_tracking_http_h2_ctx* h2_ctx,
+                                      here_tracking_error err);
+
+static here_tracking_error here_tracking_http_h2_read(here_tracking_client* client,
+                                                      here_tracking_http_h2_ctx* h2_ctx);
+
+static here_tracking_error here_tracking_http_h2_recv(here_tracking_client* client,
+                                                      here_tracking_http_h2_ctx* h2_ctx);
+
+static here_tracking_error \
+    here_tracking_http_write_h2_auth_hdr(here_tracking_tls_writer* tls_writer,
+                                         here_tracking_client* client,
+                                         const here_tracking_http2_stream* stream);
+
+static here_tracking_error \
+    here_tracking_http_write_h2_send_stream_hdr(here_tracking_tls_writer* tls_writer,
+                                                here_tracking_client* client,
+                                                const here_tracking_http2_stream* stream,
+                                                here_tracking_req_type req_type,
+                                                here_tracking_resp_type resp_type,
+                                                bool decode);
+
+static here_tracking_error \
+    here_tracking_http_write_h2_get_hdr(here_tracking_tls_writer* tls_writer,
+                                        here_tracking_client* client,
+                                        const here_tracking_http2_stream* stream,
+                                        const here_tracking_http_request* request);
+
+static here_tracking_error here_tracking_http_async_connect(here_tracking_http_async* async);
+
+static here_tracking_error here_tracking_http_async_connecting(here_tracking_http_async* async);
+
+static here_tracking_error here_tracking_http_async_request(here_tracking_http_async* async);
+
+static here_tracking_error here_tracking_http_async_write(here_tracking_http_async* async);
+
+static void here_tracking_http_async_set_out(here_tracking_http_async* async,
+                                             const uint8_t* data,
+                                             size_t data_size);
+
+static here_tracking_error here_tracking_http_async_send_hdr(here_tracking_http_async* async);
+
+static here_tracking_error here_tracking_http_async_send_body(here_tracking_http_async* async);
+
+static void here_tracking_http_async_recv_init(here_tracking_http_async* async);
+
+static here_tracking_error here_tracking_http_async_recv(here_tracking_http_async* async);
+
+static void here_tracking_http_async_recv_done(here_tracking_http_async* async,
+                                               here_tracking_error err);
+
+static void here_tracking_http_async_finish(here_tracking_http_async* async,
+                                            here_tracking_error result);
 
 
 /**************************************************************************************************/
 
 here_tracking_error here_tracking_http_auth(here_tracking_client* client)
 {
+    uint32_t request_deadline = here_tracking_http_deadline(client->timeouts.request_timeout, 0);
     here_tracking_error err = here_tracking_http_connect(client,
                                                          client->base_url,
-                                                         HERE_TRACKING_HTTP_PORT_HTTPS);
+                                                         HERE_TRACKING_HTTP_PORT_HTTPS,
+                                                         request_deadline);
 
-    if(err == HERE_TRACKING_OK)
+    if(err == HERE_TRACKING_OK && client->http2.active)
+    {
+        err = here_tracking_http_auth_h2(client, request_deadline);
+    }
+    else if(err == HERE_TRACKING_OK)
     {
         here_tracking_tls_writer tls_writer;
         uint8_t tls_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
-        uint8_t oauth_buffer[HERE_TRACKING_OAUTH_MIN_OUT_SIZE];
-        uint32_t oauth_size = HERE_TRACKING_OAUTH_MIN_OUT_SIZE;
-        char correlation_id[HERE_TRACKING_UUID_SIZE];
+        here_tracking_io_buffers io_buffers;
         here_tracking_http_auth_data auth_data;
+        bool reusable = false;
 
+        here_tracking_http_io_buffers(client, tls_buffer, &io_buffers);
         TRY((here_tracking_tls_writer_init(&tls_writer,
                                            client->tls,
-                                           tls_buffer,
-                                           HERE_TRACKING_HTTP_TLS_BUFFER_SIZE)));
-
-        /* HTTP request line */
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_method_post)));
-        TRY((here_tracking_tls_writer_write_char(&tls_writer, ' ')));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer,
-                                                   here_tracking_http_path_version)));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer,
-                                                   here_tracking_http_path_token)));
-        TRY((here_tracking_tls_writer_write_char(&tls_writer, ' ')));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_version)));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_crlf)));
-
-        /* Host header */
-        HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                        here_tracking_http_header_host,
-                                        client->base_url);
-
-        /* Connection header */
-        HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                        here_tracking_http_header_connection,
-                                        here_tracking_http_connection_close);
-
-        /* Content length header */
-        HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer, here_tracking_http_header_content_length, "0");
-
-        /* Correlation id header */
-        if(here_tracking_http_get_correlation_id(client, correlation_id, HERE_TRACKING_UUID_SIZE)
-           == HERE_TRACKING_OK)
-        {
-            HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                            here_tracking_http_header_x_request_id,
-                                            correlation_id);
-            HERE_TRACKING_LOGI("Auth req with id: %s", correlation_id);
-        }
-
-        if(client->user_agent != NULL && strlen(client->user_agent) > 0)
-        {
-            HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                            here_tracking_http_header_user_agent,
-                                            client->user_agent);
-        }
-
-        /* Authorization header */
-        TRY((here_tracking_tls_writer_write_string(&tls_writer,
-                                                   here_tracking_http_header_authorization)));
-        TRY((here_tracking_tls_writer_write_char(&tls_writer, ':')));
-        TRY((here_tracking_oauth_create_header(client->device_id,
-                                               client->device_secret,
-                                               client->base_url,
-                                               client->srv_time_diff,
-                                               (char*)oauth_buffer,
-                                               &oauth_size)));
-        TRY((here_tracking_tls_writer_write_data(&tls_writer, oauth_buffer, oauth_size)));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_crlf)));
-
-        /* Complete header section */
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_crlf)));
+                                           io_buffers.send_buffer,
+                                           io_buffers.send_buffer_size)));
+        TRY((here_tracking_http_write_auth_req(&tls_writer, client)));
 
         /* Flush remaining data */
         TRY((here_tracking_tls_writer_flush(&tls_writer)));
@@ -247,10 +371,13 @@ here_tracking_error here_tracking_http_auth(here_tracking_client* client)
         /* Finally set up response handler and read the response */
         here_tracking_http_auth_data_init(&auth_data, client);
         err = here_tracking_http_recv_resp(client,
-                                           tls_buffer,
-                                           HERE_TRACKING_HTTP_TLS_BUFFER_SIZE,
+                                           io_buffers.recv_buffer,
+                                           io_buffers.recv_buffer_size,
                                            here_tracking_http_auth_resp_cb,
-                                           (void*)(&auth_data));
+                                           (void*)(&auth_data),
+                                           request_deadline,
+                                           NULL,
+                                           &reusable);
 
         if(err == HERE_TRACKING_OK || err == HERE_TRACKING_ERROR_CLIENT_INTERRUPT)
         {
@@ -258,7 +385,7 @@ here_tracking_error here_tracking_http_auth(here_tracking_client* client)
         }
 
 here_tracking_http_error:
-        here_tracking_tls_close(client->tls);
+        here_tracking_http_release(client, reusable);
     }
 
     return err;
@@ -317,136 +444,201 @@ here_tracking_error here_tracking_http_send_stream(here_tracking_client* client,
                                              here_tracking_resp_type resp_type,
                                              void* user_data)
 {
+    uint32_t request_deadline = here_tracking_http_deadline(client->timeouts.request_timeout, 0);
     here_tracking_error err = here_tracking_http_connect(client,
                                                          client->base_url,
-                                                         HERE_TRACKING_HTTP_PORT_HTTPS);
+                                                         HERE_TRACKING_HTTP_PORT_HTTPS,
+                                                         request_deadline);
 
-    if(err == HERE_TRACKING_OK)
+    if(err == HERE_TRACKING_OK && client->http2.active)
+    {
+        here_tracking_stream_req req;
+        uint8_t completed;
+
+        req.send_cb = send_cb;
+        req.recv_cb = recv_cb;
+        req.req_type = req_type;
+        req.resp_type = resp_type;
+        req.user_data = user_data;
+        err = here_tracking_http_send_stream_pipelined_h2(client,
+                                                          &req,
+                                                          1,
+                                                          &completed,
+                                                          request_deadline);
+
+        if(err == HERE_TRACKING_OK && completed == 0)
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+    else if(err == HERE_TRACKING_OK)
     {
         here_tracking_tls_writer tls_writer;
         uint8_t tls_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
-        char correlation_id[HERE_TRACKING_UUID_SIZE];
+        here_tracking_io_buffers io_buffers;
         here_tracking_http_recv_ctx recv_ctx;
-        const uint8_t* data;
-        size_t data_size;
+        bool reusable = false;
 
+        here_tracking_http_io_buffers(client, tls_buffer, &io_buffers);
         TRY((here_tracking_tls_writer_init(&tls_writer,
                                            client->tls,
-                                           tls_buffer,
-                                           HERE_TRACKING_HTTP_TLS_BUFFER_SIZE)));
-
-        /* HTTP request line */
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_method_post)));
-        TRY((here_tracking_tls_writer_write_char(&tls_writer, ' ')));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer,
-                                                   here_tracking_http_path_version)));
-        TRY((here_tracking_tls_writer_write_char(&tls_writer, '/')));
+                                           io_buffers.send_buffer,
+                                           io_buffers.send_buffer_size)));
+        TRY((here_tracking_http_write_send_stream_hdr(&tls_writer,
+                                                      client,
+                                                      req_type,
+                                                      resp_type,
+                                                      here_tracking_http_connection_hdr_val(
+                                                          client),
+                                                      client->codec)));
+        TRY((here_tracking_http_write_send_stream_body(&tls_writer,
+                                                       client,
+                                                       send_cb,
+                                                       user_data,
+                                                       request_deadline,
+                                                       NULL)));
 
-        if(resp_type == HERE_TRACKING_RESP_STATUS_ONLY)
-        {
-            TRY((here_tracking_tls_writer_write_string(&tls_writer,
-                                                       here_tracking_http_query_async)));
-        }
+        /* Flush remaining data */
+        TRY((here_tracking_tls_writer_flush(&tls_writer)));
 
-        TRY((here_tracking_tls_writer_write_char(&tls_writer, ' ')));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_version)));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_crlf)));
+        /* Finally set up response handler and read the response */
+        recv_ctx.client = client;
+        recv_ctx.status_code = HERE_TRACKING_ERROR;
+        recv_ctx.recv_cb = recv_cb;
+        recv_ctx.user_data = user_data;
+        recv_ctx.codec = client->codec;
 
-        /* HTTP headers */
-        HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                        here_tracking_http_header_host,
-                                        client->base_url);
-        HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                        here_tracking_http_header_connection,
-                                        here_tracking_http_connection_close);
-        HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                        here_tracking_http_header_transfer_encoding,
-                                        here_tracking_http_transfer_encoding_chunked);
+        err = here_tracking_http_recv_resp(client,
+                                           io_buffers.recv_buffer,
+                                           io_buffers.recv_buffer_size,
+                                           here_tracking_http_send_resp_cb,
+                                           &recv_ctx,
+                                           request_deadline,
+                                           NULL,
+                                           &reusable);
 
-        if(req_type == HERE_TRACKING_REQ_DATA_PROTOBUF)
-        {
-            HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                            here_tracking_http_header_content_type,
-                                            here_tracking_http_content_type_octet_stream);
-        }
-        else
+        if(err == HERE_TRACKING_ERROR_CLIENT_INTERRUPT)
         {
-            HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                            here_tracking_http_header_content_type,
-                                            here_tracking_http_content_type_json);
+            err = HERE_TRACKING_OK;
         }
 
-        if(resp_type == HERE_TRACKING_RESP_WITH_DATA_PROTOBUF)
+        if(recv_ctx.status_code == HERE_TRACKING_ERROR_UNAUTHORIZED ||
+           recv_ctx.status_code == HERE_TRACKING_ERROR_FORBIDDEN)
         {
-            HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                            here_tracking_http_header_accept,
-                                            here_tracking_http_content_type_octet_stream);
+            here_tracking_http_clear_token(client);
         }
 
-        if(here_tracking_http_get_correlation_id(client, correlation_id, HERE_TRACKING_UUID_SIZE)
-           == HERE_TRACKING_OK)
-        {
-            HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                            here_tracking_http_header_x_request_id,
-                                            correlation_id);
-            HERE_TRACKING_LOGI("Send req with id: %s", correlation_id);
-        }
+here_tracking_http_error:
+        here_tracking_http_release(client, reusable);
+    }
 
-        if(client->user_agent != NULL && strlen(client->user_agent) > 0)
-        {
-            HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
-                                            here_tracking_http_header_user_agent,
-                                            client->user_agent);
-        }
+    return err;
+}
 
-        /* Construct authorization header */
-        TRY((here_tracking_tls_writer_write_string(&tls_writer,
-                                                   here_tracking_http_header_authorization)));
-        TRY((here_tracking_tls_writer_write_char(&tls_writer, ':')));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_header_bearer)));
-        TRY((here_tracking_tls_writer_write_char(&tls_writer, ' ')));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, client->access_token)));
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_crlf)));
+/**************************************************************************************************/
 
-        /* Complete header section */
-        TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_crlf)));
+here_tracking_error here_tracking_http_send_stream_pipelined(here_tracking_client* client,
+                                                             const here_tracking_stream_req* reqs,
+                                                             uint8_t req_count,
+                                                             uint8_t* completed)
+{
+    uint32_t request_deadline = here_tracking_http_deadline(client->timeouts.request_timeout, 0);
+    here_tracking_error err = here_tracking_http_connect(client,
+                                                         client->base_url,
+                                                         HERE_TRACKING_HTTP_PORT_HTTPS,
+                                                         request_deadline);
 
-        /* Read and send data chunks from io context */
-        do
+    (*completed) = 0;
+
+    if(err == HERE_TRACKING_OK && client->http2.active)
+    {
+        err = here_tracking_http_send_stream_pipelined_h2(client,
+                                                          reqs,
+                                                          req_count,
+                                                          completed,
+                                                          request_deadline);
+    }
+    else if(err == HERE_TRACKING_OK)
+    {
+        here_tracking_tls_writer tls_writer;
+        uint8_t tls_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
+        here_tracking_io_buffers io_buffers;
+        here_tracking_http_recv_ctx recv_ctx;
+        uint32_t in_size = 0;
+        uint8_t i;
+        bool keep_alive = true;
+        bool reusable = false;
+
+        here_tracking_http_io_buffers(client, tls_buffer, &io_buffers);
+        TRY((here_tracking_tls_writer_init(&tls_writer,
+                                           client->tls,
+                                           io_buffers.send_buffer,
+                                           io_buffers.send_buffer_size)));
+
+        /* All requests are written before reading any response so that they share one round
+           trip. Only the last request may ask the server to close the connection. */
+        for(i = 0; i < req_count; ++i)
         {
-            TRY((send_cb(&data, &data_size, user_data)));
-            TRY((here_tracking_http_send_chunk(&tls_writer, data, data_size)));
-        } while(data != NULL && data_size > 0);
+            const char* connection = (i + 1 < req_count) ?
+                here_tracking_http_connection_keep_alive :
+                here_tracking_http_connection_hdr_val(client);
+
+            TRY((here_tracking_http_write_send_stream_hdr(&tls_writer,
+                                                          client,
+                                                          reqs[i].req_type,
+                                                          reqs[i].resp_type,
+                                                          connection,
+                                                          client->codec)));
+            TRY((here_tracking_http_write_send_stream_body(&tls_writer,
+                                                           client,
+                                                           reqs[i].send_cb,
+                                                           reqs[i].user_data,
+                                                           request_deadline,
+                                                           NULL)));
+        }
 
         /* Flush remaining data */
         TRY((here_tracking_tls_writer_flush(&tls_writer)));
 
-        /* Finally set up response handler and read the response */
-        recv_ctx.client = client;
-        recv_ctx.status_code = HERE_TRACKING_ERROR;
-        recv_ctx.recv_cb = recv_cb;
-        recv_ctx.user_data = user_data;
+        /* Responses arrive in the order of the requests. If the server closes the connection
+           after a response, the requests after it were not processed. */
+        for(i = 0; i < req_count && keep_alive; ++i)
+        {
+            recv_ctx.client = client;
+            recv_ctx.status_code = HERE_TRACKING_ERROR;
+            recv_ctx.recv_cb = reqs[i].recv_cb;
+            recv_ctx.user_data = reqs[i].user_data;
+            recv_ctx.codec = client->codec;
+
+            err = here_tracking_http_recv_resp(client,
+                                               io_buffers.recv_buffer,
+                                               io_buffers.recv_buffer_size,
+                                               here_tracking_http_send_resp_cb,
+                                               &recv_ctx,
+                                               request_deadline,
+                                               &in_size,
+                                               &keep_alive);
+
+            if(err == HERE_TRACKING_ERROR_CLIENT_INTERRUPT)
+            {
+                err = HERE_TRACKING_OK;
+            }
 
-        err = here_tracking_http_recv_resp(client,
-                                           tls_buffer,
-                                           HERE_TRACKING_HTTP_TLS_BUFFER_SIZE,
-                                           here_tracking_http_send_resp_cb,
-                                           &recv_ctx);
+            if(recv_ctx.status_code == HERE_TRACKING_ERROR_UNAUTHORIZED ||
+               recv_ctx.status_code == HERE_TRACKING_ERROR_FORBIDDEN)
+            {
+                here_tracking_http_clear_token(client);
+            }
 
-        if(err == HERE_TRACKING_ERROR_CLIENT_INTERRUPT)
-        {
-            err = HERE_TRACKING_OK;
+            TRY(err);
+            (*completed)++;
         }
 
-        if(recv_ctx.status_code == HERE_TRACKING_ERROR_UNAUTHORIZED ||
-           recv_ctx.status_code == HERE_TRACKING_ERROR_FORBIDDEN)
-        {
-            client->access_token[0] = '\0';
-            client->token_expiry = 0;
-        }
+        /* Connection can be reused only if all responses were read and nothing was left over */
+        reusable = (keep_alive && in_size == 0 && (*completed) == req_count);
 
 here_tracking_http_error:
-        here_tracking_tls_close(client->tls);
+        here_tracking_http_release(client, reusable);
     }
 
     return err;
@@ -460,6 +652,7 @@ here_tracking_error here_tracking_http_get(here_tracking_client* client,
                                            void* user_data)
 {
     here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    uint32_t request_deadline = 0;
 
     if(client != NULL &&
        request != NULL &&
@@ -467,23 +660,32 @@ here_tracking_error here_tracking_http_get(here_tracking_client* client,
        request->path != NULL &&
        recv_cb != NULL)
     {
-        err = here_tracking_http_connect(client, request->host, request->port);
+        request_deadline = here_tracking_http_deadline(client->timeouts.request_timeout, 0);
+        err = here_tracking_http_connect(client, request->host, request->port, request_deadline);
     }
 
-    if(err == HERE_TRACKING_OK)
+    if(err == HERE_TRACKING_OK && client->http2.active)
+    {
+        err = here_tracking_http_get_h2(client, request, recv_cb, user_data, request_deadline);
+    }
+    else if(err == HERE_TRACKING_OK)
     {
         here_tracking_tls_writer tls_writer;
         uint8_t tls_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
-        char correlation_id[HERE_TRACKING_UUID_SIZE];
+        here_tracking_io_buffers io_buffers;
+        char correlation_id_buffer[HERE_TRACKING_UUID_SIZE];
+        const char* correlation_id;
         here_tracking_http_recv_ctx recv_ctx;
         uint8_t i;
         bool user_agent_present = false;
         bool correlation_id_present = false;
+        bool reusable = false;
 
+        here_tracking_http_io_buffers(client, tls_buffer, &io_buffers);
         TRY((here_tracking_tls_writer_init(&tls_writer,
                                            client->tls,
-                                           tls_buffer,
-                                           HERE_TRACKING_HTTP_TLS_BUFFER_SIZE)));
+                                           io_buffers.send_buffer,
+                                           io_buffers.send_buffer_size)));
 
         /* HTTP request line */
         TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_method_get)));
@@ -494,6 +696,9 @@ here_tracking_error here_tracking_http_get(here_tracking_client* client,
         TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_crlf)));
 
         /* HTTP headers */
+        HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
+                                        here_tracking_http_header_connection,
+                                        here_tracking_http_connection_hdr_val(client));
 
         /* Construct host header */
         TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_header_host)));
@@ -536,8 +741,9 @@ here_tracking_error here_tracking_http_get(here_tracking_client* client,
 
         if(!correlation_id_present &&
            here_tracking_http_get_correlation_id(client,
-                                                 correlation_id,
-                                                 HERE_TRACKING_UUID_SIZE) == HERE_TRACKING_OK)
+                                                 correlation_id_buffer,
+                                                 HERE_TRACKING_UUID_SIZE,
+                                                 &correlation_id) == HERE_TRACKING_OK)
         {
             HERE_TRACKING_HTTP_WRITE_HEADER(&tls_writer,
                                             here_tracking_http_header_x_request_id,
@@ -563,12 +769,16 @@ here_tracking_error here_tracking_http_get(here_tracking_client* client,
         recv_ctx.status_code = HERE_TRACKING_ERROR;
         recv_ctx.recv_cb = recv_cb;
         recv_ctx.user_data = user_data;
+        recv_ctx.codec = NULL;
 
         err = here_tracking_http_recv_resp(client,
-                                           tls_buffer,
-                                           HERE_TRACKING_HTTP_TLS_BUFFER_SIZE,
+                                           io_buffers.recv_buffer,
+                                           io_buffers.recv_buffer_size,
                                            here_tracking_http_send_resp_cb,
-                                           &recv_ctx);
+                                           &recv_ctx,
+                                           request_deadline,
+                                           NULL,
+                                           &reusable);
 
         if(err == HERE_TRACKING_ERROR_CLIENT_INTERRUPT)
         {
@@ -576,7 +786,7 @@ here_tracking_error here_tracking_http_get(here_tracking_client* client,
         }
 
 here_tracking_http_error:
-        here_tracking_tls_close(client->tls);
+        here_tracking_http_release(client, reusable);
     }
 
     return err;
@@ -584,54 +794,282 @@ here_tracking_http_error:
 
 /**************************************************************************************************/
 
-static bool here_tracking_http_auth_resp_cb(const here_tracking_http_parser_evt* evt,
-                                            bool last,
-                                            void* cb_data)
+here_tracking_error here_tracking_http_prewarm(here_tracking_client* client)
 {
-    here_tracking_http_auth_data* auth_data = (here_tracking_http_auth_data*)cb_data;
-    bool res = false;
+    uint32_t request_deadline = here_tracking_http_deadline(client->timeouts.request_timeout, 0);
+    here_tracking_error err = here_tracking_http_connect(client,
+                                                         client->base_url,
+                                                         HERE_TRACKING_HTTP_PORT_HTTPS,
+                                                         request_deadline);
 
-    switch(evt->id)
+    if(err == HERE_TRACKING_OK)
     {
-        case HERE_TRACKING_HTTP_PARSER_EVT_STATUS_CODE:
+        /* Nothing was sent, the connection stays open for the next request and its idle time
+           starts now. */
+        here_tracking_http_release(client, true);
+        err = client->keep_alive.connected ? HERE_TRACKING_OK : HERE_TRACKING_ERROR;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http_send_stream_async(here_tracking_http_async* async,
+                                                         here_tracking_client* client,
+                                                         bool auth,
+                                                         here_tracking_send_cb send_cb,
+                                                         here_tracking_recv_cb recv_cb,
+                                                         here_tracking_req_type req_type,
+                                                         here_tracking_resp_type resp_type,
+                                                         void* user_data)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(async != NULL && client != NULL && send_cb != NULL && recv_cb != NULL)
+    {
+        async->client = client;
+        async->state = HERE_TRACKING_HTTP_ASYNC_STATE_CONNECT;
+        async->result = HERE_TRACKING_ERROR_WOULD_BLOCK;
+        async->auth = auth;
+        async->auth_retried = false;
+        async->send_cb = send_cb;
+        async->req_type = req_type;
+        async->resp_type = resp_type;
+        async->recv_ctx.client = client;
+        async->recv_ctx.status_code = HERE_TRACKING_ERROR;
+        async->recv_ctx.recv_cb = recv_cb;
+        async->recv_ctx.user_data = user_data;
+        async->recv_ctx.codec = NULL;
+        async->in_pos = 0;
+        async->in_size = 0;
+        async->request_deadline =
+            here_tracking_http_deadline(client->timeouts.request_timeout, 0);
+        async->deadline = async->request_deadline;
+        async->step_deadline = 0;
+
+        if(auth)
         {
-            auth_data->status_code = here_tracking_http_status_code_to_err(evt->data.status_code);
+            here_tracking_http_clear_token(client);
         }
-        break;
 
-        case HERE_TRACKING_HTTP_PARSER_EVT_HDR:
-        {
-            if(auth_data->status_code == HERE_TRACKING_ERROR_UNAUTHORIZED)
-            {
-                const here_tracking_http_parser_evt_hdr* hdr = &(evt->data.hdr);
+        err = HERE_TRACKING_OK;
+    }
 
-                if(hdr->hdr_key_size == strlen(here_tracking_http_header_x_here_timestamp) &&
-                   here_tracking_utils_memcasecmp((const uint8_t*)hdr->hdr_key,
-                                        (const uint8_t*)here_tracking_http_header_x_here_timestamp,
-                                        hdr->hdr_key_size) == 0)
-                {
-                    uint32_t srv_time, pl_time;
+    return err;
+}
 
-                    if(here_tracking_get_unixtime(&pl_time) == HERE_TRACKING_OK)
-                    {
-                        srv_time = here_tracking_utils_atou(hdr->hdr_val, hdr->hdr_val_size);
-                        auth_data->client->srv_time_diff = srv_time - pl_time;
-                        auth_data->status_code = HERE_TRACKING_ERROR_TIME_MISMATCH;
-                        res = true;
-                    }
-                }
-            }
-        }
-        break;
+/**************************************************************************************************/
 
-        case HERE_TRACKING_HTTP_PARSER_EVT_BODY:
+here_tracking_error here_tracking_http_async_step(here_tracking_http_async* async)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(async != NULL)
+    {
+        err = HERE_TRACKING_OK;
+
+        /* Advance the request until it has to wait for the connection or is done */
+        while(err == HERE_TRACKING_OK && async->state != HERE_TRACKING_HTTP_ASYNC_STATE_DONE)
         {
-            if(auth_data->status_code == HERE_TRACKING_OK)
+            switch(async->state)
             {
-                uint32_t pos = 0, data_size = evt->data.body.buffer_size;
-                const char* data = evt->data.body.buffer;
+                case HERE_TRACKING_HTTP_ASYNC_STATE_CONNECT:
+                {
+                    err = here_tracking_http_async_connect(async);
+                }
+                break;
 
-                while(data_size - pos > 0)
+                case HERE_TRACKING_HTTP_ASYNC_STATE_CONNECTING:
+                {
+                    err = here_tracking_http_async_connecting(async);
+                }
+                break;
+
+                case HERE_TRACKING_HTTP_ASYNC_STATE_SEND_HDR:
+                {
+                    err = here_tracking_http_async_send_hdr(async);
+                }
+                break;
+
+                case HERE_TRACKING_HTTP_ASYNC_STATE_SEND_BODY:
+                {
+                    err = here_tracking_http_async_send_body(async);
+                }
+                break;
+
+                case HERE_TRACKING_HTTP_ASYNC_STATE_RECV:
+                {
+                    err = here_tracking_http_async_recv(async);
+                }
+                break;
+
+                default:
+                {
+                    err = HERE_TRACKING_ERROR;
+                }
+                break;
+            }
+        }
+
+        if(err == HERE_TRACKING_ERROR_WOULD_BLOCK &&
+           here_tracking_http_deadline_passed(async->deadline))
+        {
+            HERE_TRACKING_LOGE("Request timed out");
+            err = HERE_TRACKING_ERROR_TIMEOUT;
+        }
+
+        if(err != HERE_TRACKING_OK && err != HERE_TRACKING_ERROR_WOULD_BLOCK)
+        {
+            here_tracking_http_release(async->client, false);
+            here_tracking_http_async_finish(async, err);
+        }
+
+        if(async->state == HERE_TRACKING_HTTP_ASYNC_STATE_DONE)
+        {
+            err = async->result;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http_async_get_poll_info(const here_tracking_http_async* async,
+                                                           int* fd,
+                                                           uint8_t* events)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(async != NULL && fd != NULL && events != NULL)
+    {
+        if(async->state == HERE_TRACKING_HTTP_ASYNC_STATE_DONE || async->client->tls == NULL)
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+        else
+        {
+            err = here_tracking_tls_get_poll_info(async->client->tls, fd, events);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http_async_get_timeout(const here_tracking_http_async* async,
+                                                         int32_t* timeout)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+    uint32_t now;
+
+    if(async != NULL && timeout != NULL)
+    {
+        uint32_t deadline = async->deadline;
+
+        err = HERE_TRACKING_OK;
+
+        if(async->state == HERE_TRACKING_HTTP_ASYNC_STATE_CONNECTING &&
+           async->step_deadline != 0 &&
+           (deadline == 0 || (int32_t)(async->step_deadline - deadline) < 0))
+        {
+            deadline = async->step_deadline;
+        }
+
+        if(deadline == 0 || async->state == HERE_TRACKING_HTTP_ASYNC_STATE_DONE)
+        {
+            (*timeout) = -1;
+        }
+        else if(here_tracking_get_monotonic_ms(&now) == HERE_TRACKING_OK)
+        {
+            (*timeout) = (int32_t)(deadline - now);
+
+            if((*timeout) < 0)
+            {
+                (*timeout) = 0;
+            }
+        }
+        else
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http_async_cancel(here_tracking_http_async* async)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(async != NULL)
+    {
+        if(async->state != HERE_TRACKING_HTTP_ASYNC_STATE_DONE)
+        {
+            here_tracking_http_release(async->client, false);
+            here_tracking_http_async_finish(async, HERE_TRACKING_ERROR_CLIENT_INTERRUPT);
+        }
+
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_http_auth_resp_cb(const here_tracking_http_parser_evt* evt,
+                                            bool last,
+                                            void* cb_data)
+{
+    here_tracking_http_auth_data* auth_data = (here_tracking_http_auth_data*)cb_data;
+    bool res = false;
+
+    switch(evt->id)
+    {
+        case HERE_TRACKING_HTTP_PARSER_EVT_STATUS_CODE:
+        {
+            auth_data->status_code = here_tracking_http_status_code_to_err(evt->data.status_code);
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_PARSER_EVT_HDR:
+        {
+            if(auth_data->status_code == HERE_TRACKING_ERROR_UNAUTHORIZED)
+            {
+                const here_tracking_http_parser_evt_hdr* hdr = &(evt->data.hdr);
+
+                if(hdr->hdr_key_size == strlen(here_tracking_http_header_x_here_timestamp) &&
+                   here_tracking_utils_memcasecmp((const uint8_t*)hdr->hdr_key,
+                                        (const uint8_t*)here_tracking_http_header_x_here_timestamp,
+                                        hdr->hdr_key_size) == 0)
+                {
+                    uint32_t srv_time, pl_time;
+
+                    if(here_tracking_get_unixtime(&pl_time) == HERE_TRACKING_OK)
+                    {
+                        srv_time = here_tracking_utils_atou(hdr->hdr_val, hdr->hdr_val_size);
+                        auth_data->client->srv_time_diff = srv_time - pl_time;
+                        auth_data->status_code = HERE_TRACKING_ERROR_TIME_MISMATCH;
+                        res = true;
+                    }
+                }
+            }
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_PARSER_EVT_BODY:
+        {
+            if(auth_data->status_code == HERE_TRACKING_OK)
+            {
+                uint32_t pos = 0, data_size = evt->data.body.buffer_size;
+                const char* data = evt->data.body.buffer;
+
+                while(data_size - pos > 0)
                 {
                     /*
                      * Auth data states:
@@ -765,6 +1203,7 @@ static bool here_tracking_http_send_resp_cb(const here_tracking_http_parser_evt*
                                             void* cb_data)
 {
     here_tracking_http_recv_ctx* recv_ctx = (here_tracking_http_recv_ctx*)cb_data;
+    const here_tracking_codec* codec = recv_ctx->codec;
     bool res = false;
 
     switch(evt->id)
@@ -772,6 +1211,9 @@ static bool here_tracking_http_send_resp_cb(const here_tracking_http_parser_evt*
         case HERE_TRACKING_HTTP_PARSER_EVT_STATUS_CODE:
         {
             recv_ctx->status_code = here_tracking_http_status_code_to_err(evt->data.status_code);
+            recv_ctx->decode = false;
+            recv_ctx->decode_end = false;
+            recv_ctx->size_pending = false;
         }
         break;
 
@@ -785,11 +1227,41 @@ static bool here_tracking_http_send_resp_cb(const here_tracking_http_parser_evt*
                                               hdr->hdr_key_size) == 0)
             {
                 uint32_t current_time;
+                uint32_t retry_after = here_tracking_utils_atou(hdr->hdr_val, hdr->hdr_val_size);
 
                 if(here_tracking_get_unixtime(&current_time) == HERE_TRACKING_OK)
                 {
-                    recv_ctx->client->retry_after =
-                        current_time + here_tracking_utils_atou(hdr->hdr_val, hdr->hdr_val_size);
+                    recv_ctx->client->retry_after = current_time + retry_after;
+                }
+
+                /* Other clients of the gateway are not paused */
+                if(recv_ctx->client->rate_limiter != NULL)
+                {
+                    (void)here_tracking_rate_limiter_pause(recv_ctx->client->rate_limiter,
+                                                           retry_after);
+                }
+            }
+            else if(codec != NULL &&
+                    codec->decode != NULL &&
+                    hdr->hdr_key_size == strlen(here_tracking_http_header_content_encoding) &&
+                    here_tracking_utils_memcasecmp(
+                        (const uint8_t*)hdr->hdr_key,
+                        (const uint8_t*)here_tracking_http_header_content_encoding,
+                        hdr->hdr_key_size) == 0 &&
+                    hdr->hdr_val_size == strlen(codec->content_encoding) &&
+                    here_tracking_utils_memcasecmp((const uint8_t*)hdr->hdr_val,
+                                                   (const uint8_t*)codec->content_encoding,
+                                                   hdr->hdr_val_size) == 0)
+            {
+                /* Other content codings are passed to the receive callback as they are */
+                if(codec->decode_begin(codec->codec_data) == HERE_TRACKING_OK)
+                {
+                    recv_ctx->decode = true;
+                }
+                else
+                {
+                    here_tracking_http_send_resp_complete(recv_ctx, HERE_TRACKING_ERROR);
+                    res = true;
                 }
             }
         }
@@ -799,24 +1271,40 @@ static bool here_tracking_http_send_resp_cb(const here_tracking_http_parser_evt*
         {
             here_tracking_recv_data data;
 
-            data.err = HERE_TRACKING_OK;
-            data.evt = HERE_TRACKING_RECV_EVT_RESP_DATA;
-            data.data = (uint8_t*)evt->data.body.buffer;
-            data.data_size = evt->data.body.buffer_size;
+            /* Size of an encoded body is not the size of the data passed to the callback */
+            if(recv_ctx->size_pending)
+            {
+                recv_ctx->size_pending = false;
+
+                if(!recv_ctx->decode)
+                {
+                    data.err = HERE_TRACKING_OK;
+                    data.evt = HERE_TRACKING_RECV_EVT_RESP_SIZE;
+                    data.data = NULL;
+                    data.data_size = recv_ctx->body_size;
+                    recv_ctx->recv_cb(&data, recv_ctx->user_data);
+                }
+            }
 
-            if(recv_ctx->recv_cb(&data, recv_ctx->user_data) != HERE_TRACKING_OK)
+            if(recv_ctx->decode)
             {
-                res = true;
-                break;
+                res = here_tracking_http_send_resp_decode(recv_ctx, &(evt->data.body), last);
+            }
+            else
+            {
+                data.err = HERE_TRACKING_OK;
+                data.evt = HERE_TRACKING_RECV_EVT_RESP_DATA;
+                data.data = (uint8_t*)evt->data.body.buffer;
+                data.data_size = evt->data.body.buffer_size;
+
+                /* End of a chunked body carries no data */
+                res = (data.data_size > 0 &&
+                       recv_ctx->recv_cb(&data, recv_ctx->user_data) != HERE_TRACKING_OK);
             }
 
-            if(last)
+            if(!res && last)
             {
-                data.err = recv_ctx->status_code;
-                data.evt = HERE_TRACKING_RECV_EVT_RESP_COMPLETE;
-                data.data = NULL;
-                data.data_size = 0;
-                recv_ctx->recv_cb(&data, recv_ctx->user_data);
+                here_tracking_http_send_resp_complete(recv_ctx, recv_ctx->status_code);
             }
         }
         break;
@@ -825,19 +1313,24 @@ static bool here_tracking_http_send_resp_cb(const here_tracking_http_parser_evt*
         {
             here_tracking_recv_data data;
 
-            data.err = HERE_TRACKING_OK;
-            data.evt = HERE_TRACKING_RECV_EVT_RESP_SIZE;
-            data.data = NULL;
-            data.data_size = evt->data.body_size;
-            recv_ctx->recv_cb(&data, recv_ctx->user_data);
-
-            if(evt->data.body_size == 0)
+            if(codec != NULL && codec->decode != NULL && evt->data.body_size > 0)
             {
-                data.err = recv_ctx->status_code;
-                data.evt = HERE_TRACKING_RECV_EVT_RESP_COMPLETE;
+                /* Content-Encoding may follow Content-Length, wait for the body */
+                recv_ctx->size_pending = true;
+                recv_ctx->body_size = evt->data.body_size;
+            }
+            else
+            {
+                data.err = HERE_TRACKING_OK;
+                data.evt = HERE_TRACKING_RECV_EVT_RESP_SIZE;
                 data.data = NULL;
-                data.data_size = 0;
+                data.data_size = evt->data.body_size;
                 recv_ctx->recv_cb(&data, recv_ctx->user_data);
+
+                if(evt->data.body_size == 0)
+                {
+                    here_tracking_http_send_resp_complete(recv_ctx, recv_ctx->status_code);
+                }
             }
         }
         break;
@@ -851,166 +1344,1793 @@ static bool here_tracking_http_send_resp_cb(const here_tracking_http_parser_evt*
 
 /**************************************************************************************************/
 
-static here_tracking_error here_tracking_http_connect(here_tracking_client* client,
-                                                      const char* host,
-                                                      uint16_t port)
-{
-    here_tracking_error err = HERE_TRACKING_OK;
-
-    if(client->tls == NULL)
-    {
-        err = here_tracking_tls_init(&(client->tls));
-    }
-
-    if(err == HERE_TRACKING_OK)
-    {
-        err = here_tracking_tls_connect(client->tls, host, port);
-    }
-
-    return err;
-}
-
-/**************************************************************************************************/
-
-static here_tracking_error here_tracking_http_recv_resp(here_tracking_client* client,
-                                                        uint8_t* recv_buffer,
-                                                        size_t recv_buffer_size,
-                                                        here_tracking_http_parser_evt_cb resp_cb,
-                                                        void* resp_cb_data)
+static bool here_tracking_http_send_resp_decode(here_tracking_http_recv_ctx* recv_ctx,
+                                                const here_tracking_http_parser_evt_body* body,
+                                                bool last)
 {
+    const here_tracking_codec* codec = recv_ctx->codec;
+    here_tracking_client* client = recv_ctx->client;
     here_tracking_error err = HERE_TRACKING_OK;
-    uint32_t size = (uint32_t)recv_buffer_size, parse_size, pos = 0;
-    here_tracking_http_parser parser;
+    here_tracking_recv_data data;
+    size_t pos = 0, in_size, out_size;
+    bool more = true, res = false;
 
-    TRY((here_tracking_tls_read(client->tls, (char*)recv_buffer, &size)));
-    here_tracking_http_parser_init(&parser, resp_cb, resp_cb_data);
-    parse_size = size;
-    err = here_tracking_http_parser_parse(&parser, (char*)recv_buffer, &parse_size);
+    data.err = HERE_TRACKING_OK;
+    data.evt = HERE_TRACKING_RECV_EVT_RESP_DATA;
+    data.data = client->codec_buffer;
 
-    while(err == HERE_TRACKING_ERROR_NEED_MORE_DATA && (size < recv_buffer_size || parse_size > 0))
+    /* Decoded data is passed to the callback one codec buffer at a time. Anything after the end
+       of the encoded data is ignored. */
+    while(err == HERE_TRACKING_OK && !res && more && !recv_ctx->decode_end)
     {
-        /* Move data that hasn't been parsed to the beginning of the work buffer */
-        memmove(recv_buffer,
-                (recv_buffer + parse_size),
-                size - parse_size);
-
-        pos = size - parse_size; /* Free space starts in this position */
-        size = (uint32_t)recv_buffer_size - pos; /* Free space available */
-
-        /* Read more data to the free space in work buffer */
-        TRY((here_tracking_tls_read(client->tls, ((char*)recv_buffer) + pos, &size)));
+        in_size = body->buffer_size - pos;
+        out_size = client->codec_buffer_size;
+        err = codec->decode((in_size > 0) ? ((const uint8_t*)body->buffer + pos) : NULL,
+                            &in_size,
+                            client->codec_buffer,
+                            &out_size,
+                            last,
+                            &recv_ctx->decode_end,
+                            codec->codec_data);
+        pos += in_size;
+
+        if(err == HERE_TRACKING_OK && out_size > 0)
+        {
+            data.data_size = out_size;
+            res = (recv_ctx->recv_cb(&data, recv_ctx->user_data) != HERE_TRACKING_OK);
+        }
 
-        size = parse_size = pos + size; /* Size of unparsed data in the work buffer */
+        if(err == HERE_TRACKING_OK &&
+           in_size == 0 &&
+           out_size == 0 &&
+           !recv_ctx->decode_end &&
+           (pos < body->buffer_size || last))
+        {
+            /* Decoder is stuck or the encoded data ended too early */
+            err = HERE_TRACKING_ERROR;
+        }
 
-        err = here_tracking_http_parser_parse(&parser, ((char*)recv_buffer), &parse_size);
+        /* A full buffer may leave decoded data in the codec */
+        more = (pos < body->buffer_size || out_size == client->codec_buffer_size || last);
     }
 
-    /* Parser requires more data to continue but work buffer is already full. */
-    if(err == HERE_TRACKING_ERROR_NEED_MORE_DATA)
+    if(err != HERE_TRACKING_OK)
     {
-        err = HERE_TRACKING_ERROR;
+        here_tracking_http_send_resp_complete(recv_ctx, err);
+        res = true;
     }
 
-here_tracking_http_error:
-    return err;
+    return res;
 }
 
 /**************************************************************************************************/
 
-static void here_tracking_http_auth_data_init(here_tracking_http_auth_data* auth_data,
-                                              here_tracking_client* client)
+static void here_tracking_http_send_resp_complete(here_tracking_http_recv_ctx* recv_ctx,
+                                                  here_tracking_error err)
 {
-    auth_data->client = client;
-    auth_data->state = HERE_TRACKING_HTTP_AUTH_FIND_KEY;
-    auth_data->chars = 0;
-    auth_data->status_code = HERE_TRACKING_ERROR;
-    auth_data->search_keys[0].key = here_tracking_http_access_token;
-    auth_data->search_keys[0].found = false;
-    auth_data->search_keys[0].chars = 0;
-    auth_data->search_keys[0].next_state = HERE_TRACKING_HTTP_AUTH_TOKEN_FIND_START;
-    auth_data->search_keys[1].key = here_tracking_http_expires_in;
-    auth_data->search_keys[1].found = false;
-    auth_data->search_keys[1].chars = 0;
-    auth_data->search_keys[1].next_state = HERE_TRACKING_HTTP_AUTH_EXPIRY_FIND_START;
+    here_tracking_recv_data data;
+
+    here_tracking_http_update_rate_limiters(recv_ctx->client, err);
+    data.err = err;
+    data.evt = HERE_TRACKING_RECV_EVT_RESP_COMPLETE;
+    data.data = NULL;
+    data.data_size = 0;
+    recv_ctx->recv_cb(&data, recv_ctx->user_data);
 }
 
 /**************************************************************************************************/
 
-static bool here_tracking_http_auth_done(here_tracking_http_auth_data* auth_data)
+static void here_tracking_http_update_rate_limiters(here_tracking_client* client,
+                                                    here_tracking_error err)
 {
-    uint8_t i;
-    bool all_found = true;
-
-    /* Done if all search keys have been found. */
-    for(i = 0; i < HERE_TRACKING_HTTP_AUTH_SEARCH_KEY_COUNT; ++i)
+    if(client->rate_limiter != NULL)
     {
-        if(!auth_data->search_keys[i].found)
-        {
-            auth_data->search_keys[i].chars = 0;
-            all_found = false;
-        }
+        (void)here_tracking_rate_limiter_update(client->rate_limiter, err);
     }
 
-    return all_found;
+    if(client->gateway_rate_limiter != NULL)
+    {
+        (void)here_tracking_rate_limiter_update(client->gateway_rate_limiter, err);
+    }
 }
 
 /**************************************************************************************************/
 
-static here_tracking_error here_tracking_http_status_code_to_err(uint16_t http_status_code)
+static here_tracking_error here_tracking_http_connect(here_tracking_client* client,
+                                                      const char* host,
+                                                      uint16_t port,
+                                                      uint32_t request_deadline)
 {
-    here_tracking_error err;
+    here_tracking_error err = HERE_TRACKING_OK;
 
-    switch(http_status_code)
+    if(!here_tracking_http_reuse_connection(client, host, port, false))
     {
-        case HERE_TRACKING_HTTP_STATUS_OK:
-            /* fall through */
-        case HERE_TRACKING_HTTP_STATUS_NO_CONTENT:
+        if(client->tls == NULL)
         {
-            err = HERE_TRACKING_OK;
+            err = here_tracking_tls_init(&(client->tls), client->tls_env);
         }
-        break;
 
-        case HERE_TRACKING_HTTP_STATUS_BAD_REQUEST:
+        if(err == HERE_TRACKING_OK)
         {
-            err = HERE_TRACKING_ERROR_BAD_REQUEST;
+            err = here_tracking_http_set_deadline(client,
+                                                  client->timeouts.connect_timeout,
+                                                  request_deadline);
         }
-        break;
 
-        case HERE_TRACKING_HTTP_STATUS_UNAUTHORIZED:
+        if(err == HERE_TRACKING_OK)
         {
-            err = HERE_TRACKING_ERROR_UNAUTHORIZED;
+            /* HTTP/2 is used only if the server selects it during the handshake */
+            err = here_tracking_tls_set_alpn(client->tls,
+                                             client->http2.enabled ?
+                                                 here_tracking_http2_alpn : NULL);
         }
-        break;
 
-        case HERE_TRACKING_HTTP_STATUS_FORBIDDEN:
+        if(err == HERE_TRACKING_OK)
         {
-            err = HERE_TRACKING_ERROR_FORBIDDEN;
+            err = here_tracking_tls_connect(client->tls, host, port);
         }
-        break;
 
-        case HERE_TRACKING_HTTP_STATUS_NOT_FOUND:
+        if(err == HERE_TRACKING_OK)
         {
-            err = HERE_TRACKING_ERROR_NOT_FOUND;
+            const char* protocol = NULL;
+
+            /* Server that doesn't support ALPN or HTTP/2 is used with HTTP/1.1 */
+            client->http2.active = (client->http2.enabled &&
+                                    here_tracking_tls_get_alpn(client->tls,
+                                                               &protocol) == HERE_TRACKING_OK &&
+                                    protocol == here_tracking_http2_alpn[0]);
+
+            if(client->http2.active)
+            {
+                here_tracking_http2_conn_init(&client->http2);
+            }
+        }
+
+        if(err == HERE_TRACKING_OK &&
+           client->keep_alive.enabled &&
+           strcmp(host, client->base_url) == 0)
+        {
+            client->keep_alive.connected = true;
+            client->keep_alive.port = port;
+            client->keep_alive.non_blocking = false;
+        }
+    }
+
+    if(err == HERE_TRACKING_OK)
+    {
+        /* Request is written right after connecting */
+        err = here_tracking_http_set_deadline(client,
+                                              client->timeouts.io_timeout,
+                                              request_deadline);
+
+        if(err != HERE_TRACKING_OK)
+        {
+            here_tracking_http_release(client, false);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_http_reuse_connection(here_tracking_client* client,
+                                                const char* host,
+                                                uint16_t port,
+                                                bool non_blocking)
+{
+    if(client->keep_alive.connected)
+    {
+        uint32_t ts;
+
+        /* Reuse the open connection if it is to the same endpoint in the same I/O mode, hasn't
+           been idle for too long and hasn't been closed by the server in the meantime. */
+        if(client->keep_alive.enabled &&
+           strcmp(host, client->base_url) == 0 &&
+           client->keep_alive.port == port &&
+           client->keep_alive.non_blocking == non_blocking &&
+           here_tracking_get_unixtime(&ts) == HERE_TRACKING_OK &&
+           ts - client->keep_alive.last_used < client->keep_alive.idle_timeout &&
+           here_tracking_tls_check_connection(client->tls) == HERE_TRACKING_OK)
+        {
+            HERE_TRACKING_LOGI("Reusing connection");
+        }
+        else
+        {
+            here_tracking_tls_close(client->tls);
+            client->keep_alive.connected = false;
+        }
+    }
+
+    return client->keep_alive.connected;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http_release(here_tracking_client* client, bool reusable)
+{
+    uint32_t ts;
+
+    if(client->keep_alive.connected &&
+       client->keep_alive.enabled &&
+       reusable &&
+       here_tracking_get_unixtime(&ts) == HERE_TRACKING_OK)
+    {
+        client->keep_alive.last_used = ts;
+    }
+    else
+    {
+        here_tracking_tls_close(client->tls);
+        client->keep_alive.connected = false;
+    }
+}
+
+/**************************************************************************************************/
+
+static const char* here_tracking_http_connection_hdr_val(const here_tracking_client* client)
+{
+    return client->keep_alive.connected ?
+        here_tracking_http_connection_keep_alive : here_tracking_http_connection_close;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_recv_resp(here_tracking_client* client,
+                                                        uint8_t* recv_buffer,
+                                                        size_t recv_buffer_size,
+                                                        here_tracking_http_parser_evt_cb resp_cb,
+                                                        void* resp_cb_data,
+                                                        uint32_t request_deadline,
+                                                        uint32_t* in_size,
+                                                        bool* reusable)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t size = (in_size != NULL) ? (*in_size) : 0, parse_size, start = 0;
+    uint32_t read_size;
+    here_tracking_http_parser parser;
+    here_tracking_http_drain_ctx drain_ctx;
+
+    (*reusable) = false;
+
+    /* Data left over from the previous pipelined response is parsed before reading more */
+    if(size == 0)
+    {
+        size = (uint32_t)recv_buffer_size;
+        TRY((here_tracking_http_set_deadline(client,
+                                             client->timeouts.io_timeout,
+                                             request_deadline)));
+        TRY((here_tracking_tls_read(client->tls, (char*)recv_buffer, &size)));
+    }
+
+    if(client->keep_alive.connected || in_size != NULL)
+    {
+        /* The whole response must be read before the connection can be reused, so events are
+           passed through a callback that keeps the parser running after the client has stopped. */
+        drain_ctx.resp_cb = resp_cb;
+        drain_ctx.resp_cb_data = resp_cb_data;
+        drain_ctx.interrupted = false;
+        here_tracking_http_parser_init(&parser, here_tracking_http_drain_cb, &drain_ctx);
+    }
+    else
+    {
+        here_tracking_http_parser_init(&parser, resp_cb, resp_cb_data);
+    }
+
+    parse_size = size;
+
+    if(size > 0)
+    {
+        err = here_tracking_http_parser_parse(&parser, (char*)recv_buffer, &parse_size);
+        start = parse_size;
+    }
+    else
+    {
+        /* Connection was closed before the response */
+        err = HERE_TRACKING_ERROR;
+    }
+
+    /* Unparsed data is between start and size. The parser keeps track of how far it has searched
+       an incomplete line, so the data is not parsed again from the start. */
+    while(err == HERE_TRACKING_ERROR_NEED_MORE_DATA)
+    {
+        if(start == size)
+        {
+            /* Everything parsed, reuse the whole work buffer */
+            start = size = 0;
+        }
+        else if(size == recv_buffer_size)
+        {
+            if(start == 0)
+            {
+                /* Parser requires more data to continue but work buffer is already full */
+                break;
+            }
+
+            /* Move the incomplete line to the beginning only when the end of the work buffer
+               has been used up */
+            memmove(recv_buffer, (recv_buffer + start), size - start);
+            size -= start;
+            start = 0;
+        }
+
+        /* Read more data to the free space at the end of the work buffer */
+        read_size = (uint32_t)recv_buffer_size - size;
+        TRY((here_tracking_http_set_deadline(client,
+                                             client->timeouts.io_timeout,
+                                             request_deadline)));
+        TRY((here_tracking_tls_read(client->tls, ((char*)recv_buffer) + size, &read_size)));
+
+        if(read_size == 0)
+        {
+            /* Connection was closed before the response was complete */
+            err = HERE_TRACKING_ERROR;
+            break;
+        }
+
+        size += read_size;
+        parse_size = size - start;
+        err = here_tracking_http_parser_parse(&parser, ((char*)recv_buffer) + start, &parse_size);
+        start += parse_size;
+    }
+
+    /* Parser requires more data to continue but work buffer is already full. */
+    if(err == HERE_TRACKING_ERROR_NEED_MORE_DATA)
+    {
+        err = HERE_TRACKING_ERROR;
+    }
+
+    if(err == HERE_TRACKING_OK && (client->keep_alive.connected || in_size != NULL))
+    {
+        if(in_size != NULL)
+        {
+            /* Keep the start of the next pipelined response for the next call */
+            (*in_size) = size - start;
+            memmove(recv_buffer, (recv_buffer + start), (*in_size));
+            (*reusable) = parser.keep_alive;
+        }
+        else
+        {
+            /* Connection can be reused only if the response ended exactly at the end of read
+               data */
+            (*reusable) = (parser.keep_alive && start == size);
+        }
+
+        if(drain_ctx.interrupted)
+        {
+            err = HERE_TRACKING_ERROR_CLIENT_INTERRUPT;
+        }
+    }
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_http_deadline(uint32_t timeout, uint32_t request_deadline)
+{
+    uint32_t deadline = 0, now;
+
+    if(timeout > 0 && here_tracking_get_monotonic_ms(&now) == HERE_TRACKING_OK)
+    {
+        deadline = now + timeout;
+
+        /* 0 means no deadline */
+        if(deadline == 0)
+        {
+            deadline = 1;
+        }
+    }
+
+    /* Deadlines are compared as signed differences so that wrap-around is handled */
+    if(request_deadline != 0 && (deadline == 0 || (int32_t)(request_deadline - deadline) < 0))
+    {
+        deadline = request_deadline;
+    }
+
+    return deadline;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http_io_buffers(const here_tracking_client* client,
+                                          uint8_t* default_buffer,
+                                          here_tracking_io_buffers* io_buffers)
+{
+    (*io_buffers) = client->io_buffers;
+
+    if(io_buffers->send_buffer == NULL)
+    {
+        io_buffers->send_buffer = default_buffer;
+        io_buffers->send_buffer_size = HERE_TRACKING_HTTP_TLS_BUFFER_SIZE;
+    }
+
+    if(io_buffers->recv_buffer == NULL)
+    {
+        io_buffers->recv_buffer = default_buffer;
+        io_buffers->recv_buffer_size = HERE_TRACKING_HTTP_TLS_BUFFER_SIZE;
+    }
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_http_deadline_passed(uint32_t deadline)
+{
+    uint32_t now;
+
+    return (deadline != 0 &&
+            here_tracking_get_monotonic_ms(&now) == HERE_TRACKING_OK &&
+            (int32_t)(deadline - now) <= 0);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_set_deadline(here_tracking_client* client,
+                                                           uint32_t timeout,
+                                                           uint32_t request_deadline)
+{
+    return here_tracking_tls_set_deadline(client->tls,
+                                          here_tracking_http_deadline(timeout, request_deadline));
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_http_drain_cb(const here_tracking_http_parser_evt* evt,
+                                        bool last,
+                                        void* cb_data)
+{
+    here_tracking_http_drain_ctx* drain_ctx = (here_tracking_http_drain_ctx*)cb_data;
+
+    if(!drain_ctx->interrupted)
+    {
+        drain_ctx->interrupted = drain_ctx->resp_cb(evt, last, drain_ctx->resp_cb_data);
+    }
+
+    return false;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http_auth_data_init(here_tracking_http_auth_data* auth_data,
+                                              here_tracking_client* client)
+{
+    auth_data->client = client;
+    auth_data->state = HERE_TRACKING_HTTP_AUTH_FIND_KEY;
+    auth_data->chars = 0;
+    auth_data->status_code = HERE_TRACKING_ERROR;
+    auth_data->search_keys[0].key = here_tracking_http_access_token;
+    auth_data->search_keys[0].found = false;
+    auth_data->search_keys[0].chars = 0;
+    auth_data->search_keys[0].next_state = HERE_TRACKING_HTTP_AUTH_TOKEN_FIND_START;
+    auth_data->search_keys[1].key = here_tracking_http_expires_in;
+    auth_data->search_keys[1].found = false;
+    auth_data->search_keys[1].chars = 0;
+    auth_data->search_keys[1].next_state = HERE_TRACKING_HTTP_AUTH_EXPIRY_FIND_START;
+
+    /* Cached headers hold the old token */
+    client->hdr_cache.size = 0;
+    client->hdr_cache.too_small = false;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http_clear_token(here_tracking_client* client)
+{
+    client->access_token[0] = '\0';
+    client->token_expiry = 0;
+    client->hdr_cache.size = 0;
+    client->hdr_cache.too_small = false;
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_http_auth_done(here_tracking_http_auth_data* auth_data)
+{
+    uint8_t i;
+    bool all_found = true;
+
+    /* Done if all search keys have been found. */
+    for(i = 0; i < HERE_TRACKING_HTTP_AUTH_SEARCH_KEY_COUNT; ++i)
+    {
+        if(!auth_data->search_keys[i].found)
+        {
+            auth_data->search_keys[i].chars = 0;
+            all_found = false;
+        }
+    }
+
+    return all_found;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_status_code_to_err(uint16_t http_status_code)
+{
+    here_tracking_error err;
+
+    switch(http_status_code)
+    {
+        case HERE_TRACKING_HTTP_STATUS_OK:
+            /* fall through */
+        case HERE_TRACKING_HTTP_STATUS_NO_CONTENT:
+        {
+            err = HERE_TRACKING_OK;
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_STATUS_BAD_REQUEST:
+        {
+            err = HERE_TRACKING_ERROR_BAD_REQUEST;
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_STATUS_UNAUTHORIZED:
+        {
+            err = HERE_TRACKING_ERROR_UNAUTHORIZED;
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_STATUS_FORBIDDEN:
+        {
+            err = HERE_TRACKING_ERROR_FORBIDDEN;
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_STATUS_NOT_FOUND:
+        {
+            err = HERE_TRACKING_ERROR_NOT_FOUND;
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_STATUS_PRECONDITION_FAILED:
+        {
+            err = HERE_TRACKING_ERROR_DEVICE_UNCLAIMED;
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_STATUS_TOO_MANY_REQUESTS:
+        {
+            err = HERE_TRACKING_ERROR_TOO_MANY_REQUESTS;
+        }
+        break;
+
+        default:
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+        break;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_send_chunk(here_tracking_tls_writer* tls_writer,
+                                                         const uint8_t* chunk_data,
+                                                         size_t chunk_size)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+
+    TRY((here_tracking_tls_writer_write_utoa(tls_writer, (uint32_t)chunk_size, 16)));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+
+    if(chunk_data != NULL && chunk_size > 0)
+    {
+        TRY((here_tracking_tls_writer_write_data(tls_writer, chunk_data, chunk_size)));
+    }
+
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_write_body_data(here_tracking_tls_writer* tls_writer,
+                                                              here_tracking_client* client,
+                                                              here_tracking_http_h2_ctx* h2_ctx,
+                                                              const uint8_t* data,
+                                                              size_t data_size)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_http2_stream* stream;
+    size_t pos = 0;
+    uint32_t size;
+    bool done = false;
+
+    if(h2_ctx == NULL)
+    {
+        err = here_tracking_http_send_chunk(tls_writer, data, data_size);
+    }
+    else
+    {
+        stream = h2_ctx->stream;
+
+        /* Empty data ends the stream. The rest of the body is dropped if the server has already
+           responded. */
+        while(err == HERE_TRACKING_OK && !done)
+        {
+            if(stream->closed)
+            {
+                done = true;
+            }
+            else if(data_size > 0 && (stream->send_window <= 0 || client->http2.send_window <= 0))
+            {
+                /* Wait for the server to open the flow control windows */
+                err = here_tracking_http_h2_read(client, h2_ctx);
+            }
+            else
+            {
+                size = (uint32_t)(data_size - pos);
+                err = here_tracking_http2_write_data(&client->http2,
+                                                     tls_writer,
+                                                     stream,
+                                                     (data != NULL) ? (data + pos) : NULL,
+                                                     &size,
+                                                     data_size == 0);
+                pos += size;
+                done = (pos == data_size);
+            }
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_send_cb(const uint8_t** data,
+                                                      size_t* data_size,
+                                                      void* user_data)
+{
+    here_tracking_http_send_recv_ctx* send_recv_ctx = (here_tracking_http_send_recv_ctx*)user_data;
+
+    if(send_recv_ctx->send_data != NULL && send_recv_ctx->send_data_size > 0)
+    {
+        *data = send_recv_ctx->send_data;
+        *data_size = send_recv_ctx->send_data_size;
+        send_recv_ctx->send_data = NULL;
+        send_recv_ctx->send_data_size = 0;
+    }
+    else
+    {
+        *data = NULL;
+        *data_size = 0;
+    }
+
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_recv_cb(const here_tracking_recv_data* data,
+                                                      void* user_data)
+{
+    here_tracking_http_send_recv_ctx* send_recv_ctx = (here_tracking_http_send_recv_ctx*)user_data;
+
+    switch(data->evt)
+    {
+        case HERE_TRACKING_RECV_EVT_RESP_SIZE:
+        {
+            send_recv_ctx->body_size = data->data_size;
+        }
+        break;
+
+        case HERE_TRACKING_RECV_EVT_RESP_DATA:
+        {
+            if(here_tracking_data_buffer_add_data(&send_recv_ctx->resp_buffer,
+                                                  (const char*)data->data,
+                                                  (uint32_t)data->data_size) != HERE_TRACKING_OK)
+            {
+                here_tracking_data_buffer_add_data(&send_recv_ctx->resp_buffer,
+                                                   (const char*)data->data,
+                                                   (send_recv_ctx->resp_buffer.buffer_capacity -
+                                                    send_recv_ctx->resp_buffer.buffer_size));
+                send_recv_ctx->status_code = HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+            }
+        }
+        break;
+
+        case HERE_TRACKING_RECV_EVT_RESP_COMPLETE:
+        {
+            send_recv_ctx->status_code = data->err;
+        }
+        break;
+
+        default:
+            send_recv_ctx->status_code = HERE_TRACKING_ERROR;
+            break;
+    }
+
+    return send_recv_ctx->status_code;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_write_auth_req(here_tracking_tls_writer* tls_writer,
+                                                             here_tracking_client* client)
+{
+    here_tracking_error err;
+    uint8_t oauth_buffer[HERE_TRACKING_OAUTH_MIN_OUT_SIZE];
+    uint32_t oauth_size = HERE_TRACKING_OAUTH_MIN_OUT_SIZE;
+    char correlation_id_buffer[HERE_TRACKING_UUID_SIZE];
+    const char* correlation_id;
+
+    /* HTTP request line */
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_method_post)));
+    TRY((here_tracking_tls_writer_write_char(tls_writer, ' ')));
+    TRY((here_tracking_tls_writer_write_string(tls_writer,
+                                               here_tracking_http_path_version)));
+    TRY((here_tracking_tls_writer_write_string(tls_writer,
+                                               here_tracking_http_path_token)));
+    TRY((here_tracking_tls_writer_write_char(tls_writer, ' ')));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_version)));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+
+    /* Host header */
+    HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                    here_tracking_http_header_host,
+                                    client->base_url);
+
+    /* Connection header */
+    HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                    here_tracking_http_header_connection,
+                                    here_tracking_http_connection_hdr_val(client));
+
+    /* Content length header */
+    HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer, here_tracking_http_header_content_length, "0");
+
+    /* Correlation id header */
+    if(here_tracking_http_get_correlation_id(client,
+                                             correlation_id_buffer,
+                                             HERE_TRACKING_UUID_SIZE,
+                                             &correlation_id) == HERE_TRACKING_OK)
+    {
+        HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                        here_tracking_http_header_x_request_id,
+                                        correlation_id);
+        HERE_TRACKING_LOGI("Auth req with id: %s", correlation_id);
+    }
+
+    if(client->user_agent != NULL && strlen(client->user_agent) > 0)
+    {
+        HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                        here_tracking_http_header_user_agent,
+                                        client->user_agent);
+    }
+
+    /* Authorization header */
+    TRY((here_tracking_tls_writer_write_string(tls_writer,
+                                               here_tracking_http_header_authorization)));
+    TRY((here_tracking_tls_writer_write_char(tls_writer, ':')));
+    TRY((here_tracking_oauth_create_header(client->device_id,
+                                           client->device_secret,
+                                           client->base_url,
+                                           client->srv_time_diff,
+                                           (char*)oauth_buffer,
+                                           &oauth_size)));
+    TRY((here_tracking_tls_writer_write_data(tls_writer, oauth_buffer, oauth_size)));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+
+    /* Complete header section */
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_write_send_stream_hdr(here_tracking_tls_writer* tls_writer,
+                                             here_tracking_client* client,
+                                             here_tracking_req_type req_type,
+                                             here_tracking_resp_type resp_type,
+                                             const char* connection,
+                                             const here_tracking_codec* codec)
+{
+    here_tracking_error err;
+    char correlation_id_buffer[HERE_TRACKING_UUID_SIZE];
+    const char* correlation_id;
+
+    if(client->hdr_cache.buffer != NULL)
+    {
+        TRY((here_tracking_http_write_cached_hdr(tls_writer, client, req_type, resp_type)));
+    }
+    else
+    {
+        TRY((here_tracking_http_write_static_hdr(tls_writer, client, req_type, resp_type)));
+    }
+
+    /* Headers that may change from one request to the next */
+    HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                    here_tracking_http_header_connection,
+                                    connection);
+
+    if(codec != NULL && codec->encode != NULL)
+    {
+        HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                        here_tracking_http_header_content_encoding,
+                                        codec->content_encoding);
+    }
+
+    if(codec != NULL && codec->decode != NULL)
+    {
+        HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                        here_tracking_http_header_accept_encoding,
+                                        codec->content_encoding);
+    }
+
+    if(here_tracking_http_get_correlation_id(client,
+                                             correlation_id_buffer,
+                                             HERE_TRACKING_UUID_SIZE,
+                                             &correlation_id) == HERE_TRACKING_OK)
+    {
+        HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                        here_tracking_http_header_x_request_id,
+                                        correlation_id);
+        HERE_TRACKING_LOGI("Send req with id: %s", correlation_id);
+    }
+
+    /* Complete header section */
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_write_static_hdr(here_tracking_tls_writer* tls_writer,
+                                        const here_tracking_client* client,
+                                        here_tracking_req_type req_type,
+                                        here_tracking_resp_type resp_type)
+{
+    here_tracking_error err;
+
+    /* HTTP request line */
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_method_post)));
+    TRY((here_tracking_tls_writer_write_char(tls_writer, ' ')));
+    TRY((here_tracking_tls_writer_write_string(tls_writer,
+                                               here_tracking_http_path_version)));
+    TRY((here_tracking_tls_writer_write_char(tls_writer, '/')));
+
+    if(resp_type == HERE_TRACKING_RESP_STATUS_ONLY)
+    {
+        TRY((here_tracking_tls_writer_write_string(tls_writer,
+                                                   here_tracking_http_query_async)));
+    }
+
+    TRY((here_tracking_tls_writer_write_char(tls_writer, ' ')));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_version)));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+
+    /* HTTP headers */
+    HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                    here_tracking_http_header_host,
+                                    client->base_url);
+    HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                    here_tracking_http_header_transfer_encoding,
+                                    here_tracking_http_transfer_encoding_chunked);
+
+    if(req_type == HERE_TRACKING_REQ_DATA_PROTOBUF)
+    {
+        HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                        here_tracking_http_header_content_type,
+                                        here_tracking_http_content_type_octet_stream);
+    }
+    else
+    {
+        HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                        here_tracking_http_header_content_type,
+                                        here_tracking_http_content_type_json);
+    }
+
+    if(resp_type == HERE_TRACKING_RESP_WITH_DATA_PROTOBUF)
+    {
+        HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                        here_tracking_http_header_accept,
+                                        here_tracking_http_content_type_octet_stream);
+    }
+
+    if(client->user_agent != NULL && strlen(client->user_agent) > 0)
+    {
+        HERE_TRACKING_HTTP_WRITE_HEADER(tls_writer,
+                                        here_tracking_http_header_user_agent,
+                                        client->user_agent);
+    }
+
+    /* Construct authorization header */
+    TRY((here_tracking_tls_writer_write_string(tls_writer,
+                                               here_tracking_http_header_authorization)));
+    TRY((here_tracking_tls_writer_write_char(tls_writer, ':')));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_header_bearer)));
+    TRY((here_tracking_tls_writer_write_char(tls_writer, ' ')));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, client->access_token)));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_write_cached_hdr(here_tracking_tls_writer* tls_writer,
+                                        here_tracking_client* client,
+                                        here_tracking_req_type req_type,
+                                        here_tracking_resp_type resp_type)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_hdr_cache* cache = &client->hdr_cache;
+
+    /* A header block which didn't fit is built again only when the cache would be rebuilt */
+    if((cache->size == 0 && !cache->too_small) ||
+       cache->req_type != req_type ||
+       cache->resp_type != resp_type ||
+       cache->user_agent != client->user_agent)
+    {
+        here_tracking_tls_writer cache_writer;
+
+        cache->size = 0;
+        cache->req_type = req_type;
+        cache->resp_type = resp_type;
+        cache->user_agent = client->user_agent;
+        err = here_tracking_tls_writer_init_buffered(&cache_writer,
+                                                     cache->buffer,
+                                                     cache->buffer_size);
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_http_write_static_hdr(&cache_writer, client, req_type, resp_type);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            cache->size = cache_writer.data_buffer.buffer_size;
+        }
+
+        cache->too_small = (err != HERE_TRACKING_OK);
+    }
+
+    /* Header block which does not fit in the cache is written as usual */
+    if(cache->size > 0)
+    {
+        err = here_tracking_tls_writer_write_data(tls_writer, cache->buffer, cache->size);
+    }
+    else
+    {
+        err = here_tracking_http_write_static_hdr(tls_writer, client, req_type, resp_type);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_write_send_stream_body(here_tracking_tls_writer* tls_writer,
+                                              here_tracking_client* client,
+                                              here_tracking_send_cb send_cb,
+                                              void* user_data,
+                                              uint32_t request_deadline,
+                                              here_tracking_http_h2_ctx* h2_ctx)
+{
+    here_tracking_error err;
+    const uint8_t* data;
+    size_t data_size;
+
+    if(client->codec != NULL && client->codec->encode != NULL)
+    {
+        TRY((here_tracking_http_write_encoded_body(tls_writer,
+                                                   client,
+                                                   send_cb,
+                                                   user_data,
+                                                   request_deadline,
+                                                   h2_ctx)));
+    }
+    else
+    {
+        /* Read and send data chunks from io context */
+        do
+        {
+            TRY((send_cb(&data, &data_size, user_data)));
+            TRY((here_tracking_http_set_deadline(client,
+                                                 client->timeouts.io_timeout,
+                                                 request_deadline)));
+            TRY((here_tracking_http_write_body_data(tls_writer, client, h2_ctx, data, data_size)));
+        } while(data != NULL && data_size > 0);
+    }
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_write_encoded_body(here_tracking_tls_writer* tls_writer,
+                                          here_tracking_client* client,
+                                          here_tracking_send_cb send_cb,
+                                          void* user_data,
+                                          uint32_t request_deadline,
+                                          here_tracking_http_h2_ctx* h2_ctx)
+{
+    here_tracking_error err;
+    const here_tracking_codec* codec = client->codec;
+    const uint8_t* data = NULL;
+    size_t data_size = 0, pos, in_size, out_size;
+    bool finish = false, end = false;
+
+    TRY((codec->begin(codec->codec_data)));
+
+    /* Data from the send callback is compressed to the codec buffer and each full buffer is sent
+       as one chunk, so the data must not outlive the next send callback */
+    while(err == HERE_TRACKING_OK && !end)
+    {
+        TRY((send_cb(&data, &data_size, user_data)));
+
+        if(data == NULL || data_size == 0)
+        {
+            data = NULL;
+            data_size = 0;
+            finish = true;
+        }
+
+        pos = 0;
+
+        do
+        {
+            in_size = data_size - pos;
+            out_size = client->codec_buffer_size;
+            TRY((codec->encode((data != NULL) ? (data + pos) : NULL,
+                               &in_size,
+                               client->codec_buffer,
+                               &out_size,
+                               finish,
+                               &end,
+                               codec->codec_data)));
+
+            if(in_size == 0 && out_size == 0 && !end)
+            {
+                /* Codec is not making progress */
+                err = HERE_TRACKING_ERROR;
+            }
+            else if(out_size > 0)
+            {
+                TRY((here_tracking_http_set_deadline(client,
+                                                     client->timeouts.io_timeout,
+                                                     request_deadline)));
+                TRY((here_tracking_http_write_body_data(tls_writer,
+                                                        client,
+                                                        h2_ctx,
+                                                        client->codec_buffer,
+                                                        out_size)));
+            }
+
+            pos += in_size;
+        } while(err == HERE_TRACKING_OK && (pos < data_size || (finish && !end)));
+    }
+
+    if(err == HERE_TRACKING_OK)
+    {
+        /* Last chunk */
+        TRY((here_tracking_http_set_deadline(client,
+                                             client->timeouts.io_timeout,
+                                             request_deadline)));
+        TRY((here_tracking_http_write_body_data(tls_writer, client, h2_ctx, NULL, 0)));
+    }
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_get_write_auth_header(here_tracking_tls_writer* tls_writer,
+                                             const here_tracking_http_header* auth_header)
+{
+    here_tracking_error err;
+
+    TRY((here_tracking_tls_writer_write_string(tls_writer,
+                                               here_tracking_http_header_authorization)));
+    TRY((here_tracking_tls_writer_write_char(tls_writer, ':')));
+
+    /* Make sure that 'Bearer' token type is set */
+    if(strncmp(auth_header->value,
+               here_tracking_http_header_bearer,
+               strlen(here_tracking_http_header_bearer)) != 0)
+    {
+        TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_header_bearer)));
+        TRY((here_tracking_tls_writer_write_char(tls_writer, ' ')));
+    }
+
+    TRY((here_tracking_tls_writer_write_string(tls_writer, auth_header->value)));
+    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_get_correlation_id(here_tracking_client* client,
+                                                                 char* buffer, size_t buff_size,
+                                                                 const char** correlation_id)
+{
+    here_tracking_error ret = HERE_TRACKING_OK;
+
+    /* User set id is used as is, new one is generated to the buffer otherwise */
+    if(NULL != client->correlation_id
+       && strlen(client->correlation_id) < buff_size)
+    {
+        *correlation_id = client->correlation_id;
+    }
+    else
+    {
+        ret = here_tracking_uuid_gen_new(buffer, buff_size);
+        *correlation_id = buffer;
+    }
+
+    return ret;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_auth_h2(here_tracking_client* client,
+                                                      uint32_t request_deadline)
+{
+    here_tracking_error err;
+    here_tracking_tls_writer tls_writer;
+    uint8_t tls_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
+    uint8_t h2_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
+    here_tracking_http_h2_ctx h2_ctx;
+    here_tracking_http2_stream stream;
+    here_tracking_http_auth_data auth_data;
+
+    here_tracking_http_auth_data_init(&auth_data, client);
+    TRY((here_tracking_http_h2_begin(client,
+                                     &h2_ctx,
+                                     &tls_writer,
+                                     tls_buffer,
+                                     h2_buffer,
+                                     request_deadline)));
+    TRY((here_tracking_http2_stream_open(&client->http2,
+                                         &h2_ctx.reader,
+                                         &stream,
+                                         here_tracking_http_auth_resp_cb,
+                                         (void*)(&auth_data))));
+    TRY((here_tracking_http_write_h2_auth_hdr(&tls_writer, client, &stream)));
+    TRY((here_tracking_http_h2_recv(client, &h2_ctx)));
+
+here_tracking_http_error:
+    here_tracking_http_h2_end(client, &h2_ctx, err);
+
+    if(err == HERE_TRACKING_OK)
+    {
+        err = (stream.err != HERE_TRACKING_OK) ? stream.err : auth_data.status_code;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_send_stream_pipelined_h2(here_tracking_client* client,
+                                                const here_tracking_stream_req* reqs,
+                                                uint8_t req_count,
+                                                uint8_t* completed,
+                                                uint32_t request_deadline)
+{
+    here_tracking_error err;
+    here_tracking_tls_writer tls_writer;
+    uint8_t tls_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
+    uint8_t h2_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
+    here_tracking_http_h2_ctx h2_ctx;
+    here_tracking_http2_stream streams[HERE_TRACKING_HTTP2_MAX_STREAMS];
+    here_tracking_http_recv_ctx recv_ctx[HERE_TRACKING_HTTP2_MAX_STREAMS];
+    uint32_t batch;
+    uint8_t i;
+    bool decode, failed = false;
+
+    TRY((here_tracking_http_h2_begin(client,
+                                     &h2_ctx,
+                                     &tls_writer,
+                                     tls_buffer,
+                                     h2_buffer,
+                                     request_deadline)));
+
+    /* Requests are sent in batches of concurrent streams and the responses of a batch are read
+       before the next one is sent */
+    while((*completed) < req_count && !failed)
+    {
+        batch = req_count - (*completed);
+        batch = (batch < HERE_TRACKING_HTTP2_MAX_STREAMS) ? batch : HERE_TRACKING_HTTP2_MAX_STREAMS;
+        batch = (batch < client->http2.max_streams) ? batch : client->http2.max_streams;
+
+        if(batch == 0)
+        {
+            /* Server doesn't allow any streams */
+            err = HERE_TRACKING_ERROR;
+            TRY(err);
+        }
+
+        /* The codec holds the state of one response, so only a single stream is decoded */
+        decode = (batch == 1);
+        here_tracking_http2_reader_clear(&h2_ctx.reader);
+
+        for(i = 0; i < batch; ++i)
+        {
+            const here_tracking_stream_req* req = reqs + (*completed) + i;
+
+            recv_ctx[i].client = client;
+            recv_ctx[i].status_code = HERE_TRACKING_ERROR;
+            recv_ctx[i].recv_cb = req->recv_cb;
+            recv_ctx[i].user_data = req->user_data;
+            recv_ctx[i].codec = decode ? client->codec : NULL;
+
+            TRY((here_tracking_http2_stream_open(&client->http2,
+                                                 &h2_ctx.reader,
+                                                 &streams[i],
+                                                 here_tracking_http_send_resp_cb,
+                                                 &recv_ctx[i])));
+            h2_ctx.stream = &streams[i];
+            TRY((here_tracking_http_write_h2_send_stream_hdr(&tls_writer,
+                                                             client,
+                                                             &streams[i],
+                                                             req->req_type,
+                                                             req->resp_type,
+                                                             decode)));
+            TRY((here_tracking_http_write_send_stream_body(&tls_writer,
+                                                           client,
+                                                           req->send_cb,
+                                                           req->user_data,
+                                                           request_deadline,
+                                                           &h2_ctx)));
+        }
+
+        TRY((here_tracking_http_h2_recv(client, &h2_ctx)));
+
+        /* Streams that the server didn't process before going away can be sent again, like
+           requests after a closed connection with HTTP/1.1 */
+        for(i = 0; i < batch && !failed; ++i)
+        {
+            if(recv_ctx[i].status_code == HERE_TRACKING_ERROR_UNAUTHORIZED ||
+               recv_ctx[i].status_code == HERE_TRACKING_ERROR_FORBIDDEN)
+            {
+                here_tracking_http_clear_token(client);
+            }
+
+            if(streams[i].err == HERE_TRACKING_OK)
+            {
+                (*completed)++;
+            }
+            else
+            {
+                failed = true;
+                err = client->http2.goaway ? HERE_TRACKING_OK : streams[i].err;
+            }
+        }
+    }
+
+here_tracking_http_error:
+    here_tracking_http_h2_end(client, &h2_ctx, err);
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_get_h2(here_tracking_client* client,
+                                                     const here_tracking_http_request* request,
+                                                     here_tracking_recv_cb recv_cb,
+                                                     void* user_data,
+                                                     uint32_t request_deadline)
+{
+    here_tracking_error err;
+    here_tracking_tls_writer tls_writer;
+    uint8_t tls_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
+    uint8_t h2_buffer[HERE_TRACKING_HTTP_TLS_BUFFER_SIZE];
+    here_tracking_http_h2_ctx h2_ctx;
+    here_tracking_http2_stream stream;
+    here_tracking_http_recv_ctx recv_ctx;
+
+    recv_ctx.client = client;
+    recv_ctx.status_code = HERE_TRACKING_ERROR;
+    recv_ctx.recv_cb = recv_cb;
+    recv_ctx.user_data = user_data;
+    recv_ctx.codec = NULL;
+
+    TRY((here_tracking_http_h2_begin(client,
+                                     &h2_ctx,
+                                     &tls_writer,
+                                     tls_buffer,
+                                     h2_buffer,
+                                     request_deadline)));
+    TRY((here_tracking_http2_stream_open(&client->http2,
+                                         &h2_ctx.reader,
+                                         &stream,
+                                         here_tracking_http_send_resp_cb,
+                                         &recv_ctx)));
+    TRY((here_tracking_http_write_h2_get_hdr(&tls_writer, client, &stream, request)));
+    TRY((here_tracking_http_h2_recv(client, &h2_ctx)));
+    err = stream.err;
+
+here_tracking_http_error:
+    here_tracking_http_h2_end(client, &h2_ctx, err);
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_h2_begin(here_tracking_client* client,
+                                                       here_tracking_http_h2_ctx* h2_ctx,
+                                                       here_tracking_tls_writer* tls_writer,
+                                                       uint8_t* tls_buffer,
+                                                       uint8_t* h2_buffer,
+                                                       uint32_t request_deadline)
+{
+    here_tracking_error err;
+    here_tracking_io_buffers io_buffers;
+
+    here_tracking_http_io_buffers(client, tls_buffer, &io_buffers);
+    h2_ctx->tls_writer = tls_writer;
+    h2_ctx->recv_buffer = io_buffers.recv_buffer;
+    h2_ctx->recv_buffer_size = io_buffers.recv_buffer_size;
+    h2_ctx->recv_size = 0;
+    h2_ctx->request_deadline = request_deadline;
+    h2_ctx->stream = NULL;
+    here_tracking_http2_reader_init(&h2_ctx->reader);
+
+    /* Frames written in reply while reading must not overwrite the received data */
+    if(io_buffers.recv_buffer == io_buffers.send_buffer)
+    {
+        h2_ctx->recv_buffer = h2_buffer;
+        h2_ctx->recv_buffer_size = HERE_TRACKING_HTTP_TLS_BUFFER_SIZE;
+    }
+
+    err = here_tracking_tls_writer_init(tls_writer,
+                                        client->tls,
+                                        io_buffers.send_buffer,
+                                        io_buffers.send_buffer_size);
+
+    if(err == HERE_TRACKING_OK && !client->http2.preface_sent)
+    {
+        err = here_tracking_http2_start(&client->http2, tls_writer);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http_h2_end(here_tracking_client* client,
+                                      here_tracking_http_h2_ctx* h2_ctx,
+                                      here_tracking_error err)
+{
+    bool reusable = false;
+
+    /* Replies to the last frames read are sent before the connection is kept for later. Frames
+       that arrive after the responses make the connection unusable for the next request. */
+    if(err == HERE_TRACKING_OK)
+    {
+        reusable = (here_tracking_tls_writer_flush(h2_ctx->tls_writer) == HERE_TRACKING_OK &&
+                    h2_ctx->recv_size == 0 &&
+                    !h2_ctx->reader.in_frame &&
+                    !client->http2.goaway);
+    }
+
+    here_tracking_http_release(client, reusable);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_h2_read(here_tracking_client* client,
+                                                      here_tracking_http_h2_ctx* h2_ctx)
+{
+    here_tracking_error err;
+    uint32_t read_size, parse_size;
+
+    /* Requests and replies are sent before waiting for the server */
+    TRY((here_tracking_http_set_deadline(client,
+                                         client->timeouts.io_timeout,
+                                         h2_ctx->request_deadline)));
+    TRY((here_tracking_tls_writer_flush(h2_ctx->tls_writer)));
+
+    if(h2_ctx->recv_size == h2_ctx->recv_buffer_size)
+    {
+        /* Frame part that must be read at once doesn't fit in the buffer */
+        err = HERE_TRACKING_ERROR;
+        TRY(err);
+    }
+
+    read_size = h2_ctx->recv_buffer_size - h2_ctx->recv_size;
+    TRY((here_tracking_tls_read(client->tls,
+                                ((char*)h2_ctx->recv_buffer) + h2_ctx->recv_size,
+                                &read_size)));
+
+    if(read_size == 0)
+    {
+        /* Connection was closed before the responses were complete */
+        err = HERE_TRACKING_ERROR;
+        TRY(err);
+    }
+
+    h2_ctx->recv_size += read_size;
+    parse_size = h2_ctx->recv_size;
+    TRY((here_tracking_http2_read(&client->http2,
+                                  &h2_ctx->reader,
+                                  h2_ctx->tls_writer,
+                                  h2_ctx->recv_buffer,
+                                  &parse_size)));
+
+    /* Keep the unread frame part for the next read */
+    h2_ctx->recv_size -= parse_size;
+    memmove(h2_ctx->recv_buffer, h2_ctx->recv_buffer + parse_size, h2_ctx->recv_size);
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_h2_recv(here_tracking_client* client,
+                                                      here_tracking_http_h2_ctx* h2_ctx)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+
+    while(err == HERE_TRACKING_OK && !here_tracking_http2_reader_done(&h2_ctx->reader))
+    {
+        err = here_tracking_http_h2_read(client, h2_ctx);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_write_h2_auth_hdr(here_tracking_tls_writer* tls_writer,
+                                         here_tracking_client* client,
+                                         const here_tracking_http2_stream* stream)
+{
+    here_tracking_error err;
+    here_tracking_http2_block block;
+    uint8_t oauth_buffer[HERE_TRACKING_OAUTH_MIN_OUT_SIZE];
+    uint32_t oauth_size = HERE_TRACKING_OAUTH_MIN_OUT_SIZE;
+    char correlation_id_buffer[HERE_TRACKING_UUID_SIZE];
+    const char* correlation_id;
+
+    /* Request has no body, the stream ends with the headers */
+    TRY((here_tracking_http2_block_begin(&block, &client->http2, tls_writer, stream, true)));
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_pseudo_header_method,
+                                   here_tracking_http_method_post,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_pseudo_header_scheme,
+                                   here_tracking_http_scheme_https,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_pseudo_header_authority,
+                                   client->base_url,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+    TRY((here_tracking_http2_block_add(&block,
+                                       here_tracking_http_pseudo_header_path,
+                                       here_tracking_http_path_version,
+                                       here_tracking_http_path_token,
+                                       (uint32_t)strlen(here_tracking_http_path_token),
+                                       HERE_TRACKING_HTTP2_HDR_INDEX)));
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_header_content_length,
+                                   "0",
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+
+    if(here_tracking_http_get_correlation_id(client,
+                                             correlation_id_buffer,
+                                             HERE_TRACKING_UUID_SIZE,
+                                             &correlation_id) == HERE_TRACKING_OK)
+    {
+        HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                       here_tracking_http_header_x_request_id,
+                                       correlation_id,
+                                       0);
+        HERE_TRACKING_LOGI("Auth req with id: %s", correlation_id);
+    }
+
+    if(client->user_agent != NULL && strlen(client->user_agent) > 0)
+    {
+        HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                       here_tracking_http_header_user_agent,
+                                       client->user_agent,
+                                       HERE_TRACKING_HTTP2_HDR_INDEX);
+    }
+
+    /* Signature changes with every request and is never indexed */
+    TRY((here_tracking_oauth_create_header(client->device_id,
+                                           client->device_secret,
+                                           client->base_url,
+                                           client->srv_time_diff,
+                                           (char*)oauth_buffer,
+                                           &oauth_size)));
+    TRY((here_tracking_http2_block_add(&block,
+                                       here_tracking_http_header_authorization,
+                                       NULL,
+                                       (const char*)oauth_buffer,
+                                       oauth_size,
+                                       HERE_TRACKING_HTTP2_HDR_SENSITIVE)));
+    TRY((here_tracking_http2_block_end(&block)));
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_write_h2_send_stream_hdr(here_tracking_tls_writer* tls_writer,
+                                                here_tracking_client* client,
+                                                const here_tracking_http2_stream* stream,
+                                                here_tracking_req_type req_type,
+                                                here_tracking_resp_type resp_type,
+                                                bool decode)
+{
+    here_tracking_error err;
+    here_tracking_http2_block block;
+    const here_tracking_codec* codec = client->codec;
+    const char* path = (resp_type == HERE_TRACKING_RESP_STATUS_ONLY) ?
+        here_tracking_http_path_async : here_tracking_http_path_root;
+    char correlation_id_buffer[HERE_TRACKING_UUID_SIZE];
+    const char* correlation_id;
+
+    /* Headers that stay the same from one request to the next are sent as table indices after
+       the first request, so the header cache is not needed */
+    TRY((here_tracking_http2_block_begin(&block, &client->http2, tls_writer, stream, false)));
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_pseudo_header_method,
+                                   here_tracking_http_method_post,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_pseudo_header_scheme,
+                                   here_tracking_http_scheme_https,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_pseudo_header_authority,
+                                   client->base_url,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+    TRY((here_tracking_http2_block_add(&block,
+                                       here_tracking_http_pseudo_header_path,
+                                       here_tracking_http_path_version,
+                                       path,
+                                       (uint32_t)strlen(path),
+                                       HERE_TRACKING_HTTP2_HDR_INDEX)));
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_header_content_type,
+                                   (req_type == HERE_TRACKING_REQ_DATA_PROTOBUF) ?
+                                       here_tracking_http_content_type_octet_stream :
+                                       here_tracking_http_content_type_json,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+
+    if(resp_type == HERE_TRACKING_RESP_WITH_DATA_PROTOBUF)
+    {
+        HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                       here_tracking_http_header_accept,
+                                       here_tracking_http_content_type_octet_stream,
+                                       HERE_TRACKING_HTTP2_HDR_INDEX);
+    }
+
+    if(client->user_agent != NULL && strlen(client->user_agent) > 0)
+    {
+        HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                       here_tracking_http_header_user_agent,
+                                       client->user_agent,
+                                       HERE_TRACKING_HTTP2_HDR_INDEX);
+    }
+
+    TRY((here_tracking_http2_block_add(&block,
+                                       here_tracking_http_header_authorization,
+                                       here_tracking_http_header_bearer_prefix,
+                                       client->access_token,
+                                       (uint32_t)strlen(client->access_token),
+                                       HERE_TRACKING_HTTP2_HDR_INDEX)));
+
+    if(codec != NULL && codec->encode != NULL)
+    {
+        HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                       here_tracking_http_header_content_encoding,
+                                       codec->content_encoding,
+                                       HERE_TRACKING_HTTP2_HDR_INDEX);
+    }
+
+    if(decode && codec != NULL && codec->decode != NULL)
+    {
+        HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                       here_tracking_http_header_accept_encoding,
+                                       codec->content_encoding,
+                                       HERE_TRACKING_HTTP2_HDR_INDEX);
+    }
+
+    if(here_tracking_http_get_correlation_id(client,
+                                             correlation_id_buffer,
+                                             HERE_TRACKING_UUID_SIZE,
+                                             &correlation_id) == HERE_TRACKING_OK)
+    {
+        HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                       here_tracking_http_header_x_request_id,
+                                       correlation_id,
+                                       0);
+        HERE_TRACKING_LOGI("Send req with id: %s", correlation_id);
+    }
+
+    TRY((here_tracking_http2_block_end(&block)));
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http_write_h2_get_hdr(here_tracking_tls_writer* tls_writer,
+                                        here_tracking_client* client,
+                                        const here_tracking_http2_stream* stream,
+                                        const here_tracking_http_request* request)
+{
+    here_tracking_error err;
+    here_tracking_http2_block block;
+    here_tracking_tls_writer port_writer;
+    uint8_t port[HERE_TRACKING_HTTP_PORT_SIZE];
+    char correlation_id_buffer[HERE_TRACKING_UUID_SIZE];
+    const char* correlation_id;
+    uint8_t i;
+    bool user_agent_present = false;
+    bool correlation_id_present = false;
+
+    TRY((here_tracking_tls_writer_init_buffered(&port_writer, port, sizeof(port))));
+    TRY((here_tracking_tls_writer_write_char(&port_writer, ':')));
+    TRY((here_tracking_tls_writer_write_utoa(&port_writer, request->port, 10)));
+
+    TRY((here_tracking_http2_block_begin(&block, &client->http2, tls_writer, stream, true)));
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_pseudo_header_method,
+                                   here_tracking_http_method_get,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_pseudo_header_scheme,
+                                   here_tracking_http_scheme_https,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+    TRY((here_tracking_http2_block_add(&block,
+                                       here_tracking_http_pseudo_header_authority,
+                                       request->host,
+                                       (const char*)port,
+                                       port_writer.data_buffer.buffer_size,
+                                       HERE_TRACKING_HTTP2_HDR_INDEX)));
+    HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                   here_tracking_http_pseudo_header_path,
+                                   request->path,
+                                   HERE_TRACKING_HTTP2_HDR_INDEX);
+
+    /* User defined headers, connection specific ones are not allowed in HTTP/2 */
+    for(i = 0; i < request->header_count; ++i)
+    {
+        here_tracking_http_header* header = (request->headers + i);
+
+        if(here_tracking_utils_strcasecmp(header->name,
+                                          here_tracking_http_header_authorization) == 0)
+        {
+            /* Make sure that 'Bearer' token type is set */
+            TRY((here_tracking_http2_block_add(&block,
+                                               header->name,
+                                               (strncmp(header->value,
+                                                        here_tracking_http_header_bearer,
+                                                        strlen(here_tracking_http_header_bearer))
+                                                != 0) ? here_tracking_http_header_bearer_prefix :
+                                                        NULL,
+                                               header->value,
+                                               (uint32_t)strlen(header->value),
+                                               HERE_TRACKING_HTTP2_HDR_INDEX)));
+        }
+        else if(here_tracking_utils_strcasecmp(header->name,
+                                               here_tracking_http_header_connection) != 0 &&
+                here_tracking_utils_strcasecmp(header->name,
+                                               here_tracking_http_header_host) != 0 &&
+                here_tracking_utils_strcasecmp(header->name,
+                                               here_tracking_http_header_transfer_encoding) != 0 &&
+                here_tracking_utils_strcasecmp(header->name,
+                                               here_tracking_http_header_keep_alive) != 0 &&
+                here_tracking_utils_strcasecmp(header->name,
+                                               here_tracking_http_header_upgrade) != 0 &&
+                here_tracking_utils_strcasecmp(header->name,
+                                               here_tracking_http_header_proxy_connection) != 0)
+        {
+            if(here_tracking_utils_strcasecmp(header->name,
+                                              here_tracking_http_header_user_agent) == 0)
+            {
+                user_agent_present = true;
+            }
+            else if(here_tracking_utils_strcasecmp(header->name,
+                                                   here_tracking_http_header_x_request_id) == 0)
+            {
+                HERE_TRACKING_LOGI("Send req with id: %s", header->value);
+                correlation_id_present = true;
+            }
+
+            HERE_TRACKING_HTTP2_ADD_HEADER(&block, header->name, header->value, 0);
         }
-        break;
+    }
 
-        case HERE_TRACKING_HTTP_STATUS_PRECONDITION_FAILED:
+    if(!correlation_id_present &&
+       here_tracking_http_get_correlation_id(client,
+                                             correlation_id_buffer,
+                                             HERE_TRACKING_UUID_SIZE,
+                                             &correlation_id) == HERE_TRACKING_OK)
+    {
+        HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                       here_tracking_http_header_x_request_id,
+                                       correlation_id,
+                                       0);
+        HERE_TRACKING_LOGI("Send req with id: %s", correlation_id);
+    }
+
+    if(!user_agent_present && client->user_agent != NULL && strlen(client->user_agent) > 0)
+    {
+        HERE_TRACKING_HTTP2_ADD_HEADER(&block,
+                                       here_tracking_http_header_user_agent,
+                                       client->user_agent,
+                                       HERE_TRACKING_HTTP2_HDR_INDEX);
+    }
+
+    TRY((here_tracking_http2_block_end(&block)));
+
+here_tracking_http_error:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_async_connect(here_tracking_http_async* async)
+{
+    here_tracking_client* client = async->client;
+    here_tracking_error err = HERE_TRACKING_OK;
+
+    if(here_tracking_http_reuse_connection(client,
+                                           client->base_url,
+                                           HERE_TRACKING_HTTP_PORT_HTTPS,
+                                           true))
+    {
+        err = here_tracking_http_async_request(async);
+    }
+    else
+    {
+        if(client->tls == NULL)
         {
-            err = HERE_TRACKING_ERROR_DEVICE_UNCLAIMED;
+            err = here_tracking_tls_init(&(client->tls), client->tls_env);
         }
-        break;
 
-        case HERE_TRACKING_HTTP_STATUS_TOO_MANY_REQUESTS:
+        /* Asynchronous requests use HTTP/1.1 */
+        if(err == HERE_TRACKING_OK)
         {
-            err = HERE_TRACKING_ERROR_TOO_MANY_REQUESTS;
+            client->http2.active = false;
+            err = here_tracking_tls_set_alpn(client->tls, NULL);
         }
-        break;
 
-        default:
+        if(err == HERE_TRACKING_OK)
         {
-            err = HERE_TRACKING_ERROR;
+            async->deadline = here_tracking_http_deadline(client->timeouts.connect_timeout,
+                                                          async->request_deadline);
+            async->step_deadline = 0;
+            async->state = HERE_TRACKING_HTTP_ASYNC_STATE_CONNECTING;
+        }
+        else
+        {
+            /* Nothing to release, connection wasn't opened */
+            here_tracking_http_async_finish(async, err);
+            err = HERE_TRACKING_OK;
         }
-        break;
     }
 
     return err;
@@ -1018,138 +3138,398 @@ static here_tracking_error here_tracking_http_status_code_to_err(uint16_t http_s
 
 /**************************************************************************************************/
 
-static here_tracking_error here_tracking_http_send_chunk(here_tracking_tls_writer* tls_writer,
-                                                         const uint8_t* chunk_data,
-                                                         size_t chunk_size)
+static here_tracking_error here_tracking_http_async_connecting(here_tracking_http_async* async)
 {
-    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_client* client = async->client;
+    here_tracking_error err = here_tracking_tls_connect_async(client->tls,
+                                                              client->base_url,
+                                                              HERE_TRACKING_HTTP_PORT_HTTPS);
 
-    TRY((here_tracking_tls_writer_write_utoa(tls_writer, (uint32_t)chunk_size, 16)));
-    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+    if(err == HERE_TRACKING_OK)
+    {
+        if(client->keep_alive.enabled)
+        {
+            client->keep_alive.connected = true;
+            client->keep_alive.port = HERE_TRACKING_HTTP_PORT_HTTPS;
+            client->keep_alive.non_blocking = true;
+        }
 
-    if(chunk_data != NULL && chunk_size > 0)
+        err = here_tracking_http_async_request(async);
+    }
+    else if(err == HERE_TRACKING_ERROR_WOULD_BLOCK)
     {
-        TRY((here_tracking_tls_writer_write_data(tls_writer, chunk_data, chunk_size)));
+        async->step_deadline =
+            here_tracking_http_deadline(HERE_TRACKING_HTTP_ASYNC_CONNECT_STEP, 0);
+    }
+    else
+    {
+        /* Nothing to release, connection wasn't opened */
+        here_tracking_http_async_finish(async, err);
+        err = HERE_TRACKING_OK;
     }
 
-    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
-
-here_tracking_http_error:
     return err;
 }
 
 /**************************************************************************************************/
 
-static here_tracking_error here_tracking_http_send_cb(const uint8_t** data,
-                                                      size_t* data_size,
-                                                      void* user_data)
+static here_tracking_error here_tracking_http_async_request(here_tracking_http_async* async)
 {
-    here_tracking_http_send_recv_ctx* send_recv_ctx = (here_tracking_http_send_recv_ctx*)user_data;
+    here_tracking_error err;
+    here_tracking_tls_writer tls_writer;
 
-    if(send_recv_ctx->send_data != NULL && send_recv_ctx->send_data_size > 0)
+    /* Whole request header section is built up front so that it can be written in pieces */
+    TRY((here_tracking_tls_writer_init_buffered(&tls_writer,
+                                                async->buffer,
+                                                HERE_TRACKING_HTTP_ASYNC_BUFFER_SIZE)));
+
+    if(async->auth)
     {
-        *data = send_recv_ctx->send_data;
-        *data_size = send_recv_ctx->send_data_size;
-        send_recv_ctx->send_data = NULL;
-        send_recv_ctx->send_data_size = 0;
+        TRY((here_tracking_http_write_auth_req(&tls_writer, async->client)));
     }
     else
     {
-        *data = NULL;
-        *data_size = 0;
+        TRY((here_tracking_http_write_send_stream_hdr(&tls_writer,
+                                                      async->client,
+                                                      async->req_type,
+                                                      async->resp_type,
+                                                      here_tracking_http_connection_hdr_val(
+                                                          async->client),
+                                                      NULL)));
     }
 
-    return HERE_TRACKING_OK;
+    async->out_data = async->buffer;
+    async->out_size = tls_writer.data_buffer.buffer_size;
+    async->out_pos = 0;
+    async->chunk_state = HERE_TRACKING_HTTP_ASYNC_CHUNK_NEXT;
+    async->state = HERE_TRACKING_HTTP_ASYNC_STATE_SEND_HDR;
+    async->deadline = here_tracking_http_deadline(async->client->timeouts.io_timeout,
+                                                  async->request_deadline);
+
+here_tracking_http_error:
+    return err;
 }
 
 /**************************************************************************************************/
 
-static here_tracking_error here_tracking_http_recv_cb(const here_tracking_recv_data* data,
-                                                      void* user_data)
+static here_tracking_error here_tracking_http_async_write(here_tracking_http_async* async)
 {
-    here_tracking_http_send_recv_ctx* send_recv_ctx = (here_tracking_http_send_recv_ctx*)user_data;
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t size;
 
-    switch(data->evt)
+    while(err == HERE_TRACKING_OK && async->out_pos < async->out_size)
     {
-        case HERE_TRACKING_RECV_EVT_RESP_SIZE:
+        size = (uint32_t)(async->out_size - async->out_pos);
+        err = here_tracking_tls_write(async->client->tls,
+                                      (const char*)(async->out_data + async->out_pos),
+                                      &size);
+
+        if(err == HERE_TRACKING_OK)
         {
-            send_recv_ctx->body_size = data->data_size;
+            async->out_pos += size;
+            async->deadline = here_tracking_http_deadline(async->client->timeouts.io_timeout,
+                                                          async->request_deadline);
         }
-        break;
+    }
 
-        case HERE_TRACKING_RECV_EVT_RESP_DATA:
+    return err;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http_async_set_out(here_tracking_http_async* async,
+                                             const uint8_t* data,
+                                             size_t data_size)
+{
+    async->out_data = data;
+    async->out_size = data_size;
+    async->out_pos = 0;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_async_send_hdr(here_tracking_http_async* async)
+{
+    here_tracking_error err = here_tracking_http_async_write(async);
+
+    if(err == HERE_TRACKING_OK)
+    {
+        if(async->auth)
         {
-            if(here_tracking_data_buffer_add_data(&send_recv_ctx->resp_buffer,
-                                                  (const char*)data->data,
-                                                  (uint32_t)data->data_size) != HERE_TRACKING_OK)
-            {
-                here_tracking_data_buffer_add_data(&send_recv_ctx->resp_buffer,
-                                                   (const char*)data->data,
-                                                   (send_recv_ctx->resp_buffer.buffer_capacity -
-                                                    send_recv_ctx->resp_buffer.buffer_size));
-                send_recv_ctx->status_code = HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
-            }
+            here_tracking_http_async_recv_init(async);
         }
-        break;
-
-        case HERE_TRACKING_RECV_EVT_RESP_COMPLETE:
+        else
         {
-            send_recv_ctx->status_code = data->err;
+            async->state = HERE_TRACKING_HTTP_ASYNC_STATE_SEND_BODY;
         }
-        break;
+    }
 
-        default:
-            send_recv_ctx->status_code = HERE_TRACKING_ERROR;
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_async_send_body(here_tracking_http_async* async)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_tls_writer tls_writer;
+
+    while(err == HERE_TRACKING_OK && async->chunk_state != HERE_TRACKING_HTTP_ASYNC_CHUNK_DONE)
+    {
+        switch(async->chunk_state)
+        {
+            case HERE_TRACKING_HTTP_ASYNC_CHUNK_NEXT:
+            {
+                /* Chunk data is written directly from the user buffer so it must stay valid
+                   until the next call to the send callback. */
+                TRY((async->send_cb(&async->chunk_data,
+                                    &async->chunk_size,
+                                    async->recv_ctx.user_data)));
+
+                if(async->chunk_data == NULL)
+                {
+                    async->chunk_size = 0;
+                }
+
+                TRY((here_tracking_tls_writer_init_buffered(
+                    &tls_writer, async->chunk_hdr, HERE_TRACKING_HTTP_ASYNC_CHUNK_HDR_SIZE)));
+                TRY((here_tracking_tls_writer_write_utoa(&tls_writer,
+                                                         (uint32_t)async->chunk_size,
+                                                         16)));
+                TRY((here_tracking_tls_writer_write_string(&tls_writer, here_tracking_http_crlf)));
+                here_tracking_http_async_set_out(async,
+                                                 async->chunk_hdr,
+                                                 tls_writer.data_buffer.buffer_size);
+                async->chunk_state = HERE_TRACKING_HTTP_ASYNC_CHUNK_HDR;
+            }
+            break;
+
+            case HERE_TRACKING_HTTP_ASYNC_CHUNK_HDR:
+            {
+                TRY((here_tracking_http_async_write(async)));
+
+                if(async->chunk_size > 0)
+                {
+                    here_tracking_http_async_set_out(async, async->chunk_data, async->chunk_size);
+                    async->chunk_state = HERE_TRACKING_HTTP_ASYNC_CHUNK_DATA;
+                }
+                else
+                {
+                    here_tracking_http_async_set_out(async,
+                                                     (const uint8_t*)here_tracking_http_crlf,
+                                                     strlen(here_tracking_http_crlf));
+                    async->chunk_state = HERE_TRACKING_HTTP_ASYNC_CHUNK_END;
+                }
+            }
+            break;
+
+            case HERE_TRACKING_HTTP_ASYNC_CHUNK_DATA:
+            {
+                TRY((here_tracking_http_async_write(async)));
+                here_tracking_http_async_set_out(async,
+                                                 (const uint8_t*)here_tracking_http_crlf,
+                                                 strlen(here_tracking_http_crlf));
+                async->chunk_state = HERE_TRACKING_HTTP_ASYNC_CHUNK_END;
+            }
+            break;
+
+            case HERE_TRACKING_HTTP_ASYNC_CHUNK_END:
+            {
+                TRY((here_tracking_http_async_write(async)));
+
+                /* Zero size chunk terminates the body */
+                async->chunk_state = (async->chunk_size > 0) ?
+                    HERE_TRACKING_HTTP_ASYNC_CHUNK_NEXT : HERE_TRACKING_HTTP_ASYNC_CHUNK_DONE;
+            }
+            break;
+
+            default:
+            {
+                err = HERE_TRACKING_ERROR;
+            }
             break;
+        }
     }
 
-    return send_recv_ctx->status_code;
+    if(err == HERE_TRACKING_OK)
+    {
+        here_tracking_http_async_recv_init(async);
+    }
+
+here_tracking_http_error:
+    return err;
 }
 
 /**************************************************************************************************/
 
-static here_tracking_error \
-    here_tracking_http_get_write_auth_header(here_tracking_tls_writer* tls_writer,
-                                             const here_tracking_http_header* auth_header)
+static void here_tracking_http_async_recv_init(here_tracking_http_async* async)
 {
-    here_tracking_error err;
+    here_tracking_http_parser_evt_cb resp_cb;
+    void* resp_cb_data;
 
-    TRY((here_tracking_tls_writer_write_string(tls_writer,
-                                               here_tracking_http_header_authorization)));
-    TRY((here_tracking_tls_writer_write_char(tls_writer, ':')));
+    if(async->auth)
+    {
+        here_tracking_http_auth_data_init(&async->auth_data, async->client);
+        resp_cb = here_tracking_http_auth_resp_cb;
+        resp_cb_data = &async->auth_data;
+    }
+    else
+    {
+        resp_cb = here_tracking_http_send_resp_cb;
+        resp_cb_data = &async->recv_ctx;
+    }
 
-    /* Make sure that 'Bearer' token type is set */
-    if(strncmp(auth_header->value,
-               here_tracking_http_header_bearer,
-               strlen(here_tracking_http_header_bearer)) != 0)
+    if(async->client->keep_alive.connected)
     {
-        TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_header_bearer)));
-        TRY((here_tracking_tls_writer_write_char(tls_writer, ' ')));
+        /* See here_tracking_http_recv_resp() */
+        async->drain_ctx.resp_cb = resp_cb;
+        async->drain_ctx.resp_cb_data = resp_cb_data;
+        async->drain_ctx.interrupted = false;
+        here_tracking_http_parser_init(&async->parser,
+                                       here_tracking_http_drain_cb,
+                                       &async->drain_ctx);
+    }
+    else
+    {
+        here_tracking_http_parser_init(&async->parser, resp_cb, resp_cb_data);
     }
 
-    TRY((here_tracking_tls_writer_write_string(tls_writer, auth_header->value)));
-    TRY((here_tracking_tls_writer_write_string(tls_writer, here_tracking_http_crlf)));
+    async->in_pos = 0;
+    async->in_size = 0;
+    async->state = HERE_TRACKING_HTTP_ASYNC_STATE_RECV;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_async_recv(here_tracking_http_async* async)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_NEED_MORE_DATA;
+    uint32_t size, parse_size;
+
+    while(err == HERE_TRACKING_ERROR_NEED_MORE_DATA)
+    {
+        /* See here_tracking_http_recv_resp() */
+        if(async->in_pos == async->in_size)
+        {
+            async->in_pos = async->in_size = 0;
+        }
+        else if(async->in_size == HERE_TRACKING_HTTP_ASYNC_BUFFER_SIZE && async->in_pos > 0)
+        {
+            memmove(async->buffer,
+                    (async->buffer + async->in_pos),
+                    async->in_size - async->in_pos);
+            async->in_size -= async->in_pos;
+            async->in_pos = 0;
+        }
+
+        size = HERE_TRACKING_HTTP_ASYNC_BUFFER_SIZE - async->in_size;
+
+        if(size == 0)
+        {
+            /* Parser requires more data to continue but work buffer is already full. */
+            err = HERE_TRACKING_ERROR;
+        }
+        else
+        {
+            err = here_tracking_tls_read(async->client->tls,
+                                         (char*)(async->buffer + async->in_size),
+                                         &size);
+
+            if(err == HERE_TRACKING_OK && size == 0)
+            {
+                /* Connection was closed before the response was complete */
+                err = HERE_TRACKING_ERROR;
+            }
+            else if(err == HERE_TRACKING_OK)
+            {
+                async->deadline = here_tracking_http_deadline(async->client->timeouts.io_timeout,
+                                                              async->request_deadline);
+                async->in_size += size;
+                parse_size = async->in_size - async->in_pos;
+                err = here_tracking_http_parser_parse(&async->parser,
+                                                      (char*)(async->buffer + async->in_pos),
+                                                      &parse_size);
+                async->in_pos += parse_size;
+            }
+        }
+    }
+
+    if(err != HERE_TRACKING_ERROR_WOULD_BLOCK)
+    {
+        here_tracking_http_async_recv_done(async, err);
+        err = HERE_TRACKING_OK;
+    }
 
-here_tracking_http_error:
     return err;
 }
 
 /**************************************************************************************************/
 
-static here_tracking_error here_tracking_http_get_correlation_id(here_tracking_client* client,
-                                                                 char* buffer, size_t buff_size)
+static void here_tracking_http_async_recv_done(here_tracking_http_async* async,
+                                               here_tracking_error err)
 {
-    here_tracking_error ret = HERE_TRACKING_OK;
+    here_tracking_client* client = async->client;
+    bool reusable = false;
 
-    if(NULL != client->correlation_id
-       && strlen(client->correlation_id) < buff_size)
+    if(err == HERE_TRACKING_OK && client->keep_alive.connected)
     {
-        strncpy(buffer, client->correlation_id, buff_size);
+        /* Connection can be reused only if the response ended exactly at the end of read data */
+        reusable = (async->parser.keep_alive && async->in_pos == async->in_size);
+
+        if(async->drain_ctx.interrupted)
+        {
+            err = HERE_TRACKING_ERROR_CLIENT_INTERRUPT;
+        }
+    }
+
+    here_tracking_http_release(client, reusable);
+
+    if(async->auth)
+    {
+        if(err == HERE_TRACKING_OK || err == HERE_TRACKING_ERROR_CLIENT_INTERRUPT)
+        {
+            err = async->auth_data.status_code;
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            /* Token received, continue with the actual request */
+            async->auth = false;
+            async->state = HERE_TRACKING_HTTP_ASYNC_STATE_CONNECT;
+        }
+        else if(err == HERE_TRACKING_ERROR_TIME_MISMATCH && !async->auth_retried)
+        {
+            /* Server time difference has been updated, retry once like here_tracking_auth() */
+            async->auth_retried = true;
+            async->state = HERE_TRACKING_HTTP_ASYNC_STATE_CONNECT;
+        }
+        else
+        {
+            here_tracking_http_async_finish(async, err);
+        }
     }
     else
     {
-        ret = here_tracking_uuid_gen_new(buffer, buff_size);
+        if(err == HERE_TRACKING_ERROR_CLIENT_INTERRUPT)
+        {
+            err = HERE_TRACKING_OK;
+        }
+
+        if(async->recv_ctx.status_code == HERE_TRACKING_ERROR_UNAUTHORIZED ||
+           async->recv_ctx.status_code == HERE_TRACKING_ERROR_FORBIDDEN)
+        {
+            here_tracking_http_clear_token(client);
+        }
+
+        here_tracking_http_async_finish(async, err);
     }
+}
 
-    return ret;
+/**************************************************************************************************/
+
+static void here_tracking_http_async_finish(here_tracking_http_async* async,
+                                            here_tracking_error result)
+{
+    async->result = result;
+    async->state = HERE_TRACKING_HTTP_ASYNC_STATE_DONE;
 }
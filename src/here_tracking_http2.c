@@ -0,0 +1,2010 @@
+/**************************************************************************************************
+* Copyright (C) 2017 HERE Europe B.V.                                                             *
+* All rights reserved.                                                                            *
+*                                                                                                 *
+* MIT License                                                                                     *
+* Permission is hereby granted, free of charge, to any person obtaining a copy                    *
+* of this software and associated documentation files (the "Software"), to deal                   *
+* in the Software without restriction, including without limitation the rights                    *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                       *
+* copies of the Software, and to permit persons to whom the Software is                           *
+* furnished to do so, subject to the following conditions:                                        *
+*                                                                                                 *
+* The above copyright notice and this permission notice shall be included in all                  *
+* copies or substantial portions of the Software.                                                 *
+*                                                                                                 *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                      *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                        *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                     *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                          *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                   *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                   *
+* SOFTWARE.                                                                                       *
+**************************************************************************************************/
+
+#include <string.h>
+
+#include "here_tracking_http2.h"
+#include "here_tracking_http_defs.h"
+#include "here_tracking_utils.h"
+
+/**************************************************************************************************/
+
+#define HERE_TRACKING_HTTP2_FRAME_HDR_SIZE 9
+
+#define HERE_TRACKING_HTTP2_FRAME_DATA          0x00
+#define HERE_TRACKING_HTTP2_FRAME_HEADERS       0x01
+#define HERE_TRACKING_HTTP2_FRAME_RST_STREAM    0x03
+#define HERE_TRACKING_HTTP2_FRAME_SETTINGS      0x04
+#define HERE_TRACKING_HTTP2_FRAME_PUSH_PROMISE  0x05
+#define HERE_TRACKING_HTTP2_FRAME_PING          0x06
+#define HERE_TRACKING_HTTP2_FRAME_GOAWAY        0x07
+#define HERE_TRACKING_HTTP2_FRAME_WINDOW_UPDATE 0x08
+#define HERE_TRACKING_HTTP2_FRAME_CONTINUATION  0x09
+#define HERE_TRACKING_HTTP2_FRAME_SKIP          0xff /* Rest of a frame that is not read */
+
+#define HERE_TRACKING_HTTP2_FLAG_END_STREAM  0x01
+#define HERE_TRACKING_HTTP2_FLAG_ACK         0x01
+#define HERE_TRACKING_HTTP2_FLAG_END_HEADERS 0x04
+#define HERE_TRACKING_HTTP2_FLAG_PADDED      0x08
+#define HERE_TRACKING_HTTP2_FLAG_PRIORITY    0x20
+
+#define HERE_TRACKING_HTTP2_SETTINGS_HEADER_TABLE_SIZE      0x01
+#define HERE_TRACKING_HTTP2_SETTINGS_ENABLE_PUSH            0x02
+#define HERE_TRACKING_HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS 0x03
+#define HERE_TRACKING_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE    0x04
+#define HERE_TRACKING_HTTP2_SETTINGS_MAX_FRAME_SIZE         0x05
+#define HERE_TRACKING_HTTP2_SETTING_SIZE                    6
+
+#define HERE_TRACKING_HTTP2_PING_SIZE         8
+#define HERE_TRACKING_HTTP2_WINDOW_UPDATE_SIZE 4
+#define HERE_TRACKING_HTTP2_RST_STREAM_SIZE   4
+#define HERE_TRACKING_HTTP2_GOAWAY_MIN_SIZE   8
+#define HERE_TRACKING_HTTP2_PRIORITY_SIZE     5
+
+#define HERE_TRACKING_HTTP2_WINDOW_DEFAULT     65535
+#define HERE_TRACKING_HTTP2_WINDOW_MAX         0x7fffffff
+#define HERE_TRACKING_HTTP2_FRAME_SIZE_DEFAULT 16384
+#define HERE_TRACKING_HTTP2_FRAME_SIZE_MAX     16777215
+#define HERE_TRACKING_HTTP2_STREAM_ID_MASK     0x7fffffff
+
+/* Received data is acknowledged when half of the default window is used */
+#define HERE_TRACKING_HTTP2_WINDOW_UPDATE_THRESHOLD (HERE_TRACKING_HTTP2_WINDOW_DEFAULT / 2)
+
+/* Table entry size includes 32 bytes of overhead, the stored entry has 4 bytes of lengths */
+#define HERE_TRACKING_HTTP2_TABLE_ENTRY_OVERHEAD 32
+#define HERE_TRACKING_HTTP2_TABLE_ENTRY_HDR_SIZE 4
+#define HERE_TRACKING_HTTP2_TABLE_ENTRY_MAX      0xffff
+
+#define HERE_TRACKING_HTTP2_STATIC_TABLE_SIZE 61
+#define HERE_TRACKING_HTTP2_HUFFMAN_MAX_BITS  30
+#define HERE_TRACKING_HTTP2_HUFFMAN_EOS       256
+
+/* Integers above this don't fit into 32 bits anymore */
+#define HERE_TRACKING_HTTP2_INT_MAX_SHIFT 28
+
+#define HERE_TRACKING_HTTP2_STATUS_INFO_MIN 100
+#define HERE_TRACKING_HTTP2_STATUS_INFO_MAX 199
+#define HERE_TRACKING_HTTP2_STATUS_NO_CONTENT 204
+
+/**************************************************************************************************/
+
+typedef struct
+{
+    const char* name;
+    const char* value;
+} here_tracking_http2_static_entry;
+
+/**************************************************************************************************/
+
+const char* here_tracking_http2_alpn[] = { "h2", "http/1.1", NULL };
+
+static const char* here_tracking_http2_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+/* RFC 7541 Appendix A */
+static const here_tracking_http2_static_entry here_tracking_http2_static_table[] =
+{
+    { ":authority", "" },
+    { ":method", "GET" },
+    { ":method", "POST" },
+    { ":path", "/" },
+    { ":path", "/index.html" },
+    { ":scheme", "http" },
+    { ":scheme", "https" },
+    { ":status", "200" },
+    { ":status", "204" },
+    { ":status", "206" },
+    { ":status", "304" },
+    { ":status", "400" },
+    { ":status", "404" },
+    { ":status", "500" },
+    { "accept-charset", "" },
+    { "accept-encoding", "gzip, deflate" },
+    { "accept-language", "" },
+    { "accept-ranges", "" },
+    { "accept", "" },
+    { "access-control-allow-origin", "" },
+    { "age", "" },
+    { "allow", "" },
+    { "authorization", "" },
+    { "cache-control", "" },
+    { "content-disposition", "" },
+    { "content-encoding", "" },
+    { "content-language", "" },
+    { "content-length", "" },
+    { "content-location", "" },
+    { "content-range", "" },
+    { "content-type", "" },
+    { "cookie", "" },
+    { "date", "" },
+    { "etag", "" },
+    { "expect", "" },
+    { "expires", "" },
+    { "from", "" },
+    { "host", "" },
+    { "if-match", "" },
+    { "if-modified-since", "" },
+    { "if-none-match", "" },
+    { "if-range", "" },
+    { "if-unmodified-since", "" },
+    { "last-modified", "" },
+    { "link", "" },
+    { "location", "" },
+    { "max-forwards", "" },
+    { "proxy-authenticate", "" },
+    { "proxy-authorization", "" },
+    { "range", "" },
+    { "referer", "" },
+    { "refresh", "" },
+    { "retry-after", "" },
+    { "server", "" },
+    { "set-cookie", "" },
+    { "strict-transport-security", "" },
+    { "transfer-encoding", "" },
+    { "user-agent", "" },
+    { "vary", "" },
+    { "via", "" },
+    { "www-authenticate", "" }
+};
+
+/* RFC 7541 Appendix B as a canonical code: number of codes of each length and the symbols sorted
+ * by code */
+static const uint8_t here_tracking_http2_huffman_counts[HERE_TRACKING_HTTP2_HUFFMAN_MAX_BITS + 1] =
+{
+    0, 0, 0, 0, 0, 10, 26, 32, 6, 0, 5, 3, 2, 6, 2, 3, 0, 0, 0, 3, 8, 13, 26, 29, 12, 4, 15, 19, 29,
+    0, 4
+};
+
+static const uint16_t here_tracking_http2_huffman_symbols[HERE_TRACKING_HTTP2_HUFFMAN_EOS + 1] =
+{
+    48, 49, 50, 97, 99, 101, 105, 111, 115, 116, 32, 37, 45, 46, 47, 51, 52, 53, 54, 55, 56, 57,
+    61, 65, 95, 98, 100, 102, 103, 104, 108, 109, 110, 112, 114, 117, 58, 66, 67, 68, 69, 70, 71,
+    72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 89, 106, 107, 113, 118, 119,
+    120, 121, 122, 38, 42, 44, 59, 88, 90, 33, 34, 40, 41, 63, 39, 43, 124, 35, 62, 0, 36, 64, 91,
+    93, 126, 94, 125, 60, 96, 123, 92, 195, 208, 128, 130, 131, 162, 184, 194, 224, 226, 153, 161,
+    167, 172, 176, 177, 179, 209, 216, 217, 227, 229, 230, 129, 132, 133, 134, 136, 146, 154, 156,
+    160, 163, 164, 169, 170, 173, 178, 181, 185, 186, 187, 189, 190, 196, 198, 228, 232, 233, 1,
+    135, 137, 138, 139, 140, 141, 143, 147, 149, 150, 151, 152, 155, 157, 158, 165, 166, 168, 174,
+    175, 180, 182, 183, 188, 191, 197, 231, 239, 9, 142, 144, 145, 148, 159, 171, 206, 215, 225,
+    236, 237, 199, 207, 234, 235, 192, 193, 200, 201, 202, 205, 210, 213, 218, 219, 238, 240, 242,
+    243, 255, 203, 204, 211, 212, 214, 221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252,
+    253, 254, 2, 3, 4, 5, 6, 7, 8, 11, 12, 14, 15, 16, 17, 18, 19, 20, 21, 23, 24, 25, 26, 27, 28,
+    29, 30, 31, 127, 220, 249, 10, 13, 22, 256
+};
+
+/**************************************************************************************************/
+
+static uint8_t here_tracking_http2_tolower(uint8_t c);
+
+static void here_tracking_http2_put_u32(uint8_t* data, uint32_t value);
+
+static uint32_t here_tracking_http2_get_u32(const uint8_t* data);
+
+static here_tracking_error here_tracking_http2_write_frame_hdr(here_tracking_tls_writer* tls_writer,
+                                                               uint32_t length,
+                                                               uint8_t type,
+                                                               uint8_t flags,
+                                                               uint32_t stream_id);
+
+static here_tracking_error \
+    here_tracking_http2_write_window_update(here_tracking_tls_writer* tls_writer,
+                                            uint32_t stream_id,
+                                            uint32_t increment);
+
+static bool here_tracking_http2_value_equal(const uint8_t* value,
+                                            uint32_t value_size,
+                                            const char* prefix,
+                                            uint32_t prefix_size,
+                                            const char* suffix,
+                                            uint32_t suffix_size);
+
+static void here_tracking_http2_table_find(const here_tracking_http2* conn,
+                                           const char* name,
+                                           uint32_t name_size,
+                                           const char* prefix,
+                                           uint32_t prefix_size,
+                                           const char* value,
+                                           uint32_t value_size,
+                                           uint32_t* index,
+                                           uint32_t* name_index);
+
+static void here_tracking_http2_table_evict(here_tracking_http2* conn, uint32_t size);
+
+static void here_tracking_http2_table_insert(here_tracking_http2* conn,
+                                             const char* name,
+                                             uint32_t name_size,
+                                             const char* prefix,
+                                             uint32_t prefix_size,
+                                             const char* value,
+                                             uint32_t value_size);
+
+static void here_tracking_http2_table_resize(here_tracking_http2* conn);
+
+static here_tracking_error here_tracking_http2_block_flush(here_tracking_http2_block* block,
+                                                           bool last);
+
+static here_tracking_error here_tracking_http2_block_put(here_tracking_http2_block* block,
+                                                         const uint8_t* data,
+                                                         uint32_t data_size,
+                                                         bool lower);
+
+static here_tracking_error here_tracking_http2_block_put_int(here_tracking_http2_block* block,
+                                                             uint8_t first,
+                                                             uint8_t prefix_bits,
+                                                             uint32_t value);
+
+static here_tracking_error here_tracking_http2_block_put_str(here_tracking_http2_block* block,
+                                                             const char* prefix,
+                                                             uint32_t prefix_size,
+                                                             const char* value,
+                                                             uint32_t value_size,
+                                                             bool lower);
+
+static here_tracking_error here_tracking_http2_int_decode(const uint8_t* data,
+                                                          uint32_t data_size,
+                                                          uint8_t prefix_bits,
+                                                          uint32_t* value,
+                                                          uint32_t* used);
+
+static here_tracking_error here_tracking_http2_huffman_decode(const uint8_t* data,
+                                                              uint32_t data_size,
+                                                              char* out,
+                                                              uint32_t out_capacity,
+                                                              uint32_t* out_size);
+
+static here_tracking_error here_tracking_http2_str_decode(here_tracking_http2_reader* reader,
+                                                          const uint8_t* data,
+                                                          uint32_t data_size,
+                                                          uint32_t* buffer_used,
+                                                          const char** str,
+                                                          uint32_t* str_size,
+                                                          uint32_t* used);
+
+static here_tracking_error here_tracking_http2_field_decode(here_tracking_http2_reader* reader,
+                                                            const uint8_t* data,
+                                                            uint32_t data_size,
+                                                            uint32_t* used);
+
+static here_tracking_error here_tracking_http2_field(here_tracking_http2_stream* stream,
+                                                     const char* name,
+                                                     uint32_t name_size,
+                                                     const char* value,
+                                                     uint32_t value_size);
+
+static void here_tracking_http2_stream_evt(here_tracking_http2_stream* stream,
+                                           const here_tracking_http_parser_evt* evt,
+                                           bool last);
+
+static void here_tracking_http2_stream_end(here_tracking_http2_stream* stream);
+
+static here_tracking_http2_stream* \
+    here_tracking_http2_reader_stream(const here_tracking_http2_reader* reader, uint32_t id);
+
+static here_tracking_error here_tracking_http2_frame_begin(here_tracking_http2* conn,
+                                                           here_tracking_http2_reader* reader,
+                                                           here_tracking_tls_writer* tls_writer,
+                                                           const uint8_t* data,
+                                                           uint32_t data_size,
+                                                           uint32_t* used);
+
+static here_tracking_error here_tracking_http2_frame_end(here_tracking_http2_reader* reader);
+
+static here_tracking_error here_tracking_http2_read_data(here_tracking_http2_reader* reader,
+                                                         const uint8_t* data,
+                                                         uint32_t data_size,
+                                                         uint32_t* used);
+
+static here_tracking_error here_tracking_http2_read_headers(here_tracking_http2_reader* reader,
+                                                            uint8_t* data,
+                                                            uint32_t data_size,
+                                                            uint32_t* used);
+
+static here_tracking_error here_tracking_http2_splice(here_tracking_http2_reader* reader,
+                                                      uint8_t* data,
+                                                      uint32_t data_size,
+                                                      uint32_t* used);
+
+static here_tracking_error here_tracking_http2_read_control(here_tracking_http2* conn,
+                                                            here_tracking_http2_reader* reader,
+                                                            here_tracking_tls_writer* tls_writer,
+                                                            const uint8_t* data,
+                                                            uint32_t data_size,
+                                                            uint32_t* used);
+
+static here_tracking_error here_tracking_http2_read_settings(here_tracking_http2* conn,
+                                                             here_tracking_http2_reader* reader,
+                                                             here_tracking_tls_writer* tls_writer,
+                                                             const uint8_t* data);
+
+/**************************************************************************************************/
+
+void here_tracking_http2_conn_init(here_tracking_http2* conn)
+{
+    conn->preface_sent = false;
+    conn->goaway = false;
+    conn->next_stream_id = 1;
+    conn->send_window = HERE_TRACKING_HTTP2_WINDOW_DEFAULT;
+    conn->recv_unacked = 0;
+    conn->initial_window = HERE_TRACKING_HTTP2_WINDOW_DEFAULT;
+    conn->max_frame_size = HERE_TRACKING_HTTP2_FRAME_SIZE_DEFAULT;
+    conn->max_streams = UINT32_MAX;
+    conn->table_limit = HERE_TRACKING_HTTP2_TABLE_SIZE_DEFAULT;
+    conn->table_max = HERE_TRACKING_HTTP2_TABLE_SIZE_DEFAULT;
+    conn->table_size = 0;
+    conn->table_used = 0;
+    conn->table_update = false;
+    here_tracking_http2_table_resize(conn);
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http2_start(here_tracking_http2* conn,
+                                              here_tracking_tls_writer* tls_writer)
+{
+    here_tracking_error err;
+    uint8_t settings[HERE_TRACKING_HTTP2_SETTING_SIZE * 2] = { 0 };
+
+    /* The dynamic table for responses is not supported and pushed responses are not used */
+    settings[1] = HERE_TRACKING_HTTP2_SETTINGS_HEADER_TABLE_SIZE;
+    settings[HERE_TRACKING_HTTP2_SETTING_SIZE + 1] = HERE_TRACKING_HTTP2_SETTINGS_ENABLE_PUSH;
+    err = here_tracking_tls_writer_write_string(tls_writer, here_tracking_http2_preface);
+
+    if(err == HERE_TRACKING_OK)
+    {
+        err = here_tracking_http2_write_frame_hdr(tls_writer,
+                                                  sizeof(settings),
+                                                  HERE_TRACKING_HTTP2_FRAME_SETTINGS,
+                                                  0,
+                                                  0);
+    }
+
+    if(err == HERE_TRACKING_OK)
+    {
+        err = here_tracking_tls_writer_write_data(tls_writer, settings, sizeof(settings));
+    }
+
+    conn->preface_sent = (err == HERE_TRACKING_OK);
+    return err;
+}
+
+/**************************************************************************************************/
+
+void here_tracking_http2_reader_init(here_tracking_http2_reader* reader)
+{
+    reader->stream_count = 0;
+    reader->in_frame = false;
+    reader->stream = NULL;
+    reader->header_block = false;
+    reader->block_end_stream = false;
+}
+
+/**************************************************************************************************/
+
+void here_tracking_http2_reader_clear(here_tracking_http2_reader* reader)
+{
+    reader->stream_count = 0;
+    reader->stream = NULL;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http2_stream_open(here_tracking_http2* conn,
+                                                    here_tracking_http2_reader* reader,
+                                                    here_tracking_http2_stream* stream,
+                                                    here_tracking_http_parser_evt_cb resp_cb,
+                                                    void* resp_cb_data)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR;
+
+    if(!conn->goaway &&
+       reader->stream_count < HERE_TRACKING_HTTP2_MAX_STREAMS &&
+       conn->next_stream_id <= HERE_TRACKING_HTTP2_STREAM_ID_MASK)
+    {
+        stream->id = conn->next_stream_id;
+        stream->send_window = (int32_t)conn->initial_window;
+        stream->recv_unacked = 0;
+        stream->resp_cb = resp_cb;
+        stream->resp_cb_data = resp_cb_data;
+        stream->err = HERE_TRACKING_OK;
+        stream->closed = false;
+        stream->interrupted = false;
+        stream->headers_done = false;
+        stream->skip_block = false;
+        stream->size_reported = false;
+        stream->body_empty = false;
+        stream->data_received = false;
+        conn->next_stream_id += 2;
+        reader->streams[reader->stream_count++] = stream;
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http2_block_begin(here_tracking_http2_block* block,
+                                                    here_tracking_http2* conn,
+                                                    here_tracking_tls_writer* tls_writer,
+                                                    const here_tracking_http2_stream* stream,
+                                                    bool end_stream)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+
+    block->conn = conn;
+    block->tls_writer = tls_writer;
+    block->stream_id = stream->id;
+    block->end_stream = end_stream;
+    block->first = true;
+    block->size = 0;
+
+    /* A changed table size must be signalled at the start of the next block */
+    if(conn->table_update)
+    {
+        err = here_tracking_http2_block_put_int(block, 0x20, 5, conn->table_max);
+        conn->table_update = false;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http2_block_add(here_tracking_http2_block* block,
+                                                  const char* name,
+                                                  const char* value_prefix,
+                                                  const char* value,
+                                                  uint32_t value_size,
+                                                  uint8_t flags)
+{
+    here_tracking_error err;
+    here_tracking_http2* conn = block->conn;
+    uint32_t name_size = (uint32_t)strlen(name);
+    uint32_t prefix_size = (value_prefix != NULL) ? (uint32_t)strlen(value_prefix) : 0;
+    uint32_t index = 0, name_index = 0, i;
+    bool insert = false;
+
+    for(i = 0; i < HERE_TRACKING_HTTP2_STATIC_TABLE_SIZE && index == 0; ++i)
+    {
+        const here_tracking_http2_static_entry* entry = &here_tracking_http2_static_table[i];
+
+        if(strlen(entry->name) == name_size &&
+           here_tracking_utils_memcasecmp((const uint8_t*)entry->name,
+                                          (const uint8_t*)name,
+                                          name_size) == 0)
+        {
+            if(name_index == 0)
+            {
+                name_index = i + 1;
+            }
+
+            if(here_tracking_http2_value_equal((const uint8_t*)entry->value,
+                                               (uint32_t)strlen(entry->value),
+                                               value_prefix,
+                                               prefix_size,
+                                               value,
+                                               value_size))
+            {
+                index = i + 1;
+            }
+        }
+    }
+
+    if(index == 0)
+    {
+        here_tracking_http2_table_find(conn,
+                                       name,
+                                       name_size,
+                                       value_prefix,
+                                       prefix_size,
+                                       value,
+                                       value_size,
+                                       &index,
+                                       &name_index);
+    }
+
+    if(index > 0)
+    {
+        err = here_tracking_http2_block_put_int(block, 0x80, 7, index);
+    }
+    else
+    {
+        if((flags & HERE_TRACKING_HTTP2_HDR_INDEX) &&
+           (name_size + prefix_size + value_size + HERE_TRACKING_HTTP2_TABLE_ENTRY_OVERHEAD) <= \
+                conn->table_max &&
+           name_size <= HERE_TRACKING_HTTP2_TABLE_ENTRY_MAX &&
+           (prefix_size + value_size) <= HERE_TRACKING_HTTP2_TABLE_ENTRY_MAX)
+        {
+            err = here_tracking_http2_block_put_int(block, 0x40, 6, name_index);
+            insert = true;
+        }
+        else
+        {
+            err = here_tracking_http2_block_put_int(block,
+                                                    (flags & HERE_TRACKING_HTTP2_HDR_SENSITIVE) ? \
+                                                        0x10 : 0x00,
+                                                    4,
+                                                    name_index);
+        }
+
+        if(err == HERE_TRACKING_OK && name_index == 0)
+        {
+            err = here_tracking_http2_block_put_str(block, NULL, 0, name, name_size, true);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_http2_block_put_str(block,
+                                                    value_prefix,
+                                                    prefix_size,
+                                                    value,
+                                                    value_size,
+                                                    false);
+        }
+
+        if(err == HERE_TRACKING_OK && insert)
+        {
+            here_tracking_http2_table_insert(conn,
+                                             name,
+                                             name_size,
+                                             value_prefix,
+                                             prefix_size,
+                                             value,
+                                             value_size);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http2_block_end(here_tracking_http2_block* block)
+{
+    return here_tracking_http2_block_flush(block, true);
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http2_write_data(here_tracking_http2* conn,
+                                                   here_tracking_tls_writer* tls_writer,
+                                                   here_tracking_http2_stream* stream,
+                                                   const uint8_t* data,
+                                                   uint32_t* data_size,
+                                                   bool end_stream)
+{
+    here_tracking_error err = stream->err;
+    uint32_t written = 0, size;
+    bool done = false;
+
+    while(err == HERE_TRACKING_OK && !done)
+    {
+        size = (*data_size) - written;
+
+        if(conn->send_window < 0 || stream->send_window < 0)
+        {
+            size = 0;
+        }
+        else
+        {
+            size = (size < (uint32_t)conn->send_window) ? size : (uint32_t)conn->send_window;
+            size = (size < (uint32_t)stream->send_window) ? size : (uint32_t)stream->send_window;
+            size = (size < conn->max_frame_size) ? size : conn->max_frame_size;
+        }
+
+        /* An empty frame is only needed to end the stream when there is no data left */
+        if(size > 0 || (end_stream && written == (*data_size)))
+        {
+            bool last = end_stream && (written + size) == (*data_size);
+
+            err = here_tracking_http2_write_frame_hdr(tls_writer,
+                                                      size,
+                                                      HERE_TRACKING_HTTP2_FRAME_DATA,
+                                                      last ? \
+                                                          HERE_TRACKING_HTTP2_FLAG_END_STREAM : 0,
+                                                      stream->id);
+
+            if(err == HERE_TRACKING_OK && size > 0)
+            {
+                err = here_tracking_tls_writer_write_data(tls_writer, data + written, size);
+            }
+
+            written += size;
+            conn->send_window -= (int32_t)size;
+            stream->send_window -= (int32_t)size;
+            done = last;
+        }
+
+        done = done || size == 0;
+    }
+
+    *data_size = written;
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_http2_read(here_tracking_http2* conn,
+                                             here_tracking_http2_reader* reader,
+                                             here_tracking_tls_writer* tls_writer,
+                                             uint8_t* data,
+                                             uint32_t* data_size)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t pos = 0, used;
+    bool in_frame;
+
+    do
+    {
+        in_frame = reader->in_frame;
+        used = 0;
+
+        if(!in_frame)
+        {
+            err = here_tracking_http2_frame_begin(conn,
+                                                  reader,
+                                                  tls_writer,
+                                                  data + pos,
+                                                  (*data_size) - pos,
+                                                  &used);
+        }
+        else
+        {
+            switch(reader->type)
+            {
+                case HERE_TRACKING_HTTP2_FRAME_DATA:
+                {
+                    err = here_tracking_http2_read_data(reader,
+                                                        data + pos,
+                                                        (*data_size) - pos,
+                                                        &used);
+                    break;
+                }
+                case HERE_TRACKING_HTTP2_FRAME_HEADERS:
+                case HERE_TRACKING_HTTP2_FRAME_CONTINUATION:
+                {
+                    err = here_tracking_http2_read_headers(reader,
+                                                           data + pos,
+                                                           (*data_size) - pos,
+                                                           &used);
+                    break;
+                }
+                case HERE_TRACKING_HTTP2_FRAME_SETTINGS:
+                case HERE_TRACKING_HTTP2_FRAME_RST_STREAM:
+                case HERE_TRACKING_HTTP2_FRAME_PING:
+                case HERE_TRACKING_HTTP2_FRAME_GOAWAY:
+                case HERE_TRACKING_HTTP2_FRAME_WINDOW_UPDATE:
+                {
+                    err = here_tracking_http2_read_control(conn,
+                                                           reader,
+                                                           tls_writer,
+                                                           data + pos,
+                                                           (*data_size) - pos,
+                                                           &used);
+                    break;
+                }
+                default:
+                {
+                    /* Unknown frames and the rest of known ones are skipped */
+                    used = (*data_size) - pos;
+                    used = (used < reader->length) ? used : reader->length;
+                    reader->length -= used;
+                    break;
+                }
+            }
+
+            if(err == HERE_TRACKING_OK && reader->length == 0)
+            {
+                uint32_t padding = (*data_size) - pos - used;
+
+                padding = (padding < reader->padding) ? padding : reader->padding;
+                reader->padding -= (uint8_t)padding;
+                used += padding;
+
+                if(reader->padding == 0)
+                {
+                    err = here_tracking_http2_frame_end(reader);
+                }
+            }
+        }
+
+        pos += used;
+    }
+    while(err == HERE_TRACKING_OK && (used > 0 || in_frame != reader->in_frame));
+
+    /* Window updates and replies to settings and pings are sent before waiting for more data */
+    if(err == HERE_TRACKING_OK && conn->recv_unacked >= HERE_TRACKING_HTTP2_WINDOW_UPDATE_THRESHOLD)
+    {
+        err = here_tracking_http2_write_window_update(tls_writer, 0, conn->recv_unacked);
+        conn->recv_unacked = 0;
+    }
+
+    *data_size = pos;
+    return err;
+}
+
+/**************************************************************************************************/
+
+bool here_tracking_http2_reader_done(const here_tracking_http2_reader* reader)
+{
+    bool done = true;
+    uint8_t i;
+
+    for(i = 0; i < reader->stream_count && done; ++i)
+    {
+        done = reader->streams[i]->closed;
+    }
+
+    return done;
+}
+
+/**************************************************************************************************/
+
+static uint8_t here_tracking_http2_tolower(uint8_t c)
+{
+    return (uint8_t)((c >= 'A' && c <= 'Z') ? (c - 'A' + 'a') : c);
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http2_put_u32(uint8_t* data, uint32_t value)
+{
+    data[0] = (uint8_t)(value >> 24);
+    data[1] = (uint8_t)(value >> 16);
+    data[2] = (uint8_t)(value >> 8);
+    data[3] = (uint8_t)value;
+}
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_http2_get_u32(const uint8_t* data)
+{
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | \
+        (uint32_t)data[3];
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_write_frame_hdr(here_tracking_tls_writer* tls_writer,
+                                                               uint32_t length,
+                                                               uint8_t type,
+                                                               uint8_t flags,
+                                                               uint32_t stream_id)
+{
+    uint8_t hdr[HERE_TRACKING_HTTP2_FRAME_HDR_SIZE];
+
+    hdr[0] = (uint8_t)(length >> 16);
+    hdr[1] = (uint8_t)(length >> 8);
+    hdr[2] = (uint8_t)length;
+    hdr[3] = type;
+    hdr[4] = flags;
+    here_tracking_http2_put_u32(hdr + 5, stream_id);
+    return here_tracking_tls_writer_write_data(tls_writer, hdr, sizeof(hdr));
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    here_tracking_http2_write_window_update(here_tracking_tls_writer* tls_writer,
+                                            uint32_t stream_id,
+                                            uint32_t increment)
+{
+    here_tracking_error err;
+    uint8_t payload[HERE_TRACKING_HTTP2_WINDOW_UPDATE_SIZE];
+
+    here_tracking_http2_put_u32(payload, increment);
+    err = here_tracking_http2_write_frame_hdr(tls_writer,
+                                              sizeof(payload),
+                                              HERE_TRACKING_HTTP2_FRAME_WINDOW_UPDATE,
+                                              0,
+                                              stream_id);
+
+    if(err == HERE_TRACKING_OK)
+    {
+        err = here_tracking_tls_writer_write_data(tls_writer, payload, sizeof(payload));
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_http2_value_equal(const uint8_t* value,
+                                            uint32_t value_size,
+                                            const char* prefix,
+                                            uint32_t prefix_size,
+                                            const char* suffix,
+                                            uint32_t suffix_size)
+{
+    return value_size == (prefix_size + suffix_size) &&
+           (prefix_size == 0 || memcmp(value, prefix, prefix_size) == 0) &&
+           (suffix_size == 0 || memcmp(value + prefix_size, suffix, suffix_size) == 0);
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http2_table_find(const here_tracking_http2* conn,
+                                           const char* name,
+                                           uint32_t name_size,
+                                           const char* prefix,
+                                           uint32_t prefix_size,
+                                           const char* value,
+                                           uint32_t value_size,
+                                           uint32_t* index,
+                                           uint32_t* name_index)
+{
+    uint32_t pos = 0, i = HERE_TRACKING_HTTP2_STATIC_TABLE_SIZE + 1;
+
+    /* Entries are stored newest first, which is also the order of the indices */
+    while(pos < conn->table_used && (*index) == 0)
+    {
+        const uint8_t* entry = conn->hpack_buffer + pos;
+        uint32_t entry_name_size = ((uint32_t)entry[0] << 8) | entry[1];
+        uint32_t entry_value_size = ((uint32_t)entry[2] << 8) | entry[3];
+
+        entry += HERE_TRACKING_HTTP2_TABLE_ENTRY_HDR_SIZE;
+
+        if(entry_name_size == name_size &&
+           here_tracking_utils_memcasecmp(entry, (const uint8_t*)name, name_size) == 0)
+        {
+            if((*name_index) == 0)
+            {
+                *name_index = i;
+            }
+
+            if(here_tracking_http2_value_equal(entry + entry_name_size,
+                                               entry_value_size,
+                                               prefix,
+                                               prefix_size,
+                                               value,
+                                               value_size))
+            {
+                *index = i;
+            }
+        }
+
+        pos += HERE_TRACKING_HTTP2_TABLE_ENTRY_HDR_SIZE + entry_name_size + entry_value_size;
+        ++i;
+    }
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http2_table_evict(here_tracking_http2* conn, uint32_t size)
+{
+    while(conn->table_size > size)
+    {
+        uint32_t pos = 0, last = 0, entry_size = 0;
+
+        while(pos < conn->table_used)
+        {
+            const uint8_t* entry = conn->hpack_buffer + pos;
+
+            last = pos;
+            entry_size = (((uint32_t)entry[0] << 8) | entry[1]) + \
+                (((uint32_t)entry[2] << 8) | entry[3]);
+            pos += HERE_TRACKING_HTTP2_TABLE_ENTRY_HDR_SIZE + entry_size;
+        }
+
+        conn->table_used = last;
+        conn->table_size -= entry_size + HERE_TRACKING_HTTP2_TABLE_ENTRY_OVERHEAD;
+    }
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http2_table_insert(here_tracking_http2* conn,
+                                             const char* name,
+                                             uint32_t name_size,
+                                             const char* prefix,
+                                             uint32_t prefix_size,
+                                             const char* value,
+                                             uint32_t value_size)
+{
+    uint32_t entry_size = name_size + prefix_size + value_size;
+    uint32_t stored_size = entry_size + HERE_TRACKING_HTTP2_TABLE_ENTRY_HDR_SIZE;
+    uint8_t* entry = conn->hpack_buffer;
+    uint32_t i;
+
+    /* Stored entries are smaller than their table size, so the buffer can't overflow */
+    here_tracking_http2_table_evict(conn,
+                                    conn->table_max - \
+                                        (entry_size + HERE_TRACKING_HTTP2_TABLE_ENTRY_OVERHEAD));
+    memmove(entry + stored_size, entry, conn->table_used);
+    entry[0] = (uint8_t)(name_size >> 8);
+    entry[1] = (uint8_t)name_size;
+    entry[2] = (uint8_t)((prefix_size + value_size) >> 8);
+    entry[3] = (uint8_t)(prefix_size + value_size);
+    entry += HERE_TRACKING_HTTP2_TABLE_ENTRY_HDR_SIZE;
+
+    for(i = 0; i < name_size; ++i)
+    {
+        entry[i] = here_tracking_http2_tolower((uint8_t)name[i]);
+    }
+
+    entry += name_size;
+
+    if(prefix_size > 0)
+    {
+        memcpy(entry, prefix, prefix_size);
+    }
+
+    if(value_size > 0)
+    {
+        memcpy(entry + prefix_size, value, value_size);
+    }
+
+    conn->table_used += stored_size;
+    conn->table_size += entry_size + HERE_TRACKING_HTTP2_TABLE_ENTRY_OVERHEAD;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http2_table_resize(here_tracking_http2* conn)
+{
+    uint32_t table_max = (conn->hpack_buffer != NULL) ? conn->hpack_buffer_size : 0;
+
+    table_max = (table_max < conn->table_limit) ? table_max : conn->table_limit;
+
+    if(table_max != conn->table_max)
+    {
+        conn->table_max = table_max;
+        here_tracking_http2_table_evict(conn, table_max);
+        conn->table_update = true;
+    }
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_block_flush(here_tracking_http2_block* block,
+                                                           bool last)
+{
+    here_tracking_error err;
+    uint8_t flags = last ? HERE_TRACKING_HTTP2_FLAG_END_HEADERS : 0;
+
+    if(block->first && block->end_stream)
+    {
+        flags |= HERE_TRACKING_HTTP2_FLAG_END_STREAM;
+    }
+
+    err = here_tracking_http2_write_frame_hdr(block->tls_writer,
+                                              block->size,
+                                              block->first ? \
+                                                  HERE_TRACKING_HTTP2_FRAME_HEADERS : \
+                                                  HERE_TRACKING_HTTP2_FRAME_CONTINUATION,
+                                              flags,
+                                              block->stream_id);
+
+    if(err == HERE_TRACKING_OK && block->size > 0)
+    {
+        err = here_tracking_tls_writer_write_data(block->tls_writer, block->buffer, block->size);
+    }
+
+    block->first = false;
+    block->size = 0;
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_block_put(here_tracking_http2_block* block,
+                                                         const uint8_t* data,
+                                                         uint32_t data_size,
+                                                         bool lower)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t pos = 0, size, i;
+
+    while(err == HERE_TRACKING_OK && pos < data_size)
+    {
+        if(block->size == HERE_TRACKING_HTTP2_BLOCK_FRAME_SIZE)
+        {
+            err = here_tracking_http2_block_flush(block, false);
+        }
+        else
+        {
+            uint8_t* out = block->buffer + block->size;
+
+            size = HERE_TRACKING_HTTP2_BLOCK_FRAME_SIZE - block->size;
+            size = ((data_size - pos) < size) ? (data_size - pos) : size;
+            memcpy(out, data + pos, size);
+
+            for(i = 0; lower && i < size; ++i)
+            {
+                out[i] = here_tracking_http2_tolower(out[i]);
+            }
+
+            block->size += (uint16_t)size;
+            pos += size;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_block_put_int(here_tracking_http2_block* block,
+                                                             uint8_t first,
+                                                             uint8_t prefix_bits,
+                                                             uint32_t value)
+{
+    uint8_t out[6];
+    uint32_t size = 0;
+    uint32_t max = (1u << prefix_bits) - 1;
+
+    if(value < max)
+    {
+        out[size++] = (uint8_t)(first | value);
+    }
+    else
+    {
+        out[size++] = (uint8_t)(first | max);
+        value -= max;
+
+        while(value >= 0x80)
+        {
+            out[size++] = (uint8_t)((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+
+        out[size++] = (uint8_t)value;
+    }
+
+    return here_tracking_http2_block_put(block, out, size, false);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_block_put_str(here_tracking_http2_block* block,
+                                                             const char* prefix,
+                                                             uint32_t prefix_size,
+                                                             const char* value,
+                                                             uint32_t value_size,
+                                                             bool lower)
+{
+    here_tracking_error err = here_tracking_http2_block_put_int(block,
+                                                                0x00,
+                                                                7,
+                                                                prefix_size + value_size);
+
+    if(err == HERE_TRACKING_OK)
+    {
+        err = here_tracking_http2_block_put(block, (const uint8_t*)prefix, prefix_size, lower);
+    }
+
+    if(err == HERE_TRACKING_OK)
+    {
+        err = here_tracking_http2_block_put(block, (const uint8_t*)value, value_size, lower);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_int_decode(const uint8_t* data,
+                                                          uint32_t data_size,
+                                                          uint8_t prefix_bits,
+                                                          uint32_t* value,
+                                                          uint32_t* used)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t max = (1u << prefix_bits) - 1;
+    uint32_t pos = 1, shift = 0;
+    bool more = ((data[0] & max) == max);
+
+    *value = data[0] & max;
+    *used = 0;
+
+    while(err == HERE_TRACKING_OK && more && pos < data_size)
+    {
+        if(shift > HERE_TRACKING_HTTP2_INT_MAX_SHIFT)
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+        else
+        {
+            *value += (uint32_t)(data[pos] & 0x7f) << shift;
+            more = (data[pos] & 0x80) != 0;
+            shift += 7;
+            ++pos;
+        }
+    }
+
+    if(err == HERE_TRACKING_OK && !more)
+    {
+        *used = pos;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_huffman_decode(const uint8_t* data,
+                                                              uint32_t data_size,
+                                                              char* out,
+                                                              uint32_t out_capacity,
+                                                              uint32_t* out_size)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t code = 0, first = 0, index = 0, len = 0, count, bit;
+
+    *out_size = 0;
+
+    /* Codes are read bit by bit, the codes of one length follow each other */
+    for(bit = 0; bit < data_size * 8 && err == HERE_TRACKING_OK; ++bit)
+    {
+        code |= (data[bit >> 3] >> (7 - (bit & 7))) & 1;
+        count = here_tracking_http2_huffman_counts[++len];
+
+        if(code < first + count)
+        {
+            uint16_t symbol = here_tracking_http2_huffman_symbols[index + code - first];
+
+            if(symbol == HERE_TRACKING_HTTP2_HUFFMAN_EOS)
+            {
+                err = HERE_TRACKING_ERROR;
+            }
+            else if((*out_size) == out_capacity)
+            {
+                err = HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+            }
+            else
+            {
+                out[(*out_size)++] = (char)symbol;
+            }
+
+            code = first = index = len = 0;
+        }
+        else if(len == HERE_TRACKING_HTTP2_HUFFMAN_MAX_BITS)
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+        else
+        {
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+    }
+
+    /* Padding is a prefix of EOS, which is all ones, and shorter than a byte */
+    if(err == HERE_TRACKING_OK && (len > 7 || (code >> 1) != ((1u << len) - 1)))
+    {
+        err = HERE_TRACKING_ERROR;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_str_decode(here_tracking_http2_reader* reader,
+                                                          const uint8_t* data,
+                                                          uint32_t data_size,
+                                                          uint32_t* buffer_used,
+                                                          const char** str,
+                                                          uint32_t* str_size,
+                                                          uint32_t* used)
+{
+    uint32_t size, pos;
+    here_tracking_error err = here_tracking_http2_int_decode(data, data_size, 7, &size, &pos);
+
+    *used = 0;
+
+    if(err == HERE_TRACKING_OK && pos > 0 && (data_size - pos) >= size)
+    {
+        if(data[0] & 0x80)
+        {
+            char* out = reader->hdr_buffer + (*buffer_used);
+
+            err = here_tracking_http2_huffman_decode(data + pos,
+                                                     size,
+                                                     out,
+                                                     HERE_TRACKING_HTTP2_HDR_BUFFER_SIZE - \
+                                                         (*buffer_used),
+                                                     str_size);
+            *str = out;
+            *buffer_used += *str_size;
+        }
+        else
+        {
+            *str = (const char*)(data + pos);
+            *str_size = size;
+        }
+
+        *used = pos + size;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_field_decode(here_tracking_http2_reader* reader,
+                                                            const uint8_t* data,
+                                                            uint32_t data_size,
+                                                            uint32_t* used)
+{
+    here_tracking_error err;
+    uint32_t index, pos = 0, size = 0, buffer_used = 0, name_size = 0, value_size = 0;
+    const char* name = NULL;
+    const char* value = NULL;
+    bool field = false;
+
+    if(data[0] & 0x80)
+    {
+        /* Indexed field */
+        err = here_tracking_http2_int_decode(data, data_size, 7, &index, &pos);
+
+        if(err == HERE_TRACKING_OK && pos > 0)
+        {
+            if(index == 0 || index > HERE_TRACKING_HTTP2_STATIC_TABLE_SIZE)
+            {
+                err = HERE_TRACKING_ERROR;
+            }
+            else
+            {
+                name = here_tracking_http2_static_table[index - 1].name;
+                value = here_tracking_http2_static_table[index - 1].value;
+                name_size = (uint32_t)strlen(name);
+                value_size = (uint32_t)strlen(value);
+                field = true;
+            }
+        }
+    }
+    else if((data[0] & 0xe0) == 0x20)
+    {
+        /* Table size update, the table is advertised with size 0 */
+        err = here_tracking_http2_int_decode(data, data_size, 5, &index, &pos);
+
+        if(err == HERE_TRACKING_OK && pos > 0 && index != 0)
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+    }
+    else
+    {
+        /* Literal field, with incremental indexing or not */
+        err = here_tracking_http2_int_decode(data,
+                                             data_size,
+                                             ((data[0] & 0xc0) == 0x40) ? 6 : 4,
+                                             &index,
+                                             &pos);
+
+        if(err == HERE_TRACKING_OK && pos > 0)
+        {
+            if(index > HERE_TRACKING_HTTP2_STATIC_TABLE_SIZE)
+            {
+                err = HERE_TRACKING_ERROR;
+            }
+            else if(index > 0)
+            {
+                name = here_tracking_http2_static_table[index - 1].name;
+                name_size = (uint32_t)strlen(name);
+            }
+            else if(pos < data_size)
+            {
+                err = here_tracking_http2_str_decode(reader,
+                                                     data + pos,
+                                                     data_size - pos,
+                                                     &buffer_used,
+                                                     &name,
+                                                     &name_size,
+                                                     &size);
+                pos = (size > 0) ? (pos + size) : 0;
+            }
+            else
+            {
+                pos = 0;
+            }
+        }
+
+        /* Fields too large for the buffer are left out */
+        field = (err == HERE_TRACKING_OK);
+        err = (err == HERE_TRACKING_ERROR_BUFFER_TOO_SMALL) ? HERE_TRACKING_OK : err;
+
+        if(err == HERE_TRACKING_OK && pos > 0 && pos < data_size)
+        {
+            here_tracking_error str_err = here_tracking_http2_str_decode(reader,
+                                                                         data + pos,
+                                                                         data_size - pos,
+                                                                         &buffer_used,
+                                                                         &value,
+                                                                         &value_size,
+                                                                         &size);
+
+            field = field && (str_err == HERE_TRACKING_OK);
+            err = (str_err == HERE_TRACKING_ERROR_BUFFER_TOO_SMALL) ? HERE_TRACKING_OK : str_err;
+            pos = (size > 0) ? (pos + size) : 0;
+        }
+        else
+        {
+            pos = 0;
+        }
+    }
+
+    *used = (err == HERE_TRACKING_OK) ? pos : 0;
+
+    if(err == HERE_TRACKING_OK && pos > 0 && field && reader->stream != NULL)
+    {
+        err = here_tracking_http2_field(reader->stream, name, name_size, value, value_size);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_field(here_tracking_http2_stream* stream,
+                                                     const char* name,
+                                                     uint32_t name_size,
+                                                     const char* value,
+                                                     uint32_t value_size)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_http_parser_evt evt;
+    size_t pseudo_size = strlen(here_tracking_http_pseudo_header_status);
+
+    if(stream->skip_block || stream->closed)
+    {
+        /* Informational responses and trailers are not reported */
+    }
+    else if(name_size == pseudo_size &&
+            memcmp(name, here_tracking_http_pseudo_header_status, pseudo_size) == 0)
+    {
+        uint32_t status = here_tracking_utils_atou(value, value_size);
+
+        if(value_size != 3 || status < HERE_TRACKING_HTTP2_STATUS_INFO_MIN)
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+        else if(status <= HERE_TRACKING_HTTP2_STATUS_INFO_MAX)
+        {
+            stream->skip_block = true;
+        }
+        else
+        {
+            stream->headers_done = true;
+            evt.id = HERE_TRACKING_HTTP_PARSER_EVT_STATUS_CODE;
+            evt.data.status_code = (here_tracking_http_parser_evt_status_code)status;
+            here_tracking_http2_stream_evt(stream, &evt, false);
+
+            if(status == HERE_TRACKING_HTTP2_STATUS_NO_CONTENT)
+            {
+                evt.id = HERE_TRACKING_HTTP_PARSER_EVT_BODY_SIZE;
+                evt.data.body_size = 0;
+                stream->size_reported = true;
+                stream->body_empty = true;
+                here_tracking_http2_stream_evt(stream, &evt, false);
+            }
+        }
+    }
+    else if(name_size > 0 && name[0] == ':')
+    {
+        /* Other pseudo headers are not expected in responses */
+    }
+    else if(stream->headers_done &&
+            !stream->body_empty &&
+            name_size <= UINT16_MAX &&
+            value_size <= UINT16_MAX)
+    {
+        evt.id = HERE_TRACKING_HTTP_PARSER_EVT_HDR;
+        evt.data.hdr.hdr_key = name;
+        evt.data.hdr.hdr_key_size = (uint16_t)name_size;
+        evt.data.hdr.hdr_val = value;
+        evt.data.hdr.hdr_val_size = (uint16_t)value_size;
+        here_tracking_http2_stream_evt(stream, &evt, false);
+
+        if(name_size == strlen(here_tracking_http_header_content_length) &&
+           here_tracking_utils_memcasecmp((const uint8_t*)name,
+                                          (const uint8_t*)here_tracking_http_header_content_length,
+                                          name_size) == 0)
+        {
+            evt.id = HERE_TRACKING_HTTP_PARSER_EVT_BODY_SIZE;
+            evt.data.body_size = here_tracking_utils_atou(value, value_size);
+            stream->size_reported = true;
+            stream->body_empty = (evt.data.body_size == 0);
+            here_tracking_http2_stream_evt(stream, &evt, false);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http2_stream_evt(here_tracking_http2_stream* stream,
+                                           const here_tracking_http_parser_evt* evt,
+                                           bool last)
+{
+    if(!stream->interrupted && stream->resp_cb != NULL)
+    {
+        stream->interrupted = stream->resp_cb(evt, last, stream->resp_cb_data);
+    }
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http2_stream_end(here_tracking_http2_stream* stream)
+{
+    here_tracking_http_parser_evt evt;
+
+    if(!stream->closed)
+    {
+        if(!stream->headers_done)
+        {
+            stream->err = HERE_TRACKING_ERROR;
+        }
+        else if(stream->body_empty)
+        {
+            /* The response is already complete */
+        }
+        else if(!stream->data_received && !stream->size_reported)
+        {
+            evt.id = HERE_TRACKING_HTTP_PARSER_EVT_BODY_SIZE;
+            evt.data.body_size = 0;
+            here_tracking_http2_stream_evt(stream, &evt, false);
+        }
+        else
+        {
+            evt.id = HERE_TRACKING_HTTP_PARSER_EVT_BODY;
+            evt.data.body.buffer = NULL;
+            evt.data.body.buffer_capacity = evt.data.body.buffer_size = 0;
+            here_tracking_http2_stream_evt(stream, &evt, true);
+        }
+
+        stream->closed = true;
+    }
+}
+
+/**************************************************************************************************/
+
+static here_tracking_http2_stream* \
+    here_tracking_http2_reader_stream(const here_tracking_http2_reader* reader, uint32_t id)
+{
+    here_tracking_http2_stream* stream = NULL;
+    uint8_t i;
+
+    for(i = 0; i < reader->stream_count && stream == NULL && id != 0; ++i)
+    {
+        if(reader->streams[i]->id == id)
+        {
+            stream = reader->streams[i];
+        }
+    }
+
+    return stream;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_frame_begin(here_tracking_http2* conn,
+                                                           here_tracking_http2_reader* reader,
+                                                           here_tracking_tls_writer* tls_writer,
+                                                           const uint8_t* data,
+                                                           uint32_t data_size,
+                                                           uint32_t* used)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t length, hdr_size = HERE_TRACKING_HTTP2_FRAME_HDR_SIZE, stream_id;
+    uint8_t type, flags, padding = 0;
+
+    *used = 0;
+
+    if(data_size >= HERE_TRACKING_HTTP2_FRAME_HDR_SIZE)
+    {
+        length = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+        type = data[3];
+        flags = data[4];
+        stream_id = here_tracking_http2_get_u32(data + 5) & HERE_TRACKING_HTTP2_STREAM_ID_MASK;
+
+        if(type == HERE_TRACKING_HTTP2_FRAME_DATA || type == HERE_TRACKING_HTTP2_FRAME_HEADERS)
+        {
+            hdr_size += (flags & HERE_TRACKING_HTTP2_FLAG_PADDED) ? 1 : 0;
+        }
+
+        if(type == HERE_TRACKING_HTTP2_FRAME_HEADERS)
+        {
+            hdr_size += (flags & HERE_TRACKING_HTTP2_FLAG_PRIORITY) ? \
+                HERE_TRACKING_HTTP2_PRIORITY_SIZE : 0;
+        }
+
+        /* Header blocks can only be continued with CONTINUATION frames of the same stream */
+        if(length > HERE_TRACKING_HTTP2_FRAME_SIZE_DEFAULT ||
+           (length + HERE_TRACKING_HTTP2_FRAME_HDR_SIZE) < hdr_size ||
+           type == HERE_TRACKING_HTTP2_FRAME_PUSH_PROMISE ||
+           (reader->header_block &&
+            (type != HERE_TRACKING_HTTP2_FRAME_CONTINUATION || stream_id != reader->stream_id)) ||
+           (!reader->header_block && type == HERE_TRACKING_HTTP2_FRAME_CONTINUATION) ||
+           ((type == HERE_TRACKING_HTTP2_FRAME_DATA || type == HERE_TRACKING_HTTP2_FRAME_HEADERS) &&
+            stream_id == 0))
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+        else if(data_size >= hdr_size)
+        {
+            if(hdr_size > HERE_TRACKING_HTTP2_FRAME_HDR_SIZE &&
+               (flags & HERE_TRACKING_HTTP2_FLAG_PADDED))
+            {
+                padding = data[HERE_TRACKING_HTTP2_FRAME_HDR_SIZE];
+            }
+
+            length -= hdr_size - HERE_TRACKING_HTTP2_FRAME_HDR_SIZE;
+
+            if(padding > length)
+            {
+                err = HERE_TRACKING_ERROR;
+            }
+            else
+            {
+                reader->in_frame = true;
+                reader->type = type;
+                reader->flags = flags;
+                reader->stream_id = stream_id;
+                reader->stream = here_tracking_http2_reader_stream(reader, stream_id);
+                reader->length = length - padding;
+                reader->padding = padding;
+                *used = hdr_size;
+            }
+        }
+    }
+
+    if(err == HERE_TRACKING_OK && reader->in_frame && (*used) > 0)
+    {
+        here_tracking_http2_stream* stream = reader->stream;
+
+        if(reader->type == HERE_TRACKING_HTTP2_FRAME_DATA)
+        {
+            /* Padding counts to flow control too */
+            uint32_t frame_size = reader->length + reader->padding + \
+                ((*used) - HERE_TRACKING_HTTP2_FRAME_HDR_SIZE);
+
+            conn->recv_unacked += frame_size;
+
+            if(stream != NULL && !stream->closed)
+            {
+                stream->recv_unacked += frame_size;
+
+                if(stream->recv_unacked >= HERE_TRACKING_HTTP2_WINDOW_UPDATE_THRESHOLD &&
+                   !(reader->flags & HERE_TRACKING_HTTP2_FLAG_END_STREAM))
+                {
+                    err = here_tracking_http2_write_window_update(tls_writer,
+                                                                  stream->id,
+                                                                  stream->recv_unacked);
+                    stream->recv_unacked = 0;
+                }
+            }
+        }
+        else if(reader->type == HERE_TRACKING_HTTP2_FRAME_HEADERS)
+        {
+            reader->block_end_stream = (reader->flags & HERE_TRACKING_HTTP2_FLAG_END_STREAM) != 0;
+
+            if(stream != NULL)
+            {
+                /* Header blocks after the final response headers are trailers */
+                stream->skip_block = stream->headers_done;
+            }
+        }
+
+        if(reader->type == HERE_TRACKING_HTTP2_FRAME_HEADERS ||
+           reader->type == HERE_TRACKING_HTTP2_FRAME_CONTINUATION)
+        {
+            reader->header_block = !(reader->flags & HERE_TRACKING_HTTP2_FLAG_END_HEADERS);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_frame_end(here_tracking_http2_reader* reader)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_http2_stream* stream = reader->stream;
+
+    reader->in_frame = false;
+
+    if(stream != NULL)
+    {
+        if(reader->type == HERE_TRACKING_HTTP2_FRAME_DATA)
+        {
+            if(reader->flags & HERE_TRACKING_HTTP2_FLAG_END_STREAM)
+            {
+                here_tracking_http2_stream_end(stream);
+            }
+        }
+        else if((reader->type == HERE_TRACKING_HTTP2_FRAME_HEADERS ||
+                 reader->type == HERE_TRACKING_HTTP2_FRAME_CONTINUATION) &&
+                !reader->header_block)
+        {
+            if(stream->skip_block)
+            {
+                stream->skip_block = false;
+            }
+            else if(!stream->headers_done && !stream->closed)
+            {
+                /* A response header block without status */
+                err = HERE_TRACKING_ERROR;
+            }
+
+            if(err == HERE_TRACKING_OK && reader->block_end_stream)
+            {
+                here_tracking_http2_stream_end(stream);
+            }
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_read_data(here_tracking_http2_reader* reader,
+                                                         const uint8_t* data,
+                                                         uint32_t data_size,
+                                                         uint32_t* used)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_http2_stream* stream = reader->stream;
+    uint32_t size = (data_size < reader->length) ? data_size : reader->length;
+
+    reader->length -= size;
+
+    if(stream != NULL && !stream->closed && size > 0)
+    {
+        if(!stream->headers_done)
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+        else
+        {
+            here_tracking_http_parser_evt evt;
+            bool last = (reader->flags & HERE_TRACKING_HTTP2_FLAG_END_STREAM) && \
+                reader->length == 0;
+
+            evt.id = HERE_TRACKING_HTTP_PARSER_EVT_BODY;
+            evt.data.body.buffer = (char*)data;
+            evt.data.body.buffer_capacity = evt.data.body.buffer_size = size;
+            stream->data_received = true;
+            here_tracking_http2_stream_evt(stream, &evt, last);
+            stream->closed = last;
+        }
+    }
+
+    *used = size;
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_read_headers(here_tracking_http2_reader* reader,
+                                                            uint8_t* data,
+                                                            uint32_t data_size,
+                                                            uint32_t* used)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t pos = 0, size, field_size = 1;
+
+    while(err == HERE_TRACKING_OK && pos < data_size && reader->length > 0 && field_size > 0)
+    {
+        size = ((data_size - pos) < reader->length) ? (data_size - pos) : reader->length;
+
+        if(reader->stream == NULL)
+        {
+            /* Header blocks of other streams are skipped, responses use no dynamic table */
+            field_size = size;
+        }
+        else
+        {
+            err = here_tracking_http2_field_decode(reader, data + pos, size, &field_size);
+
+            if(err == HERE_TRACKING_OK && field_size == 0 && size == reader->length)
+            {
+                /* The field continues in the next frame */
+                err = here_tracking_http2_splice(reader, data + pos, data_size - pos, &size);
+                pos += size;
+                field_size = size;
+                size = 0;
+            }
+        }
+
+        if(err == HERE_TRACKING_OK && size > 0)
+        {
+            pos += field_size;
+            reader->length -= field_size;
+        }
+    }
+
+    *used = pos;
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_splice(here_tracking_http2_reader* reader,
+                                                      uint8_t* data,
+                                                      uint32_t data_size,
+                                                      uint32_t* used)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t gap = reader->padding + HERE_TRACKING_HTTP2_FRAME_HDR_SIZE;
+    const uint8_t* next = data + reader->length + reader->padding;
+
+    *used = 0;
+
+    if(reader->flags & HERE_TRACKING_HTTP2_FLAG_END_HEADERS)
+    {
+        err = HERE_TRACKING_ERROR;
+    }
+    else if(data_size >= (reader->length + gap))
+    {
+        uint32_t length = ((uint32_t)next[0] << 16) | ((uint32_t)next[1] << 8) | next[2];
+
+        if(next[3] != HERE_TRACKING_HTTP2_FRAME_CONTINUATION ||
+           (here_tracking_http2_get_u32(next + 5) & HERE_TRACKING_HTTP2_STREAM_ID_MASK) != \
+               reader->stream_id ||
+           length > HERE_TRACKING_HTTP2_FRAME_SIZE_DEFAULT)
+        {
+            err = HERE_TRACKING_ERROR;
+        }
+        else
+        {
+            /* Move the start of the field next to its rest, the gap is read */
+            reader->flags = next[4];
+            reader->header_block = !(reader->flags & HERE_TRACKING_HTTP2_FLAG_END_HEADERS);
+            memmove(data + gap, data, reader->length);
+            reader->length += length;
+            reader->padding = 0;
+            *used = gap;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_read_control(here_tracking_http2* conn,
+                                                            here_tracking_http2_reader* reader,
+                                                            here_tracking_tls_writer* tls_writer,
+                                                            const uint8_t* data,
+                                                            uint32_t data_size,
+                                                            uint32_t* used)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    here_tracking_http2_stream* stream = reader->stream;
+    uint32_t size = reader->length, value;
+    uint8_t i;
+
+    /* Only the fixed part of GOAWAY is needed, the debug data is skipped */
+    if(reader->type == HERE_TRACKING_HTTP2_FRAME_GOAWAY)
+    {
+        size = HERE_TRACKING_HTTP2_GOAWAY_MIN_SIZE;
+    }
+
+    *used = 0;
+
+    if((reader->type == HERE_TRACKING_HTTP2_FRAME_WINDOW_UPDATE &&
+        reader->length != HERE_TRACKING_HTTP2_WINDOW_UPDATE_SIZE) ||
+       (reader->type == HERE_TRACKING_HTTP2_FRAME_RST_STREAM &&
+        (reader->length != HERE_TRACKING_HTTP2_RST_STREAM_SIZE || reader->stream_id == 0)) ||
+       (reader->type == HERE_TRACKING_HTTP2_FRAME_PING &&
+        (reader->length != HERE_TRACKING_HTTP2_PING_SIZE || reader->stream_id != 0)) ||
+       (reader->type == HERE_TRACKING_HTTP2_FRAME_GOAWAY &&
+        (reader->length < HERE_TRACKING_HTTP2_GOAWAY_MIN_SIZE || reader->stream_id != 0)) ||
+       (reader->type == HERE_TRACKING_HTTP2_FRAME_SETTINGS &&
+        ((reader->length % HERE_TRACKING_HTTP2_SETTING_SIZE) != 0 || reader->stream_id != 0)))
+    {
+        err = HERE_TRACKING_ERROR;
+    }
+    else if(data_size >= size)
+    {
+        switch(reader->type)
+        {
+            case HERE_TRACKING_HTTP2_FRAME_SETTINGS:
+            {
+                err = here_tracking_http2_read_settings(conn, reader, tls_writer, data);
+                break;
+            }
+            case HERE_TRACKING_HTTP2_FRAME_PING:
+            {
+                if(!(reader->flags & HERE_TRACKING_HTTP2_FLAG_ACK))
+                {
+                    err = here_tracking_http2_write_frame_hdr(tls_writer,
+                                                              size,
+                                                              HERE_TRACKING_HTTP2_FRAME_PING,
+                                                              HERE_TRACKING_HTTP2_FLAG_ACK,
+                                                              0);
+
+                    if(err == HERE_TRACKING_OK)
+                    {
+                        err = here_tracking_tls_writer_write_data(tls_writer, data, size);
+                    }
+                }
+
+                break;
+            }
+            case HERE_TRACKING_HTTP2_FRAME_WINDOW_UPDATE:
+            {
+                int32_t* window = (reader->stream_id == 0) ? &conn->send_window : NULL;
+
+                value = here_tracking_http2_get_u32(data) & HERE_TRACKING_HTTP2_STREAM_ID_MASK;
+
+                if(stream != NULL)
+                {
+                    window = &stream->send_window;
+                }
+
+                if(value == 0)
+                {
+                    err = HERE_TRACKING_ERROR;
+                }
+                else if(window != NULL)
+                {
+                    if((int64_t)(*window) + value > HERE_TRACKING_HTTP2_WINDOW_MAX)
+                    {
+                        err = HERE_TRACKING_ERROR;
+                    }
+                    else
+                    {
+                        *window += (int32_t)value;
+                    }
+                }
+
+                break;
+            }
+            case HERE_TRACKING_HTTP2_FRAME_RST_STREAM:
+            {
+                if(stream != NULL && !stream->closed)
+                {
+                    stream->err = HERE_TRACKING_ERROR;
+                    stream->closed = true;
+                }
+
+                break;
+            }
+            case HERE_TRACKING_HTTP2_FRAME_GOAWAY:
+            {
+                /* Streams above the last processed one were not handled and may be retried */
+                value = here_tracking_http2_get_u32(data) & HERE_TRACKING_HTTP2_STREAM_ID_MASK;
+                conn->goaway = true;
+
+                for(i = 0; i < reader->stream_count; ++i)
+                {
+                    if(reader->streams[i]->id > value && !reader->streams[i]->closed)
+                    {
+                        reader->streams[i]->err = HERE_TRACKING_ERROR;
+                        reader->streams[i]->closed = true;
+                    }
+                }
+
+                reader->type = HERE_TRACKING_HTTP2_FRAME_SKIP;
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+
+        *used = size;
+        reader->length -= size;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http2_read_settings(here_tracking_http2* conn,
+                                                             here_tracking_http2_reader* reader,
+                                                             here_tracking_tls_writer* tls_writer,
+                                                             const uint8_t* data)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t pos, value;
+    uint16_t id;
+    uint8_t i;
+
+    if(reader->flags & HERE_TRACKING_HTTP2_FLAG_ACK)
+    {
+        err = (reader->length == 0) ? HERE_TRACKING_OK : HERE_TRACKING_ERROR;
+    }
+    else
+    {
+        for(pos = 0; pos < reader->length && err == HERE_TRACKING_OK;
+            pos += HERE_TRACKING_HTTP2_SETTING_SIZE)
+        {
+            id = (uint16_t)(((uint16_t)data[pos] << 8) | data[pos + 1]);
+            value = here_tracking_http2_get_u32(data + pos + 2);
+
+            switch(id)
+            {
+                case HERE_TRACKING_HTTP2_SETTINGS_HEADER_TABLE_SIZE:
+                {
+                    conn->table_limit = value;
+                    here_tracking_http2_table_resize(conn);
+                    break;
+                }
+                case HERE_TRACKING_HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS:
+                {
+                    conn->max_streams = value;
+                    break;
+                }
+                case HERE_TRACKING_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE:
+                {
+                    if(value > HERE_TRACKING_HTTP2_WINDOW_MAX)
+                    {
+                        err = HERE_TRACKING_ERROR;
+                    }
+                    else
+                    {
+                        /* The change applies to the windows of open streams too */
+                        for(i = 0; i < reader->stream_count; ++i)
+                        {
+                            reader->streams[i]->send_window += \
+                                (int32_t)(value - conn->initial_window);
+                        }
+
+                        conn->initial_window = value;
+                    }
+
+                    break;
+                }
+                case HERE_TRACKING_HTTP2_SETTINGS_MAX_FRAME_SIZE:
+                {
+                    if(value < HERE_TRACKING_HTTP2_FRAME_SIZE_DEFAULT ||
+                       value > HERE_TRACKING_HTTP2_FRAME_SIZE_MAX)
+                    {
+                        err = HERE_TRACKING_ERROR;
+                    }
+                    else
+                    {
+                        conn->max_frame_size = value;
+                    }
+
+                    break;
+                }
+                default:
+                {
+                    break;
+                }
+            }
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_http2_write_frame_hdr(tls_writer,
+                                                      0,
+                                                      HERE_TRACKING_HTTP2_FRAME_SETTINGS,
+                                                      HERE_TRACKING_HTTP2_FLAG_ACK,
+                                                      0);
+        }
+    }
+
+    return err;
+}
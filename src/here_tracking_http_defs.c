@@ -24,6 +24,8 @@
 
 const char* here_tracking_http_connection_close          = "close";
 
+const char* here_tracking_http_connection_keep_alive     = "keep-alive";
+
 const char* here_tracking_http_content_type_json         = "application/json";
 
 const char* here_tracking_http_content_type_octet_stream = "application/octet-stream";
@@ -32,10 +34,14 @@ const char* here_tracking_http_crlf                      = "\r\n";
 
 const char* here_tracking_http_header_accept             = "Accept";
 
+const char* here_tracking_http_header_accept_encoding    = "Accept-Encoding";
+
 const char* here_tracking_http_header_authorization      = "Authorization";
 
 const char* here_tracking_http_header_connection         = "Connection";
 
+const char* here_tracking_http_header_content_encoding   = "Content-Encoding";
+
 const char* here_tracking_http_header_content_length     = "Content-Length";
 
 const char* here_tracking_http_header_content_type       = "Content-Type";
@@ -54,4 +60,16 @@ const char* here_tracking_http_path_version              = "/v2";
 
 const char* here_tracking_http_protocol_https            = "https://";
 
+const char* here_tracking_http_pseudo_header_authority   = ":authority";
+
+const char* here_tracking_http_pseudo_header_method      = ":method";
+
+const char* here_tracking_http_pseudo_header_path        = ":path";
+
+const char* here_tracking_http_pseudo_header_scheme      = ":scheme";
+
+const char* here_tracking_http_pseudo_header_status      = ":status";
+
+const char* here_tracking_http_scheme_https              = "https";
+
 const char* here_tracking_http_transfer_encoding_chunked = "chunked";
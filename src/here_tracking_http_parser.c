@@ -66,6 +66,20 @@ static here_tracking_error here_tracking_http_parser_parse_body(here_tracking_ht
                                                                 const char* data,
                                                                 uint32_t* data_size);
 
+static here_tracking_error here_tracking_http_parser_parse_chunk(here_tracking_http_parser* parser,
+                                                                 const char* data,
+                                                                 uint32_t* data_size);
+
+static bool here_tracking_http_parser_find_crlf(here_tracking_http_parser* parser,
+                                                const char* data,
+                                                uint32_t data_size,
+                                                uint32_t* line_size);
+
+static bool here_tracking_http_parser_body_done(const here_tracking_http_parser* parser);
+
+static void here_tracking_http_parser_connection_hdr(here_tracking_http_parser* parser,
+                                                     const here_tracking_http_parser_evt_hdr* hdr);
+
 /**************************************************************************************************/
 
 #define HERE_TRACKING_HTTP_PARSER_CMP(DATA, STR) memcmp(DATA, STR, strlen(STR))
@@ -84,6 +98,10 @@ here_tracking_error here_tracking_http_parser_init(here_tracking_http_parser* pa
         parser->cb = cb;
         parser->cb_data = cb_data;
         parser->content_size = HERE_TRACKING_HTTP_PARSER_CONTENT_LENGTH_UNKNOWN;
+        parser->chunked = false;
+        parser->chunk_state = HERE_TRACKING_HTTP_PARSER_CHUNK_SIZE;
+        parser->keep_alive = false;
+        parser->scan_pos = 0;
     }
     else
     {
@@ -105,8 +123,12 @@ here_tracking_error here_tracking_http_parser_parse(here_tracking_http_parser* p
     {
         uint32_t pos = 0, size = (*data_size);
 
-        /* Run as long as all is well and new data is available */
-        while(err == HERE_TRACKING_OK && pos < (*data_size))
+        /* Run as long as all is well and new data is available. Stop at the end of the response,
+           data after it belongs to the next response on the connection. */
+        while(err == HERE_TRACKING_OK &&
+              pos < (*data_size) &&
+              !(parser->evt_state == HERE_TRACKING_HTTP_PARSER_EVT_BODY &&
+                here_tracking_http_parser_body_done(parser)))
         {
             switch(parser->evt_state)
             {
@@ -136,7 +158,14 @@ here_tracking_error here_tracking_http_parser_parse(here_tracking_http_parser* p
 
                 case HERE_TRACKING_HTTP_PARSER_EVT_BODY:
                 {
-                    err = here_tracking_http_parser_parse_body(parser, (data + pos), &size);
+                    if(parser->chunked)
+                    {
+                        err = here_tracking_http_parser_parse_chunk(parser, (data + pos), &size);
+                    }
+                    else
+                    {
+                        err = here_tracking_http_parser_parse_body(parser, (data + pos), &size);
+                    }
                 }
                 break;
 
@@ -164,7 +193,7 @@ here_tracking_error here_tracking_http_parser_parse(here_tracking_http_parser* p
             if(parser->evt_state == HERE_TRACKING_HTTP_PARSER_EVT_BODY)
             {
                 /* Content left to parse */
-                if(parser->content_size > 0)
+                if(!here_tracking_http_parser_body_done(parser))
                 {
                     err = HERE_TRACKING_ERROR_NEED_MORE_DATA;
                 }
@@ -228,6 +257,10 @@ static here_tracking_error \
                         evt.data.version.minor =
                             here_tracking_utils_atou(data + minor_pos, pos - minor_pos);
                         (*data_size) = pos + 1;
+                        /* Connections are persistent by default starting from HTTP/1.1 */
+                        parser->keep_alive = (evt.data.version.major > 1 ||
+                                              (evt.data.version.major == 1 &&
+                                               evt.data.version.minor >= 1));
                         err = parser->cb(&evt, true, parser->cb_data) ?
                             HERE_TRACKING_ERROR_CLIENT_INTERRUPT : HERE_TRACKING_OK;
                         parser->evt_state = HERE_TRACKING_HTTP_PARSER_EVT_STATUS_CODE;
@@ -320,33 +353,32 @@ static here_tracking_error here_tracking_http_parser_parse_reason(here_tracking_
 {
     here_tracking_error err = HERE_TRACKING_ERROR_NEED_MORE_DATA;
 
+    uint32_t pos;
+
     /* Minimum 3 bytes required, 1 to N for reason phrase, 2 for CRLF */
     if((*data_size) >= strlen(here_tracking_http_crlf) + 1)
     {
-        uint32_t pos = 1; /* Start from index 1 as must find one character before CRLF */
-
-        while(pos <= (*data_size) - strlen(here_tracking_http_crlf))
+        /* Start from index 1 as must find one character before CRLF */
+        if(parser->scan_pos == 0)
         {
-            if(HERE_TRACKING_HTTP_PARSER_CMP((data + pos), here_tracking_http_crlf) == 0)
-            {
-                here_tracking_http_parser_evt evt;
-
-                evt.id = HERE_TRACKING_HTTP_PARSER_EVT_REASON;
-                evt.data.reason.buffer = (char*)data;
-                evt.data.reason.buffer_capacity = evt.data.reason.buffer_size = pos;
-                (*data_size) = pos + (uint32_t)strlen(here_tracking_http_crlf);
-                err = parser->cb(&evt, true, parser->cb_data) ?
-                    HERE_TRACKING_ERROR_CLIENT_INTERRUPT : HERE_TRACKING_OK;
-                parser->evt_state = HERE_TRACKING_HTTP_PARSER_EVT_HDR;
-                break;
-            }
-            else
-            {
-                pos++;
-            }
+            parser->scan_pos = 1;
         }
     }
 
+    if((*data_size) >= strlen(here_tracking_http_crlf) + 1 &&
+       here_tracking_http_parser_find_crlf(parser, data, (*data_size), &pos))
+    {
+        here_tracking_http_parser_evt evt;
+
+        evt.id = HERE_TRACKING_HTTP_PARSER_EVT_REASON;
+        evt.data.reason.buffer = (char*)data;
+        evt.data.reason.buffer_capacity = evt.data.reason.buffer_size = pos;
+        (*data_size) = pos + (uint32_t)strlen(here_tracking_http_crlf);
+        err = parser->cb(&evt, true, parser->cb_data) ?
+            HERE_TRACKING_ERROR_CLIENT_INTERRUPT : HERE_TRACKING_OK;
+        parser->evt_state = HERE_TRACKING_HTTP_PARSER_EVT_HDR;
+    }
+
     if(err == HERE_TRACKING_ERROR_NEED_MORE_DATA)
     {
         (*data_size) = 0;
@@ -365,14 +397,25 @@ static here_tracking_error here_tracking_http_parser_hdr_end(here_tracking_http_
 
     (*data_size) = (uint32_t)strlen(here_tracking_http_crlf);
 
-    if(parser->content_size == HERE_TRACKING_HTTP_PARSER_CONTENT_LENGTH_UNKNOWN)
+    if(parser->chunked && parser->content_size != 0)
     {
-        /* Content length header wasn't found. Required for this parser. */
+        /* Chunked transfer coding overrides the content length. Body starts with a chunk size. */
+        err = HERE_TRACKING_OK;
+        parser->content_size = 0;
+        parser->chunk_state = HERE_TRACKING_HTTP_PARSER_CHUNK_SIZE;
+        parser->evt_state = HERE_TRACKING_HTTP_PARSER_EVT_BODY;
+    }
+    else if(parser->content_size == HERE_TRACKING_HTTP_PARSER_CONTENT_LENGTH_UNKNOWN)
+    {
+        /* Content length header wasn't found. Required for this parser unless the body is
+           chunked. */
         err = HERE_TRACKING_ERROR;
     }
     else
     {
+        /* Body size known from the content length or the status code */
         err = HERE_TRACKING_OK;
+        parser->chunked = false;
         parser->evt_state = HERE_TRACKING_HTTP_PARSER_EVT_BODY;
     }
 
@@ -437,44 +480,62 @@ static here_tracking_error here_tracking_http_parser_parse_hdr(here_tracking_htt
         }
         else
         {
-            uint32_t pos = 1;
+            uint32_t pos;
 
-            while(pos <= (*data_size) - strlen(here_tracking_http_crlf))
+            if(here_tracking_http_parser_find_crlf(parser, data, (*data_size), &pos))
             {
-                if(HERE_TRACKING_HTTP_PARSER_CMP((data + pos), here_tracking_http_crlf) == 0)
-                {
-                    here_tracking_http_parser_evt evt;
+                here_tracking_http_parser_evt evt;
 
-                    err = here_tracking_http_parser_build_hdr_evt(data, pos, &evt);
+                err = here_tracking_http_parser_build_hdr_evt(data, pos, &evt);
 
-                    if(err == HERE_TRACKING_OK)
-                    {
-                        here_tracking_http_parser_evt_hdr* hdr = &evt.data.hdr;
+                if(err == HERE_TRACKING_OK)
+                {
+                    here_tracking_http_parser_evt_hdr* hdr = &evt.data.hdr;
+
+                    (*data_size) = pos + (uint32_t)strlen(here_tracking_http_crlf);
 
-                        (*data_size) = pos + (uint32_t)strlen(here_tracking_http_crlf);
+                    err = parser->cb(&evt, true, parser->cb_data) ?
+                        HERE_TRACKING_ERROR_CLIENT_INTERRUPT : HERE_TRACKING_OK;
 
+                    if(err == HERE_TRACKING_OK &&
+                       hdr->hdr_key_size == strlen(here_tracking_http_header_content_length) &&
+                       here_tracking_utils_memcasecmp((uint8_t*)hdr->hdr_key,
+                                            (uint8_t*)here_tracking_http_header_content_length,
+                                            hdr->hdr_key_size) == 0)
+                    {
+                        parser->content_size = here_tracking_utils_atou(hdr->hdr_val,
+                                                                        hdr->hdr_val_size);
+                        evt.id = HERE_TRACKING_HTTP_PARSER_EVT_BODY_SIZE;
+                        evt.data.body_size = (uint32_t)parser->content_size;
                         err = parser->cb(&evt, true, parser->cb_data) ?
                             HERE_TRACKING_ERROR_CLIENT_INTERRUPT : HERE_TRACKING_OK;
-
-                        if(err == HERE_TRACKING_OK &&
-                           hdr->hdr_key_size == strlen(here_tracking_http_header_content_length) &&
-                           here_tracking_utils_memcasecmp((uint8_t*)hdr->hdr_key,
-                                                (uint8_t*)here_tracking_http_header_content_length,
+                    }
+                    else if(err == HERE_TRACKING_OK &&
+                            hdr->hdr_key_size ==
+                                strlen(here_tracking_http_header_transfer_encoding) &&
+                            here_tracking_utils_memcasecmp((uint8_t*)hdr->hdr_key,
+                                        (uint8_t*)here_tracking_http_header_transfer_encoding,
+                                        hdr->hdr_key_size) == 0)
+                    {
+                        /* Chunked must be the last coding applied */
+                        size_t chunked_size =
+                            strlen(here_tracking_http_transfer_encoding_chunked);
+
+                        parser->chunked = (hdr->hdr_val_size >= chunked_size &&
+                            here_tracking_utils_memcasecmp((uint8_t*)(hdr->hdr_val +
+                                                               hdr->hdr_val_size -
+                                                               chunked_size),
+                                        (uint8_t*)here_tracking_http_transfer_encoding_chunked,
+                                        chunked_size) == 0);
+                    }
+                    else if(hdr->hdr_key_size == strlen(here_tracking_http_header_connection) &&
+                            here_tracking_utils_memcasecmp((uint8_t*)hdr->hdr_key,
+                                                (uint8_t*)here_tracking_http_header_connection,
                                                 hdr->hdr_key_size) == 0)
-                        {
-                            parser->content_size = here_tracking_utils_atou(hdr->hdr_val,
-                                                                            hdr->hdr_val_size);
-                            evt.id = HERE_TRACKING_HTTP_PARSER_EVT_BODY_SIZE;
-                            evt.data.body_size = (uint32_t)parser->content_size;
-                            err = parser->cb(&evt, true, parser->cb_data) ?
-                                HERE_TRACKING_ERROR_CLIENT_INTERRUPT : HERE_TRACKING_OK;
-                        }
+                    {
+                        here_tracking_http_parser_connection_hdr(parser, hdr);
                     }
-
-                    break;
                 }
-
-                pos++;
             }
         }
     }
@@ -521,3 +582,197 @@ static here_tracking_error here_tracking_http_parser_parse_body(here_tracking_ht
 
     return err;
 }
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_http_parser_parse_chunk(here_tracking_http_parser* parser,
+                                                                 const char* data,
+                                                                 uint32_t* data_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_NEED_MORE_DATA;
+    here_tracking_http_parser_evt evt;
+    uint32_t line_size;
+
+    evt.id = HERE_TRACKING_HTTP_PARSER_EVT_BODY;
+    evt.data.body.buffer = (char*)data;
+
+    switch(parser->chunk_state)
+    {
+        case HERE_TRACKING_HTTP_PARSER_CHUNK_SIZE:
+        {
+            if(here_tracking_http_parser_find_crlf(parser, data, (*data_size), &line_size))
+            {
+                uint32_t digits = 0;
+
+                while(digits < line_size && here_tracking_utils_isxdigit(data[digits]))
+                {
+                    digits++;
+                }
+
+                /* Size may be followed by chunk extensions which are ignored. Size is limited so
+                   that it fits in content size. */
+                if(digits == 0 ||
+                   digits > 7 ||
+                   (digits < line_size && data[digits] != ';' && data[digits] != ' '))
+                {
+                    err = HERE_TRACKING_ERROR;
+                }
+                else
+                {
+                    parser->content_size = (int32_t)here_tracking_utils_xtou(data, digits);
+                    parser->chunk_state = (parser->content_size > 0) ?
+                        HERE_TRACKING_HTTP_PARSER_CHUNK_DATA :
+                        HERE_TRACKING_HTTP_PARSER_CHUNK_TRAILER;
+                    (*data_size) = line_size + (uint32_t)strlen(here_tracking_http_crlf);
+                    err = HERE_TRACKING_OK;
+                }
+            }
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_PARSER_CHUNK_DATA:
+        {
+            /* Chunk data is passed on from the input buffer as is */
+            if(parser->content_size <= (*data_size))
+            {
+                (*data_size) = parser->content_size;
+                parser->content_size = 0;
+                parser->chunk_state = HERE_TRACKING_HTTP_PARSER_CHUNK_DATA_END;
+                err = HERE_TRACKING_OK;
+            }
+            else
+            {
+                parser->content_size -= (*data_size);
+            }
+
+            evt.data.body.buffer_capacity = evt.data.body.buffer_size = (*data_size);
+
+            if(parser->cb(&evt, false, parser->cb_data))
+            {
+                err = HERE_TRACKING_ERROR_CLIENT_INTERRUPT;
+            }
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_PARSER_CHUNK_DATA_END:
+        {
+            if((*data_size) >= strlen(here_tracking_http_crlf))
+            {
+                if(HERE_TRACKING_HTTP_PARSER_CMP(data, here_tracking_http_crlf) == 0)
+                {
+                    (*data_size) = (uint32_t)strlen(here_tracking_http_crlf);
+                    parser->chunk_state = HERE_TRACKING_HTTP_PARSER_CHUNK_SIZE;
+                    err = HERE_TRACKING_OK;
+                }
+                else
+                {
+                    err = HERE_TRACKING_ERROR;
+                }
+            }
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_PARSER_CHUNK_TRAILER:
+        {
+            if(here_tracking_http_parser_find_crlf(parser, data, (*data_size), &line_size))
+            {
+                /* Trailer fields are skipped, empty line ends the body */
+                (*data_size) = line_size + (uint32_t)strlen(here_tracking_http_crlf);
+                err = HERE_TRACKING_OK;
+
+                if(line_size == 0)
+                {
+                    parser->chunk_state = HERE_TRACKING_HTTP_PARSER_CHUNK_DONE;
+                    evt.data.body.buffer_capacity = evt.data.body.buffer_size = 0;
+
+                    if(parser->cb(&evt, true, parser->cb_data))
+                    {
+                        err = HERE_TRACKING_ERROR_CLIENT_INTERRUPT;
+                    }
+                }
+            }
+        }
+        break;
+
+        default:
+        {
+            /* Should not be here */
+            err = HERE_TRACKING_ERROR;
+        }
+        break;
+    }
+
+    if(err == HERE_TRACKING_ERROR_NEED_MORE_DATA &&
+       parser->chunk_state != HERE_TRACKING_HTTP_PARSER_CHUNK_DATA)
+    {
+        (*data_size) = 0;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_http_parser_find_crlf(here_tracking_http_parser* parser,
+                                                const char* data,
+                                                uint32_t data_size,
+                                                uint32_t* line_size)
+{
+    bool found = false;
+    uint32_t pos = parser->scan_pos;
+
+    while(!found && pos + strlen(here_tracking_http_crlf) <= data_size)
+    {
+        /* memchr() is typically vectorized by the C library. CR must be followed by one byte. */
+        const char* cr = memchr((data + pos), '\r', data_size - pos - 1);
+
+        if(cr == NULL)
+        {
+            pos = data_size - 1;
+        }
+        else if(cr[1] == '\n')
+        {
+            (*line_size) = (uint32_t)(cr - data);
+            found = true;
+        }
+        else
+        {
+            pos = (uint32_t)(cr - data) + 1;
+        }
+    }
+
+    /* Line is complete or the next search continues from the last byte which may be CR */
+    parser->scan_pos = found ? 0 : pos;
+
+    return found;
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_http_parser_body_done(const here_tracking_http_parser* parser)
+{
+    return parser->chunked ?
+        (parser->chunk_state == HERE_TRACKING_HTTP_PARSER_CHUNK_DONE) :
+        (parser->content_size == 0);
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_http_parser_connection_hdr(here_tracking_http_parser* parser,
+                                                     const here_tracking_http_parser_evt_hdr* hdr)
+{
+    if(hdr->hdr_val_size >= strlen(here_tracking_http_connection_close) &&
+       here_tracking_utils_memcasecmp((uint8_t*)hdr->hdr_val,
+                                      (uint8_t*)here_tracking_http_connection_close,
+                                      strlen(here_tracking_http_connection_close)) == 0)
+    {
+        parser->keep_alive = false;
+    }
+    else if(hdr->hdr_val_size >= strlen(here_tracking_http_connection_keep_alive) &&
+            here_tracking_utils_memcasecmp((uint8_t*)hdr->hdr_val,
+                                           (uint8_t*)here_tracking_http_connection_keep_alive,
+                                           strlen(here_tracking_http_connection_keep_alive)) == 0)
+    {
+        parser->keep_alive = true;
+    }
+}
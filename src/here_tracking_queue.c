@@ -0,0 +1,654 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <string.h>
+
+#include "here_tracking_queue.h"
+#include "here_tracking_utils.h"
+
+/**************************************************************************************************/
+
+#define HERE_TRACKING_QUEUE_MAGIC 0x31515448 /* "HTQ1" */
+
+/* Header slot: magic, generation, storage size, head, head sequence, head CRC, reserved, CRC */
+#define HERE_TRACKING_QUEUE_SLOT_SIZE       32
+#define HERE_TRACKING_QUEUE_SLOT_CRC_OFFSET 28
+
+/* Size of a record that tells the next record is at the start of the queue memory */
+#define HERE_TRACKING_QUEUE_WRAP 0xffffffff
+
+#define HERE_TRACKING_QUEUE_ALIGN(x) (((x) + 3) & ~((uint32_t)3))
+
+/**************************************************************************************************/
+
+typedef enum
+{
+    HERE_TRACKING_QUEUE_SEND_START,
+    HERE_TRACKING_QUEUE_SEND_SAMPLE,
+    HERE_TRACKING_QUEUE_SEND_SEPARATOR,
+    HERE_TRACKING_QUEUE_SEND_END,
+    HERE_TRACKING_QUEUE_SEND_DONE
+} here_tracking_queue_send_state;
+
+typedef struct
+{
+    here_tracking_queue* queue;
+    here_tracking_queue_iter iter;
+    here_tracking_queue_send_state state;
+    here_tracking_recv_cb recv_cb;
+    void* user_data;
+    here_tracking_error resp_err;
+} here_tracking_queue_send_ctx;
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_queue_get_u32(const uint8_t* p);
+
+static void here_tracking_queue_put_u32(uint8_t* p, uint32_t val);
+
+static uint32_t here_tracking_queue_next(const here_tracking_queue* queue, uint32_t offset);
+
+static uint32_t here_tracking_queue_record_crc(uint32_t prev_crc,
+                                               const uint8_t* record,
+                                               uint32_t size);
+
+static bool here_tracking_queue_read_slot(const here_tracking_queue* queue,
+                                          const uint8_t* slot,
+                                          uint32_t* generation);
+
+static void here_tracking_queue_write_slot(here_tracking_queue* queue);
+
+static bool here_tracking_queue_read_record(const here_tracking_queue* queue,
+                                            uint32_t offset,
+                                            uint32_t seq,
+                                            uint32_t prev_crc,
+                                            uint32_t* size);
+
+static void here_tracking_queue_write_record(here_tracking_queue* queue,
+                                             uint32_t size,
+                                             const uint8_t* sample);
+
+static void here_tracking_queue_recover(here_tracking_queue* queue);
+
+static here_tracking_error here_tracking_queue_send_cb(const uint8_t** data,
+                                                       size_t* data_size,
+                                                       void* user_data);
+
+static here_tracking_error here_tracking_queue_recv_cb(const here_tracking_recv_data* data,
+                                                       void* user_data);
+
+/**************************************************************************************************/
+
+static const uint8_t here_tracking_queue_array_start[] = "[";
+static const uint8_t here_tracking_queue_array_separator[] = ",";
+static const uint8_t here_tracking_queue_array_end[] = "]";
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_queue_open(here_tracking_queue* queue,
+                                             uint8_t* storage,
+                                             uint32_t storage_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(queue != NULL &&
+       storage != NULL &&
+       ((uintptr_t)storage & 3) == 0 &&
+       storage_size >= HERE_TRACKING_QUEUE_MIN_SIZE)
+    {
+        uint32_t gen0 = 0, gen1 = 0;
+        bool valid0, valid1;
+
+        queue->storage = storage;
+        queue->storage_size = storage_size & ~((uint32_t)3);
+        queue->count = 0;
+        valid0 = here_tracking_queue_read_slot(queue, storage, &gen0);
+        valid1 = here_tracking_queue_read_slot(queue,
+                                               storage + HERE_TRACKING_QUEUE_SLOT_SIZE,
+                                               &gen1);
+
+        if(valid0 || valid1)
+        {
+            /* Use the slot written last, generations are compared with wraparound */
+            const uint8_t* slot = storage;
+
+            if(!valid0 || (valid1 && (int32_t)(gen1 - gen0) > 0))
+            {
+                slot += HERE_TRACKING_QUEUE_SLOT_SIZE;
+            }
+
+            queue->generation = here_tracking_queue_get_u32(slot + 4);
+            queue->head = here_tracking_queue_get_u32(slot + 12);
+            queue->head_seq = here_tracking_queue_get_u32(slot + 16);
+            queue->head_crc = here_tracking_queue_get_u32(slot + 20);
+            here_tracking_queue_recover(queue);
+        }
+        else
+        {
+            queue->generation = 0;
+            queue->head = HERE_TRACKING_QUEUE_HDR_SIZE;
+            queue->head_seq = 0;
+            queue->head_crc = 0;
+            queue->tail = HERE_TRACKING_QUEUE_HDR_SIZE;
+            queue->tail_crc = 0;
+            memset(storage, 0, HERE_TRACKING_QUEUE_HDR_SIZE + HERE_TRACKING_QUEUE_RECORD_HDR_SIZE);
+            here_tracking_queue_write_slot(queue);
+        }
+
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_queue_push(here_tracking_queue* queue,
+                                             const uint8_t* sample,
+                                             uint32_t sample_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(queue != NULL && queue->storage != NULL && sample != NULL && sample_size > 0)
+    {
+        uint32_t area = queue->storage_size - HERE_TRACKING_QUEUE_HDR_SIZE;
+        uint32_t need;
+
+        err = HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+
+        if(sample_size <= area - HERE_TRACKING_QUEUE_RECORD_HDR_SIZE)
+        {
+            need = HERE_TRACKING_QUEUE_RECORD_HDR_SIZE + HERE_TRACKING_QUEUE_ALIGN(sample_size);
+
+            if(need > area)
+            {
+                /* Doesn't fit even into an empty queue */
+            }
+            else if(queue->count == 0)
+            {
+                if(queue->tail + need > queue->storage_size)
+                {
+                    queue->head = HERE_TRACKING_QUEUE_HDR_SIZE;
+                    queue->head_crc = queue->tail_crc;
+                    queue->tail = HERE_TRACKING_QUEUE_HDR_SIZE;
+                    here_tracking_queue_write_slot(queue);
+                }
+
+                err = HERE_TRACKING_OK;
+            }
+            else if(queue->tail <= queue->head)
+            {
+                /* Free space is between the newest and the oldest sample */
+                if(queue->head - queue->tail >= need)
+                {
+                    err = HERE_TRACKING_OK;
+                }
+            }
+            else if(queue->tail + need <= queue->storage_size)
+            {
+                err = HERE_TRACKING_OK;
+            }
+            else if(queue->head - HERE_TRACKING_QUEUE_HDR_SIZE >= need)
+            {
+                /* Tail is never closer to the end than the record header size, so there is
+                   always room for the wrap record */
+                here_tracking_queue_write_record(queue, HERE_TRACKING_QUEUE_WRAP, NULL);
+                queue->tail = HERE_TRACKING_QUEUE_HDR_SIZE;
+                err = HERE_TRACKING_OK;
+            }
+
+            if(err == HERE_TRACKING_OK)
+            {
+                here_tracking_queue_write_record(queue, sample_size, sample);
+                queue->tail = here_tracking_queue_next(queue, queue->tail + need);
+                queue->count++;
+            }
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_queue_pop(here_tracking_queue* queue, uint32_t count)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(queue != NULL && queue->storage != NULL && count <= queue->count)
+    {
+        if(count > 0)
+        {
+            here_tracking_queue_iter iter;
+            const uint8_t* sample;
+            uint32_t sample_size, i;
+
+            here_tracking_queue_iter_init(queue, &iter);
+
+            for(i = 0; i < count; ++i)
+            {
+                (void)here_tracking_queue_iter_next(queue, &iter, &sample, &sample_size);
+            }
+
+            /* The record CRC is stored just before the sample */
+            queue->head_crc = here_tracking_queue_get_u32(sample - 4);
+            queue->count -= count;
+            queue->head_seq += count;
+            queue->head = (queue->count > 0) ? iter.offset : queue->tail;
+            here_tracking_queue_write_slot(queue);
+        }
+
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+void here_tracking_queue_iter_init(const here_tracking_queue* queue,
+                                   here_tracking_queue_iter* iter)
+{
+    if(queue != NULL && iter != NULL)
+    {
+        iter->offset = queue->head;
+        iter->remaining = queue->count;
+    }
+}
+
+/**************************************************************************************************/
+
+bool here_tracking_queue_iter_next(const here_tracking_queue* queue,
+                                   here_tracking_queue_iter* iter,
+                                   const uint8_t** sample,
+                                   uint32_t* sample_size)
+{
+    bool res = false;
+
+    if(queue != NULL && iter != NULL && sample != NULL && sample_size != NULL &&
+       iter->remaining > 0)
+    {
+        uint32_t offset = iter->offset;
+        uint32_t size = here_tracking_queue_get_u32(queue->storage + offset + 4);
+
+        if(size == HERE_TRACKING_QUEUE_WRAP)
+        {
+            offset = HERE_TRACKING_QUEUE_HDR_SIZE;
+            size = here_tracking_queue_get_u32(queue->storage + offset + 4);
+        }
+
+        (*sample) = queue->storage + offset + HERE_TRACKING_QUEUE_RECORD_HDR_SIZE;
+        (*sample_size) = size;
+        iter->offset = here_tracking_queue_next(queue,
+                                                offset +
+                                                HERE_TRACKING_QUEUE_RECORD_HDR_SIZE +
+                                                HERE_TRACKING_QUEUE_ALIGN(size));
+        iter->remaining--;
+        res = true;
+    }
+
+    return res;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_queue_send(here_tracking_client* client,
+                                             here_tracking_queue* queue,
+                                             uint32_t max_batch,
+                                             here_tracking_recv_cb recv_cb,
+                                             void* user_data,
+                                             uint32_t* sent)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(client != NULL && queue != NULL && queue->storage != NULL && sent != NULL)
+    {
+        here_tracking_queue_send_ctx ctx;
+
+        ctx.queue = queue;
+        ctx.recv_cb = recv_cb;
+        ctx.user_data = user_data;
+        err = HERE_TRACKING_OK;
+        (*sent) = 0;
+
+        while(err == HERE_TRACKING_OK && queue->count > 0)
+        {
+            uint32_t batch = queue->count;
+
+            if(max_batch > 0 && max_batch < batch)
+            {
+                batch = max_batch;
+            }
+
+            here_tracking_queue_iter_init(queue, &ctx.iter);
+            ctx.iter.remaining = batch;
+            ctx.state = HERE_TRACKING_QUEUE_SEND_START;
+            ctx.resp_err = HERE_TRACKING_ERROR;
+
+            err = here_tracking_send_stream(client,
+                                            here_tracking_queue_send_cb,
+                                            here_tracking_queue_recv_cb,
+                                            HERE_TRACKING_REQ_DATA_JSON,
+                                            (recv_cb != NULL) ?
+                                                HERE_TRACKING_RESP_WITH_DATA_JSON :
+                                                HERE_TRACKING_RESP_STATUS_ONLY,
+                                            &ctx);
+
+            if(err == HERE_TRACKING_OK)
+            {
+                err = ctx.resp_err;
+            }
+
+            /* Samples the server rejected would be rejected again, so they are dropped too */
+            if(err == HERE_TRACKING_OK || err == HERE_TRACKING_ERROR_BAD_REQUEST)
+            {
+                err = here_tracking_queue_pop(queue, batch);
+                (*sent) += batch;
+            }
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_queue_get_u32(const uint8_t* p)
+{
+    return ((uint32_t)p[0]) |
+           ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_queue_put_u32(uint8_t* p, uint32_t val)
+{
+    p[0] = (uint8_t)val;
+    p[1] = (uint8_t)(val >> 8);
+    p[2] = (uint8_t)(val >> 16);
+    p[3] = (uint8_t)(val >> 24);
+}
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_queue_next(const here_tracking_queue* queue, uint32_t offset)
+{
+    /* A record header doesn't fit at the end, next record is at the start */
+    if(queue->storage_size - offset < HERE_TRACKING_QUEUE_RECORD_HDR_SIZE)
+    {
+        offset = HERE_TRACKING_QUEUE_HDR_SIZE;
+    }
+
+    return offset;
+}
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_queue_record_crc(uint32_t prev_crc,
+                                               const uint8_t* record,
+                                               uint32_t size)
+{
+    /* Chained to the previous record, so that records left over from before the last recovery
+       don't continue a record written after it */
+    uint32_t crc = here_tracking_utils_crc32(prev_crc, record, 8);
+
+    return here_tracking_utils_crc32(crc, record + HERE_TRACKING_QUEUE_RECORD_HDR_SIZE, size);
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_queue_read_slot(const here_tracking_queue* queue,
+                                          const uint8_t* slot,
+                                          uint32_t* generation)
+{
+    bool res = false;
+
+    if(here_tracking_queue_get_u32(slot) == HERE_TRACKING_QUEUE_MAGIC &&
+       here_tracking_queue_get_u32(slot + HERE_TRACKING_QUEUE_SLOT_CRC_OFFSET) ==
+       here_tracking_utils_crc32(0, slot, HERE_TRACKING_QUEUE_SLOT_CRC_OFFSET))
+    {
+        uint32_t head = here_tracking_queue_get_u32(slot + 12);
+
+        /* Queue memory of a different size is formatted again */
+        if(here_tracking_queue_get_u32(slot + 8) == queue->storage_size &&
+           head >= HERE_TRACKING_QUEUE_HDR_SIZE &&
+           head <= queue->storage_size - HERE_TRACKING_QUEUE_RECORD_HDR_SIZE &&
+           (head & 3) == 0)
+        {
+            (*generation) = here_tracking_queue_get_u32(slot + 4);
+            res = true;
+        }
+    }
+
+    return res;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_queue_write_slot(here_tracking_queue* queue)
+{
+    uint8_t* slot;
+
+    /* The other slot stays intact if the write is interrupted */
+    queue->generation++;
+    slot = queue->storage + ((queue->generation & 1) * HERE_TRACKING_QUEUE_SLOT_SIZE);
+    memset(slot, 0, HERE_TRACKING_QUEUE_SLOT_SIZE);
+    here_tracking_queue_put_u32(slot, HERE_TRACKING_QUEUE_MAGIC);
+    here_tracking_queue_put_u32(slot + 4, queue->generation);
+    here_tracking_queue_put_u32(slot + 8, queue->storage_size);
+    here_tracking_queue_put_u32(slot + 12, queue->head);
+    here_tracking_queue_put_u32(slot + 16, queue->head_seq);
+    here_tracking_queue_put_u32(slot + 20, queue->head_crc);
+    here_tracking_queue_put_u32(slot + HERE_TRACKING_QUEUE_SLOT_CRC_OFFSET,
+                                here_tracking_utils_crc32(0,
+                                                          slot,
+                                                          HERE_TRACKING_QUEUE_SLOT_CRC_OFFSET));
+}
+
+/**************************************************************************************************/
+
+static bool here_tracking_queue_read_record(const here_tracking_queue* queue,
+                                            uint32_t offset,
+                                            uint32_t seq,
+                                            uint32_t prev_crc,
+                                            uint32_t* size)
+{
+    const uint8_t* record = queue->storage + offset;
+    bool res = false;
+
+    if(here_tracking_queue_get_u32(record) == seq)
+    {
+        uint32_t payload_size = 0;
+
+        (*size) = here_tracking_queue_get_u32(record + 4);
+
+        if((*size) != HERE_TRACKING_QUEUE_WRAP)
+        {
+            payload_size = (*size);
+        }
+
+        if(payload_size <= queue->storage_size - offset - HERE_TRACKING_QUEUE_RECORD_HDR_SIZE &&
+           HERE_TRACKING_QUEUE_ALIGN(payload_size) <=
+           queue->storage_size - offset - HERE_TRACKING_QUEUE_RECORD_HDR_SIZE &&
+           here_tracking_queue_get_u32(record + 8) ==
+           here_tracking_queue_record_crc(prev_crc, record, payload_size))
+        {
+            res = ((*size) > 0);
+        }
+    }
+
+    return res;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_queue_write_record(here_tracking_queue* queue,
+                                             uint32_t size,
+                                             const uint8_t* sample)
+{
+    uint8_t* record = queue->storage + queue->tail;
+    uint32_t sample_size = 0;
+
+    if(size != HERE_TRACKING_QUEUE_WRAP)
+    {
+        sample_size = size;
+        memcpy(record + HERE_TRACKING_QUEUE_RECORD_HDR_SIZE, sample, sample_size);
+        memset(record + HERE_TRACKING_QUEUE_RECORD_HDR_SIZE + sample_size,
+               0,
+               HERE_TRACKING_QUEUE_ALIGN(sample_size) - sample_size);
+    }
+
+    here_tracking_queue_put_u32(record, queue->head_seq + queue->count);
+    here_tracking_queue_put_u32(record + 4, size);
+    queue->tail_crc = here_tracking_queue_record_crc(queue->tail_crc, record, sample_size);
+    here_tracking_queue_put_u32(record + 8, queue->tail_crc);
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_queue_recover(here_tracking_queue* queue)
+{
+    uint32_t offset = queue->head;
+    uint32_t max_count = (queue->storage_size - HERE_TRACKING_QUEUE_HDR_SIZE) /
+                         HERE_TRACKING_QUEUE_RECORD_HDR_SIZE;
+    uint32_t size;
+
+    /* Records are accepted in sequence until the first one that was not completely written */
+    queue->tail_crc = queue->head_crc;
+
+    while(queue->count < max_count &&
+          here_tracking_queue_read_record(queue,
+                                          offset,
+                                          queue->head_seq + queue->count,
+                                          queue->tail_crc,
+                                          &size))
+    {
+        queue->tail_crc = here_tracking_queue_get_u32(queue->storage + offset + 8);
+
+        if(size == HERE_TRACKING_QUEUE_WRAP)
+        {
+            if(offset == HERE_TRACKING_QUEUE_HDR_SIZE)
+            {
+                break;
+            }
+
+            offset = HERE_TRACKING_QUEUE_HDR_SIZE;
+        }
+        else
+        {
+            offset = here_tracking_queue_next(queue,
+                                              offset +
+                                              HERE_TRACKING_QUEUE_RECORD_HDR_SIZE +
+                                              HERE_TRACKING_QUEUE_ALIGN(size));
+            queue->count++;
+        }
+    }
+
+    queue->tail = offset;
+
+    if(queue->count == 0)
+    {
+        queue->head = offset;
+        queue->head_crc = queue->tail_crc;
+    }
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_queue_send_cb(const uint8_t** data,
+                                                       size_t* data_size,
+                                                       void* user_data)
+{
+    here_tracking_queue_send_ctx* ctx = (here_tracking_queue_send_ctx*)user_data;
+    uint32_t sample_size = 0;
+
+    (*data) = NULL;
+    (*data_size) = 0;
+
+    switch(ctx->state)
+    {
+        case HERE_TRACKING_QUEUE_SEND_START:
+        {
+            (*data) = here_tracking_queue_array_start;
+            (*data_size) = 1;
+            ctx->state = HERE_TRACKING_QUEUE_SEND_SAMPLE;
+        }
+        break;
+
+        case HERE_TRACKING_QUEUE_SEND_SAMPLE:
+        {
+            (void)here_tracking_queue_iter_next(ctx->queue, &ctx->iter, data, &sample_size);
+            (*data_size) = sample_size;
+            ctx->state = (ctx->iter.remaining > 0) ?
+                HERE_TRACKING_QUEUE_SEND_SEPARATOR : HERE_TRACKING_QUEUE_SEND_END;
+        }
+        break;
+
+        case HERE_TRACKING_QUEUE_SEND_SEPARATOR:
+        {
+            (*data) = here_tracking_queue_array_separator;
+            (*data_size) = 1;
+            ctx->state = HERE_TRACKING_QUEUE_SEND_SAMPLE;
+        }
+        break;
+
+        case HERE_TRACKING_QUEUE_SEND_END:
+        {
+            (*data) = here_tracking_queue_array_end;
+            (*data_size) = 1;
+            ctx->state = HERE_TRACKING_QUEUE_SEND_DONE;
+        }
+        break;
+
+        default:
+        {
+        }
+        break;
+    }
+
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_queue_recv_cb(const here_tracking_recv_data* data,
+                                                       void* user_data)
+{
+    here_tracking_queue_send_ctx* ctx = (here_tracking_queue_send_ctx*)user_data;
+    here_tracking_error err = HERE_TRACKING_OK;
+
+    if(data->evt == HERE_TRACKING_RECV_EVT_RESP_COMPLETE)
+    {
+        ctx->resp_err = data->err;
+    }
+
+    if(ctx->recv_cb != NULL)
+    {
+        err = ctx->recv_cb(data, ctx->user_data);
+    }
+
+    return err;
+}
@@ -0,0 +1,234 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <stddef.h>
+
+#include "here_tracking_rate_limiter.h"
+#include "here_tracking_time.h"
+
+/**************************************************************************************************/
+
+/* Times are compared with wraparound of the monotonic clock, so they must fit into int32_t */
+#define HERE_TRACKING_RATE_LIMITER_TIME_MAX_MS 0x7fffffff
+
+#define HERE_TRACKING_RATE_LIMITER_INTERVAL_MAX_MS \
+    (HERE_TRACKING_RATE_LIMITER_TIME_MAX_MS / HERE_TRACKING_RATE_LIMITER_MAX_BACKOFF)
+
+/**************************************************************************************************/
+
+static void here_tracking_rate_limiter_refill(here_tracking_rate_limiter* limiter, uint32_t now);
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_rate_limiter_init(here_tracking_rate_limiter* limiter,
+                                                    uint32_t interval_ms,
+                                                    uint32_t burst)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(limiter != NULL &&
+       interval_ms > 0 &&
+       interval_ms <= HERE_TRACKING_RATE_LIMITER_INTERVAL_MAX_MS &&
+       burst > 0)
+    {
+        err = here_tracking_get_monotonic_ms(&(limiter->refill_ms));
+        limiter->base_interval_ms = interval_ms;
+        limiter->interval_ms = interval_ms;
+        limiter->burst = burst;
+        limiter->tokens = burst;
+        limiter->pause_ms = 0;
+        limiter->paused = false;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_rate_limiter_check(here_tracking_rate_limiter* limiter,
+                                                     uint32_t requests,
+                                                     uint32_t* wait_ms)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(limiter != NULL)
+    {
+        uint32_t now, wait = 0;
+
+        err = here_tracking_get_monotonic_ms(&now);
+
+        if(err == HERE_TRACKING_OK && limiter->paused)
+        {
+            int32_t left = (int32_t)(limiter->pause_ms - now);
+
+            if(left > 0)
+            {
+                wait = (uint32_t)left;
+            }
+            else
+            {
+                limiter->paused = false;
+            }
+        }
+
+        if(err == HERE_TRACKING_OK && wait == 0 && requests > 0)
+        {
+            uint32_t needed = (requests < limiter->burst) ? requests : limiter->burst;
+
+            here_tracking_rate_limiter_refill(limiter, now);
+
+            if(limiter->tokens < needed)
+            {
+                /* Time until the missing tokens are back, counted from the last refill */
+                int64_t left = ((int64_t)(needed - limiter->tokens) * limiter->interval_ms) -
+                               (int32_t)(now - limiter->refill_ms);
+
+                wait = (left > HERE_TRACKING_RATE_LIMITER_TIME_MAX_MS) ?
+                    HERE_TRACKING_RATE_LIMITER_TIME_MAX_MS : ((left > 0) ? (uint32_t)left : 1);
+            }
+        }
+
+        if(err == HERE_TRACKING_OK && wait > 0)
+        {
+            err = HERE_TRACKING_ERROR_TOO_MANY_REQUESTS;
+        }
+
+        if(wait_ms != NULL)
+        {
+            (*wait_ms) = wait;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+void here_tracking_rate_limiter_take(here_tracking_rate_limiter* limiter, uint32_t requests)
+{
+    if(limiter != NULL)
+    {
+        limiter->tokens -= (requests < limiter->tokens) ? requests : limiter->tokens;
+    }
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_rate_limiter_update(here_tracking_rate_limiter* limiter,
+                                                      here_tracking_error result)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(limiter != NULL)
+    {
+        uint32_t now;
+
+        err = here_tracking_get_monotonic_ms(&now);
+
+        if(err == HERE_TRACKING_OK && result == HERE_TRACKING_ERROR_TOO_MANY_REQUESTS)
+        {
+            uint32_t max_interval =
+                limiter->base_interval_ms * HERE_TRACKING_RATE_LIMITER_MAX_BACKOFF;
+
+            /* Multiplicative decrease of the rate */
+            limiter->interval_ms = (limiter->interval_ms > max_interval / 2) ?
+                max_interval : (limiter->interval_ms * 2);
+            limiter->tokens = 0;
+
+            /* The Retry-After header may come before or after the end of the response */
+            if(!limiter->paused || (int32_t)(limiter->pause_ms - now) <= 0)
+            {
+                limiter->refill_ms = now;
+            }
+        }
+        else if(err == HERE_TRACKING_OK &&
+                result == HERE_TRACKING_OK &&
+                limiter->interval_ms > limiter->base_interval_ms)
+        {
+            /* Rate recovers in steps of an eighth of the remaining difference */
+            limiter->interval_ms -= (limiter->interval_ms - limiter->base_interval_ms + 7) / 8;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_rate_limiter_pause(here_tracking_rate_limiter* limiter,
+                                                     uint32_t retry_after)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(limiter != NULL)
+    {
+        uint32_t now;
+
+        err = here_tracking_get_monotonic_ms(&now);
+
+        if(err == HERE_TRACKING_OK)
+        {
+            if(retry_after > (HERE_TRACKING_RATE_LIMITER_TIME_MAX_MS / 2) / 1000)
+            {
+                retry_after = (HERE_TRACKING_RATE_LIMITER_TIME_MAX_MS / 2) / 1000;
+            }
+
+            /* No tokens are collected during the pause, so it doesn't end with a burst */
+            limiter->pause_ms = now + (retry_after * 1000);
+            limiter->refill_ms = limiter->pause_ms;
+            limiter->tokens = 0;
+            limiter->paused = true;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static void here_tracking_rate_limiter_refill(here_tracking_rate_limiter* limiter, uint32_t now)
+{
+    int32_t elapsed = (int32_t)(now - limiter->refill_ms);
+
+    if(limiter->tokens >= limiter->burst)
+    {
+        /* Full bucket doesn't collect tokens */
+        limiter->refill_ms = now;
+    }
+    else if(elapsed > 0)
+    {
+        uint32_t count = (uint32_t)elapsed / limiter->interval_ms;
+
+        if(count >= limiter->burst - limiter->tokens)
+        {
+            limiter->tokens = limiter->burst;
+            limiter->refill_ms = now;
+        }
+        else
+        {
+            limiter->tokens += count;
+            limiter->refill_ms += count * limiter->interval_ms;
+        }
+    }
+}
@@ -0,0 +1,293 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <string.h>
+
+#include "here_tracking_scheduler.h"
+#include "here_tracking_time.h"
+#include "here_tracking_utils.h"
+
+/**************************************************************************************************/
+
+/* Delays are compared with wraparound of the monotonic clock, so they must fit into int32_t */
+#define HERE_TRACKING_SCHEDULER_DELAY_MAX_MS 0x7fffffff
+
+#define HERE_TRACKING_SCHEDULER_RAND_SEED 0x9e3779b9
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_scheduler_rand(here_tracking_scheduler* scheduler, uint32_t max);
+
+static uint32_t here_tracking_scheduler_backoff(here_tracking_scheduler* scheduler);
+
+static here_tracking_error here_tracking_scheduler_limiter_wait(here_tracking_rate_limiter* limiter,
+                                                                uint32_t* wait);
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_scheduler_init(here_tracking_scheduler* scheduler,
+                                                 here_tracking_client* client,
+                                                 uint32_t base_delay_ms,
+                                                 uint32_t max_delay_ms,
+                                                 uint32_t spread_ms)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(scheduler != NULL && client != NULL)
+    {
+        const char* id_end = memchr(client->device_id, '\0', HERE_TRACKING_DEVICE_ID_SIZE);
+        size_t id_size = (id_end != NULL) ?
+            (size_t)(id_end - client->device_id) : HERE_TRACKING_DEVICE_ID_SIZE;
+        uint32_t now = 0;
+
+        scheduler->client = client;
+        scheduler->base_delay_ms = (base_delay_ms > 0) ?
+            base_delay_ms : HERE_TRACKING_SCHEDULER_DEFAULT_BASE_DELAY_MS;
+        scheduler->max_delay_ms = (max_delay_ms > 0) ?
+            max_delay_ms : HERE_TRACKING_SCHEDULER_DEFAULT_MAX_DELAY_MS;
+        scheduler->spread_ms = spread_ms;
+
+        if(scheduler->max_delay_ms > HERE_TRACKING_SCHEDULER_DELAY_MAX_MS)
+        {
+            scheduler->max_delay_ms = HERE_TRACKING_SCHEDULER_DELAY_MAX_MS;
+        }
+
+        if(scheduler->base_delay_ms > scheduler->max_delay_ms)
+        {
+            scheduler->base_delay_ms = scheduler->max_delay_ms;
+        }
+
+        if(scheduler->spread_ms > HERE_TRACKING_SCHEDULER_DELAY_MAX_MS / 2)
+        {
+            scheduler->spread_ms = HERE_TRACKING_SCHEDULER_DELAY_MAX_MS / 2;
+        }
+
+        scheduler->failures = 0;
+        scheduler->next_ms = 0;
+        scheduler->waiting = false;
+
+        /* Devices with the same start time still get different delays */
+        (void)here_tracking_get_monotonic_ms(&now);
+        scheduler->rand_state =
+            here_tracking_utils_crc32(0, (const uint8_t*)client->device_id, id_size) ^ now;
+
+        if(scheduler->rand_state == 0)
+        {
+            scheduler->rand_state = HERE_TRACKING_SCHEDULER_RAND_SEED;
+        }
+
+        err = HERE_TRACKING_OK;
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_scheduler_ready(here_tracking_scheduler* scheduler,
+                                                  uint32_t* wait_ms)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(scheduler != NULL && scheduler->client != NULL)
+    {
+        uint32_t wait = 0, now;
+
+        err = here_tracking_get_monotonic_ms(&now);
+
+        if(err == HERE_TRACKING_OK && scheduler->waiting)
+        {
+            int32_t left = (int32_t)(scheduler->next_ms - now);
+
+            if(left > 0)
+            {
+                wait = (uint32_t)left;
+            }
+            else
+            {
+                scheduler->waiting = false;
+            }
+        }
+
+        /* Rate limit seen by requests sent without the scheduler */
+        if(err == HERE_TRACKING_OK && wait == 0 && scheduler->client->retry_after > 0)
+        {
+            err = here_tracking_get_unixtime(&now);
+
+            if(err == HERE_TRACKING_OK && scheduler->client->retry_after > now)
+            {
+                wait = (scheduler->client->retry_after - now) * 1000;
+            }
+        }
+
+        if(err == HERE_TRACKING_OK && wait == 0)
+        {
+            err = here_tracking_scheduler_limiter_wait(scheduler->client->rate_limiter, &wait);
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            err = here_tracking_scheduler_limiter_wait(scheduler->client->gateway_rate_limiter,
+                                                       &wait);
+        }
+
+        if(err == HERE_TRACKING_OK && wait > 0)
+        {
+            err = HERE_TRACKING_ERROR_WOULD_BLOCK;
+        }
+
+        if(wait_ms != NULL)
+        {
+            (*wait_ms) = wait;
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+here_tracking_error here_tracking_scheduler_update(here_tracking_scheduler* scheduler,
+                                                   here_tracking_error result)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(scheduler != NULL && scheduler->client != NULL)
+    {
+        uint32_t now_ms, delay = 0;
+
+        err = here_tracking_get_monotonic_ms(&now_ms);
+
+        if(err == HERE_TRACKING_OK)
+        {
+            switch(result)
+            {
+                case HERE_TRACKING_ERROR_TOO_MANY_REQUESTS:
+                {
+                    uint32_t now_s;
+
+                    err = here_tracking_get_unixtime(&now_s);
+
+                    if(err == HERE_TRACKING_OK && scheduler->client->retry_after > now_s)
+                    {
+                        uint32_t retry_s = scheduler->client->retry_after - now_s;
+
+                        if(retry_s > (HERE_TRACKING_SCHEDULER_DELAY_MAX_MS / 2) / 1000)
+                        {
+                            retry_s = (HERE_TRACKING_SCHEDULER_DELAY_MAX_MS / 2) / 1000;
+                        }
+
+                        delay = (retry_s * 1000) +
+                                here_tracking_scheduler_rand(scheduler, scheduler->spread_ms);
+                    }
+                    else if(err == HERE_TRACKING_OK)
+                    {
+                        /* No Retry-After in the response */
+                        delay = here_tracking_scheduler_backoff(scheduler);
+                    }
+                }
+                break;
+
+                case HERE_TRACKING_ERROR:
+                case HERE_TRACKING_ERROR_TIMEOUT:
+                {
+                    delay = here_tracking_scheduler_backoff(scheduler);
+                }
+                break;
+
+                default:
+                {
+                    scheduler->failures = 0;
+                }
+                break;
+            }
+        }
+
+        if(err == HERE_TRACKING_OK)
+        {
+            scheduler->next_ms = now_ms + delay;
+            scheduler->waiting = (delay > 0);
+        }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_scheduler_rand(here_tracking_scheduler* scheduler, uint32_t max)
+{
+    uint32_t x = scheduler->rand_state;
+
+    /* xorshift32 */
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    scheduler->rand_state = x;
+
+    return (max > 0) ? (x % (max + 1)) : 0;
+}
+
+/**************************************************************************************************/
+
+static uint32_t here_tracking_scheduler_backoff(here_tracking_scheduler* scheduler)
+{
+    uint32_t ceiling = scheduler->base_delay_ms, i;
+
+    for(i = 0; i < scheduler->failures && ceiling < scheduler->max_delay_ms; ++i)
+    {
+        ceiling = (ceiling > scheduler->max_delay_ms / 2) ? scheduler->max_delay_ms : ceiling * 2;
+    }
+
+    if(scheduler->failures < UINT32_MAX)
+    {
+        scheduler->failures++;
+    }
+
+    /* Full jitter: anything between no delay and the exponential delay */
+    return here_tracking_scheduler_rand(scheduler, ceiling);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_scheduler_limiter_wait(here_tracking_rate_limiter* limiter,
+                                                                uint32_t* wait)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+
+    if(limiter != NULL)
+    {
+        uint32_t limiter_wait;
+
+        err = here_tracking_rate_limiter_check(limiter, 1, &limiter_wait);
+
+        if(err == HERE_TRACKING_ERROR_TOO_MANY_REQUESTS)
+        {
+            (*wait) = (limiter_wait > (*wait)) ? limiter_wait : (*wait);
+            err = HERE_TRACKING_OK;
+        }
+    }
+
+    return err;
+}
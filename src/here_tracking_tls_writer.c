@@ -30,6 +30,12 @@
 
 /**************************************************************************************************/
 
+static here_tracking_error here_tracking_tls_writer_write_tls(here_tracking_tls_writer* writer,
+                                                              const uint8_t* data,
+                                                              uint32_t data_size);
+
+/**************************************************************************************************/
+
 here_tracking_error here_tracking_tls_writer_init(here_tracking_tls_writer* writer,
                                                   here_tracking_tls tls_ctx,
                                                   uint8_t* write_buf,
@@ -50,6 +56,25 @@ here_tracking_error here_tracking_tls_writer_init(here_tracking_tls_writer* writ
 
 /**************************************************************************************************/
 
+here_tracking_error here_tracking_tls_writer_init_buffered(here_tracking_tls_writer* writer,
+                                                           uint8_t* write_buf,
+                                                           size_t write_buf_size)
+{
+    here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
+
+    if(writer != NULL && write_buf != NULL && write_buf_size > 0)
+    {
+        writer->tls_ctx = NULL;
+        err = here_tracking_data_buffer_init(&writer->data_buffer,
+                                             (char*)write_buf,
+                                             (uint32_t)write_buf_size);
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
 here_tracking_error here_tracking_tls_writer_write_char(here_tracking_tls_writer* writer,
                                                         char c)
 {
@@ -75,7 +100,7 @@ here_tracking_error here_tracking_tls_writer_write_data(here_tracking_tls_writer
                                                      ((const char*)data) + pos,
                                                      (uint32_t)data_size);
 
-            if(err == HERE_TRACKING_ERROR_BUFFER_TOO_SMALL)
+            if(err == HERE_TRACKING_ERROR_BUFFER_TOO_SMALL && writer->tls_ctx != NULL)
             {
                 size_t bytes_free = HERE_TRACKING_DATA_BUFFER_BYTES_FREE(&writer->data_buffer);
 
@@ -89,13 +114,27 @@ here_tracking_error here_tracking_tls_writer_write_data(here_tracking_tls_writer
                     data_size -= bytes_free;
                     err = here_tracking_tls_writer_flush(writer);
                 }
+
+                /* Buffered data went out together with the start of the data. Rest of a large
+                   write is passed to TLS as is instead of copying it through the buffer piece by
+                   piece. */
+                if(err == HERE_TRACKING_OK &&
+                   data_size >= writer->data_buffer.buffer_capacity)
+                {
+                    err = here_tracking_tls_writer_write_tls(writer,
+                                                             data + pos,
+                                                             (uint32_t)data_size);
+                    pos += data_size;
+                    data_size = 0;
+                }
             }
             else if(err == HERE_TRACKING_OK)
             {
                 pos += data_size;
                 data_size = 0;
 
-                if(HERE_TRACKING_DATA_BUFFER_BYTES_FREE(&writer->data_buffer) == 0)
+                if(HERE_TRACKING_DATA_BUFFER_BYTES_FREE(&writer->data_buffer) == 0 &&
+                   writer->tls_ctx != NULL)
                 {
                     err = here_tracking_tls_writer_flush(writer);
                 }
@@ -151,27 +190,38 @@ here_tracking_error here_tracking_tls_writer_flush(here_tracking_tls_writer* wri
 {
     here_tracking_error err = HERE_TRACKING_ERROR_INVALID_INPUT;
 
-    if(writer != NULL)
+    if(writer != NULL && writer->tls_ctx != NULL)
     {
-        uint32_t write_size = writer->data_buffer.buffer_size, pos = 0;
-        err = HERE_TRACKING_OK;
+        err = here_tracking_tls_writer_write_tls(writer,
+                                                 (const uint8_t*)writer->data_buffer.buffer,
+                                                 writer->data_buffer.buffer_size);
 
-        while(err == HERE_TRACKING_OK && write_size > 0)
+        if(err == HERE_TRACKING_OK)
         {
-            err = here_tracking_tls_write(writer->tls_ctx,
-                                          writer->data_buffer.buffer + pos,
-                                          &write_size);
-
-            if(err == HERE_TRACKING_OK)
-            {
-                pos += write_size;
-                write_size = writer->data_buffer.buffer_size - pos;
-            }
+            writer->data_buffer.buffer_size = 0;
         }
+    }
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error here_tracking_tls_writer_write_tls(here_tracking_tls_writer* writer,
+                                                              const uint8_t* data,
+                                                              uint32_t data_size)
+{
+    here_tracking_error err = HERE_TRACKING_OK;
+    uint32_t write_size = data_size, pos = 0;
+
+    while(err == HERE_TRACKING_OK && write_size > 0)
+    {
+        err = here_tracking_tls_write(writer->tls_ctx, (const char*)(data + pos), &write_size);
 
         if(err == HERE_TRACKING_OK)
         {
-            writer->data_buffer.buffer_size = 0;
+            pos += write_size;
+            write_size = data_size - pos;
         }
     }
 
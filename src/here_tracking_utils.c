@@ -29,6 +29,15 @@
 
 /**************************************************************************************************/
 
+/* CRC-32 (IEEE 802.3) of each nibble, a small table is enough for the amounts of data checked */
+static const uint32_t here_tracking_utils_crc32_table[16] =
+{
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+/**************************************************************************************************/
+
 int32_t here_tracking_utils_atoi(const char* str, size_t n)
 {
     int32_t val = 0;
@@ -52,6 +61,24 @@ int32_t here_tracking_utils_atoi(const char* str, size_t n)
 
 /**************************************************************************************************/
 
+uint32_t here_tracking_utils_crc32(uint32_t crc, const uint8_t* data, size_t n)
+{
+    size_t i;
+
+    crc = ~crc;
+
+    for(i = 0; i < n; ++i)
+    {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ here_tracking_utils_crc32_table[crc & 0x0f];
+        crc = (crc >> 4) ^ here_tracking_utils_crc32_table[crc & 0x0f];
+    }
+
+    return ~crc;
+}
+
+/**************************************************************************************************/
+
 uint32_t here_tracking_utils_atou(const char* str, size_t n)
 {
     uint32_t val = 0;
@@ -74,6 +101,41 @@ uint32_t here_tracking_utils_atou(const char* str, size_t n)
 
 /**************************************************************************************************/
 
+uint32_t here_tracking_utils_xtou(const char* str, size_t n)
+{
+    uint32_t val = 0;
+
+    if(str != NULL && n > 0)
+    {
+        size_t pos = 0;
+
+        /* No checks for range, will overflow if over uint32_t max value */
+        while(pos < n && here_tracking_utils_isxdigit(str[pos]))
+        {
+            val *= 16;
+
+            if(here_tracking_utils_isdigit(str[pos]))
+            {
+                val += str[pos] - '0';
+            }
+            else if(str[pos] >= 'a')
+            {
+                val += str[pos] - 'a' + 10;
+            }
+            else
+            {
+                val += str[pos] - 'A' + 10;
+            }
+
+            pos++;
+        }
+    }
+
+    return val;
+}
+
+/**************************************************************************************************/
+
 bool here_tracking_utils_isalnum(const char c)
 {
     return (here_tracking_utils_isalpha(c) || here_tracking_utils_isdigit(c)) ? true : false;
@@ -95,6 +157,15 @@ bool here_tracking_utils_isdigit(const char c)
 
 /**************************************************************************************************/
 
+bool here_tracking_utils_isxdigit(const char c)
+{
+    return (here_tracking_utils_isdigit(c) ||
+            (c >= 'A' && c <= 'F') ||
+            (c >= 'a' && c <= 'f')) ? true : false;
+}
+
+/**************************************************************************************************/
+
 int32_t here_tracking_utils_memcasecmp(const uint8_t* b1, const uint8_t* b2, size_t n)
 {
     size_t i;
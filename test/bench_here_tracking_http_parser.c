@@ -0,0 +1,159 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "here_tracking_http_parser.h"
+
+/**************************************************************************************************/
+
+const char* here_tracking_http_connection_close = "close";
+const char* here_tracking_http_connection_keep_alive = "keep-alive";
+const char* here_tracking_http_crlf = "\r\n";
+const char* here_tracking_http_header_connection = "Connection";
+const char* here_tracking_http_header_content_length = "Content-Length";
+const char* here_tracking_http_header_transfer_encoding = "Transfer-Encoding";
+const char* here_tracking_http_transfer_encoding_chunked = "chunked";
+
+/**************************************************************************************************/
+
+#define BENCH_TARGET_BYTES (64 * 1024 * 1024)
+#define BENCH_LONG_HDR_SIZE 4096
+
+static const char* bench_send_resp = \
+    "HTTP/1.1 200 OK\r\n"\
+    "Content-Type: application/json; charset=utf-8\r\n"\
+    "Content-Length: 62\r\n"\
+    "Connection: keep-alive\r\n"\
+    "Date: Mon, 01 Jan 2018 00:00:00 GMT\r\n"\
+    "Server: nginx\r\n"\
+    "Vary: Accept-Encoding\r\n"\
+    "X-Request-Id: 0f5a6c1e-7f3b-4a6e-9b1d-3c0a9e2f4d11\r\n"\
+    "Strict-Transport-Security: max-age=31536000; includeSubDomains\r\n"\
+    "\r\n"\
+    "{\"timestamp\":1514764800000,\"position\":{\"lat\":52.5,\"lng\":13.4}}";
+
+/**************************************************************************************************/
+
+static bool bench_here_tracking_http_parser_cb(const here_tracking_http_parser_evt* evt,
+                                               bool last,
+                                               void* cb_data)
+{
+    (void)evt;
+    (void)last;
+    (*((uint32_t*)cb_data))++;
+    return false;
+}
+
+/**************************************************************************************************/
+
+/**
+ * Parses the response the way here_tracking_http_recv_resp() does when each TLS read returns
+ * fragment_size bytes. Unparsed data is passed in again with the next fragment.
+ */
+static here_tracking_error bench_here_tracking_http_parser_run(const char* resp,
+                                                               uint32_t resp_size,
+                                                               uint32_t fragment_size,
+                                                               uint32_t* evt_count)
+{
+    here_tracking_error err;
+    here_tracking_http_parser parser;
+    uint32_t start = 0, end = 0, parse_size;
+
+    here_tracking_http_parser_init(&parser, bench_here_tracking_http_parser_cb, evt_count);
+
+    do
+    {
+        end = (resp_size - end > fragment_size) ? (end + fragment_size) : resp_size;
+        parse_size = end - start;
+        err = here_tracking_http_parser_parse(&parser, resp + start, &parse_size);
+        start += parse_size;
+    } while(err == HERE_TRACKING_ERROR_NEED_MORE_DATA && end < resp_size);
+
+    return err;
+}
+
+/**************************************************************************************************/
+
+static int bench_here_tracking_http_parser(const char* name,
+                                           const char* resp,
+                                           uint32_t fragment_size)
+{
+    uint32_t resp_size = (uint32_t)strlen(resp);
+    uint32_t i, rounds = BENCH_TARGET_BYTES / resp_size, evt_count = 0;
+    clock_t begin;
+    double secs;
+
+    begin = clock();
+
+    for(i = 0; i < rounds; ++i)
+    {
+        if(bench_here_tracking_http_parser_run(resp,
+                                               resp_size,
+                                               fragment_size,
+                                               &evt_count) != HERE_TRACKING_OK)
+        {
+            printf("%-32s parse failed\n", name);
+            return EXIT_FAILURE;
+        }
+    }
+
+    secs = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    if(secs <= 0.0)
+    {
+        secs = 1.0 / CLOCKS_PER_SEC;
+    }
+
+    printf("%-32s %8.1f MB/s %10.0f responses/s %6u events/response\n",
+           name,
+           ((double)rounds * resp_size) / (secs * 1024 * 1024),
+           rounds / secs,
+           evt_count / rounds);
+    return EXIT_SUCCESS;
+}
+
+/**************************************************************************************************/
+
+int main()
+{
+    int res = EXIT_SUCCESS;
+    char* long_hdr_resp = malloc(BENCH_LONG_HDR_SIZE + 128);
+
+    /* One header line much longer than a single TLS read */
+    strcpy(long_hdr_resp, "HTTP/1.1 200 OK\r\nX-Long:");
+    memset(long_hdr_resp + strlen(long_hdr_resp), 'a', BENCH_LONG_HDR_SIZE);
+    strcpy(long_hdr_resp + strlen("HTTP/1.1 200 OK\r\nX-Long:") + BENCH_LONG_HDR_SIZE,
+           "\r\nContent-Length: 2\r\n\r\nOK");
+
+    res |= bench_here_tracking_http_parser("send response, one read", bench_send_resp, UINT32_MAX);
+    res |= bench_here_tracking_http_parser("send response, 16 byte reads", bench_send_resp, 16);
+    res |= bench_here_tracking_http_parser("long header, one read", long_hdr_resp, UINT32_MAX);
+    res |= bench_here_tracking_http_parser("long header, 64 byte reads", long_hdr_resp, 64);
+    free(long_hdr_resp);
+    return res;
+}
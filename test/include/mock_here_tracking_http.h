@@ -35,6 +35,8 @@ extern "C" {
 
 DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_http_auth, here_tracking_client*);
 
+DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_http_prewarm, here_tracking_client*);
+
 DECLARE_FAKE_VALUE_FUNC4(here_tracking_error,
                          here_tracking_http_send,
                          here_tracking_client*,
@@ -51,10 +53,54 @@ DECLARE_FAKE_VALUE_FUNC6(here_tracking_error,
                          here_tracking_resp_type,
                          void*);
 
+DECLARE_FAKE_VALUE_FUNC4(here_tracking_error,
+                         here_tracking_http_send_stream_pipelined,
+                         here_tracking_client*,
+                         const here_tracking_stream_req*,
+                         uint8_t,
+                         uint8_t*);
+
+DECLARE_FAKE_VALUE_FUNC8(here_tracking_error,
+                         here_tracking_http_send_stream_async,
+                         here_tracking_http_async*,
+                         here_tracking_client*,
+                         bool,
+                         here_tracking_send_cb,
+                         here_tracking_recv_cb,
+                         here_tracking_req_type,
+                         here_tracking_resp_type,
+                         void*);
+
+DECLARE_FAKE_VALUE_FUNC1(here_tracking_error,
+                         here_tracking_http_async_step,
+                         here_tracking_http_async*);
+
+DECLARE_FAKE_VALUE_FUNC3(here_tracking_error,
+                         here_tracking_http_async_get_poll_info,
+                         const here_tracking_http_async*,
+                         int*,
+                         uint8_t*);
+
+DECLARE_FAKE_VALUE_FUNC2(here_tracking_error,
+                         here_tracking_http_async_get_timeout,
+                         const here_tracking_http_async*,
+                         int32_t*);
+
+DECLARE_FAKE_VALUE_FUNC1(here_tracking_error,
+                         here_tracking_http_async_cancel,
+                         here_tracking_http_async*);
+
 #define MOCK_HERE_TRACKING_HTTP_FAKE_LIST(FAKE) \
     FAKE(here_tracking_http_auth)  \
+    FAKE(here_tracking_http_prewarm)  \
     FAKE(here_tracking_http_send)  \
     FAKE(here_tracking_http_send_stream) \
+    FAKE(here_tracking_http_send_stream_pipelined) \
+    FAKE(here_tracking_http_send_stream_async) \
+    FAKE(here_tracking_http_async_step) \
+    FAKE(here_tracking_http_async_get_poll_info) \
+    FAKE(here_tracking_http_async_get_timeout) \
+    FAKE(here_tracking_http_async_cancel) \
 
 void mock_here_tracking_http_auth_set_result_token(const char* token);
 
@@ -35,14 +35,20 @@ extern "C" {
 #endif
 
 DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_get_unixtime, uint32_t*);
+DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_get_monotonic_ms, uint32_t*);
 
 #define MOCK_HERE_TRACKING_TIME_FAKE_LIST(FAKE) \
-    FAKE(here_tracking_get_unixtime)
+    FAKE(here_tracking_get_unixtime) \
+    FAKE(here_tracking_get_monotonic_ms)
 
 void mock_here_tracking_get_unixtime_set_result(uint32_t result);
 
 here_tracking_error mock_here_tracking_get_unixtime_custom(uint32_t* ts);
 
+void mock_here_tracking_get_monotonic_ms_set_result(uint32_t result);
+
+here_tracking_error mock_here_tracking_get_monotonic_ms_custom(uint32_t* ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,7 +34,16 @@
 extern "C" {
 #endif
 
-DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_init, here_tracking_tls*);
+DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_env_init, here_tracking_tls_env*);
+
+DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_env_ref, here_tracking_tls_env);
+
+DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_env_free, here_tracking_tls_env*);
+
+DECLARE_FAKE_VALUE_FUNC2(here_tracking_error,
+                         here_tracking_tls_init,
+                         here_tracking_tls*,
+                         here_tracking_tls_env);
 
 DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_free, here_tracking_tls*);
 
@@ -44,8 +53,51 @@ DECLARE_FAKE_VALUE_FUNC3(here_tracking_error,
                          const char*,
                          uint16_t);
 
+DECLARE_FAKE_VALUE_FUNC3(here_tracking_error,
+                         here_tracking_tls_connect_async,
+                         here_tracking_tls,
+                         const char*,
+                         uint16_t);
+
+DECLARE_FAKE_VALUE_FUNC3(here_tracking_error,
+                         here_tracking_tls_get_poll_info,
+                         here_tracking_tls,
+                         int*,
+                         uint8_t*);
+
 DECLARE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_close, here_tracking_tls);
 
+DECLARE_FAKE_VALUE_FUNC1(here_tracking_error,
+                         here_tracking_tls_check_connection,
+                         here_tracking_tls);
+
+DECLARE_FAKE_VALUE_FUNC2(here_tracking_error,
+                         here_tracking_tls_set_deadline,
+                         here_tracking_tls,
+                         uint32_t);
+
+DECLARE_FAKE_VALUE_FUNC3(here_tracking_error,
+                         here_tracking_tls_get_session,
+                         here_tracking_tls,
+                         uint8_t*,
+                         uint32_t*);
+
+DECLARE_FAKE_VALUE_FUNC3(here_tracking_error,
+                         here_tracking_tls_set_session,
+                         here_tracking_tls,
+                         const uint8_t*,
+                         uint32_t);
+
+DECLARE_FAKE_VALUE_FUNC2(here_tracking_error,
+                         here_tracking_tls_set_alpn,
+                         here_tracking_tls,
+                         const char**);
+
+DECLARE_FAKE_VALUE_FUNC2(here_tracking_error,
+                         here_tracking_tls_get_alpn,
+                         here_tracking_tls,
+                         const char**);
+
 DECLARE_FAKE_VALUE_FUNC3(here_tracking_error,
                          here_tracking_tls_read,
                          here_tracking_tls,
@@ -59,14 +111,26 @@ DECLARE_FAKE_VALUE_FUNC3(here_tracking_error,
                          uint32_t*);
 
 #define MOCK_HERE_TRACKING_TLS_FAKE_LIST(FAKE) \
+    FAKE(here_tracking_tls_env_init) \
+    FAKE(here_tracking_tls_env_ref) \
+    FAKE(here_tracking_tls_env_free) \
     FAKE(here_tracking_tls_init) \
     FAKE(here_tracking_tls_free) \
     FAKE(here_tracking_tls_connect) \
+    FAKE(here_tracking_tls_connect_async) \
+    FAKE(here_tracking_tls_get_poll_info) \
     FAKE(here_tracking_tls_close) \
+    FAKE(here_tracking_tls_check_connection) \
+    FAKE(here_tracking_tls_set_deadline) \
+    FAKE(here_tracking_tls_get_session) \
+    FAKE(here_tracking_tls_set_session) \
+    FAKE(here_tracking_tls_set_alpn) \
+    FAKE(here_tracking_tls_get_alpn) \
     FAKE(here_tracking_tls_read) \
     FAKE(here_tracking_tls_write)
 
-here_tracking_error mock_here_tracking_tls_init_custom(here_tracking_tls* tls);
+here_tracking_error mock_here_tracking_tls_init_custom(here_tracking_tls* tls,
+                                                       here_tracking_tls_env env);
 
 here_tracking_error mock_here_tracking_tls_free_custom(here_tracking_tls* tls);
 
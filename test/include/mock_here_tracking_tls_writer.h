@@ -40,6 +40,12 @@ DECLARE_FAKE_VALUE_FUNC4(here_tracking_error,
                          uint8_t*,
                          size_t);
 
+DECLARE_FAKE_VALUE_FUNC3(here_tracking_error,
+                         here_tracking_tls_writer_init_buffered,
+                         here_tracking_tls_writer*,
+                         uint8_t*,
+                         size_t);
+
 DECLARE_FAKE_VALUE_FUNC2(here_tracking_error,
                          here_tracking_tls_writer_write_char,
                          here_tracking_tls_writer*,
@@ -68,12 +74,18 @@ DECLARE_FAKE_VALUE_FUNC1(here_tracking_error,
 
 #define MOCK_HERE_TRACKING_TLS_WRITER_FAKE_LIST(FAKE) \
     FAKE(here_tracking_tls_writer_init) \
+    FAKE(here_tracking_tls_writer_init_buffered) \
     FAKE(here_tracking_tls_writer_write_char) \
     FAKE(here_tracking_tls_writer_write_string) \
     FAKE(here_tracking_tls_writer_write_data) \
     FAKE(here_tracking_tls_writer_write_utoa) \
     FAKE(here_tracking_tls_writer_flush)
 
+here_tracking_error \
+    mock_here_tracking_tls_writer_init_buffered_custom(here_tracking_tls_writer* writer,
+                                                       uint8_t* write_buf,
+                                                       size_t write_buf_size);
+
 #ifdef __cplusplus
 }
 #endif
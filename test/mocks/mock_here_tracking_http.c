@@ -41,6 +41,8 @@ static here_tracking_error mock_here_tracking_http_recv_cb_status = HERE_TRACKIN
 
 DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_http_auth, here_tracking_client*);
 
+DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_http_prewarm, here_tracking_client*);
+
 DEFINE_FAKE_VALUE_FUNC4(here_tracking_error,
                         here_tracking_http_send,
                         here_tracking_client*,
@@ -57,6 +59,43 @@ DEFINE_FAKE_VALUE_FUNC6(here_tracking_error,
                         here_tracking_resp_type,
                         void*);
 
+DEFINE_FAKE_VALUE_FUNC4(here_tracking_error,
+                        here_tracking_http_send_stream_pipelined,
+                        here_tracking_client*,
+                        const here_tracking_stream_req*,
+                        uint8_t,
+                        uint8_t*);
+
+DEFINE_FAKE_VALUE_FUNC8(here_tracking_error,
+                        here_tracking_http_send_stream_async,
+                        here_tracking_http_async*,
+                        here_tracking_client*,
+                        bool,
+                        here_tracking_send_cb,
+                        here_tracking_recv_cb,
+                        here_tracking_req_type,
+                        here_tracking_resp_type,
+                        void*);
+
+DEFINE_FAKE_VALUE_FUNC1(here_tracking_error,
+                        here_tracking_http_async_step,
+                        here_tracking_http_async*);
+
+DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
+                        here_tracking_http_async_get_poll_info,
+                        const here_tracking_http_async*,
+                        int*,
+                        uint8_t*);
+
+DEFINE_FAKE_VALUE_FUNC2(here_tracking_error,
+                        here_tracking_http_async_get_timeout,
+                        const here_tracking_http_async*,
+                        int32_t*);
+
+DEFINE_FAKE_VALUE_FUNC1(here_tracking_error,
+                        here_tracking_http_async_cancel,
+                        here_tracking_http_async*);
+
 /**************************************************************************************************/
 
 void mock_here_tracking_http_auth_set_result_token(const char* token)
@@ -28,10 +28,12 @@
 /**************************************************************************************************/
 
 static uint32_t mock_here_tracking_get_unixtime_result = 0;
+static uint32_t mock_here_tracking_get_monotonic_ms_result = 0;
 
 /**************************************************************************************************/
 
 DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_get_unixtime, uint32_t*);
+DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_get_monotonic_ms, uint32_t*);
 
 /**************************************************************************************************/
 
@@ -70,3 +72,39 @@ here_tracking_error mock_here_tracking_get_unixtime_custom(uint32_t* ts)
 
     return err;
 }
+
+
+void mock_here_tracking_get_monotonic_ms_set_result(uint32_t result)
+{
+    mock_here_tracking_get_monotonic_ms_result = result;
+}
+
+
+here_tracking_error mock_here_tracking_get_monotonic_ms_custom(uint32_t* ms)
+{
+    here_tracking_error err;
+    here_tracking_get_monotonic_ms_Fake* the_fake = &here_tracking_get_monotonic_ms_fake;
+
+    if(the_fake->return_val_seq_len > 0)
+    {
+        if(the_fake->return_val_seq_idx < the_fake->return_val_seq_len)
+        {
+            err = the_fake->return_val_seq[the_fake->return_val_seq_idx++];
+        }
+        else
+        {
+            err = the_fake->return_val_seq[the_fake->return_val_seq_len - 1];
+        }
+    }
+    else
+    {
+        err = the_fake->return_val;
+    }
+
+    if(err == HERE_TRACKING_OK)
+    {
+        *ms = mock_here_tracking_get_monotonic_ms_result;
+    }
+
+    return err;
+}
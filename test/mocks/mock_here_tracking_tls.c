@@ -39,7 +39,16 @@ static uint32_t mock_tls_read_current_chunk_offset = 0;
 
 /**************************************************************************************************/
 
-DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_init, here_tracking_tls*);
+DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_env_init, here_tracking_tls_env*);
+
+DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_env_ref, here_tracking_tls_env);
+
+DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_env_free, here_tracking_tls_env*);
+
+DEFINE_FAKE_VALUE_FUNC2(here_tracking_error,
+                        here_tracking_tls_init,
+                        here_tracking_tls*,
+                        here_tracking_tls_env);
 
 DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_free, here_tracking_tls*);
 
@@ -49,8 +58,49 @@ DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
                         const char*,
                         uint16_t);
 
+DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
+                        here_tracking_tls_connect_async,
+                        here_tracking_tls,
+                        const char*,
+                        uint16_t);
+
+DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
+                        here_tracking_tls_get_poll_info,
+                        here_tracking_tls,
+                        int*,
+                        uint8_t*);
+
 DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_close, here_tracking_tls);
 
+DEFINE_FAKE_VALUE_FUNC1(here_tracking_error, here_tracking_tls_check_connection, here_tracking_tls);
+
+DEFINE_FAKE_VALUE_FUNC2(here_tracking_error,
+                        here_tracking_tls_set_deadline,
+                        here_tracking_tls,
+                        uint32_t);
+
+DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
+                        here_tracking_tls_get_session,
+                        here_tracking_tls,
+                        uint8_t*,
+                        uint32_t*);
+
+DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
+                        here_tracking_tls_set_session,
+                        here_tracking_tls,
+                        const uint8_t*,
+                        uint32_t);
+
+DEFINE_FAKE_VALUE_FUNC2(here_tracking_error,
+                        here_tracking_tls_set_alpn,
+                        here_tracking_tls,
+                        const char**);
+
+DEFINE_FAKE_VALUE_FUNC2(here_tracking_error,
+                        here_tracking_tls_get_alpn,
+                        here_tracking_tls,
+                        const char**);
+
 DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
                         here_tracking_tls_read,
                         here_tracking_tls,
@@ -65,7 +115,8 @@ DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
 
 /**************************************************************************************************/
 
-here_tracking_error mock_here_tracking_tls_init_custom(here_tracking_tls* tls)
+here_tracking_error mock_here_tracking_tls_init_custom(here_tracking_tls* tls,
+                                                       here_tracking_tls_env env)
 {
     if(here_tracking_tls_init_fake.return_val == HERE_TRACKING_OK)
     {
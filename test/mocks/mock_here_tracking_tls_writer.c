@@ -36,6 +36,12 @@ DEFINE_FAKE_VALUE_FUNC4(here_tracking_error,
                         uint8_t*,
                         size_t);
 
+DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
+                        here_tracking_tls_writer_init_buffered,
+                        here_tracking_tls_writer*,
+                        uint8_t*,
+                        size_t);
+
 DEFINE_FAKE_VALUE_FUNC2(here_tracking_error,
                         here_tracking_tls_writer_write_char,
                         here_tracking_tls_writer*,
@@ -61,3 +67,21 @@ DEFINE_FAKE_VALUE_FUNC3(here_tracking_error,
 DEFINE_FAKE_VALUE_FUNC1(here_tracking_error,
                         here_tracking_tls_writer_flush,
                         here_tracking_tls_writer*);
+
+/**************************************************************************************************/
+
+here_tracking_error \
+    mock_here_tracking_tls_writer_init_buffered_custom(here_tracking_tls_writer* writer,
+                                                       uint8_t* write_buf,
+                                                       size_t write_buf_size)
+{
+    if(here_tracking_tls_writer_init_buffered_fake.return_val == HERE_TRACKING_OK)
+    {
+        writer->tls_ctx = NULL;
+        writer->data_buffer.buffer = (char*)write_buf;
+        writer->data_buffer.buffer_capacity = (uint32_t)write_buf_size;
+        writer->data_buffer.buffer_size = 0;
+    }
+
+    return here_tracking_tls_writer_init_buffered_fake.return_val;
+}
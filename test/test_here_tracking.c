@@ -28,6 +28,7 @@
 #include <fff.h>
 
 #include "here_tracking.h"
+#include "here_tracking_async.h"
 #include "here_tracking_test.h"
 
 #include "mock_here_tracking_http.h"
@@ -626,6 +627,668 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_send_stream_pipelined)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    here_tracking_stream_req reqs[2];
+    uint8_t i, completed = 0;
+
+    for(i = 0; i < 2; ++i)
+    {
+        reqs[i].send_cb = test_here_tracking_send_cb;
+        reqs[i].recv_cb = test_here_tracking_recv_cb;
+        reqs[i].req_type = HERE_TRACKING_REQ_DATA_JSON;
+        reqs[i].resp_type = HERE_TRACKING_RESP_WITH_DATA_JSON;
+        reqs[i].user_data = NULL;
+    }
+
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    res = here_tracking_send_stream_pipelined(&client, reqs, 2, &completed);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_str_eq(client.access_token, mock_access_token);
+    ck_assert_uint_eq(here_tracking_http_auth_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_http_send_stream_pipelined_fake.call_count, 1);
+    ck_assert_ptr_eq(here_tracking_http_send_stream_pipelined_fake.arg1_val, reqs);
+    ck_assert_uint_eq(here_tracking_http_send_stream_pipelined_fake.arg2_val, 2);
+
+    res = here_tracking_send_stream_pipelined(NULL, reqs, 2, &completed);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_send_stream_pipelined(&client, NULL, 2, &completed);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_send_stream_pipelined(&client, reqs, 0, &completed);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_send_stream_pipelined(&client, reqs, 2, NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+    reqs[1].recv_cb = NULL;
+    res = here_tracking_send_stream_pipelined(&client, reqs, 2, &completed);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_uint_eq(here_tracking_http_send_stream_pipelined_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_set_keep_alive)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(!client.keep_alive.enabled);
+    ck_assert(!client.keep_alive.connected);
+    res = here_tracking_set_keep_alive(&client, true, 0);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.enabled);
+    ck_assert_uint_eq(client.keep_alive.idle_timeout,
+                      HERE_TRACKING_KEEP_ALIVE_DEFAULT_IDLE_TIMEOUT);
+    res = here_tracking_set_keep_alive(&client, true, 5);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert_uint_eq(client.keep_alive.idle_timeout, 5);
+    client.keep_alive.connected = true;
+    res = here_tracking_set_keep_alive(&client, false, 0);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(!client.keep_alive.enabled);
+    ck_assert(!client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+    res = here_tracking_set_keep_alive(NULL, true, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_prewarm_ok)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    uint32_t time_in_test = 1000;
+
+    mock_here_tracking_get_unixtime_set_result(time_in_test);
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    res = here_tracking_set_keep_alive(&client, true, 0);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    strcpy(client.access_token, "valid_token");
+    client.token_expiry = time_in_test + 3600;
+    res = here_tracking_prewarm(&client, time_in_test + 30);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_http_auth_fake.call_count, 0);
+    ck_assert_uint_eq(here_tracking_http_prewarm_fake.call_count, 1);
+    ck_assert_ptr_eq(here_tracking_http_prewarm_fake.arg0_val, &client);
+    ck_assert_str_eq(client.access_token, "valid_token");
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_prewarm_token_refresh)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    uint32_t time_in_test = 1000, token_expires_in = 900;
+
+    mock_here_tracking_get_unixtime_set_result(time_in_test);
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    res = here_tracking_set_keep_alive(&client, true, 0);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    strcpy(client.access_token, "token_valid_now");
+    client.token_expiry = time_in_test + token_expires_in;
+
+    /* Token still valid for a send now, but not at the time the send is expected */
+    res = here_tracking_prewarm(&client, 0);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_http_auth_fake.call_count, 0);
+    res = here_tracking_prewarm(&client, time_in_test + token_expires_in);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_http_auth_fake.call_count, 1);
+    ck_assert_str_eq(client.access_token, mock_access_token);
+    ck_assert_uint_eq(here_tracking_http_prewarm_fake.call_count, 2);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_prewarm_fail)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    strcpy(client.access_token, "valid_token");
+    client.token_expiry = UINT32_MAX;
+    res = here_tracking_prewarm(&client, 0);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR);
+    ck_assert_uint_eq(here_tracking_http_prewarm_fake.call_count, 0);
+    res = here_tracking_set_keep_alive(&client, true, 0);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    here_tracking_http_prewarm_fake.return_val = HERE_TRACKING_ERROR_TIMEOUT;
+    res = here_tracking_prewarm(&client, 0);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_TIMEOUT);
+    ck_assert_uint_eq(here_tracking_http_prewarm_fake.call_count, 1);
+    res = here_tracking_prewarm(NULL, 0);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_set_timeouts)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert_uint_eq(client.timeouts.connect_timeout, HERE_TRACKING_DEFAULT_CONNECT_TIMEOUT);
+    ck_assert_uint_eq(client.timeouts.io_timeout, HERE_TRACKING_DEFAULT_IO_TIMEOUT);
+    ck_assert_uint_eq(client.timeouts.request_timeout, HERE_TRACKING_DEFAULT_REQUEST_TIMEOUT);
+    res = here_tracking_set_timeouts(&client, 1000, 2000, 3000);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert_uint_eq(client.timeouts.connect_timeout, 1000);
+    ck_assert_uint_eq(client.timeouts.io_timeout, 2000);
+    ck_assert_uint_eq(client.timeouts.request_timeout, 3000);
+    res = here_tracking_set_timeouts(NULL, 1000, 2000, 3000);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_set_io_buffers)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    uint8_t buffer[HERE_TRACKING_IO_BUFFER_MIN_SIZE];
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.io_buffers.send_buffer == NULL);
+    ck_assert(client.io_buffers.recv_buffer == NULL);
+    res = here_tracking_set_io_buffers(&client, buffer, sizeof(buffer), buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.io_buffers.send_buffer == buffer);
+    ck_assert_uint_eq(client.io_buffers.send_buffer_size, sizeof(buffer));
+    ck_assert(client.io_buffers.recv_buffer == buffer);
+    ck_assert_uint_eq(client.io_buffers.recv_buffer_size, sizeof(buffer));
+    res = here_tracking_set_io_buffers(&client, buffer, sizeof(buffer) - 1, NULL, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_io_buffers(&client, NULL, 0, buffer, sizeof(buffer) - 1);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert(client.io_buffers.send_buffer == buffer);
+    res = here_tracking_set_io_buffers(&client, NULL, sizeof(buffer), NULL, 0);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.io_buffers.send_buffer == NULL);
+    ck_assert_uint_eq(client.io_buffers.send_buffer_size, 0);
+    ck_assert(client.io_buffers.recv_buffer == NULL);
+    ck_assert_uint_eq(client.io_buffers.recv_buffer_size, 0);
+    res = here_tracking_set_io_buffers(NULL, NULL, 0, NULL, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_set_hdr_cache)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    uint8_t buffer[HERE_TRACKING_ACCESS_TOKEN_SIZE + 256];
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.hdr_cache.buffer == NULL);
+    res = here_tracking_set_hdr_cache(&client, buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.hdr_cache.buffer == buffer);
+    ck_assert_uint_eq(client.hdr_cache.buffer_size, sizeof(buffer));
+    ck_assert_uint_eq(client.hdr_cache.size, 0);
+    client.hdr_cache.size = 100;
+    client.hdr_cache.too_small = true;
+    res = here_tracking_set_hdr_cache(&client, buffer, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_uint_eq(client.hdr_cache.size, 100);
+    res = here_tracking_set_hdr_cache(&client, NULL, 0);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.hdr_cache.buffer == NULL);
+    ck_assert_uint_eq(client.hdr_cache.size, 0);
+    ck_assert(!client.hdr_cache.too_small);
+    res = here_tracking_set_hdr_cache(NULL, buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_codec_begin(void* codec_data)
+{
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_codec_encode(const uint8_t* in,
+                                                          size_t* in_size,
+                                                          uint8_t* out,
+                                                          size_t* out_size,
+                                                          bool finish,
+                                                          bool* end,
+                                                          void* codec_data)
+{
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_set_codec)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    uint8_t buffer[64];
+    here_tracking_codec codec =
+    {
+        "gzip",
+        test_here_tracking_codec_begin,
+        test_here_tracking_codec_encode,
+        test_here_tracking_codec_begin,
+        test_here_tracking_codec_encode,
+        NULL
+    };
+    here_tracking_codec codec_no_encoding = codec;
+    here_tracking_codec codec_no_encode = codec;
+    here_tracking_codec codec_no_decode = codec;
+    here_tracking_codec codec_decode_only = codec;
+    here_tracking_codec codec_no_callbacks = codec;
+    codec_no_encoding.content_encoding = NULL;
+    codec_no_encode.encode = NULL;
+    codec_no_decode.decode = NULL;
+    codec_decode_only.begin = NULL;
+    codec_decode_only.encode = NULL;
+    codec_no_callbacks.begin = NULL;
+    codec_no_callbacks.encode = NULL;
+    codec_no_callbacks.decode_begin = NULL;
+    codec_no_callbacks.decode = NULL;
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.codec == NULL);
+    res = here_tracking_set_codec(&client, &codec, buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.codec == &codec);
+    ck_assert(client.codec_buffer == buffer);
+    ck_assert_uint_eq(client.codec_buffer_size, sizeof(buffer));
+    res = here_tracking_set_codec(&client, &codec, NULL, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_codec(&client, &codec, buffer, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_codec(&client, &codec_no_encoding, buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_codec(&client, &codec_no_encode, buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_codec(&client, &codec_no_decode, buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_codec(&client, &codec_no_callbacks, buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert(client.codec == &codec);
+    res = here_tracking_set_codec(&client, &codec_decode_only, buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.codec == &codec_decode_only);
+    res = here_tracking_set_codec(&client, NULL, NULL, 0);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.codec == NULL);
+    ck_assert(client.codec_buffer == NULL);
+    res = here_tracking_set_codec(NULL, NULL, NULL, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_set_http2)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    uint8_t buffer[256];
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(!client.http2.enabled);
+    ck_assert(!client.http2.active);
+    res = here_tracking_set_http2(&client, true, buffer, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.http2.enabled);
+    ck_assert(client.http2.hpack_buffer == buffer);
+    ck_assert_uint_eq(client.http2.hpack_buffer_size, sizeof(buffer));
+    res = here_tracking_set_http2(&client, true, buffer, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert(client.http2.hpack_buffer == buffer);
+    client.http2.active = true;
+    res = here_tracking_set_http2(&client, true, NULL, sizeof(buffer));
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.http2.hpack_buffer == NULL);
+    ck_assert_uint_eq(client.http2.hpack_buffer_size, 0);
+    ck_assert(!client.http2.active);
+    res = here_tracking_set_http2(&client, false, NULL, 0);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(!client.http2.enabled);
+    res = here_tracking_set_http2(NULL, true, NULL, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_set_rate_limiters)
+{
+    here_tracking_client client;
+    here_tracking_rate_limiter limiter, gateway_limiter;
+    here_tracking_error res;
+    here_tracking_get_monotonic_ms_fake.custom_fake = mock_here_tracking_get_monotonic_ms_custom;
+    mock_here_tracking_get_monotonic_ms_set_result(1000);
+    mock_here_tracking_get_unixtime_set_result(1000);
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&limiter, 60000, 2), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&gateway_limiter, 1000, 1), HERE_TRACKING_OK);
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.rate_limiter == NULL);
+    ck_assert(client.gateway_rate_limiter == NULL);
+    res = here_tracking_set_rate_limiters(&client, &limiter, &limiter);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_rate_limiters(NULL, &limiter, NULL);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_rate_limiters(&client, &limiter, &gateway_limiter);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.rate_limiter == &limiter);
+    ck_assert(client.gateway_rate_limiter == &gateway_limiter);
+    res = here_tracking_send_stream(&client,
+                                    test_here_tracking_send_cb,
+                                    test_here_tracking_recv_cb,
+                                    HERE_TRACKING_REQ_DATA_JSON,
+                                    HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                    NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_http_send_stream_fake.call_count, 1);
+    ck_assert_uint_eq(limiter.tokens, 1);
+    ck_assert_uint_eq(gateway_limiter.tokens, 0);
+
+    /* Rejected before connecting, the client limiter keeps its token */
+    res = here_tracking_send_stream(&client,
+                                    test_here_tracking_send_cb,
+                                    test_here_tracking_recv_cb,
+                                    HERE_TRACKING_REQ_DATA_JSON,
+                                    HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                    NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(here_tracking_http_send_stream_fake.call_count, 1);
+    ck_assert_uint_eq(limiter.tokens, 1);
+    mock_here_tracking_get_monotonic_ms_set_result(2000);
+    res = here_tracking_send_stream(&client,
+                                    test_here_tracking_send_cb,
+                                    test_here_tracking_recv_cb,
+                                    HERE_TRACKING_REQ_DATA_JSON,
+                                    HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                    NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_http_send_stream_fake.call_count, 2);
+    ck_assert_uint_eq(limiter.tokens, 0);
+    res = here_tracking_set_rate_limiters(&client, NULL, NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.rate_limiter == NULL);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_set_tls_env)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.tls_env == NULL);
+    client.tls = (here_tracking_tls)1;
+    client.keep_alive.connected = true;
+    res = here_tracking_set_tls_env(&client, (here_tracking_tls_env)2);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.tls_env == (here_tracking_tls_env)2);
+    ck_assert(client.tls == NULL);
+    ck_assert(!client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_env_ref_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_env_free_fake.call_count, 0);
+    ck_assert_uint_eq(here_tracking_tls_free_fake.call_count, 1);
+    res = here_tracking_set_tls_env(&client, NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.tls_env == NULL);
+    ck_assert_uint_eq(here_tracking_tls_env_ref_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_env_free_fake.call_count, 1);
+    res = here_tracking_set_tls_env(&client, (here_tracking_tls_env)3);
+    ck_assert(res == HERE_TRACKING_OK);
+    res = here_tracking_free(&client);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.tls_env == NULL);
+    ck_assert_uint_eq(here_tracking_tls_env_free_fake.call_count, 2);
+    res = here_tracking_set_tls_env(NULL, NULL);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_set_tls_env_ref_fail)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    here_tracking_tls_env_ref_fake.return_val = HERE_TRACKING_ERROR;
+    res = here_tracking_set_tls_env(&client, (here_tracking_tls_env)2);
+    ck_assert(res == HERE_TRACKING_ERROR);
+    ck_assert(client.tls_env == NULL);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_session)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    uint8_t session[16] = { 0 };
+    uint32_t session_size = sizeof(session);
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+
+    /* No TLS handle yet, nothing to store */
+    res = here_tracking_get_tls_session(&client, session, &session_size);
+    ck_assert(res == HERE_TRACKING_ERROR);
+    ck_assert_uint_eq(here_tracking_tls_get_session_fake.call_count, 0);
+
+    /* Restoring creates the TLS handle with the client's environment */
+    here_tracking_tls_init_fake.custom_fake = mock_here_tracking_tls_init_custom;
+    client.tls_env = (here_tracking_tls_env)2;
+    res = here_tracking_set_tls_session(&client, session, sizeof(session));
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(client.tls == (here_tracking_tls)1);
+    ck_assert_uint_eq(here_tracking_tls_init_fake.call_count, 1);
+    ck_assert(here_tracking_tls_init_fake.arg1_val == (here_tracking_tls_env)2);
+    ck_assert_uint_eq(here_tracking_tls_set_session_fake.call_count, 1);
+    ck_assert(here_tracking_tls_set_session_fake.arg1_val == session);
+    ck_assert_uint_eq(here_tracking_tls_set_session_fake.arg2_val, sizeof(session));
+    res = here_tracking_set_tls_session(&client, session, sizeof(session));
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_init_fake.call_count, 1);
+    here_tracking_tls_get_session_fake.return_val = HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+    res = here_tracking_get_tls_session(&client, session, &session_size);
+    ck_assert(res == HERE_TRACKING_ERROR_BUFFER_TOO_SMALL);
+    ck_assert(here_tracking_tls_get_session_fake.arg0_val == (here_tracking_tls)1);
+    ck_assert(here_tracking_tls_get_session_fake.arg2_val == &session_size);
+    client.tls_env = NULL;
+    here_tracking_free(&client);
+    ck_assert_uint_eq(here_tracking_tls_free_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_session_fail)
+{
+    here_tracking_client client;
+    here_tracking_error res;
+    uint8_t session[16] = { 0 };
+    uint32_t session_size = sizeof(session);
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert(res == HERE_TRACKING_OK);
+    here_tracking_tls_init_fake.return_val = HERE_TRACKING_ERROR;
+    res = here_tracking_set_tls_session(&client, session, sizeof(session));
+    ck_assert(res == HERE_TRACKING_ERROR);
+    ck_assert_uint_eq(here_tracking_tls_set_session_fake.call_count, 0);
+    res = here_tracking_set_tls_session(NULL, session, sizeof(session));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_tls_session(&client, NULL, sizeof(session));
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_set_tls_session(&client, session, 0);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_get_tls_session(NULL, session, &session_size);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_get_tls_session(&client, session, NULL);
+    ck_assert(res == HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_uint_eq(here_tracking_tls_init_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_send_stream_async_ok)
+{
+    here_tracking_client client;
+    here_tracking_async async;
+    here_tracking_error res;
+    uint32_t time_in_test = 1000;
+    int fd;
+    uint8_t events;
+
+    mock_here_tracking_get_unixtime_set_result(time_in_test);
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    strcpy(client.access_token, mock_access_token);
+    client.token_expiry = time_in_test + 3600;
+    res = here_tracking_send_stream_async(&async,
+                                          &client,
+                                          test_here_tracking_send_cb,
+                                          test_here_tracking_recv_cb,
+                                          HERE_TRACKING_REQ_DATA_JSON,
+                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                          NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_http_send_stream_async_fake.call_count, 1);
+    ck_assert(here_tracking_http_send_stream_async_fake.arg0_val == (void*)&async);
+    ck_assert(!here_tracking_http_send_stream_async_fake.arg2_val);
+    ck_assert_uint_eq(here_tracking_http_auth_fake.call_count, 0);
+    here_tracking_http_async_step_fake.return_val = HERE_TRACKING_ERROR_WOULD_BLOCK;
+    res = here_tracking_async_step(&async);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_WOULD_BLOCK);
+    res = here_tracking_async_get_poll_info(&async, &fd, &events);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_http_async_get_poll_info_fake.call_count, 1);
+    res = here_tracking_async_cancel(&async);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_http_async_cancel_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_send_stream_async_no_token_yet)
+{
+    here_tracking_client client;
+    here_tracking_async async;
+    here_tracking_error res;
+
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    res = here_tracking_send_stream_async(&async,
+                                          &client,
+                                          test_here_tracking_send_cb,
+                                          test_here_tracking_recv_cb,
+                                          HERE_TRACKING_REQ_DATA_JSON,
+                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                          NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_http_send_stream_async_fake.call_count, 1);
+    ck_assert(here_tracking_http_send_stream_async_fake.arg2_val);
+    ck_assert_uint_eq(here_tracking_http_auth_fake.call_count, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_send_stream_async_invalid_input)
+{
+    here_tracking_client client;
+    here_tracking_async async;
+    here_tracking_error res;
+
+    res = here_tracking_send_stream_async(NULL,
+                                          &client,
+                                          test_here_tracking_send_cb,
+                                          test_here_tracking_recv_cb,
+                                          HERE_TRACKING_REQ_DATA_JSON,
+                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                          NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_send_stream_async(&async,
+                                          NULL,
+                                          test_here_tracking_send_cb,
+                                          test_here_tracking_recv_cb,
+                                          HERE_TRACKING_REQ_DATA_JSON,
+                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                          NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_send_stream_async(&async,
+                                          &client,
+                                          NULL,
+                                          test_here_tracking_recv_cb,
+                                          HERE_TRACKING_REQ_DATA_JSON,
+                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                          NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+    res = here_tracking_send_stream_async(&async,
+                                          &client,
+                                          test_here_tracking_send_cb,
+                                          NULL,
+                                          HERE_TRACKING_REQ_DATA_JSON,
+                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                          NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_uint_eq(here_tracking_http_send_stream_async_fake.call_count, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_send_stream_async_too_many_requests)
+{
+    here_tracking_client client;
+    here_tracking_async async;
+    here_tracking_error res;
+    uint32_t time_in_test = 1000;
+
+    mock_here_tracking_get_unixtime_set_result(time_in_test);
+    res = here_tracking_init(&client, device_id, device_secret, base_url);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    client.retry_after = time_in_test + 100;
+    res = here_tracking_send_stream_async(&async,
+                                          &client,
+                                          test_here_tracking_send_cb,
+                                          test_here_tracking_recv_cb,
+                                          HERE_TRACKING_REQ_DATA_JSON,
+                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                          NULL);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(here_tracking_http_send_stream_async_fake.call_count, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_SETUP_TEARDOWN_FN(test_here_tracking_tc_setup,
                                      test_here_tracking_tc_teardown)
@@ -654,6 +1317,25 @@ TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_TEST(test_here_tracking_send_stream_time_error_seq)
     TEST_SUITE_ADD_TEST(test_here_tracking_send_stream_too_many_requests)
     TEST_SUITE_ADD_TEST(test_here_tracking_send_stream_too_many_requests_cb)
+    TEST_SUITE_ADD_TEST(test_here_tracking_send_stream_pipelined)
+    TEST_SUITE_ADD_TEST(test_here_tracking_set_keep_alive)
+    TEST_SUITE_ADD_TEST(test_here_tracking_prewarm_ok)
+    TEST_SUITE_ADD_TEST(test_here_tracking_prewarm_token_refresh)
+    TEST_SUITE_ADD_TEST(test_here_tracking_prewarm_fail)
+    TEST_SUITE_ADD_TEST(test_here_tracking_set_timeouts)
+    TEST_SUITE_ADD_TEST(test_here_tracking_set_io_buffers)
+    TEST_SUITE_ADD_TEST(test_here_tracking_set_hdr_cache)
+    TEST_SUITE_ADD_TEST(test_here_tracking_set_codec)
+    TEST_SUITE_ADD_TEST(test_here_tracking_set_http2)
+    TEST_SUITE_ADD_TEST(test_here_tracking_set_rate_limiters)
+    TEST_SUITE_ADD_TEST(test_here_tracking_set_tls_env)
+    TEST_SUITE_ADD_TEST(test_here_tracking_set_tls_env_ref_fail)
+    TEST_SUITE_ADD_TEST(test_here_tracking_tls_session)
+    TEST_SUITE_ADD_TEST(test_here_tracking_tls_session_fail)
+    TEST_SUITE_ADD_TEST(test_here_tracking_send_stream_async_ok)
+    TEST_SUITE_ADD_TEST(test_here_tracking_send_stream_async_no_token_yet)
+    TEST_SUITE_ADD_TEST(test_here_tracking_send_stream_async_invalid_input)
+    TEST_SUITE_ADD_TEST(test_here_tracking_send_stream_async_too_many_requests)
 TEST_SUITE_END
 
 /**************************************************************************************************/
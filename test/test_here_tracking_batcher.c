@@ -0,0 +1,349 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <string.h>
+
+#include <check.h>
+#include <fff.h>
+
+#include "here_tracking_batcher.h"
+#include "here_tracking_test.h"
+
+#include "mock_here_tracking_time.h"
+
+#define TEST_NAME "here_tracking_batcher"
+
+/**************************************************************************************************/
+
+DEFINE_FFF_GLOBALS;
+
+FAKE_VALUE_FUNC6(here_tracking_error,
+                 here_tracking_send_stream,
+                 here_tracking_client*,
+                 here_tracking_send_cb,
+                 here_tracking_recv_cb,
+                 here_tracking_req_type,
+                 here_tracking_resp_type,
+                 void*);
+
+#define TEST_HERE_TRACKING_BATCHER_FAKE_LIST(FAKE) \
+    MOCK_HERE_TRACKING_TIME_FAKE_LIST(FAKE) \
+    FAKE(here_tracking_send_stream)
+
+#define TEST_HERE_TRACKING_BATCHER_BODY_SIZE 256
+
+/**************************************************************************************************/
+
+static here_tracking_client client;
+static here_tracking_batcher batcher;
+static uint8_t buffer[64];
+static char test_body[TEST_HERE_TRACKING_BATCHER_BODY_SIZE];
+static here_tracking_error test_resp_status;
+static uint32_t test_recv_cb_called;
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_batcher_send_stream_custom(here_tracking_client* c,
+                                                                         here_tracking_send_cb s_cb,
+                                                                         here_tracking_recv_cb r_cb,
+                                                                         here_tracking_req_type rq,
+                                                                         here_tracking_resp_type rs,
+                                                                         void* user_data)
+{
+    here_tracking_recv_data data;
+    const uint8_t* chunk;
+    size_t chunk_size, body_size = 0;
+
+    do
+    {
+        ck_assert_int_eq(s_cb(&chunk, &chunk_size, user_data), HERE_TRACKING_OK);
+        ck_assert_uint_le(body_size + chunk_size, TEST_HERE_TRACKING_BATCHER_BODY_SIZE - 1);
+        memcpy(test_body + body_size, chunk, chunk_size);
+        body_size += chunk_size;
+    } while(chunk_size > 0);
+
+    test_body[body_size] = '\0';
+    data.evt = HERE_TRACKING_RECV_EVT_RESP_COMPLETE;
+    data.err = test_resp_status;
+    data.data = NULL;
+    data.data_size = 0;
+    return r_cb(&data, user_data);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_batcher_recv_cb(const here_tracking_recv_data* data,
+                                                              void* user_data)
+{
+    ck_assert_ptr_eq(user_data, &test_recv_cb_called);
+    test_recv_cb_called++;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_batcher_add_str(const char* sample)
+{
+    return here_tracking_batcher_add(&batcher, (const uint8_t*)sample, strlen(sample));
+}
+
+/**************************************************************************************************/
+
+void test_here_tracking_batcher_tc_setup(void)
+{
+    TEST_HERE_TRACKING_BATCHER_FAKE_LIST(RESET_FAKE);
+    FFF_RESET_HISTORY();
+    here_tracking_send_stream_fake.custom_fake = test_here_tracking_batcher_send_stream_custom;
+    here_tracking_get_monotonic_ms_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_get_monotonic_ms_fake.custom_fake = mock_here_tracking_get_monotonic_ms_custom;
+    mock_here_tracking_get_monotonic_ms_set_result(1000);
+    test_resp_status = HERE_TRACKING_OK;
+    test_recv_cb_called = 0;
+    test_body[0] = '\0';
+    ck_assert_int_eq(here_tracking_batcher_init(&batcher,
+                                                &client,
+                                                HERE_TRACKING_REQ_DATA_JSON,
+                                                buffer,
+                                                sizeof(buffer),
+                                                NULL,
+                                                NULL),
+                     HERE_TRACKING_OK);
+}
+
+/**************************************************************************************************/
+
+void test_here_tracking_batcher_tc_teardown(void)
+{
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_batcher_init_invalid)
+{
+    ck_assert_int_eq(here_tracking_batcher_init(NULL,
+                                                &client,
+                                                HERE_TRACKING_REQ_DATA_JSON,
+                                                buffer,
+                                                sizeof(buffer),
+                                                NULL,
+                                                NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_batcher_init(&batcher,
+                                                NULL,
+                                                HERE_TRACKING_REQ_DATA_JSON,
+                                                buffer,
+                                                sizeof(buffer),
+                                                NULL,
+                                                NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_batcher_init(&batcher,
+                                                &client,
+                                                HERE_TRACKING_REQ_DATA_JSON,
+                                                NULL,
+                                                sizeof(buffer),
+                                                NULL,
+                                                NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_batcher_init(&batcher,
+                                                &client,
+                                                HERE_TRACKING_REQ_DATA_JSON,
+                                                buffer,
+                                                0,
+                                                NULL,
+                                                NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_batcher_set_limits(NULL, 0, 0, 0),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_batcher_set_limits(&batcher, 0, sizeof(buffer) + 1, 0),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_batcher_add(&batcher, NULL, 1),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_batcher_poll(NULL, NULL), HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_batcher_flush(NULL), HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_batcher_max_samples)
+{
+    ck_assert_int_eq(here_tracking_batcher_set_limits(&batcher, 3, 0, 1000), HERE_TRACKING_OK);
+    ck_assert_uint_eq(batcher.max_bytes, sizeof(buffer));
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"a\":1}"), HERE_TRACKING_OK);
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"b\":2}"), HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_send_stream_fake.call_count, 0);
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"c\":3}"), HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_send_stream_fake.call_count, 1);
+    ck_assert_ptr_eq(here_tracking_send_stream_fake.arg0_val, &client);
+    ck_assert_int_eq(here_tracking_send_stream_fake.arg3_val, HERE_TRACKING_REQ_DATA_JSON);
+    ck_assert_int_eq(here_tracking_send_stream_fake.arg4_val, HERE_TRACKING_RESP_STATUS_ONLY);
+    ck_assert_str_eq(test_body, "[{\"a\":1},{\"b\":2},{\"c\":3}]");
+    ck_assert_uint_eq(batcher.count, 0);
+
+    /* Empty batch is not sent */
+    ck_assert_int_eq(here_tracking_batcher_flush(&batcher), HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_send_stream_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_batcher_max_bytes)
+{
+    ck_assert_int_eq(here_tracking_batcher_set_limits(&batcher, 0, 20, 1000), HERE_TRACKING_OK);
+
+    /* "[" + 16 + "]" fits, 19 + "]" doesn't */
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"a\":1}"), HERE_TRACKING_OK);
+    ck_assert(here_tracking_batcher_has_room(&batcher, 7));
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"b\":2}"), HERE_TRACKING_OK);
+    ck_assert(!here_tracking_batcher_has_room(&batcher, 7));
+    ck_assert(!here_tracking_batcher_has_room(NULL, 7));
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"c\":3}"), HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_send_stream_fake.call_count, 1);
+    ck_assert_str_eq(test_body, "[{\"a\":1},{\"b\":2}]");
+    ck_assert_uint_eq(batcher.count, 1);
+
+    /* Sample that doesn't fit into an empty batch */
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"long\":\"sample!!\"}"),
+                     HERE_TRACKING_ERROR_BUFFER_TOO_SMALL);
+    ck_assert_uint_eq(batcher.count, 1);
+    ck_assert_int_eq(here_tracking_batcher_flush(&batcher), HERE_TRACKING_OK);
+    ck_assert_str_eq(test_body, "[{\"c\":3}]");
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_batcher_linger)
+{
+    uint32_t wait_ms = 0;
+    ck_assert_int_eq(here_tracking_batcher_set_limits(&batcher, 0, 0, 500), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_batcher_poll(&batcher, &wait_ms), HERE_TRACKING_OK);
+    ck_assert_uint_eq(wait_ms, UINT32_MAX);
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"a\":1}"), HERE_TRACKING_OK);
+    mock_here_tracking_get_monotonic_ms_set_result(1200);
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"b\":2}"), HERE_TRACKING_OK);
+    mock_here_tracking_get_monotonic_ms_set_result(1300);
+    ck_assert_int_eq(here_tracking_batcher_poll(&batcher, &wait_ms), HERE_TRACKING_OK);
+    ck_assert_uint_eq(wait_ms, 200);
+    ck_assert_uint_eq(here_tracking_send_stream_fake.call_count, 0);
+
+    /* Oldest sample has waited long enough */
+    mock_here_tracking_get_monotonic_ms_set_result(1500);
+    ck_assert_int_eq(here_tracking_batcher_poll(&batcher, NULL), HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_send_stream_fake.call_count, 1);
+    ck_assert_str_eq(test_body, "[{\"a\":1},{\"b\":2}]");
+
+    /* Failed batch is tried again after another linger time */
+    test_resp_status = HERE_TRACKING_ERROR_TOO_MANY_REQUESTS;
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"c\":3}"), HERE_TRACKING_OK);
+    mock_here_tracking_get_monotonic_ms_set_result(2000);
+    ck_assert_int_eq(here_tracking_batcher_poll(&batcher, &wait_ms),
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(wait_ms, 500);
+    ck_assert_uint_eq(batcher.count, 1);
+    test_resp_status = HERE_TRACKING_OK;
+    mock_here_tracking_get_monotonic_ms_set_result(2499);
+    ck_assert_int_eq(here_tracking_batcher_poll(&batcher, &wait_ms), HERE_TRACKING_OK);
+    ck_assert_uint_eq(wait_ms, 1);
+    mock_here_tracking_get_monotonic_ms_set_result(2500);
+    ck_assert_int_eq(here_tracking_batcher_poll(&batcher, &wait_ms), HERE_TRACKING_OK);
+    ck_assert_uint_eq(wait_ms, UINT32_MAX);
+    ck_assert_uint_eq(batcher.count, 0);
+    ck_assert_str_eq(test_body, "[{\"c\":3}]");
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_batcher_send_errors)
+{
+    ck_assert_int_eq(here_tracking_batcher_set_limits(&batcher, 2, 0, 1000), HERE_TRACKING_OK);
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"a\":1}"), HERE_TRACKING_OK);
+
+    /* Full batch is kept when sending fails */
+    here_tracking_send_stream_fake.custom_fake = NULL;
+    here_tracking_send_stream_fake.return_val = HERE_TRACKING_ERROR_TIMEOUT;
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"b\":2}"), HERE_TRACKING_ERROR_TIMEOUT);
+    ck_assert_uint_eq(batcher.count, 2);
+
+    /* No room for the sample as long as the batch can't be sent */
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"c\":3}"), HERE_TRACKING_ERROR_TIMEOUT);
+    ck_assert_uint_eq(batcher.count, 2);
+
+    /* Rejected batch is dropped */
+    here_tracking_send_stream_fake.custom_fake = test_here_tracking_batcher_send_stream_custom;
+    test_resp_status = HERE_TRACKING_ERROR_BAD_REQUEST;
+    ck_assert_int_eq(test_here_tracking_batcher_add_str("{\"c\":3}"),
+                     HERE_TRACKING_ERROR_BAD_REQUEST);
+    ck_assert_uint_eq(batcher.count, 0);
+    ck_assert_str_eq(test_body, "[{\"a\":1},{\"b\":2}]");
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_batcher_protobuf)
+{
+    const uint8_t sample1[] = { 0x0a, 0x02, 0x08, 0x01 };
+    const uint8_t sample2[] = { 0x0a, 0x02, 0x08, 0x02 };
+    ck_assert_int_eq(here_tracking_batcher_init(&batcher,
+                                                &client,
+                                                HERE_TRACKING_REQ_DATA_PROTOBUF,
+                                                buffer,
+                                                sizeof(buffer),
+                                                test_here_tracking_batcher_recv_cb,
+                                                &test_recv_cb_called),
+                     HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_batcher_add(&batcher, sample1, sizeof(sample1)),
+                     HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_batcher_add(&batcher, sample2, sizeof(sample2)),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(batcher.size, 8);
+    ck_assert_int_eq(here_tracking_batcher_flush(&batcher), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_send_stream_fake.arg3_val, HERE_TRACKING_REQ_DATA_PROTOBUF);
+    ck_assert_int_eq(here_tracking_send_stream_fake.arg4_val,
+                     HERE_TRACKING_RESP_WITH_DATA_PROTOBUF);
+    ck_assert(memcmp(test_body, sample1, sizeof(sample1)) == 0);
+    ck_assert(memcmp(test_body + sizeof(sample1), sample2, sizeof(sample2)) == 0);
+    ck_assert_uint_eq(test_recv_cb_called, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+TEST_SUITE_BEGIN(TEST_NAME)
+    TEST_SUITE_ADD_SETUP_TEARDOWN_FN(test_here_tracking_batcher_tc_setup,
+                                     test_here_tracking_batcher_tc_teardown)
+    TEST_SUITE_ADD_TEST(test_here_tracking_batcher_init_invalid)
+    TEST_SUITE_ADD_TEST(test_here_tracking_batcher_max_samples)
+    TEST_SUITE_ADD_TEST(test_here_tracking_batcher_max_bytes)
+    TEST_SUITE_ADD_TEST(test_here_tracking_batcher_linger)
+    TEST_SUITE_ADD_TEST(test_here_tracking_batcher_send_errors)
+    TEST_SUITE_ADD_TEST(test_here_tracking_batcher_protobuf)
+TEST_SUITE_END
+
+/**************************************************************************************************/
+
+TEST_MAIN(TEST_NAME)
@@ -30,6 +30,7 @@
 
 #include "here_tracking_http.h"
 #include "here_tracking_http_defs.h"
+#include "here_tracking_http2.h"
 #include "here_tracking_test.h"
 
 #include "mock_here_tracking_data_buffer.h"
@@ -132,6 +133,45 @@ static const char* fake_too_many_requests_resp_no_retry_after = \
     "HTTP/1.1 429 Too Many Requests\r\n"\
     "Content-Length: 0\r\n"\
     "\r\n";
+static const char* fake_send_resp_connection_close = \
+    "HTTP/1.1 200 OK\r\n"\
+    "Content-Length: 21\r\n"\
+    "Connection: close\r\n"\
+    "\r\n"
+    "THIS IS SEND RESPONSE";
+static const char* fake_send_resp_chunked = \
+    "HTTP/1.1 200 OK\r\n"\
+    "Transfer-Encoding: chunked\r\n"\
+    "\r\n"
+    "8\r\n"
+    "THIS IS \r\n"
+    "D\r\n"
+    "SEND RESPONSE\r\n"
+    "0\r\n"
+    "\r\n";
+static const char* fake_send_resp_encoded = \
+    "HTTP/1.1 200 OK\r\n"\
+    "Content-Length: 22\r\n"\
+    "Content-Encoding: test\r\n"\
+    "\r\n"
+    "THIS IS SEND RESPONSE.";
+static const char* fake_send_resp_encoded_chunked = \
+    "HTTP/1.1 200 OK\r\n"\
+    "Content-Encoding: test\r\n"\
+    "Transfer-Encoding: chunked\r\n"\
+    "\r\n"
+    "8\r\n"
+    "THIS IS \r\n"
+    "E\r\n"
+    "SEND RESPONSE.\r\n"
+    "0\r\n"
+    "\r\n";
+static const char* fake_send_resp_encoded_truncated = \
+    "HTTP/1.1 200 OK\r\n"\
+    "Content-Encoding: test\r\n"\
+    "Content-Length: 21\r\n"\
+    "\r\n"
+    "THIS IS SEND RESPONSE";
 static const char* fake_unknown_resp = \
     "HTTP/1.1 999 I Don't Know This Code\r\n"\
     "Content-Length: 0\r\n"\
@@ -206,6 +246,9 @@ void test_here_tracking_http_tc_setup(void)
     here_tracking_data_buffer_add_data_fake.custom_fake = \
         mock_here_tracking_data_buffer_add_data_custom;
     here_tracking_tls_writer_init_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_tls_writer_init_buffered_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_tls_writer_init_buffered_fake.custom_fake = \
+        mock_here_tracking_tls_writer_init_buffered_custom;
     here_tracking_tls_writer_write_char_fake.return_val = HERE_TRACKING_OK;
     here_tracking_tls_writer_write_data_fake.return_val = HERE_TRACKING_OK;
     here_tracking_tls_writer_write_string_fake.return_val = HERE_TRACKING_OK;
@@ -213,9 +256,14 @@ void test_here_tracking_http_tc_setup(void)
     here_tracking_tls_writer_flush_fake.return_val = HERE_TRACKING_OK;
     here_tracking_get_unixtime_fake.return_val = HERE_TRACKING_OK;
     here_tracking_get_unixtime_fake.custom_fake = mock_here_tracking_get_unixtime_custom;
+    here_tracking_get_monotonic_ms_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_get_monotonic_ms_fake.custom_fake = mock_here_tracking_get_monotonic_ms_custom;
+    mock_here_tracking_get_monotonic_ms_set_result(1000);
     here_tracking_tls_init_fake.return_val = HERE_TRACKING_OK;
     here_tracking_tls_init_fake.custom_fake = mock_here_tracking_tls_init_custom;
     here_tracking_tls_connect_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_tls_connect_async_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_tls_write_fake.return_val = HERE_TRACKING_OK;
     here_tracking_tls_read_fake.return_val = HERE_TRACKING_OK;
     here_tracking_tls_read_fake.custom_fake = mock_here_tracking_tls_read_custom;
     mock_here_tracking_tls_read_set_result_data(NULL, NULL, 0);
@@ -259,9 +307,36 @@ static void test_here_tracking_http_setup(here_tracking_client* client)
     client->data_cb = NULL;
     client->data_cb_user_data = NULL;
     client->tls = NULL;
+    client->tls_env = NULL;
     client->correlation_id = NULL;
     client->user_agent = NULL;
     client->retry_after = 0;
+    client->keep_alive.enabled = false;
+    client->keep_alive.idle_timeout = HERE_TRACKING_KEEP_ALIVE_DEFAULT_IDLE_TIMEOUT;
+    client->keep_alive.connected = false;
+    client->keep_alive.port = 0;
+    client->keep_alive.last_used = 0;
+    client->keep_alive.non_blocking = false;
+    client->timeouts.connect_timeout = HERE_TRACKING_DEFAULT_CONNECT_TIMEOUT;
+    client->timeouts.io_timeout = HERE_TRACKING_DEFAULT_IO_TIMEOUT;
+    client->timeouts.request_timeout = HERE_TRACKING_DEFAULT_REQUEST_TIMEOUT;
+    client->io_buffers.send_buffer = NULL;
+    client->io_buffers.send_buffer_size = 0;
+    client->io_buffers.recv_buffer = NULL;
+    client->io_buffers.recv_buffer_size = 0;
+    client->hdr_cache.buffer = NULL;
+    client->hdr_cache.buffer_size = 0;
+    client->hdr_cache.size = 0;
+    client->hdr_cache.too_small = false;
+    client->codec = NULL;
+    client->codec_buffer = NULL;
+    client->codec_buffer_size = 0;
+    client->http2.enabled = false;
+    client->http2.hpack_buffer = NULL;
+    client->http2.hpack_buffer_size = 0;
+    client->http2.active = false;
+    client->rate_limiter = NULL;
+    client->gateway_rate_limiter = NULL;
 }
 
 /**************************************************************************************************/
@@ -271,6 +346,11 @@ static void test_here_tracking_http_tls_read_set_result(const char* data)
     uint32_t* mock_tls_read_data_size;
     uint8_t i, chunk_count = strlen(data) / TEST_HERE_TRACKING_HTTP_TLS_READ_CHUNK_SIZE;
 
+    if(mock_tls_read_data != NULL)
+    {
+        free(mock_tls_read_data);
+    }
+
     if(strlen(data) % TEST_HERE_TRACKING_HTTP_TLS_READ_CHUNK_SIZE > 0)
     {
         chunk_count++;
@@ -482,6 +562,23 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_http_auth_ok_tls_env)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_auth_resp);
+    client.tls_env = (here_tracking_tls_env)2;
+    err = here_tracking_http_auth(&client);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_init_fake.call_count, 1);
+    ck_assert(here_tracking_tls_init_fake.arg1_val == (here_tracking_tls_env)2);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 START_TEST(test_here_tracking_http_auth_ok_tls_initialized)
 {
     here_tracking_client client;
@@ -645,6 +742,24 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_http_auth_tls_connect_timeout)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    test_here_tracking_http_setup(&client);
+    here_tracking_tls_connect_fake.return_val = HERE_TRACKING_ERROR_TIMEOUT;
+    err = here_tracking_http_auth(&client);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_TIMEOUT);
+    ck_assert_uint_eq(here_tracking_tls_set_deadline_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_set_deadline_fake.arg1_val,
+                      1000 + HERE_TRACKING_DEFAULT_CONNECT_TIMEOUT);
+    ck_assert_uint_eq(here_tracking_tls_write_fake.call_count, 0);
+    ck_assert_uint_eq(here_tracking_oauth_create_header_fake.call_count, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 START_TEST(test_here_tracking_http_auth_oauth_create_header_fail)
 {
     here_tracking_client client;
@@ -869,6 +984,87 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_http_send_deadlines)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    char data[100];
+    uint32_t i;
+
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    client.data_cb = test_here_tracking_http_recv_data_cb_send_ok;
+    client.timeouts.connect_timeout = 10000;
+    client.timeouts.io_timeout = 2000;
+    client.timeouts.request_timeout = 5000;
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send(&client, data, 100, 100);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_ge(here_tracking_tls_set_deadline_fake.call_count, 3);
+
+    /* Connect deadline is limited by the request deadline, I/O deadline is not */
+    ck_assert_uint_eq(here_tracking_tls_set_deadline_fake.arg1_history[0], 6000);
+
+    for(i = 1; i < here_tracking_tls_set_deadline_fake.call_count; ++i)
+    {
+        ck_assert_uint_eq(here_tracking_tls_set_deadline_fake.arg1_history[i], 3000);
+    }
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_no_timeouts)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    char data[100];
+    uint32_t i;
+
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    client.data_cb = test_here_tracking_http_recv_data_cb_send_ok;
+    client.timeouts.connect_timeout = 0;
+    client.timeouts.io_timeout = 0;
+    client.timeouts.request_timeout = 0;
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send(&client, data, 100, 100);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_ge(here_tracking_tls_set_deadline_fake.call_count, 3);
+
+    for(i = 0; i < here_tracking_tls_set_deadline_fake.call_count; ++i)
+    {
+        ck_assert_uint_eq(here_tracking_tls_set_deadline_fake.arg1_history[i], 0);
+    }
+
+    ck_assert_uint_eq(here_tracking_get_monotonic_ms_fake.call_count, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_tls_read_timeout)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    char data[100];
+
+    test_here_tracking_http_setup(&client);
+    here_tracking_tls_read_fake.custom_fake = NULL;
+    here_tracking_tls_read_fake.return_val = HERE_TRACKING_ERROR_TIMEOUT;
+    client.data_cb = test_here_tracking_http_recv_data_cb_err;
+    client.keep_alive.enabled = true;
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send(&client, data, 100, 100);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_TIMEOUT);
+    ck_assert(!client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 START_TEST(test_here_tracking_http_send_tls_init_fail)
 {
     here_tracking_client client;
@@ -978,6 +1174,90 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_http_send_io_buffers)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    char data[100];
+    char mock_resp[1024];
+    uint8_t send_buffer[512];
+    uint8_t recv_buffer[1024];
+    size_t hdr_size = strlen("HTTP/1.1 200 OK\r\nx-large-header:");
+
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.data_cb = test_here_tracking_http_recv_data_cb_send_ok;
+    client.io_buffers.send_buffer = send_buffer;
+    client.io_buffers.send_buffer_size = sizeof(send_buffer);
+    client.io_buffers.recv_buffer = recv_buffer;
+    client.io_buffers.recv_buffer_size = sizeof(recv_buffer);
+
+    /* Header line longer than the default buffer */
+    memcpy(mock_resp, "HTTP/1.1 200 OK\r\nx-large-header:", hdr_size);
+    memset(mock_resp + hdr_size, 'A', 600);
+    strcpy(mock_resp + hdr_size + 600, "\r\nContent-Length: 21\r\n\r\nTHIS IS SEND RESPONSE");
+    test_here_tracking_http_tls_read_set_result(mock_resp);
+    err = here_tracking_http_send(&client, data, 100, 100);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 1);
+    ck_assert_uint_eq(here_tracking_tls_writer_init_fake.call_count, 1);
+    ck_assert_ptr_eq(here_tracking_tls_writer_init_fake.arg2_val, send_buffer);
+    ck_assert_uint_eq(here_tracking_tls_writer_init_fake.arg3_val, sizeof(send_buffer));
+    ck_assert_ptr_eq(here_tracking_tls_read_fake.arg1_history[0], recv_buffer);
+
+    /* Same response does not fit in the default buffer */
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.data_cb = test_here_tracking_http_recv_data_cb_send_ok;
+    test_here_tracking_http_tls_read_set_result(mock_resp);
+    err = here_tracking_http_send(&client, data, 100, 100);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_recv_no_compaction)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    char data[100];
+    uint8_t recv_buffer[512];
+    const char* mock_tls_read_data[3] =
+    {
+        "HTTP/1.1 200 OK\r\nContent-Le",
+        "ngth: 21\r",
+        "\n\r\nTHIS IS SEND RESPONSE"
+    };
+    uint32_t mock_tls_read_data_size[3] =
+    {
+        strlen(mock_tls_read_data[0]),
+        strlen(mock_tls_read_data[1]),
+        strlen(mock_tls_read_data[2])
+    };
+
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.data_cb = test_here_tracking_http_recv_data_cb_send_ok;
+    client.io_buffers.recv_buffer = recv_buffer;
+    client.io_buffers.recv_buffer_size = sizeof(recv_buffer);
+    mock_here_tracking_tls_read_set_result_data(mock_tls_read_data, mock_tls_read_data_size, 3);
+    err = here_tracking_http_send(&client, data, 100, 100);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 1);
+
+    /* Incomplete header line stays in place and more data is read after it */
+    ck_assert_uint_eq(here_tracking_tls_read_fake.call_count, 3);
+    ck_assert_ptr_eq(here_tracking_tls_read_fake.arg1_history[0], recv_buffer);
+    ck_assert_ptr_eq(here_tracking_tls_read_fake.arg1_history[1],
+                     recv_buffer + mock_tls_read_data_size[0]);
+    ck_assert_ptr_eq(here_tracking_tls_read_fake.arg1_history[2],
+                     recv_buffer + mock_tls_read_data_size[0] + mock_tls_read_data_size[1]);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 START_TEST(test_here_tracking_http_send_too_small_resp_buffer)
 {
     here_tracking_client client;
@@ -1647,16 +1927,76 @@ END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_send_stream_too_many_requests)
+static here_tracking_error test_here_tracking_http_writer_init(here_tracking_tls_writer* writer,
+                                                               here_tracking_tls tls_ctx,
+                                                               uint8_t* write_buf,
+                                                               size_t write_buf_size)
+{
+    writer->tls_ctx = tls_ctx;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    test_here_tracking_http_write_string_buffered(here_tracking_tls_writer* writer, const char* s)
+{
+    here_tracking_data_buffer* data_buffer = &writer->data_buffer;
+
+    /* Only writers collecting data to a buffer are emulated */
+    if(writer->tls_ctx == NULL)
+    {
+        if(HERE_TRACKING_DATA_BUFFER_BYTES_FREE(data_buffer) < strlen(s))
+        {
+            return HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+        }
+
+        data_buffer->buffer_size += strlen(s);
+    }
+
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    test_here_tracking_http_write_char_buffered(here_tracking_tls_writer* writer, char c)
+{
+    char s[2] = { c, '\0' };
+
+    return test_here_tracking_http_write_string_buffered(writer, s);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    test_here_tracking_http_send_stream_cached(here_tracking_client* client,
+                                               const char* resp,
+                                               here_tracking_req_type req_type)
+{
+    test_here_tracking_http_send_chunk_index = 0;
+    test_here_tracking_http_recv_data_cb_called = 0;
+    client->keep_alive.connected = false;
+    test_here_tracking_http_tls_read_set_result(resp);
+    return here_tracking_http_send_stream(client,
+                                          test_here_tracking_http_send_ok_cb,
+                                          test_here_tracking_http_recv_err_cb,
+                                          req_type,
+                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                          NULL);
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_stream_hdr_cache)
 {
     here_tracking_client client;
     here_tracking_error err;
-    const char* mock_tls_read_data[1] = { fake_too_many_requests_resp };
-    uint32_t mock_tls_read_data_size[1] = { strlen(fake_too_many_requests_resp) };
     uint8_t* chunks[2];
     size_t chunk_sizes[2];
     char* data = "test_data";
-    uint32_t time_in_test = 1000;
+    uint8_t cache_buffer[HERE_TRACKING_ACCESS_TOKEN_SIZE + 256];
+    uint32_t i, token_writes = 0;
 
     chunks[0] = (uint8_t*)data;
     chunks[1] = NULL;
@@ -1664,36 +2004,69 @@ START_TEST(test_here_tracking_http_send_stream_too_many_requests)
     chunk_sizes[1] = 0;
     test_here_tracking_http_send_chunks = chunks;
     test_here_tracking_http_send_chunk_sizes = chunk_sizes;
+    here_tracking_tls_writer_write_string_fake.custom_fake = \
+        test_here_tracking_http_write_string_buffered;
+    here_tracking_tls_writer_write_char_fake.custom_fake = \
+        test_here_tracking_http_write_char_buffered;
+    here_tracking_tls_writer_init_fake.custom_fake = test_here_tracking_http_writer_init;
     test_here_tracking_http_setup(&client);
-    mock_here_tracking_tls_read_set_result_data(mock_tls_read_data, mock_tls_read_data_size, 1);
-    mock_here_tracking_get_unixtime_set_result(time_in_test);
-    client.data_cb = test_here_tracking_http_recv_data_cb_err;
+    client.user_agent = test_here_tracking_http_user_agent;
+    client.hdr_cache.buffer = cache_buffer;
+    client.hdr_cache.buffer_size = sizeof(cache_buffer);
     strcpy(client.access_token, fake_access_token);
-    err = here_tracking_http_send_stream(&client,
-                                         test_here_tracking_http_send_ok_cb,
-                                         test_here_tracking_http_recv_err_cb,
-                                         HERE_TRACKING_REQ_DATA_JSON,
-                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
-                                         NULL);
+
+    /* Header block is built on the first request and reused on the second */
+    err = test_here_tracking_http_send_stream_cached(&client,
+                                                     fake_send_resp,
+                                                     HERE_TRACKING_REQ_DATA_JSON);
     ck_assert_int_eq(err, HERE_TRACKING_OK);
-    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 2);
-    ck_assert_int_eq(test_here_tracking_http_recv_data_cb_status,
-                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
-    ck_assert_uint_eq(client.retry_after, time_in_test + 3600);
+    ck_assert_uint_gt(client.hdr_cache.size, strlen(fake_access_token));
+    err = test_here_tracking_http_send_stream_cached(&client,
+                                                     fake_send_resp,
+                                                     HERE_TRACKING_REQ_DATA_JSON);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_writer_init_buffered_fake.call_count, 1);
+    ck_assert_ptr_eq(here_tracking_tls_writer_write_data_fake.arg1_history[0], cache_buffer);
+    ck_assert_uint_eq(here_tracking_tls_writer_write_data_fake.arg2_history[0],
+                      client.hdr_cache.size);
+
+    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count; ++i)
+    {
+        if(here_tracking_tls_writer_write_string_fake.arg1_history[i] == client.access_token)
+        {
+            token_writes++;
+        }
+    }
+
+    ck_assert_uint_eq(token_writes, 1);
+
+    /* Different request type rebuilds the header block */
+    err = test_here_tracking_http_send_stream_cached(&client,
+                                                     fake_send_resp,
+                                                     HERE_TRACKING_REQ_DATA_PROTOBUF);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_writer_init_buffered_fake.call_count, 2);
+    ck_assert_int_eq(client.hdr_cache.req_type, HERE_TRACKING_REQ_DATA_PROTOBUF);
+
+    /* Rejected token empties the cache */
+    err = test_here_tracking_http_send_stream_cached(&client,
+                                                     fake_unauthorized_resp,
+                                                     HERE_TRACKING_REQ_DATA_PROTOBUF);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(client.hdr_cache.size, 0);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_send_stream_too_many_requests_no_retry_after)
+START_TEST(test_here_tracking_http_send_stream_hdr_cache_too_small)
 {
     here_tracking_client client;
     here_tracking_error err;
-    const char* mock_tls_read_data[1] = { fake_too_many_requests_resp_no_retry_after };
-    uint32_t mock_tls_read_data_size[1] = { strlen(fake_too_many_requests_resp_no_retry_after) };
     uint8_t* chunks[2];
     size_t chunk_sizes[2];
     char* data = "test_data";
+    uint8_t cache_buffer[64];
 
     chunks[0] = (uint8_t*)data;
     chunks[1] = NULL;
@@ -1701,44 +2074,172 @@ START_TEST(test_here_tracking_http_send_stream_too_many_requests_no_retry_after)
     chunk_sizes[1] = 0;
     test_here_tracking_http_send_chunks = chunks;
     test_here_tracking_http_send_chunk_sizes = chunk_sizes;
+    here_tracking_tls_writer_write_string_fake.custom_fake = \
+        test_here_tracking_http_write_string_buffered;
+    here_tracking_tls_writer_write_char_fake.custom_fake = \
+        test_here_tracking_http_write_char_buffered;
+    here_tracking_tls_writer_init_fake.custom_fake = test_here_tracking_http_writer_init;
     test_here_tracking_http_setup(&client);
-    mock_here_tracking_tls_read_set_result_data(mock_tls_read_data, mock_tls_read_data_size, 1);
-    client.data_cb = test_here_tracking_http_recv_data_cb_err;
+    client.hdr_cache.buffer = cache_buffer;
+    client.hdr_cache.buffer_size = sizeof(cache_buffer);
     strcpy(client.access_token, fake_access_token);
-    err = here_tracking_http_send_stream(&client,
-                                         test_here_tracking_http_send_ok_cb,
-                                         test_here_tracking_http_recv_err_cb,
-                                         HERE_TRACKING_REQ_DATA_JSON,
-                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
-                                         NULL);
+    err = test_here_tracking_http_send_stream_cached(&client,
+                                                     fake_send_resp,
+                                                     HERE_TRACKING_REQ_DATA_JSON);
     ck_assert_int_eq(err, HERE_TRACKING_OK);
-    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 2);
-    ck_assert_int_eq(test_here_tracking_http_recv_data_cb_status,
-                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
-    ck_assert_uint_eq(client.retry_after, 0);
+    ck_assert_uint_eq(client.hdr_cache.size, 0);
+    ck_assert(client.hdr_cache.too_small);
+    ck_assert_uint_eq(here_tracking_tls_writer_init_buffered_fake.call_count, 1);
+    ck_assert_ptr_ne(here_tracking_tls_writer_write_data_fake.arg1_history[0], cache_buffer);
+
+    /* Same headers are not built into the cache again */
+    err = test_here_tracking_http_send_stream_cached(&client,
+                                                     fake_send_resp,
+                                                     HERE_TRACKING_REQ_DATA_JSON);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_writer_init_buffered_fake.call_count, 1);
+
+    /* Until the request type changes */
+    err = test_here_tracking_http_send_stream_cached(&client,
+                                                     fake_send_resp,
+                                                     HERE_TRACKING_REQ_DATA_PROTOBUF);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_writer_init_buffered_fake.call_count, 2);
+    ck_assert(client.hdr_cache.too_small);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_send_stream_ok_send_multi_chunk)
+static uint8_t test_here_tracking_http_codec_out[64];
+static size_t test_here_tracking_http_codec_out_size = 0;
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_http_codec_begin(void* codec_data)
 {
-    here_tracking_client client;
-    here_tracking_error err;
-    uint8_t* chunks[3];
-    size_t chunk_sizes[3];
-    char* data = "test_data";
-    char* data2 = "more_test_data";
+    (*((uint32_t*)codec_data)) = 0;
+    return HERE_TRACKING_OK;
+}
 
-    chunks[0] = (uint8_t*)data;
-    chunks[1] = (uint8_t*)data2;
-    chunks[2] = NULL;
-    chunk_sizes[0] = strlen(data);
-    chunk_sizes[1] = strlen(data2);
-    chunk_sizes[2] = 0;
-    test_here_tracking_http_send_chunks = chunks;
-    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
-    test_here_tracking_http_setup(&client);
+/**************************************************************************************************/
+
+/* Copies the data as is and adds "END" when finishing */
+static here_tracking_error test_here_tracking_http_codec_encode(const uint8_t* in,
+                                                               size_t* in_size,
+                                                               uint8_t* out,
+                                                               size_t* out_size,
+                                                               bool finish,
+                                                               bool* end,
+                                                               void* codec_data)
+{
+    uint32_t* end_pos = (uint32_t*)codec_data;
+
+    if(finish)
+    {
+        (*in_size) = 0;
+        (*out_size) = (*out_size < 3 - (*end_pos)) ? (*out_size) : (3 - (*end_pos));
+        memcpy(out, "END" + (*end_pos), (*out_size));
+        (*end_pos) += (uint32_t)(*out_size);
+        (*end) = ((*end_pos) == 3);
+    }
+    else
+    {
+        (*in_size) = (*out_size = ((*in_size) < (*out_size)) ? (*in_size) : (*out_size));
+        memcpy(out, in, (*out_size));
+        (*end) = false;
+    }
+
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_http_codec_encode_stuck(const uint8_t* in,
+                                                                     size_t* in_size,
+                                                                     uint8_t* out,
+                                                                     size_t* out_size,
+                                                                     bool finish,
+                                                                     bool* end,
+                                                                     void* codec_data)
+{
+    (*in_size) = (*out_size) = 0;
+    (*end) = false;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+/* Checks that the header was written with write_string as key and value */
+static bool test_here_tracking_http_hdr_written(const char* key, const char* val)
+{
+    uint32_t i;
+    bool written = false;
+
+    for(i = 0; (i + 2) < here_tracking_tls_writer_write_string_fake.call_count; ++i)
+    {
+        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i], key) == 0) &&
+           (strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i + 1], val) == 0))
+        {
+            written = true;
+        }
+    }
+
+    return written;
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    test_here_tracking_http_write_data_capture(here_tracking_tls_writer* writer,
+                                               const uint8_t* data,
+                                               size_t data_size)
+{
+    ck_assert_uint_le(test_here_tracking_http_codec_out_size + data_size,
+                      sizeof(test_here_tracking_http_codec_out));
+    memcpy(test_here_tracking_http_codec_out + test_here_tracking_http_codec_out_size,
+           data,
+           data_size);
+    test_here_tracking_http_codec_out_size += data_size;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_stream_codec)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    uint8_t* chunks[3];
+    size_t chunk_sizes[3];
+    uint8_t codec_buffer[4];
+    uint32_t codec_data, i;
+    here_tracking_codec codec =
+    {
+        "test",
+        test_here_tracking_http_codec_begin,
+        test_here_tracking_http_codec_encode,
+        NULL,
+        NULL,
+        &codec_data
+    };
+    const uint32_t expected_chunk_sizes[6] = { 4, 1, 4, 3, 3, 0 };
+
+    chunks[0] = (uint8_t*)"test_";
+    chunks[1] = (uint8_t*)"data123";
+    chunks[2] = NULL;
+    chunk_sizes[0] = 5;
+    chunk_sizes[1] = 7;
+    chunk_sizes[2] = 0;
+    test_here_tracking_http_send_chunks = chunks;
+    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
+    test_here_tracking_http_codec_out_size = 0;
+    here_tracking_tls_writer_write_data_fake.custom_fake = \
+        test_here_tracking_http_write_data_capture;
+    test_here_tracking_http_setup(&client);
+    client.codec = &codec;
+    client.codec_buffer = codec_buffer;
+    client.codec_buffer_size = sizeof(codec_buffer);
     test_here_tracking_http_tls_read_set_result(fake_send_resp);
     strcpy(client.access_token, fake_access_token);
     err = here_tracking_http_send_stream(&client,
@@ -1747,318 +2248,1703 @@ START_TEST(test_here_tracking_http_send_stream_ok_send_multi_chunk)
                                          HERE_TRACKING_REQ_DATA_JSON,
                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
                                          NULL);
-    ck_assert(err == HERE_TRACKING_OK);
-    ck_assert(test_here_tracking_http_recv_data_cb_called == 3);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+
+    /* Body is sent in chunks of at most the codec buffer size */
+    ck_assert_uint_eq(test_here_tracking_http_codec_out_size, strlen("test_data123END"));
+    ck_assert(memcmp(test_here_tracking_http_codec_out, "test_data123END", 15) == 0);
+    ck_assert_uint_eq(here_tracking_tls_writer_write_utoa_fake.call_count, 6);
+
+    for(i = 0; i < 6; ++i)
+    {
+        ck_assert_uint_eq(here_tracking_tls_writer_write_utoa_fake.arg1_history[i],
+                          expected_chunk_sizes[i]);
+    }
+
+    ck_assert(test_here_tracking_http_hdr_written(here_tracking_http_header_content_encoding,
+                                                  "test"));
+    ck_assert(!test_here_tracking_http_hdr_written(here_tracking_http_header_accept_encoding,
+                                                   "test"));
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_send_stream_ok_recv_multi_chunk)
+START_TEST(test_here_tracking_http_send_stream_codec_stuck)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    uint8_t* chunks[2];
+    size_t chunk_sizes[2];
+    uint8_t codec_buffer[4];
+    uint32_t codec_data;
+    here_tracking_codec codec =
+    {
+        "test",
+        test_here_tracking_http_codec_begin,
+        test_here_tracking_http_codec_encode_stuck,
+        NULL,
+        NULL,
+        &codec_data
+    };
+
+    chunks[0] = (uint8_t*)"test_data";
+    chunks[1] = NULL;
+    chunk_sizes[0] = 9;
+    chunk_sizes[1] = 0;
+    test_here_tracking_http_send_chunks = chunks;
+    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
+    test_here_tracking_http_setup(&client);
+    client.codec = &codec;
+    client.codec_buffer = codec_buffer;
+    client.codec_buffer_size = sizeof(codec_buffer);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_ok_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+    ck_assert_uint_eq(here_tracking_tls_read_fake.call_count, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+/* Copies the data as is until the end marker '.' */
+static here_tracking_error test_here_tracking_http_codec_decode(const uint8_t* in,
+                                                               size_t* in_size,
+                                                               uint8_t* out,
+                                                               size_t* out_size,
+                                                               bool finish,
+                                                               bool* end,
+                                                               void* codec_data)
+{
+    size_t i = 0;
+
+    while(i < (*in_size) && i < (*out_size) && in[i] != '.')
+    {
+        out[i] = in[i];
+        i++;
+    }
+
+    (*end) = (i < (*in_size) && in[i] == '.');
+    (*out_size) = i;
+    (*in_size) = (*end) ? (i + 1) : i;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static char test_here_tracking_http_decoded[64];
+static size_t test_here_tracking_http_decoded_size = 0;
+static here_tracking_error test_here_tracking_http_decoded_status = HERE_TRACKING_ERROR;
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    test_here_tracking_http_recv_decoded_cb(const here_tracking_recv_data* data, void* user_data)
+{
+    /* Size of the encoded body is not reported */
+    ck_assert(data->evt != HERE_TRACKING_RECV_EVT_RESP_SIZE);
+
+    if(data->evt == HERE_TRACKING_RECV_EVT_RESP_DATA)
+    {
+        ck_assert(data->err == HERE_TRACKING_OK);
+        ck_assert_uint_gt(data->data_size, 0);
+        ck_assert_uint_le(data->data_size, *((size_t*)user_data));
+        ck_assert_uint_le(test_here_tracking_http_decoded_size + data->data_size,
+                          sizeof(test_here_tracking_http_decoded));
+        memcpy(test_here_tracking_http_decoded + test_here_tracking_http_decoded_size,
+               data->data,
+               data->data_size);
+        test_here_tracking_http_decoded_size += data->data_size;
+    }
+    else if(data->evt == HERE_TRACKING_RECV_EVT_RESP_COMPLETE)
+    {
+        test_here_tracking_http_decoded_status = data->err;
+    }
+
+    test_here_tracking_http_recv_data_cb_called++;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_http_send_stream_decode(const char* resp)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    uint8_t codec_buffer[4];
+    size_t codec_buffer_size = sizeof(codec_buffer);
+    uint32_t codec_data;
+    here_tracking_codec codec =
+    {
+        "test",
+        NULL,
+        NULL,
+        test_here_tracking_http_codec_begin,
+        test_here_tracking_http_codec_decode,
+        &codec_data
+    };
+
+    test_here_tracking_http_decoded_size = 0;
+    test_here_tracking_http_decoded_status = HERE_TRACKING_ERROR;
+    test_here_tracking_http_setup(&client);
+    client.codec = &codec;
+    client.codec_buffer = codec_buffer;
+    client.codec_buffer_size = sizeof(codec_buffer);
+    test_here_tracking_http_tls_read_set_result(resp);
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_decoded_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         &codec_buffer_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+
+    /* Request body is not encoded by a codec that can only decode */
+    ck_assert(test_here_tracking_http_hdr_written(here_tracking_http_header_accept_encoding,
+                                                  "test"));
+    ck_assert(!test_here_tracking_http_hdr_written(here_tracking_http_header_content_encoding,
+                                                   "test"));
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_stream_codec_decode)
+{
+    test_here_tracking_http_send_stream_decode(fake_send_resp_encoded);
+    ck_assert_int_eq(test_here_tracking_http_decoded_status, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_decoded_size, 21);
+    ck_assert(memcmp(test_here_tracking_http_decoded, "THIS IS SEND RESPONSE", 21) == 0);
+
+    /* Six parts of at most four bytes and the completion */
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 7);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_stream_codec_decode_chunked)
+{
+    test_here_tracking_http_send_stream_decode(fake_send_resp_encoded_chunked);
+    ck_assert_int_eq(test_here_tracking_http_decoded_status, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_decoded_size, 21);
+    ck_assert(memcmp(test_here_tracking_http_decoded, "THIS IS SEND RESPONSE", 21) == 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_stream_codec_decode_truncated)
+{
+    test_here_tracking_http_send_stream_decode(fake_send_resp_encoded_truncated);
+    ck_assert_int_eq(test_here_tracking_http_decoded_status, HERE_TRACKING_ERROR);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_stream_codec_decode_not_encoded)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    uint8_t codec_buffer[4];
+    uint32_t codec_data;
+    here_tracking_codec codec =
+    {
+        "test",
+        NULL,
+        NULL,
+        test_here_tracking_http_codec_begin,
+        test_here_tracking_http_codec_decode,
+        &codec_data
+    };
+
+    test_here_tracking_http_setup(&client);
+    client.codec = &codec;
+    client.codec_buffer = codec_buffer;
+    client.codec_buffer_size = sizeof(codec_buffer);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+
+    /* Response without Content-Encoding is passed on as is, with its size */
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_ok_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+}
+END_TEST
+
+START_TEST(test_here_tracking_http_send_stream_too_many_requests)
+{
+    here_tracking_client client;
+    here_tracking_rate_limiter limiter, gateway_limiter;
+    here_tracking_error err;
+    const char* mock_tls_read_data[1] = { fake_too_many_requests_resp };
+    uint32_t mock_tls_read_data_size[1] = { strlen(fake_too_many_requests_resp) };
+    uint8_t* chunks[2];
+    size_t chunk_sizes[2];
+    char* data = "test_data";
+    uint32_t time_in_test = 1000;
+
+    chunks[0] = (uint8_t*)data;
+    chunks[1] = NULL;
+    chunk_sizes[0] = strlen(data);
+    chunk_sizes[1] = 0;
+    test_here_tracking_http_send_chunks = chunks;
+    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
+    test_here_tracking_http_setup(&client);
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&limiter, 1000, 1), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&gateway_limiter, 1000, 1), HERE_TRACKING_OK);
+    client.rate_limiter = &limiter;
+    client.gateway_rate_limiter = &gateway_limiter;
+    mock_here_tracking_tls_read_set_result_data(mock_tls_read_data, mock_tls_read_data_size, 1);
+    mock_here_tracking_get_unixtime_set_result(time_in_test);
+    client.data_cb = test_here_tracking_http_recv_data_cb_err;
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_err_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 2);
+    ck_assert_int_eq(test_here_tracking_http_recv_data_cb_status,
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(client.retry_after, time_in_test + 3600);
+
+    /* Rate limiters slow down, only the one of the client is paused */
+    ck_assert_uint_eq(limiter.interval_ms, 2000);
+    ck_assert(limiter.paused);
+    ck_assert_uint_eq(limiter.pause_ms, 1000 + (3600 * 1000));
+    ck_assert_uint_eq(gateway_limiter.interval_ms, 2000);
+    ck_assert(!gateway_limiter.paused);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_stream_too_many_requests_no_retry_after)
 {
     here_tracking_client client;
     here_tracking_error err;
+    const char* mock_tls_read_data[1] = { fake_too_many_requests_resp_no_retry_after };
+    uint32_t mock_tls_read_data_size[1] = { strlen(fake_too_many_requests_resp_no_retry_after) };
     uint8_t* chunks[2];
     size_t chunk_sizes[2];
     char* data = "test_data";
 
-    chunks[0] = (uint8_t*)data;
-    chunks[1] = NULL;
-    chunk_sizes[0] = strlen(data);
-    chunk_sizes[1] = 0;
-    test_here_tracking_http_send_chunks = chunks;
-    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
-    test_here_tracking_http_setup(&client);
-    test_here_tracking_http_tls_read_set_result(fake_auth_resp);
-    strcpy(client.access_token, fake_access_token);
-    err = here_tracking_http_send_stream(&client,
-                                         test_here_tracking_http_send_ok_cb,
-                                         test_here_tracking_http_recv_ok_multi_chunk_cb,
-                                         HERE_TRACKING_REQ_DATA_JSON,
-                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
-                                         NULL);
-    ck_assert(err == HERE_TRACKING_OK);
-    ck_assert(test_here_tracking_http_recv_data_cb_called > 3);
+    chunks[0] = (uint8_t*)data;
+    chunks[1] = NULL;
+    chunk_sizes[0] = strlen(data);
+    chunk_sizes[1] = 0;
+    test_here_tracking_http_send_chunks = chunks;
+    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
+    test_here_tracking_http_setup(&client);
+    mock_here_tracking_tls_read_set_result_data(mock_tls_read_data, mock_tls_read_data_size, 1);
+    client.data_cb = test_here_tracking_http_recv_data_cb_err;
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_err_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 2);
+    ck_assert_int_eq(test_here_tracking_http_recv_data_cb_status,
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(client.retry_after, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_stream_ok_send_multi_chunk)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    uint8_t* chunks[3];
+    size_t chunk_sizes[3];
+    char* data = "test_data";
+    char* data2 = "more_test_data";
+
+    chunks[0] = (uint8_t*)data;
+    chunks[1] = (uint8_t*)data2;
+    chunks[2] = NULL;
+    chunk_sizes[0] = strlen(data);
+    chunk_sizes[1] = strlen(data2);
+    chunk_sizes[2] = 0;
+    test_here_tracking_http_send_chunks = chunks;
+    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_ok_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         NULL);
+    ck_assert(err == HERE_TRACKING_OK);
+    ck_assert(test_here_tracking_http_recv_data_cb_called == 3);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_send_stream_ok_recv_multi_chunk)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    uint8_t* chunks[2];
+    size_t chunk_sizes[2];
+    char* data = "test_data";
+
+    chunks[0] = (uint8_t*)data;
+    chunks[1] = NULL;
+    chunk_sizes[0] = strlen(data);
+    chunk_sizes[1] = 0;
+    test_here_tracking_http_send_chunks = chunks;
+    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_auth_resp);
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_ok_multi_chunk_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         NULL);
+    ck_assert(err == HERE_TRACKING_OK);
+    ck_assert(test_here_tracking_http_recv_data_cb_called > 3);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_get_ok)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_http_request request;
+    char* host = "tracking.here.com";
+    char* path = "/index.html";
+
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    request.host = host;
+    request.path = path;
+    request.port = 443;
+    request.headers = NULL;
+    request.header_count = 0;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_get_ok_user_agent_set)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_http_request request;
+    char* host = "tracking.here.com";
+    char* path = "/index.html";
+    uint32_t i;
+    bool user_agent_set = false;
+
+    test_here_tracking_http_setup(&client);
+    client.user_agent = test_here_tracking_http_user_agent;
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    request.host = host;
+    request.path = path;
+    request.port = 443;
+    request.headers = NULL;
+    request.header_count = 0;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+
+    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count - 1; ++i)
+    {
+        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i],
+                  here_tracking_http_header_user_agent) == 0) &&
+           (strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i + 1],
+                   test_here_tracking_http_user_agent) == 0))
+        {
+            user_agent_set = true;
+        }
+    }
+
+    ck_assert(user_agent_set);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_get_ok_custom_user_agent_set)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_http_request request;
+    here_tracking_http_header header;
+    char* host = "tracking.here.com";
+    char* path = "/index.html";
+    char* my_user_agent = "my-very-own-user-agent";
+    uint32_t i;
+    bool user_agent_set = false;
+
+    test_here_tracking_http_setup(&client);
+    client.user_agent = test_here_tracking_http_user_agent;
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    header.name = (char*)here_tracking_http_header_user_agent;
+    header.value = my_user_agent;
+    request.host = host;
+    request.path = path;
+    request.port = 443;
+    request.headers = &header;
+    request.header_count = 1;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+
+    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count - 1; ++i)
+    {
+        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i],
+                  here_tracking_http_header_user_agent) == 0) &&
+           (strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i + 1],
+                   my_user_agent) == 0))
+        {
+            user_agent_set = true;
+        }
+    }
+
+    ck_assert(user_agent_set);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_get_ok_user_agent_empty_string)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_http_request request;
+    char* host = "tracking.here.com";
+    char* path = "/index.html";
+    uint32_t i;
+    bool user_agent_set = false;
+
+    test_here_tracking_http_setup(&client);
+    client.user_agent = "";
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    request.host = host;
+    request.path = path;
+    request.port = 443;
+    request.headers = NULL;
+    request.header_count = 0;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+
+    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count - 1; ++i)
+    {
+        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i],
+                   here_tracking_http_header_user_agent) == 0))
+        {
+            user_agent_set = true;
+        }
+    }
+
+    ck_assert(!user_agent_set);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_get_ok_custom_correlation_id_set)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_http_request request;
+    here_tracking_http_header header;
+    char* host = "tracking.here.com";
+    char* path = "/index.html";
+    char* my_correlation_id = "my-very-own-correlation-id";
+    uint32_t i;
+    bool correlation_id_set = false;
+
+    test_here_tracking_http_setup(&client);
+    client.user_agent = test_here_tracking_http_user_agent;
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    header.name = "x-request-id";
+    header.value = my_correlation_id;
+    request.host = host;
+    request.path = path;
+    request.port = 443;
+    request.headers = &header;
+    request.header_count = 1;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+
+    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count - 1; ++i)
+    {
+        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i],
+                   "x-request-id") == 0) &&
+           (strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i + 1],
+                   my_correlation_id) == 0))
+        {
+            correlation_id_set = true;
+        }
+    }
+
+    ck_assert(correlation_id_set);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_get_ok_with_auth)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_http_request request;
+    char* host = "tracking.here.com";
+    char* path = "/index.html";
+    here_tracking_http_header header;
+
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    header.name = (char*)here_tracking_http_header_authorization;
+    header.value = client.access_token;
+    request.host = host;
+    request.path = path;
+    request.port = 443;
+    request.headers = &header;
+    request.header_count = 1;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_get_ok_with_auth_bearer)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_http_request request;
+    char* host = "tracking.here.com";
+    char* path = "/index.html";
+    here_tracking_http_header header;
+    char auth_header_value[1000] = {0};
+
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    strcat(auth_header_value, "Bearer ");
+    strcat(auth_header_value, client.access_token);
+    header.name = (char*)here_tracking_http_header_authorization;
+    header.value = auth_header_value;
+    request.host = host;
+    request.path = path;
+    request.port = 443;
+    request.headers = &header;
+    request.header_count = 1;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_get_invalid_input)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_http_request request;
+    char* host = "tracking.here.com";
+    char* path = "/index.html";
+
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    strcpy(client.access_token, fake_access_token);
+    request.host = host;
+    request.path = path;
+    request.port = 443;
+    request.headers = NULL;
+    request.header_count = 0;
+    err = here_tracking_http_get(NULL, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+    err = here_tracking_http_get(&client, NULL, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+    err = here_tracking_http_get(&client, &request, NULL, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+    request.host = NULL;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+    request.host = host;
+    request.path = NULL;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_http_keep_alive_send(here_tracking_client* client,
+                                                                   const char* resp)
+{
+    test_here_tracking_http_send_chunks = NULL;
+    test_here_tracking_http_recv_data_cb_called = 0;
+    test_here_tracking_http_tls_read_set_result(resp);
+    return here_tracking_http_send_stream(client,
+                                          test_here_tracking_http_send_ok_cb,
+                                          test_here_tracking_http_recv_ok_cb,
+                                          HERE_TRACKING_REQ_DATA_JSON,
+                                          HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                          NULL);
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_keep_alive_reuse)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    uint32_t i;
+    bool keep_alive_set = false;
+
+    test_here_tracking_http_setup(&client);
+    client.keep_alive.enabled = true;
+    mock_here_tracking_get_unixtime_set_result(1000);
+    test_here_tracking_http_tls_read_set_result(fake_auth_resp);
+    err = here_tracking_http_auth(&client);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_str_eq(client.access_token, fake_access_token);
+    ck_assert(client.keep_alive.connected);
+    ck_assert_uint_eq(client.keep_alive.port, 443);
+    ck_assert_uint_eq(client.keep_alive.last_used, 1000);
+    mock_here_tracking_get_unixtime_set_result(1010);
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    ck_assert(client.keep_alive.connected);
+    ck_assert_uint_eq(client.keep_alive.last_used, 1010);
+    ck_assert_uint_eq(here_tracking_tls_init_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_check_connection_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 0);
+    ck_assert_uint_eq(here_tracking_tls_writer_write_string_fake.arg_histories_dropped, 0);
+
+    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count - 1; ++i)
+    {
+        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i],
+                   here_tracking_http_header_connection) == 0) &&
+           (strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i + 1],
+                   here_tracking_http_connection_keep_alive) == 0))
+        {
+            keep_alive_set = true;
+        }
+    }
+
+    ck_assert(keep_alive_set);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_prewarm)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.keep_alive.enabled = true;
+    mock_here_tracking_get_unixtime_set_result(1000);
+    err = here_tracking_http_prewarm(&client);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.connected);
+    ck_assert_uint_eq(client.keep_alive.port, 443);
+    ck_assert_uint_eq(client.keep_alive.last_used, 1000);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_write_fake.call_count, 0);
+    ck_assert_uint_eq(here_tracking_tls_writer_write_string_fake.call_count, 0);
+    mock_here_tracking_get_unixtime_set_result(1020);
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_check_connection_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 0);
+
+    /* Connection failure leaves nothing open */
+    test_here_tracking_http_setup(&client);
+    client.keep_alive.enabled = true;
+    here_tracking_tls_connect_fake.return_val = HERE_TRACKING_ERROR;
+    err = here_tracking_http_prewarm(&client);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+    ck_assert(!client.keep_alive.connected);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+typedef struct
+{
+    uint32_t events;
+    here_tracking_error status;
+} test_here_tracking_http_pipelined_resp;
+
+/**************************************************************************************************/
+
+static here_tracking_error \
+    test_here_tracking_http_pipelined_recv_cb(const here_tracking_recv_data* data,
+                                              void* user_data)
+{
+    test_here_tracking_http_pipelined_resp* resp =
+        (test_here_tracking_http_pipelined_resp*)user_data;
+
+    if(data->evt == HERE_TRACKING_RECV_EVT_RESP_COMPLETE)
+    {
+        resp->status = data->err;
+    }
+
+    resp->events++;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_http_pipelined_init(here_tracking_stream_req* reqs,
+                                                   test_here_tracking_http_pipelined_resp* resps,
+                                                   uint8_t count)
+{
+    uint8_t i;
+
+    for(i = 0; i < count; ++i)
+    {
+        resps[i].events = 0;
+        resps[i].status = HERE_TRACKING_ERROR;
+        reqs[i].send_cb = test_here_tracking_http_send_ok_cb;
+        reqs[i].recv_cb = test_here_tracking_http_pipelined_recv_cb;
+        reqs[i].req_type = HERE_TRACKING_REQ_DATA_JSON;
+        reqs[i].resp_type = HERE_TRACKING_RESP_WITH_DATA_JSON;
+        reqs[i].user_data = &resps[i];
+    }
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_pipelined)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_stream_req reqs[3];
+    test_here_tracking_http_pipelined_resp resps[3];
+    static char resp_data[512];
+    const char* read_data[2];
+    uint32_t read_data_size[2];
+    uint8_t completed = 0;
+
+    /* Responses split between reads in the middle of the second response */
+    strcpy(resp_data, fake_send_resp);
+    strcat(resp_data, fake_send_resp);
+    strcat(resp_data, fake_no_content_resp);
+    read_data[0] = resp_data;
+    read_data_size[0] = strlen(fake_send_resp) + 10;
+    read_data[1] = resp_data + read_data_size[0];
+    read_data_size[1] = strlen(resp_data) - read_data_size[0];
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.keep_alive.enabled = true;
+    mock_here_tracking_tls_read_set_result_data(read_data, read_data_size, 2);
+    test_here_tracking_http_pipelined_init(reqs, resps, 3);
+    err = here_tracking_http_send_stream_pipelined(&client, reqs, 3, &completed);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(completed, 3);
+    ck_assert_uint_eq(resps[0].events, 3);
+    ck_assert_int_eq(resps[0].status, HERE_TRACKING_OK);
+    ck_assert_uint_eq(resps[1].events, 3);
+    ck_assert_int_eq(resps[1].status, HERE_TRACKING_OK);
+    ck_assert_uint_eq(resps[2].events, 2);
+    ck_assert_int_eq(resps[2].status, HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_read_fake.call_count, 2);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 0);
+
+    /* All requests were written out at once before reading */
+    ck_assert_uint_eq(here_tracking_tls_writer_flush_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_pipelined_partial)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_stream_req reqs[3];
+    test_here_tracking_http_pipelined_resp resps[3];
+    static char resp_data[512];
+    const char* read_data[2];
+    uint32_t read_data_size[2];
+    uint8_t completed = 0;
+
+    /* Server invalidates the token and closes the connection after the second response */
+    strcpy(resp_data, fake_unauthorized_resp);
+    strcat(resp_data, fake_send_resp_connection_close);
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.token_expiry = 1000;
+    client.keep_alive.enabled = true;
+    test_here_tracking_http_tls_read_set_result(resp_data);
+    test_here_tracking_http_pipelined_init(reqs, resps, 3);
+    err = here_tracking_http_send_stream_pipelined(&client, reqs, 3, &completed);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(completed, 2);
+    ck_assert_int_eq(resps[0].status, HERE_TRACKING_ERROR_UNAUTHORIZED);
+    ck_assert_int_eq(resps[1].status, HERE_TRACKING_OK);
+    ck_assert_uint_eq(resps[2].events, 0);
+    ck_assert_uint_eq(strlen(client.access_token), 0);
+    ck_assert_uint_eq(client.token_expiry, 0);
+    ck_assert(!client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+
+    /* Connection closed before all responses were received */
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.keep_alive.enabled = true;
+    read_data[0] = fake_send_resp;
+    read_data_size[0] = strlen(fake_send_resp);
+    read_data[1] = "";
+    read_data_size[1] = 0;
+    mock_here_tracking_tls_read_set_result_data(read_data, read_data_size, 2);
+    test_here_tracking_http_pipelined_init(reqs, resps, 2);
+    err = here_tracking_http_send_stream_pipelined(&client, reqs, 2, &completed);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+    ck_assert_uint_eq(completed, 1);
+    ck_assert_int_eq(resps[0].status, HERE_TRACKING_OK);
+    ck_assert_uint_eq(resps[1].events, 0);
+    ck_assert(!client.keep_alive.connected);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_chunked_resp)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_stream_req req;
+    test_here_tracking_http_pipelined_resp resp;
+
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.keep_alive.enabled = true;
+    test_here_tracking_http_pipelined_init(&req, &resp, 1);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp_chunked);
+    err = here_tracking_http_send_stream(&client,
+                                         req.send_cb,
+                                         req.recv_cb,
+                                         req.req_type,
+                                         req.resp_type,
+                                         req.user_data);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+
+    /* Data of both chunks and the completion, no size event */
+    ck_assert_uint_eq(resp.events, 3);
+    ck_assert_int_eq(resp.status, HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_keep_alive_idle_timeout)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.keep_alive.enabled = true;
+    client.keep_alive.idle_timeout = 10;
+    mock_here_tracking_get_unixtime_set_result(1000);
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.connected);
+    mock_here_tracking_get_unixtime_set_result(1010);
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 2);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_keep_alive_stale_connection)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.keep_alive.enabled = true;
+    here_tracking_tls_check_connection_fake.return_val = HERE_TRACKING_ERROR;
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_check_connection_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 2);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_keep_alive_server_close)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.keep_alive.enabled = true;
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp_connection_close);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    ck_assert(!client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_check_connection_fake.call_count, 0);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 2);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_keep_alive_read_fail)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.keep_alive.enabled = true;
+    here_tracking_tls_read_fake.return_val = HERE_TRACKING_ERROR;
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+    ck_assert(!client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_keep_alive_get_other_host)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_http_request request;
+    char* host = "tracking.here.com";
+    char* path = "/index.html";
+
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.keep_alive.enabled = true;
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.connected);
+    test_here_tracking_http_recv_data_cb_called = 0;
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    request.host = host;
+    request.path = path;
+    request.port = 443;
+    request.headers = NULL;
+    request.header_count = 0;
+    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(!client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 2);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 2);
+}
+END_TEST
+
+
+/**************************************************************************************************/
+
+static uint8_t test_here_tracking_http_h2_resp[1024];
+static uint32_t test_here_tracking_http_h2_resp_size;
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_http_get_alpn_h2(here_tracking_tls tls,
+                                                               const char** protocol)
+{
+    *protocol = here_tracking_http2_alpn[0];
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_http_h2_add_frame(uint8_t type,
+                                                 uint8_t flags,
+                                                 uint32_t stream_id,
+                                                 const char* payload,
+                                                 uint32_t payload_size)
+{
+    uint8_t* frame = test_here_tracking_http_h2_resp + test_here_tracking_http_h2_resp_size;
+
+    frame[0] = (uint8_t)(payload_size >> 16);
+    frame[1] = (uint8_t)(payload_size >> 8);
+    frame[2] = (uint8_t)payload_size;
+    frame[3] = type;
+    frame[4] = flags;
+    frame[5] = (uint8_t)(stream_id >> 24);
+    frame[6] = (uint8_t)(stream_id >> 16);
+    frame[7] = (uint8_t)(stream_id >> 8);
+    frame[8] = (uint8_t)stream_id;
+    memcpy(frame + 9, payload, payload_size);
+    test_here_tracking_http_h2_resp_size += 9 + payload_size;
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_http_h2_setup(here_tracking_client* client)
+{
+    test_here_tracking_http_setup(client);
+    strcpy(client->access_token, fake_access_token);
+    client->keep_alive.enabled = true;
+    client->http2.enabled = true;
+    here_tracking_tls_get_alpn_fake.custom_fake = test_here_tracking_http_get_alpn_h2;
+    test_here_tracking_http_h2_resp_size = 0;
+
+    /* Server settings come first, the frames of the test are added after */
+    test_here_tracking_http_h2_add_frame(0x04, 0x00, 0, NULL, 0);
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_http_h2_resp_ready(void)
+{
+    static const char* read_data[1];
+    static uint32_t read_data_size[1];
+
+    read_data[0] = (const char*)test_here_tracking_http_h2_resp;
+    read_data_size[0] = test_here_tracking_http_h2_resp_size;
+    mock_here_tracking_tls_read_set_result_data(read_data, read_data_size, 1);
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_h2_send_stream)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    static const char headers[] = { 0x88, 0x0f, 0x0d, 0x02, '2', '1' };
+    const char* body = "THIS IS SEND RESPONSE";
+
+    test_here_tracking_http_h2_setup(&client);
+    test_here_tracking_http_h2_add_frame(0x01, 0x04, 1, headers, sizeof(headers));
+    test_here_tracking_http_h2_add_frame(0x00, 0x01, 1, body, strlen(body));
+    test_here_tracking_http_h2_resp_ready();
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_ok_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    ck_assert(client.http2.active);
+    ck_assert(client.http2.preface_sent);
+    ck_assert_uint_eq(client.http2.next_stream_id, 3);
+    ck_assert(client.keep_alive.connected);
+    ck_assert(here_tracking_tls_set_alpn_fake.arg1_val == here_tracking_http2_alpn);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 0);
+
+    /* Connection preface is the only text written, the request is in binary frames */
+    ck_assert_uint_eq(here_tracking_tls_writer_write_string_fake.call_count, 1);
+    ck_assert_str_eq(here_tracking_tls_writer_write_string_fake.arg1_history[0],
+                     "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n");
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_h2_auth)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    static const char headers[] = { 0x88, 0x0f, 0x0d, 0x03, '8', '7', '5' };
+    const char* body = strstr(fake_auth_resp, "\r\n\r\n") + 4;
+
+    test_here_tracking_http_h2_setup(&client);
+    memset(client.access_token, 0x00, HERE_TRACKING_ACCESS_TOKEN_SIZE);
+    test_here_tracking_http_h2_add_frame(0x01, 0x04, 1, headers, sizeof(headers));
+    test_here_tracking_http_h2_add_frame(0x00, 0x01, 1, body, strlen(body));
+    test_here_tracking_http_h2_resp_ready();
+    err = here_tracking_http_auth(&client);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_str_eq(client.access_token, fake_access_token);
+    ck_assert(client.http2.active);
+    ck_assert(client.keep_alive.connected);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_h2_pipelined_goaway)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    here_tracking_stream_req reqs[3];
+    test_here_tracking_http_pipelined_resp resps[3];
+    uint8_t completed = 0;
+    static const char headers[] = { 0x89 };
+    static const char goaway[] = { 0, 0, 0, 3, 0, 0, 0, 0 };
+
+    /* Server handles the first two streams and closes the connection */
+    test_here_tracking_http_h2_setup(&client);
+    test_here_tracking_http_h2_add_frame(0x01, 0x05, 3, headers, sizeof(headers));
+    test_here_tracking_http_h2_add_frame(0x01, 0x05, 1, headers, sizeof(headers));
+    test_here_tracking_http_h2_add_frame(0x07, 0x00, 0, goaway, sizeof(goaway));
+    test_here_tracking_http_h2_resp_ready();
+    test_here_tracking_http_pipelined_init(reqs, resps, 3);
+    err = here_tracking_http_send_stream_pipelined(&client, reqs, 3, &completed);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(completed, 2);
+    ck_assert_uint_eq(resps[0].events, 2);
+    ck_assert_int_eq(resps[0].status, HERE_TRACKING_OK);
+    ck_assert_uint_eq(resps[1].events, 2);
+    ck_assert_int_eq(resps[1].status, HERE_TRACKING_OK);
+    ck_assert_uint_eq(resps[2].events, 0);
+    ck_assert(!client.keep_alive.connected);
+    ck_assert_uint_eq(here_tracking_tls_read_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_h2_stream_reset)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+    static const char rst_stream[] = { 0, 0, 0, 2 };
+
+    test_here_tracking_http_h2_setup(&client);
+    test_here_tracking_http_h2_add_frame(0x03, 0x00, 1, rst_stream, sizeof(rst_stream));
+    test_here_tracking_http_h2_resp_ready();
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_err_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+    ck_assert(!client.keep_alive.connected);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_h2_not_selected)
+{
+    here_tracking_client client;
+    here_tracking_error err;
+
+    /* Server without HTTP/2 is used with HTTP/1.1 */
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    client.http2.enabled = true;
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    ck_assert(!client.http2.active);
+    ck_assert(here_tracking_tls_set_alpn_fake.arg1_val == here_tracking_http2_alpn);
+    ck_assert_uint_eq(here_tracking_tls_get_alpn_fake.call_count, 1);
+
+    /* Protocol is not offered when disabled */
+    test_here_tracking_http_setup(&client);
+    strcpy(client.access_token, fake_access_token);
+    here_tracking_tls_get_alpn_fake.custom_fake = test_here_tracking_http_get_alpn_h2;
+    err = test_here_tracking_http_keep_alive_send(&client, fake_send_resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(!client.http2.active);
+    ck_assert(here_tracking_tls_set_alpn_fake.arg1_val == NULL);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+static uint32_t test_here_tracking_http_tls_read_blocked;
+
+static here_tracking_error test_here_tracking_http_tls_read_block_once(here_tracking_tls tls,
+                                                                      char* data,
+                                                                      uint32_t* data_size)
+{
+    if(test_here_tracking_http_tls_read_blocked == 0)
+    {
+        test_here_tracking_http_tls_read_blocked++;
+        return HERE_TRACKING_ERROR_WOULD_BLOCK;
+    }
+
+    return mock_here_tracking_tls_read_custom(tls, data, data_size);
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_async_send_ok)
+{
+    here_tracking_client client;
+    here_tracking_http_async async;
+    here_tracking_error err;
+    here_tracking_error connect_res[2] = { HERE_TRACKING_ERROR_WOULD_BLOCK, HERE_TRACKING_OK };
+    here_tracking_error write_res[2] = { HERE_TRACKING_ERROR_WOULD_BLOCK, HERE_TRACKING_OK };
+    uint8_t* chunks[2];
+    size_t chunk_sizes[2];
+    char* data = "test_data";
+
+    chunks[0] = (uint8_t*)data;
+    chunks[1] = NULL;
+    chunk_sizes[0] = strlen(data);
+    chunk_sizes[1] = 0;
+    test_here_tracking_http_send_chunks = chunks;
+    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
+    test_here_tracking_http_setup(&client);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    test_here_tracking_http_tls_read_blocked = 0;
+    here_tracking_tls_read_fake.custom_fake = test_here_tracking_http_tls_read_block_once;
+    SET_RETURN_SEQ(here_tracking_tls_connect_async, connect_res, 2);
+    SET_RETURN_SEQ(here_tracking_tls_write, write_res, 2);
+    strcpy(client.access_token, fake_access_token);
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_init_fake.call_count, 0);
+
+    /* Connection in progress */
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_WOULD_BLOCK);
+    ck_assert_uint_eq(here_tracking_tls_init_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_connect_async_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 0);
+
+    /* Body write blocked */
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_WOULD_BLOCK);
+    ck_assert_uint_eq(here_tracking_tls_connect_async_fake.call_count, 2);
+    ck_assert_uint_eq(here_tracking_tls_write_fake.call_count, 1);
+    ck_assert_uint_eq(test_here_tracking_http_send_chunk_index, 1);
+
+    /* Response not yet available */
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_WOULD_BLOCK);
+    ck_assert_uint_eq(test_here_tracking_http_send_chunk_index, 2);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 0);
+    ck_assert_ptr_eq(here_tracking_tls_write_fake.arg1_history[1], data);
+
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+
+    /* Completed request keeps its result */
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_read_fake.call_count, 2);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_get_ok)
+START_TEST(test_here_tracking_http_async_auth_and_send_ok)
 {
     here_tracking_client client;
+    here_tracking_http_async async;
     here_tracking_error err;
-    here_tracking_http_request request;
-    char* host = "tracking.here.com";
-    char* path = "/index.html";
+    const char* read_data[2];
+    uint32_t read_data_size[2];
 
+    read_data[0] = fake_auth_resp;
+    read_data[1] = fake_send_resp;
+    read_data_size[0] = strlen(fake_auth_resp);
+    read_data_size[1] = strlen(fake_send_resp);
     test_here_tracking_http_setup(&client);
-    test_here_tracking_http_tls_read_set_result(fake_send_resp);
-    strcpy(client.access_token, fake_access_token);
-    request.host = host;
-    request.path = path;
-    request.port = 443;
-    request.headers = NULL;
-    request.header_count = 0;
-    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    mock_here_tracking_tls_read_set_result_data(read_data, read_data_size, 2);
+    strcpy(client.access_token, "old_token");
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               true,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_str_eq(client.access_token, "");
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_str_eq(client.access_token, fake_access_token);
     ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    ck_assert_uint_eq(here_tracking_oauth_create_header_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_connect_async_fake.call_count, 2);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 2);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_get_ok_user_agent_set)
+START_TEST(test_here_tracking_http_async_connect_fail)
 {
     here_tracking_client client;
+    here_tracking_http_async async;
     here_tracking_error err;
-    here_tracking_http_request request;
-    char* host = "tracking.here.com";
-    char* path = "/index.html";
-    uint32_t i;
-    bool user_agent_set = false;
 
     test_here_tracking_http_setup(&client);
-    client.user_agent = test_here_tracking_http_user_agent;
-    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    here_tracking_tls_connect_async_fake.return_val = HERE_TRACKING_ERROR;
     strcpy(client.access_token, fake_access_token);
-    request.host = host;
-    request.path = path;
-    request.port = 443;
-    request.headers = NULL;
-    request.header_count = 0;
-    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_OK);
-    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
-
-    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count - 1; ++i)
-    {
-        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i],
-                  here_tracking_http_header_user_agent) == 0) &&
-           (strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i + 1],
-                   test_here_tracking_http_user_agent) == 0))
-        {
-            user_agent_set = true;
-        }
-    }
-
-    ck_assert(user_agent_set);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+    ck_assert_uint_eq(here_tracking_tls_write_fake.call_count, 0);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 0);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_get_ok_custom_user_agent_set)
+START_TEST(test_here_tracking_http_async_write_fail)
 {
     here_tracking_client client;
+    here_tracking_http_async async;
     here_tracking_error err;
-    here_tracking_http_request request;
-    here_tracking_http_header header;
-    char* host = "tracking.here.com";
-    char* path = "/index.html";
-    char* my_user_agent = "my-very-own-user-agent";
-    uint32_t i;
-    bool user_agent_set = false;
+    uint8_t* chunks[2];
+    size_t chunk_sizes[2];
+    char* data = "test_data";
 
+    chunks[0] = (uint8_t*)data;
+    chunks[1] = NULL;
+    chunk_sizes[0] = strlen(data);
+    chunk_sizes[1] = 0;
+    test_here_tracking_http_send_chunks = chunks;
+    test_here_tracking_http_send_chunk_sizes = chunk_sizes;
     test_here_tracking_http_setup(&client);
-    client.user_agent = test_here_tracking_http_user_agent;
-    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    here_tracking_tls_write_fake.return_val = HERE_TRACKING_ERROR;
     strcpy(client.access_token, fake_access_token);
-    header.name = (char*)here_tracking_http_header_user_agent;
-    header.value = my_user_agent;
-    request.host = host;
-    request.path = path;
-    request.port = 443;
-    request.headers = &header;
-    request.header_count = 1;
-    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_OK);
-    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
-
-    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count - 1; ++i)
-    {
-        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i],
-                  here_tracking_http_header_user_agent) == 0) &&
-           (strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i + 1],
-                   my_user_agent) == 0))
-        {
-            user_agent_set = true;
-        }
-    }
-
-    ck_assert(user_agent_set);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_read_fake.call_count, 0);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_get_ok_user_agent_empty_string)
+START_TEST(test_here_tracking_http_async_keep_alive_reuse)
 {
     here_tracking_client client;
+    here_tracking_http_async async;
     here_tracking_error err;
-    here_tracking_http_request request;
-    char* host = "tracking.here.com";
-    char* path = "/index.html";
-    uint32_t i;
-    bool user_agent_set = false;
+    const char* read_data[2];
+    uint32_t read_data_size[2];
 
+    read_data[0] = fake_send_resp;
+    read_data[1] = fake_send_resp;
+    read_data_size[0] = strlen(fake_send_resp);
+    read_data_size[1] = strlen(fake_send_resp);
     test_here_tracking_http_setup(&client);
-    client.user_agent = "";
-    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    mock_here_tracking_tls_read_set_result_data(read_data, read_data_size, 2);
+    client.keep_alive.enabled = true;
     strcpy(client.access_token, fake_access_token);
-    request.host = host;
-    request.path = path;
-    request.port = 443;
-    request.headers = NULL;
-    request.header_count = 0;
-    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_OK);
-    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(client.keep_alive.connected);
+    ck_assert(client.keep_alive.non_blocking);
 
-    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count - 1; ++i)
-    {
-        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i],
-                   here_tracking_http_header_user_agent) == 0))
-        {
-            user_agent_set = true;
-        }
-    }
+    /* Non-blocking connection is not reused for a blocking request */
+    test_here_tracking_http_recv_data_cb_called = 0;
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    ck_assert_uint_eq(here_tracking_tls_connect_async_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_check_connection_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 0);
+    ck_assert(client.keep_alive.connected);
 
-    ck_assert(!user_agent_set);
+    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    test_here_tracking_http_recv_data_cb_called = 0;
+    err = here_tracking_http_send_stream(&client,
+                                         test_here_tracking_http_send_ok_cb,
+                                         test_here_tracking_http_recv_ok_cb,
+                                         HERE_TRACKING_REQ_DATA_JSON,
+                                         HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                         NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+    ck_assert_uint_eq(here_tracking_tls_connect_fake.call_count, 1);
+    ck_assert(!client.keep_alive.non_blocking);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_get_ok_custom_correlation_id_set)
+START_TEST(test_here_tracking_http_async_get_poll_info)
 {
     here_tracking_client client;
+    here_tracking_http_async async;
     here_tracking_error err;
-    here_tracking_http_request request;
-    here_tracking_http_header header;
-    char* host = "tracking.here.com";
-    char* path = "/index.html";
-    char* my_correlation_id = "my-very-own-correlation-id";
-    uint32_t i;
-    bool correlation_id_set = false;
+    int fd;
+    uint8_t events;
 
     test_here_tracking_http_setup(&client);
-    client.user_agent = test_here_tracking_http_user_agent;
-    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    here_tracking_tls_connect_async_fake.return_val = HERE_TRACKING_ERROR_WOULD_BLOCK;
     strcpy(client.access_token, fake_access_token);
-    header.name = "x-request-id";
-    header.value = my_correlation_id;
-    request.host = host;
-    request.path = path;
-    request.port = 443;
-    request.headers = &header;
-    request.header_count = 1;
-    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_OK);
-    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
-
-    for(i = 0; i < here_tracking_tls_writer_write_string_fake.call_count - 1; ++i)
-    {
-        if((strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i],
-                   "x-request-id") == 0) &&
-           (strcmp(here_tracking_tls_writer_write_string_fake.arg1_history[i + 1],
-                   my_correlation_id) == 0))
-        {
-            correlation_id_set = true;
-        }
-    }
-
-    ck_assert(correlation_id_set);
+    err = here_tracking_http_async_get_poll_info(&async, &fd, &events);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_WOULD_BLOCK);
+    err = here_tracking_http_async_get_poll_info(&async, &fd, &events);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_get_poll_info_fake.call_count, 1);
+    ck_assert_ptr_eq(here_tracking_tls_get_poll_info_fake.arg1_val, &fd);
+    ck_assert_ptr_eq(here_tracking_tls_get_poll_info_fake.arg2_val, &events);
+    err = here_tracking_http_async_get_poll_info(NULL, &fd, &events);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+    err = here_tracking_http_async_get_poll_info(&async, NULL, &events);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+    err = here_tracking_http_async_get_poll_info(&async, &fd, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_get_ok_with_auth)
+START_TEST(test_here_tracking_http_async_cancel)
 {
     here_tracking_client client;
+    here_tracking_http_async async;
     here_tracking_error err;
-    here_tracking_http_request request;
-    char* host = "tracking.here.com";
-    char* path = "/index.html";
-    here_tracking_http_header header;
+    int fd;
+    uint8_t events;
 
     test_here_tracking_http_setup(&client);
-    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    here_tracking_tls_connect_async_fake.return_val = HERE_TRACKING_ERROR_WOULD_BLOCK;
     strcpy(client.access_token, fake_access_token);
-    header.name = (char*)here_tracking_http_header_authorization;
-    header.value = client.access_token;
-    request.host = host;
-    request.path = path;
-    request.port = 443;
-    request.headers = &header;
-    request.header_count = 1;
-    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_OK);
-    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_WOULD_BLOCK);
+    err = here_tracking_http_async_cancel(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_CLIENT_INTERRUPT);
+    ck_assert_uint_eq(here_tracking_tls_connect_async_fake.call_count, 1);
+    err = here_tracking_http_async_get_poll_info(&async, &fd, &events);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+
+    /* Cancelling a completed request does nothing */
+    err = here_tracking_http_async_cancel(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+    err = here_tracking_http_async_cancel(NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_get_ok_with_auth_bearer)
+START_TEST(test_here_tracking_http_async_timeout)
 {
     here_tracking_client client;
+    here_tracking_http_async async;
     here_tracking_error err;
-    here_tracking_http_request request;
-    char* host = "tracking.here.com";
-    char* path = "/index.html";
-    here_tracking_http_header header;
-    char auth_header_value[1000] = {0};
+    int32_t timeout;
 
     test_here_tracking_http_setup(&client);
-    test_here_tracking_http_tls_read_set_result(fake_send_resp);
+    here_tracking_tls_connect_async_fake.return_val = HERE_TRACKING_ERROR_WOULD_BLOCK;
+    client.timeouts.request_timeout = 45000;
     strcpy(client.access_token, fake_access_token);
-    strcat(auth_header_value, "Bearer ");
-    strcat(auth_header_value, client.access_token);
-    header.name = (char*)here_tracking_http_header_authorization;
-    header.value = auth_header_value;
-    request.host = host;
-    request.path = path;
-    request.port = 443;
-    request.headers = &header;
-    request.header_count = 1;
-    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_OK);
-    ck_assert_uint_eq(test_here_tracking_http_recv_data_cb_called, 3);
+    err = here_tracking_http_async_get_timeout(&async, &timeout);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_int_eq(timeout, 45000);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_WOULD_BLOCK);
+    err = here_tracking_http_async_get_timeout(&async, &timeout);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+
+    /* Stepped regularly while connecting so that unanswered addresses can be given up */
+    ck_assert_int_eq(timeout, 500);
+
+    /* Still within the connect timeout */
+    mock_here_tracking_get_monotonic_ms_set_result(30999);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_WOULD_BLOCK);
+    err = here_tracking_http_async_get_timeout(&async, &timeout);
+    ck_assert_int_eq(timeout, 1);
+
+    mock_here_tracking_get_monotonic_ms_set_result(31000);
+    err = here_tracking_http_async_get_timeout(&async, &timeout);
+    ck_assert_int_eq(timeout, 0);
+    err = here_tracking_http_async_step(&async);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_TIMEOUT);
+    ck_assert_uint_eq(here_tracking_tls_connect_async_fake.call_count, 3);
+    ck_assert_uint_eq(here_tracking_tls_close_fake.call_count, 1);
+    err = here_tracking_http_async_get_timeout(&async, &timeout);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_int_eq(timeout, -1);
+    err = here_tracking_http_async_get_timeout(NULL, &timeout);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+    err = here_tracking_http_async_get_timeout(&async, NULL);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
 }
 END_TEST
 
 /**************************************************************************************************/
 
-START_TEST(test_here_tracking_http_get_invalid_input)
+START_TEST(test_here_tracking_http_async_invalid_input)
 {
     here_tracking_client client;
+    here_tracking_http_async async;
     here_tracking_error err;
-    here_tracking_http_request request;
-    char* host = "tracking.here.com";
-    char* path = "/index.html";
 
-    test_here_tracking_http_setup(&client);
-    test_here_tracking_http_tls_read_set_result(fake_send_resp);
-    strcpy(client.access_token, fake_access_token);
-    request.host = host;
-    request.path = path;
-    request.port = 443;
-    request.headers = NULL;
-    request.header_count = 0;
-    err = here_tracking_http_get(NULL, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_send_stream_async(NULL,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
-    err = here_tracking_http_get(&client, NULL, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_send_stream_async(&async,
+                                               NULL,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
-    err = here_tracking_http_get(&client, &request, NULL, NULL);
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               NULL,
+                                               test_here_tracking_http_recv_ok_cb,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
-    request.host = NULL;
-    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_send_stream_async(&async,
+                                               &client,
+                                               false,
+                                               test_here_tracking_http_send_ok_cb,
+                                               NULL,
+                                               HERE_TRACKING_REQ_DATA_JSON,
+                                               HERE_TRACKING_RESP_WITH_DATA_JSON,
+                                               NULL);
     ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
-    request.host = host;
-    request.path = NULL;
-    err = here_tracking_http_get(&client, &request, test_here_tracking_http_recv_ok_cb, NULL);
+    err = here_tracking_http_async_step(NULL);
     ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
 }
 END_TEST
@@ -2069,12 +3955,14 @@ TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_SETUP_TEARDOWN_FN(test_here_tracking_http_tc_setup,
                                      test_here_tracking_http_tc_teardown)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_ok)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_ok_tls_env)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_ok_tls_initialized)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_ok_user_agent_set);
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_ok_correlation_id_set);
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_ok_user_agent_empty_string);
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_tls_init_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_tls_connect_fail)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_tls_connect_timeout)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_oauth_create_header_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_tls_writer_flush_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_fail_bad_request)
@@ -2087,11 +3975,16 @@ TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_tls_writer_write_char_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_auth_tls_writer_write_string_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_ok)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_deadlines)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_no_timeouts)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_tls_read_timeout)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_tls_init_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_tls_connect_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_tls_writer_write_string_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_tls_read_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_too_large_to_parse_fail)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_io_buffers)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_recv_no_compaction)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_too_small_resp_buffer)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_bad_request)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_unauthorized)
@@ -2113,6 +4006,14 @@ TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_unknown_error_code)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_no_content)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_too_many_requests)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_codec)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_codec_stuck)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_codec_decode)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_codec_decode_chunked)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_codec_decode_truncated)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_codec_decode_not_encoded)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_hdr_cache)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_hdr_cache_too_small)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_too_many_requests_no_retry_after)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_ok_send_multi_chunk)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_send_stream_ok_recv_multi_chunk)
@@ -2124,6 +4025,30 @@ TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_get_ok_with_auth)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_get_ok_with_auth_bearer)
     TEST_SUITE_ADD_TEST(test_here_tracking_http_get_invalid_input)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_keep_alive_reuse)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_prewarm)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_pipelined)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_pipelined_partial)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_chunked_resp)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_keep_alive_idle_timeout)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_keep_alive_stale_connection)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_keep_alive_server_close)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_keep_alive_read_fail)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_keep_alive_get_other_host)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_h2_send_stream)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_h2_auth)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_h2_pipelined_goaway)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_h2_stream_reset)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_h2_not_selected)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_async_send_ok)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_async_auth_and_send_ok)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_async_connect_fail)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_async_write_fail)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_async_keep_alive_reuse)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_async_get_poll_info)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_async_cancel)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_async_timeout)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http_async_invalid_input)
 TEST_SUITE_END
 
 /**************************************************************************************************/
@@ -0,0 +1,712 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <string.h>
+
+#include <fff.h>
+
+#include "here_tracking_http2.h"
+#include "here_tracking_test.h"
+
+#include "mock_here_tracking_tls.h"
+
+#define TEST_NAME "here_tracking_http2"
+
+/**************************************************************************************************/
+
+DEFINE_FFF_GLOBALS;
+
+#define TEST_HERE_TRACKING_HTTP2_FAKE_LIST(FAKE) \
+    MOCK_HERE_TRACKING_TLS_FAKE_LIST(FAKE)
+
+#define TEST_HERE_TRACKING_HTTP2_WRITE_BUFFER_SIZE 512
+
+/**************************************************************************************************/
+
+typedef struct
+{
+    uint16_t status_code;
+    uint32_t body_size;
+    uint32_t body_size_count;
+    char hdrs[256];
+    uint32_t hdrs_size;
+    char body[256];
+    uint32_t body_len;
+    bool last;
+} test_here_tracking_http2_resp;
+
+static here_tracking_http2 test_conn;
+static uint8_t test_table[64];
+static here_tracking_tls_writer test_writer;
+static uint8_t test_write_buffer[TEST_HERE_TRACKING_HTTP2_WRITE_BUFFER_SIZE];
+static here_tracking_http2_reader test_reader;
+
+/**************************************************************************************************/
+
+static bool test_here_tracking_http2_resp_cb(const here_tracking_http_parser_evt* evt,
+                                             bool last,
+                                             void* cb_data)
+{
+    test_here_tracking_http2_resp* resp = (test_here_tracking_http2_resp*)cb_data;
+
+    switch(evt->id)
+    {
+        case HERE_TRACKING_HTTP_PARSER_EVT_STATUS_CODE:
+        {
+            resp->status_code = evt->data.status_code;
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_PARSER_EVT_HDR:
+        {
+            memcpy(resp->hdrs + resp->hdrs_size, evt->data.hdr.hdr_key, evt->data.hdr.hdr_key_size);
+            resp->hdrs_size += evt->data.hdr.hdr_key_size;
+            resp->hdrs[resp->hdrs_size++] = ':';
+            memcpy(resp->hdrs + resp->hdrs_size, evt->data.hdr.hdr_val, evt->data.hdr.hdr_val_size);
+            resp->hdrs_size += evt->data.hdr.hdr_val_size;
+            resp->hdrs[resp->hdrs_size++] = ';';
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_PARSER_EVT_BODY:
+        {
+            memcpy(resp->body + resp->body_len,
+                   evt->data.body.buffer,
+                   evt->data.body.buffer_size);
+            resp->body_len += evt->data.body.buffer_size;
+            resp->last = last;
+        }
+        break;
+
+        case HERE_TRACKING_HTTP_PARSER_EVT_BODY_SIZE:
+        {
+            resp->body_size = evt->data.body_size;
+            resp->body_size_count++;
+        }
+        break;
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_http2_open(here_tracking_http2_stream* stream,
+                                          test_here_tracking_http2_resp* resp)
+{
+    here_tracking_error err;
+
+    memset(resp, 0, sizeof(*resp));
+    err = here_tracking_http2_stream_open(&test_conn,
+                                          &test_reader,
+                                          stream,
+                                          test_here_tracking_http2_resp_cb,
+                                          resp);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_http2_read(uint8_t* data,
+                                                         uint32_t data_size,
+                                                         uint32_t* read_size)
+{
+    *read_size = data_size;
+    return here_tracking_http2_read(&test_conn, &test_reader, &test_writer, data, read_size);
+}
+
+/**************************************************************************************************/
+
+void test_here_tracking_http2_tc_setup(void)
+{
+    here_tracking_error err;
+
+    TEST_HERE_TRACKING_HTTP2_FAKE_LIST(RESET_FAKE);
+    FFF_RESET_HISTORY();
+    test_conn.hpack_buffer = test_table;
+    test_conn.hpack_buffer_size = sizeof(test_table);
+    here_tracking_http2_conn_init(&test_conn);
+    here_tracking_http2_reader_init(&test_reader);
+    err = here_tracking_tls_writer_init_buffered(&test_writer,
+                                                 test_write_buffer,
+                                                 sizeof(test_write_buffer));
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_start)
+{
+    here_tracking_error err;
+    static const uint8_t expected[] =
+    {
+        0x00, 0x00, 0x0c, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x02, 0x00, 0x00, 0x00, 0x00
+    };
+
+    err = here_tracking_http2_start(&test_conn, &test_writer);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert(test_conn.preface_sent);
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size, 24 + sizeof(expected));
+    ck_assert(memcmp(test_write_buffer, "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n", 24) == 0);
+    ck_assert(memcmp(test_write_buffer + 24, expected, sizeof(expected)) == 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_block_indexing)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream stream;
+    here_tracking_http2_block block;
+    test_here_tracking_http2_resp resp;
+    static const uint8_t first[] =
+    {
+        0x00, 0x00, 0x08, 0x01, 0x04, 0x00, 0x00, 0x00, 0x01,
+        0x3f, 0x21, 0x83, 0x7a, 0x03, 'a', 'b', 'c'
+    };
+    static const uint8_t second[] =
+    {
+        0x00, 0x00, 0x02, 0x01, 0x05, 0x00, 0x00, 0x00, 0x03,
+        0x83, 0xbe
+    };
+
+    /* First block announces the smaller table and adds the field to it */
+    test_here_tracking_http2_open(&stream, &resp);
+    err = here_tracking_http2_block_begin(&block, &test_conn, &test_writer, &stream, false);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, ":method", NULL, "POST", 4,
+                                        HERE_TRACKING_HTTP2_HDR_INDEX);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, "User-Agent", NULL, "abc", 3,
+                                        HERE_TRACKING_HTTP2_HDR_INDEX);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_end(&block);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size, sizeof(first));
+    ck_assert(memcmp(test_write_buffer, first, sizeof(first)) == 0);
+    ck_assert_uint_eq(test_conn.table_size, 10 + 3 + 32);
+
+    /* Second block refers to the table entry, value is given as prefix and value */
+    test_writer.data_buffer.buffer_size = 0;
+    test_here_tracking_http2_open(&stream, &resp);
+    err = here_tracking_http2_block_begin(&block, &test_conn, &test_writer, &stream, true);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, ":method", NULL, "POST", 4,
+                                        HERE_TRACKING_HTTP2_HDR_INDEX);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, "user-agent", "a", "bc", 2,
+                                        HERE_TRACKING_HTTP2_HDR_INDEX);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_end(&block);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size, sizeof(second));
+    ck_assert(memcmp(test_write_buffer, second, sizeof(second)) == 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_block_eviction)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream stream;
+    here_tracking_http2_block block;
+    test_here_tracking_http2_resp resp;
+    static const uint8_t expected[] =
+    {
+        0x3f, 0x21,
+        0x40, 0x03, 'x', '-', 'a', 0x04, '1', '2', '3', '4',
+        0x40, 0x03, 'x', '-', 'b', 0x04, '5', '6', '7', '8',
+        0x40, 0x03, 'x', '-', 'a', 0x04, '1', '2', '3', '4',
+        0x10, 0x03, 'x', '-', 'c', 0x01, 's',
+        0x1f, 0x08, 0x01, 't'
+    };
+
+    /* The table has room for one entry, so each new entry evicts the previous one */
+    test_here_tracking_http2_open(&stream, &resp);
+    err = here_tracking_http2_block_begin(&block, &test_conn, &test_writer, &stream, true);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, "X-A", NULL, "1234", 4,
+                                        HERE_TRACKING_HTTP2_HDR_INDEX);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, "x-b", NULL, "5678", 4,
+                                        HERE_TRACKING_HTTP2_HDR_INDEX);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, "x-a", NULL, "1234", 4,
+                                        HERE_TRACKING_HTTP2_HDR_INDEX);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, "x-c", NULL, "s", 1,
+                                        HERE_TRACKING_HTTP2_HDR_SENSITIVE);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, "authorization", NULL, "t", 1,
+                                        HERE_TRACKING_HTTP2_HDR_SENSITIVE);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_end(&block);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size, 9 + sizeof(expected));
+    ck_assert(memcmp(test_write_buffer + 9, expected, sizeof(expected)) == 0);
+    ck_assert_uint_eq(test_conn.table_size, 3 + 4 + 32);
+    ck_assert_uint_eq(test_conn.table_used, 4 + 3 + 4);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_block_continuation)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream stream;
+    here_tracking_http2_block block;
+    test_here_tracking_http2_resp resp;
+    char value[300];
+    uint8_t* frame = test_write_buffer;
+
+    /* Block larger than one frame is continued in CONTINUATION frames */
+    memset(value, 'v', sizeof(value));
+    test_here_tracking_http2_open(&stream, &resp);
+    err = here_tracking_http2_block_begin(&block, &test_conn, &test_writer, &stream, true);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_add(&block, "x-long", NULL, value, sizeof(value), 0);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_http2_block_end(&block);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq((frame[1] << 8) | frame[2], HERE_TRACKING_HTTP2_BLOCK_FRAME_SIZE);
+    ck_assert_uint_eq(frame[3], 0x01);
+    ck_assert_uint_eq(frame[4], 0x01);
+    frame += 9 + HERE_TRACKING_HTTP2_BLOCK_FRAME_SIZE;
+    ck_assert_uint_eq(frame[3], 0x09);
+    ck_assert_uint_eq(frame[4], 0x04);
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size,
+                      (uint32_t)((frame - test_write_buffer) + 9 + frame[2]));
+    ck_assert_uint_eq(2 + 2 + 6 + 3 + sizeof(value),
+                      HERE_TRACKING_HTTP2_BLOCK_FRAME_SIZE + frame[2]);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_write_data_flow_control)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream stream;
+    test_here_tracking_http2_resp resp;
+    uint8_t data[20];
+    uint32_t data_size = sizeof(data);
+
+    memset(data, 'd', sizeof(data));
+    test_here_tracking_http2_open(&stream, &resp);
+    test_conn.send_window = 12;
+    err = here_tracking_http2_write_data(&test_conn, &test_writer, &stream, data, &data_size, true);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(data_size, 12);
+    ck_assert_int_eq(test_conn.send_window, 0);
+    ck_assert_int_eq(stream.send_window, 65535 - 12);
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size, 9 + 12);
+    ck_assert_uint_eq(test_write_buffer[2], 12);
+    ck_assert_uint_eq(test_write_buffer[4], 0x00);
+
+    /* Rest of the data ends the stream */
+    test_writer.data_buffer.buffer_size = 0;
+    test_conn.send_window = 100;
+    data_size = 8;
+    err = here_tracking_http2_write_data(&test_conn, &test_writer, &stream, data, &data_size, true);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(data_size, 8);
+    ck_assert_uint_eq(test_write_buffer[4], 0x01);
+
+    /* Empty end of stream is sent even without window */
+    test_writer.data_buffer.buffer_size = 0;
+    test_conn.send_window = 0;
+    data_size = 0;
+    err = here_tracking_http2_write_data(&test_conn, &test_writer, &stream, NULL, &data_size, true);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size, 9);
+    ck_assert_uint_eq(test_write_buffer[2], 0);
+    ck_assert_uint_eq(test_write_buffer[4], 0x01);
+
+    /* Reset stream */
+    stream.err = HERE_TRACKING_ERROR;
+    data_size = 4;
+    err = here_tracking_http2_write_data(&test_conn, &test_writer, &stream, data, &data_size, true);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_read_response)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream stream;
+    test_here_tracking_http2_resp resp;
+    uint32_t read_size;
+    uint8_t data[] =
+    {
+        /* Server settings */
+        0x00, 0x00, 0x0c, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x03, 0x00, 0x00, 0x00, 0x02,
+        0x00, 0x04, 0x00, 0x00, 0x00, 0x10,
+        /* Headers, RFC 7541 C.4 Huffman examples */
+        0x00, 0x00, 0x1d, 0x01, 0x04, 0x00, 0x00, 0x00, 0x01,
+        0x88,
+        0x58, 0x86, 0xa8, 0xeb, 0x10, 0x64, 0x9c, 0xbf,
+        0x40, 0x88, 0x25, 0xa8, 0x49, 0xe9, 0x5b, 0xa9, 0x7d, 0x7f,
+        0x89, 0x25, 0xa8, 0x49, 0xe9, 0x5b, 0xb8, 0xe8, 0xb4, 0xbf,
+        /* Padded data */
+        0x00, 0x00, 0x07, 0x00, 0x09, 0x00, 0x00, 0x00, 0x01,
+        0x02, 'b', 'o', 'd', 'y', 0x00, 0x00
+    };
+
+    test_here_tracking_http2_open(&stream, &resp);
+
+    /* Frame header split between reads is left unread */
+    err = test_here_tracking_http2_read(data, 25, &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(read_size, 21);
+    ck_assert_uint_eq(test_conn.max_streams, 2);
+    ck_assert_int_eq(stream.send_window, 16);
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size, 9);
+    ck_assert_uint_eq(test_write_buffer[3], 0x04);
+    ck_assert_uint_eq(test_write_buffer[4], 0x01);
+
+    err = test_here_tracking_http2_read(data + 21, sizeof(data) - 21 - 3, &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(resp.status_code, 200);
+    ck_assert_uint_eq(resp.hdrs_size, strlen("cache-control:no-cache;custom-key:custom-value;"));
+    ck_assert(memcmp(resp.hdrs, "cache-control:no-cache;custom-key:custom-value;",
+                     resp.hdrs_size) == 0);
+    ck_assert_uint_eq(resp.body_len, 3);
+    ck_assert(!resp.last);
+    ck_assert(!here_tracking_http2_reader_done(&test_reader));
+
+    err = test_here_tracking_http2_read(data + sizeof(data) - 3, 3, &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(read_size, 3);
+    ck_assert(memcmp(resp.body, "body", 4) == 0);
+    ck_assert(resp.last);
+    ck_assert(stream.closed);
+    ck_assert_int_eq(stream.err, HERE_TRACKING_OK);
+    ck_assert(here_tracking_http2_reader_done(&test_reader));
+    ck_assert(!test_reader.in_frame);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_read_continuation)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream stream;
+    test_here_tracking_http2_resp resp;
+    uint32_t read_size;
+    uint8_t data[] =
+    {
+        /* Field split between HEADERS and CONTINUATION, stream ends with the headers */
+        0x00, 0x00, 0x05, 0x01, 0x01, 0x00, 0x00, 0x00, 0x01,
+        0x88, 0x00, 0x03, 'x', '-',
+        0x00, 0x00, 0x04, 0x09, 0x04, 0x00, 0x00, 0x00, 0x01,
+        'a', 0x02, 'o', 'k'
+    };
+
+    test_here_tracking_http2_open(&stream, &resp);
+
+    /* CONTINUATION header is needed before the field can be read */
+    err = test_here_tracking_http2_read(data, 20, &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(read_size, 10);
+    ck_assert_uint_eq(resp.status_code, 200);
+    ck_assert_uint_eq(resp.hdrs_size, 0);
+    memmove(data, data + read_size, sizeof(data) - read_size);
+
+    err = test_here_tracking_http2_read(data, sizeof(data) - read_size, &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(read_size, sizeof(data) - 10);
+    ck_assert_uint_eq(resp.hdrs_size, strlen("x-a:ok;"));
+    ck_assert(memcmp(resp.hdrs, "x-a:ok;", resp.hdrs_size) == 0);
+
+    /* Stream ended with the header block, so the body is empty */
+    ck_assert_uint_eq(resp.body_size_count, 1);
+    ck_assert_uint_eq(resp.body_size, 0);
+    ck_assert(stream.closed);
+    ck_assert_int_eq(stream.err, HERE_TRACKING_OK);
+    ck_assert(!test_reader.header_block);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_read_informational_trailers)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream stream;
+    test_here_tracking_http2_resp resp;
+    uint32_t read_size;
+    uint8_t data[] =
+    {
+        /* 100 Continue */
+        0x00, 0x00, 0x05, 0x01, 0x04, 0x00, 0x00, 0x00, 0x01,
+        0x08, 0x03, '1', '0', '0',
+        /* 200 with content length */
+        0x00, 0x00, 0x05, 0x01, 0x04, 0x00, 0x00, 0x00, 0x01,
+        0x88, 0x0f, 0x0d, 0x01, '1',
+        0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+        'x',
+        /* Trailers end the stream */
+        0x00, 0x00, 0x06, 0x01, 0x05, 0x00, 0x00, 0x00, 0x01,
+        0x00, 0x01, 't', 0x02, 'o', 'k'
+    };
+
+    test_here_tracking_http2_open(&stream, &resp);
+    err = test_here_tracking_http2_read(data, sizeof(data), &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(read_size, sizeof(data));
+    ck_assert_uint_eq(resp.status_code, 200);
+    ck_assert_uint_eq(resp.hdrs_size, strlen("content-length:1;"));
+    ck_assert_uint_eq(resp.body_size, 1);
+    ck_assert_uint_eq(resp.body_len, 1);
+    ck_assert(resp.last);
+    ck_assert(stream.closed);
+    ck_assert_int_eq(stream.err, HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_read_control)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream streams[3];
+    test_here_tracking_http2_resp resp[3];
+    uint32_t read_size;
+    uint8_t data[] =
+    {
+        /* Ping */
+        0x00, 0x00, 0x08, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00,
+        1, 2, 3, 4, 5, 6, 7, 8,
+        /* Window updates of the connection and a stream */
+        0x00, 0x00, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x01, 0x00,
+        0x00, 0x00, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x03,
+        0x00, 0x00, 0x00, 0x10,
+        /* Unknown frame type */
+        0x00, 0x00, 0x02, 0xfa, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xff, 0xff,
+        /* Reset of the first stream */
+        0x00, 0x00, 0x04, 0x03, 0x00, 0x00, 0x00, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x08,
+        /* Server goes away after the second stream, with debug data */
+        0x00, 0x00, 0x0a, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 'd', 'd'
+    };
+    static const uint8_t ping_ack[] =
+    {
+        0x00, 0x00, 0x08, 0x06, 0x01, 0x00, 0x00, 0x00, 0x00,
+        1, 2, 3, 4, 5, 6, 7, 8
+    };
+
+    test_here_tracking_http2_open(&streams[0], &resp[0]);
+    test_here_tracking_http2_open(&streams[1], &resp[1]);
+    test_here_tracking_http2_open(&streams[2], &resp[2]);
+    ck_assert_uint_eq(streams[2].id, 5);
+    err = test_here_tracking_http2_read(data, sizeof(data), &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(read_size, sizeof(data));
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size, sizeof(ping_ack));
+    ck_assert(memcmp(test_write_buffer, ping_ack, sizeof(ping_ack)) == 0);
+    ck_assert_int_eq(test_conn.send_window, 65535 + 256);
+    ck_assert_int_eq(streams[1].send_window, 65535 + 16);
+    ck_assert(test_conn.goaway);
+    ck_assert_int_eq(streams[0].err, HERE_TRACKING_ERROR);
+    ck_assert(streams[0].closed);
+    ck_assert(!streams[1].closed);
+    ck_assert_int_eq(streams[2].err, HERE_TRACKING_ERROR);
+    ck_assert(streams[2].closed);
+    ck_assert(!here_tracking_http2_reader_done(&test_reader));
+
+    /* No new streams after going away */
+    err = here_tracking_http2_stream_open(&test_conn,
+                                          &test_reader,
+                                          &streams[0],
+                                          test_here_tracking_http2_resp_cb,
+                                          &resp[0]);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_read_window_update)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream stream;
+    test_here_tracking_http2_resp resp;
+    uint32_t read_size, i;
+    static uint8_t data[9 + 16384];
+    static const uint8_t expected[] =
+    {
+        0x00, 0x00, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x01,
+        0x00, 0x00, 0x80, 0x00,
+        0x00, 0x00, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x80, 0x00
+    };
+
+    test_here_tracking_http2_open(&stream, &resp);
+    stream.headers_done = true;
+    stream.interrupted = true;
+    memset(data, 0, sizeof(data));
+    data[1] = 0x40;
+    data[8] = 0x01;
+
+    /* Half of the window is acknowledged for both the stream and the connection */
+    for(i = 0; i < 2; ++i)
+    {
+        err = test_here_tracking_http2_read(data, 9, &read_size);
+        ck_assert_int_eq(err, HERE_TRACKING_OK);
+        err = test_here_tracking_http2_read(data + 9, sizeof(data) - 9, &read_size);
+        ck_assert_int_eq(err, HERE_TRACKING_OK);
+        ck_assert_uint_eq(read_size, sizeof(data) - 9);
+    }
+
+    ck_assert_uint_eq(test_writer.data_buffer.buffer_size, sizeof(expected));
+    ck_assert(memcmp(test_write_buffer, expected, sizeof(expected)) == 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_read_errors)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream stream;
+    test_here_tracking_http2_resp resp;
+    uint32_t read_size;
+    uint8_t bad_padding[] =
+    {
+        0x00, 0x00, 0x06, 0x01, 0x04, 0x00, 0x00, 0x00, 0x01,
+        0x88, 0x00, 0x01, 'x', 0x81, 0x00
+    };
+    uint8_t push_promise[] =
+    {
+        0x00, 0x00, 0x04, 0x05, 0x04, 0x00, 0x00, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x02
+    };
+    uint8_t dynamic_index[] =
+    {
+        0x00, 0x00, 0x02, 0x01, 0x04, 0x00, 0x00, 0x00, 0x01,
+        0x88, 0xbe
+    };
+    uint8_t too_large[] =
+    {
+        0x00, 0x40, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01
+    };
+    uint8_t data_before_headers[] =
+    {
+        0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+        'x'
+    };
+
+    /* Huffman code 0 is five bits, the padding must be ones */
+    test_here_tracking_http2_open(&stream, &resp);
+    err = test_here_tracking_http2_read(bad_padding, sizeof(bad_padding), &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+
+    test_here_tracking_http2_tc_setup();
+    test_here_tracking_http2_open(&stream, &resp);
+    err = test_here_tracking_http2_read(push_promise, sizeof(push_promise), &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+
+    test_here_tracking_http2_tc_setup();
+    test_here_tracking_http2_open(&stream, &resp);
+    err = test_here_tracking_http2_read(dynamic_index, sizeof(dynamic_index), &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+
+    test_here_tracking_http2_tc_setup();
+    test_here_tracking_http2_open(&stream, &resp);
+    err = test_here_tracking_http2_read(too_large, sizeof(too_large), &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+
+    test_here_tracking_http2_tc_setup();
+    test_here_tracking_http2_open(&stream, &resp);
+    err = test_here_tracking_http2_read(data_before_headers,
+                                        sizeof(data_before_headers),
+                                        &read_size);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http2_stream_open_full)
+{
+    here_tracking_error err;
+    here_tracking_http2_stream streams[HERE_TRACKING_HTTP2_MAX_STREAMS + 1];
+    test_here_tracking_http2_resp resp;
+    uint8_t i;
+
+    for(i = 0; i < HERE_TRACKING_HTTP2_MAX_STREAMS; ++i)
+    {
+        test_here_tracking_http2_open(&streams[i], &resp);
+    }
+
+    err = here_tracking_http2_stream_open(&test_conn,
+                                          &test_reader,
+                                          &streams[i],
+                                          test_here_tracking_http2_resp_cb,
+                                          &resp);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR);
+
+    /* Cleared reader takes new streams, identifiers keep growing */
+    here_tracking_http2_reader_clear(&test_reader);
+    test_here_tracking_http2_open(&streams[i], &resp);
+    ck_assert_uint_eq(streams[i].id, 2 * HERE_TRACKING_HTTP2_MAX_STREAMS + 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+TEST_SUITE_BEGIN(TEST_NAME)
+    TEST_SUITE_ADD_SETUP_TEARDOWN_FN(test_here_tracking_http2_tc_setup, NULL)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_start)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_block_indexing)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_block_eviction)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_block_continuation)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_write_data_flow_control)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_read_response)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_read_continuation)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_read_informational_trailers)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_read_control)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_read_window_update)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_read_errors)
+    TEST_SUITE_ADD_TEST(test_here_tracking_http2_stream_open_full)
+TEST_SUITE_END
+
+/**************************************************************************************************/
+
+TEST_MAIN(TEST_NAME)
@@ -30,8 +30,13 @@
 
 #define TEST_NAME "here_tracking_http_parser"
 
+const char* here_tracking_http_connection_close = "close";
+const char* here_tracking_http_connection_keep_alive = "keep-alive";
 const char* here_tracking_http_crlf = "\r\n";
+const char* here_tracking_http_header_connection = "Connection";
 const char* here_tracking_http_header_content_length = "Content-Length";
+const char* here_tracking_http_header_transfer_encoding = "Transfer-Encoding";
+const char* here_tracking_http_transfer_encoding_chunked = "chunked";
 
 static const char* simple_resp = \
         "HTTP/1.1 200 OK\r\n"\
@@ -56,6 +61,66 @@ static const char* simple_resp_no_content = \
         "HTTP/1.1 204 No Content\r\n"\
         "\r\n";
 
+static const char* simple_resp_connection_close = \
+        "HTTP/1.1 200 OK\r\n"\
+        "Content-Length: 12\r\n"\
+        "Connection: Close\r\n"\
+        "\r\n"\
+        "HELLO WORLD!";
+
+static const char* simple_resp_http_1_0 = \
+        "HTTP/1.0 200 OK\r\n"\
+        "Content-Length: 12\r\n"\
+        "\r\n"\
+        "HELLO WORLD!";
+
+static const char* simple_resp_http_1_0_keep_alive = \
+        "HTTP/1.0 200 OK\r\n"\
+        "Content-Length: 12\r\n"\
+        "connection: keep-alive\r\n"\
+        "\r\n"\
+        "HELLO WORLD!";
+
+static const char* chunked_resp = \
+        "HTTP/1.1 200 OK\r\n"\
+        "Transfer-Encoding: gzip, Chunked\r\n"\
+        "\r\n"\
+        "6\r\n"\
+        "HELLO \r\n"\
+        "10;name=value\r\n"\
+        "WORLD, CHUNKED!!\r\n"\
+        "0\r\n"\
+        "Trailer: value\r\n"\
+        "\r\n";
+
+static const char* chunked_resp_body = "HELLO WORLD, CHUNKED!!";
+
+static const char* chunked_resp_invalid_size = \
+        "HTTP/1.1 200 OK\r\n"\
+        "Transfer-Encoding: chunked\r\n"\
+        "\r\n"\
+        "6x\r\n"\
+        "HELLO \r\n"\
+        "0\r\n"\
+        "\r\n";
+
+static const char* chunked_resp_missing_crlf = \
+        "HTTP/1.1 200 OK\r\n"\
+        "Transfer-Encoding: chunked\r\n"\
+        "\r\n"\
+        "6\r\n"\
+        "HELLO !!\r\n"\
+        "0\r\n"\
+        "\r\n";
+
+typedef struct
+{
+    char body[64];
+    uint32_t body_size;
+    uint32_t last_count;
+    bool body_size_evt;
+} test_here_tracking_http_parser_chunked_data;
+
 /**************************************************************************************************/
 
 static bool test_here_tracking_http_parser_cb(const here_tracking_http_parser_evt* evt,
@@ -326,6 +391,36 @@ static bool test_here_tracking_http_parser_cb_nop(const here_tracking_http_parse
 
 /**************************************************************************************************/
 
+static bool test_here_tracking_http_parser_chunked_cb(const here_tracking_http_parser_evt* evt,
+                                                      bool last,
+                                                      void* cb_data)
+{
+    test_here_tracking_http_parser_chunked_data* chunked =
+        (test_here_tracking_http_parser_chunked_data*)cb_data;
+
+    if(evt->id == HERE_TRACKING_HTTP_PARSER_EVT_BODY)
+    {
+        ck_assert_uint_le(chunked->body_size + evt->data.body.buffer_size, sizeof(chunked->body));
+        memcpy(chunked->body + chunked->body_size,
+               evt->data.body.buffer,
+               evt->data.body.buffer_size);
+        chunked->body_size += evt->data.body.buffer_size;
+
+        if(last)
+        {
+            chunked->last_count++;
+        }
+    }
+    else if(evt->id == HERE_TRACKING_HTTP_PARSER_EVT_BODY_SIZE)
+    {
+        chunked->body_size_evt = true;
+    }
+
+    return false;
+}
+
+/**************************************************************************************************/
+
 START_TEST(test_here_tracking_http_parser_ok_simple)
 {
     char* resp;
@@ -501,6 +596,38 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_http_parser_ok_resume_line)
+{
+    const char* resp = "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\ntest";
+    uint32_t parse_size;
+    here_tracking_http_parser parser;
+    here_tracking_error res = here_tracking_http_parser_init(&parser,
+                                                             test_here_tracking_http_parser_cb_nop,
+                                                             NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert_uint_eq(parser.scan_pos, 0);
+
+    /* Search of the incomplete header line continues where it ended */
+    parse_size = strlen("HTTP/1.1 200 OK\r\nContent-Len");
+    res = here_tracking_http_parser_parse(&parser, resp, &parse_size);
+    ck_assert(res == HERE_TRACKING_ERROR_NEED_MORE_DATA);
+    ck_assert_uint_eq(parse_size, 17);
+    ck_assert_uint_eq(parser.scan_pos, 10);
+    parse_size = strlen("Content-Length: 4\r");
+    res = here_tracking_http_parser_parse(&parser, resp + 17, &parse_size);
+    ck_assert(res == HERE_TRACKING_ERROR_NEED_MORE_DATA);
+    ck_assert_uint_eq(parse_size, 0);
+    ck_assert_uint_eq(parser.scan_pos, 17);
+    parse_size = strlen(resp) - 17;
+    res = here_tracking_http_parser_parse(&parser, resp + 17, &parse_size);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert_uint_eq(parse_size, strlen(resp) - 17);
+    ck_assert_uint_eq(parser.scan_pos, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 START_TEST(test_here_tracking_http_parser_ok_no_content)
 {
     char* resp;
@@ -686,6 +813,165 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_http_parser_keep_alive)
+{
+    uint32_t size;
+    here_tracking_http_parser parser;
+    here_tracking_error res;
+
+    res = here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_cb_nop, NULL);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(!parser.keep_alive);
+    size = strlen(simple_resp);
+    res = here_tracking_http_parser_parse(&parser, simple_resp, &size);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(parser.keep_alive);
+
+    here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_cb_nop, NULL);
+    size = strlen(simple_resp_connection_close);
+    res = here_tracking_http_parser_parse(&parser, simple_resp_connection_close, &size);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(!parser.keep_alive);
+
+    here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_cb_nop, NULL);
+    size = strlen(simple_resp_http_1_0);
+    res = here_tracking_http_parser_parse(&parser, simple_resp_http_1_0, &size);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(!parser.keep_alive);
+
+    here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_cb_nop, NULL);
+    size = strlen(simple_resp_http_1_0_keep_alive);
+    res = here_tracking_http_parser_parse(&parser, simple_resp_http_1_0_keep_alive, &size);
+    ck_assert(res == HERE_TRACKING_OK);
+    ck_assert(parser.keep_alive);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_parser_pipelined)
+{
+    char resp[256];
+    uint32_t size, pos, resp_size;
+    here_tracking_http_parser parser;
+    here_tracking_error res;
+
+    /* Two responses back to back in the same buffer are parsed one at a time */
+    strcpy(resp, simple_resp_no_content);
+    strcat(resp, simple_resp);
+    strcat(resp, simple_resp_zero_content_length);
+    resp_size = strlen(resp);
+    here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_cb_nop, NULL);
+    size = resp_size;
+    res = here_tracking_http_parser_parse(&parser, resp, &size);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(size, strlen(simple_resp_no_content));
+    pos = size;
+    here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_cb_nop, NULL);
+    size = resp_size - pos;
+    res = here_tracking_http_parser_parse(&parser, resp + pos, &size);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(size, strlen(simple_resp));
+    pos += size;
+    here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_cb_nop, NULL);
+    size = resp_size - pos;
+    res = here_tracking_http_parser_parse(&parser, resp + pos, &size);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(size, strlen(simple_resp_zero_content_length));
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_parser_chunked)
+{
+    char resp[256];
+    uint32_t size;
+    here_tracking_http_parser parser;
+    here_tracking_error res;
+    test_here_tracking_http_parser_chunked_data chunked;
+
+    memset(&chunked, 0, sizeof(chunked));
+    res = here_tracking_http_parser_init(&parser,
+                                         test_here_tracking_http_parser_chunked_cb,
+                                         &chunked);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+
+    /* Data following the body belongs to the next response */
+    strcpy(resp, chunked_resp);
+    strcat(resp, simple_resp);
+    size = strlen(resp);
+    res = here_tracking_http_parser_parse(&parser, resp, &size);
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(size, strlen(chunked_resp));
+    ck_assert(parser.chunked);
+    ck_assert(parser.keep_alive);
+    ck_assert(!chunked.body_size_evt);
+    ck_assert_uint_eq(chunked.last_count, 1);
+    ck_assert_uint_eq(chunked.body_size, strlen(chunked_resp_body));
+    ck_assert(memcmp(chunked.body, chunked_resp_body, chunked.body_size) == 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_parser_chunked_one_byte_increment)
+{
+    uint32_t pos = 0, size = 1, parse_size;
+    here_tracking_http_parser parser;
+    here_tracking_error res;
+    test_here_tracking_http_parser_chunked_data chunked;
+
+    memset(&chunked, 0, sizeof(chunked));
+    here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_chunked_cb, &chunked);
+
+    do
+    {
+        ck_assert_uint_le(size, strlen(chunked_resp) - pos);
+        parse_size = size;
+        res = here_tracking_http_parser_parse(&parser, chunked_resp + pos, &parse_size);
+
+        if(parse_size > 0)
+        {
+            pos += parse_size;
+            size = 1;
+        }
+        else
+        {
+            size++;
+        }
+    } while(res == HERE_TRACKING_ERROR_NEED_MORE_DATA);
+
+    ck_assert_int_eq(res, HERE_TRACKING_OK);
+    ck_assert_uint_eq(pos, strlen(chunked_resp));
+    ck_assert_uint_eq(chunked.last_count, 1);
+    ck_assert_uint_eq(chunked.body_size, strlen(chunked_resp_body));
+    ck_assert(memcmp(chunked.body, chunked_resp_body, chunked.body_size) == 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_http_parser_chunked_invalid)
+{
+    uint32_t size;
+    here_tracking_http_parser parser;
+    here_tracking_error res;
+
+    here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_cb_nop, NULL);
+    size = strlen(chunked_resp_invalid_size);
+    res = here_tracking_http_parser_parse(&parser, chunked_resp_invalid_size, &size);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR);
+
+    here_tracking_http_parser_init(&parser, test_here_tracking_http_parser_cb_nop, NULL);
+    size = strlen(chunked_resp_missing_crlf);
+    res = here_tracking_http_parser_parse(&parser, chunked_resp_missing_crlf, &size);
+    ck_assert_int_eq(res, HERE_TRACKING_ERROR);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 Suite* test_here_tracking_http_parser_suite(void)
 {
     Suite* s = suite_create(TEST_NAME);
@@ -696,11 +982,17 @@ Suite* test_here_tracking_http_parser_suite(void)
     tcase_add_test(tc, test_here_tracking_http_parser_ok_zero_content_length);
     tcase_add_test(tc, test_here_tracking_http_parser_ok_end_of_header_split);
     tcase_add_test(tc, test_here_tracking_http_parser_ok_one_byte_increment);
+    tcase_add_test(tc, test_here_tracking_http_parser_ok_resume_line);
     tcase_add_test(tc, test_here_tracking_http_parser_ok_no_content);
     tcase_add_test(tc, test_here_tracking_http_parser_invalid_input);
     tcase_add_test(tc, test_here_tracking_http_parser_no_content_length);
     tcase_add_test(tc, test_here_tracking_http_parser_invalid_version);
     tcase_add_test(tc, test_here_tracking_http_parser_invalid_status_code);
+    tcase_add_test(tc, test_here_tracking_http_parser_keep_alive);
+    tcase_add_test(tc, test_here_tracking_http_parser_pipelined);
+    tcase_add_test(tc, test_here_tracking_http_parser_chunked);
+    tcase_add_test(tc, test_here_tracking_http_parser_chunked_one_byte_increment);
+    tcase_add_test(tc, test_here_tracking_http_parser_chunked_invalid);
     suite_add_tcase(s, tc);
     return s;
 }
@@ -0,0 +1,420 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <check.h>
+#include <fff.h>
+
+#include "here_tracking_queue.h"
+#include "here_tracking_test.h"
+
+#define TEST_NAME "here_tracking_queue"
+
+/**************************************************************************************************/
+
+DEFINE_FFF_GLOBALS;
+
+FAKE_VALUE_FUNC6(here_tracking_error,
+                 here_tracking_send_stream,
+                 here_tracking_client*,
+                 here_tracking_send_cb,
+                 here_tracking_recv_cb,
+                 here_tracking_req_type,
+                 here_tracking_resp_type,
+                 void*);
+
+#define TEST_HERE_TRACKING_QUEUE_STORAGE_SIZE 512
+#define TEST_HERE_TRACKING_QUEUE_BODY_SIZE    1024
+
+/**************************************************************************************************/
+
+static uint32_t test_storage[TEST_HERE_TRACKING_QUEUE_STORAGE_SIZE / sizeof(uint32_t)];
+static uint8_t* storage = (uint8_t*)test_storage;
+static char test_body[TEST_HERE_TRACKING_QUEUE_BODY_SIZE];
+static here_tracking_error test_resp_status[4];
+static uint32_t test_recv_cb_called;
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_queue_send_stream_custom(here_tracking_client* c,
+                                                                       here_tracking_send_cb s_cb,
+                                                                       here_tracking_recv_cb r_cb,
+                                                                       here_tracking_req_type req,
+                                                                       here_tracking_resp_type res,
+                                                                       void* user_data)
+{
+    here_tracking_recv_data data;
+    const uint8_t* chunk;
+    size_t chunk_size, body_size = 0;
+
+    do
+    {
+        ck_assert_int_eq(s_cb(&chunk, &chunk_size, user_data), HERE_TRACKING_OK);
+        ck_assert_uint_le(body_size + chunk_size, TEST_HERE_TRACKING_QUEUE_BODY_SIZE - 1);
+        memcpy(test_body + body_size, chunk, chunk_size);
+        body_size += chunk_size;
+    } while(chunk_size > 0);
+
+    test_body[body_size] = '\0';
+    data.evt = HERE_TRACKING_RECV_EVT_RESP_COMPLETE;
+    data.err = test_resp_status[here_tracking_send_stream_fake.call_count - 1];
+    data.data = NULL;
+    data.data_size = 0;
+    return r_cb(&data, user_data);
+}
+
+/**************************************************************************************************/
+
+static here_tracking_error test_here_tracking_queue_recv_cb(const here_tracking_recv_data* data,
+                                                            void* user_data)
+{
+    ck_assert_ptr_eq(user_data, &test_recv_cb_called);
+    test_recv_cb_called++;
+    return HERE_TRACKING_OK;
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_queue_push_str(here_tracking_queue* queue, const char* sample)
+{
+    ck_assert_int_eq(here_tracking_queue_push(queue, (const uint8_t*)sample, strlen(sample)),
+                     HERE_TRACKING_OK);
+}
+
+/**************************************************************************************************/
+
+static void test_here_tracking_queue_check(const here_tracking_queue* queue,
+                                           const char** samples,
+                                           uint32_t count)
+{
+    here_tracking_queue_iter iter;
+    const uint8_t* sample;
+    uint32_t sample_size, i;
+
+    ck_assert_uint_eq(queue->count, count);
+    here_tracking_queue_iter_init(queue, &iter);
+
+    for(i = 0; i < count; ++i)
+    {
+        ck_assert(here_tracking_queue_iter_next(queue, &iter, &sample, &sample_size));
+        ck_assert_uint_eq(sample_size, strlen(samples[i]));
+        ck_assert(memcmp(sample, samples[i], sample_size) == 0);
+    }
+
+    ck_assert(!here_tracking_queue_iter_next(queue, &iter, &sample, &sample_size));
+}
+
+/**************************************************************************************************/
+
+void test_here_tracking_queue_tc_setup(void)
+{
+    RESET_FAKE(here_tracking_send_stream);
+    FFF_RESET_HISTORY();
+    here_tracking_send_stream_fake.custom_fake = test_here_tracking_queue_send_stream_custom;
+    memset(test_storage, 0xa5, sizeof(test_storage));
+    memset(test_resp_status, 0, sizeof(test_resp_status));
+    test_recv_cb_called = 0;
+}
+
+/**************************************************************************************************/
+
+void test_here_tracking_queue_tc_teardown(void)
+{
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_open_invalid)
+{
+    here_tracking_queue queue;
+    ck_assert_int_eq(here_tracking_queue_open(NULL, storage, sizeof(test_storage)),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_open(&queue, NULL, sizeof(test_storage)),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage + 1, sizeof(test_storage) - 4),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, HERE_TRACKING_QUEUE_MIN_SIZE - 1),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_push_pop)
+{
+    here_tracking_queue queue;
+    const char* samples[] = { "{\"a\":1}", "{\"b\":22}", "{\"c\":333}" };
+    uint8_t big[400];
+    memset(big, 'x', sizeof(big));
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    test_here_tracking_queue_check(&queue, samples, 0);
+    test_here_tracking_queue_push_str(&queue, samples[0]);
+    test_here_tracking_queue_push_str(&queue, samples[1]);
+    test_here_tracking_queue_push_str(&queue, samples[2]);
+    test_here_tracking_queue_check(&queue, samples, 3);
+    ck_assert_int_eq(here_tracking_queue_pop(&queue, 4), HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_pop(&queue, 1), HERE_TRACKING_OK);
+    test_here_tracking_queue_check(&queue, samples + 1, 2);
+    ck_assert_int_eq(here_tracking_queue_pop(&queue, 2), HERE_TRACKING_OK);
+    test_here_tracking_queue_check(&queue, samples, 0);
+
+    /* Empty queue starts again from the beginning for a sample that doesn't fit at the end */
+    ck_assert_int_eq(here_tracking_queue_push(&queue, big, sizeof(big)), HERE_TRACKING_OK);
+    ck_assert_uint_eq(queue.head, HERE_TRACKING_QUEUE_HDR_SIZE);
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(queue.count, 1);
+    ck_assert_int_eq(here_tracking_queue_push(NULL, big, 1), HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_push(&queue, NULL, 1), HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_push(&queue, (const uint8_t*)samples[0], 0),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_full_and_wrap)
+{
+    here_tracking_queue queue;
+    char samples[64][32];
+    const char* expected[64];
+    uint32_t pushed = 0, popped = 0, round;
+    here_tracking_error err;
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+
+    /* Too big for the queue at all */
+    ck_assert_int_eq(here_tracking_queue_push(&queue, (const uint8_t*)test_body, sizeof(test_body)),
+                     HERE_TRACKING_ERROR_BUFFER_TOO_SMALL);
+
+    /* Fill and drain with samples of varying size so that the log wraps at different places */
+    for(round = 0; round < 200; ++round)
+    {
+        uint32_t i;
+
+        do
+        {
+            snprintf(samples[pushed % 64], 32, "{\"n\":%u%.*s}",
+                     pushed, (int)(pushed % 13), "xxxxxxxxxxxxx");
+            err = here_tracking_queue_push(&queue,
+                                           (const uint8_t*)samples[pushed % 64],
+                                           strlen(samples[pushed % 64]));
+
+            if(err == HERE_TRACKING_OK)
+            {
+                pushed++;
+            }
+        } while(err == HERE_TRACKING_OK);
+
+        ck_assert_int_eq(err, HERE_TRACKING_ERROR_BUFFER_TOO_SMALL);
+        ck_assert_uint_eq(queue.count, pushed - popped);
+
+        for(i = 0; i < queue.count; ++i)
+        {
+            expected[i] = samples[(popped + i) % 64];
+        }
+
+        test_here_tracking_queue_check(&queue, expected, queue.count);
+
+        /* Survives reopening */
+        ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                         HERE_TRACKING_OK);
+        test_here_tracking_queue_check(&queue, expected, pushed - popped);
+
+        i = 1 + (round % queue.count);
+        ck_assert_int_eq(here_tracking_queue_pop(&queue, i), HERE_TRACKING_OK);
+        popped += i;
+    }
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_recover_torn_record)
+{
+    here_tracking_queue queue;
+    const char* samples[] = { "{\"a\":1}", "{\"b\":2}", "{\"c\":3}" };
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    test_here_tracking_queue_push_str(&queue, samples[0]);
+    test_here_tracking_queue_push_str(&queue, samples[1]);
+    test_here_tracking_queue_push_str(&queue, samples[2]);
+
+    /* Second sample only partly written, the one after it is lost too */
+    storage[HERE_TRACKING_QUEUE_HDR_SIZE + 2 * HERE_TRACKING_QUEUE_RECORD_HDR_SIZE + 8 + 3] = 'x';
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    test_here_tracking_queue_check(&queue, samples, 1);
+
+    /* New samples replace the lost ones */
+    test_here_tracking_queue_push_str(&queue, samples[2]);
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(queue.count, 2);
+    ck_assert_int_eq(here_tracking_queue_pop(&queue, 1), HERE_TRACKING_OK);
+    test_here_tracking_queue_check(&queue, samples + 2, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_recover_torn_header)
+{
+    here_tracking_queue queue;
+    const char* samples[] = { "{\"a\":1}", "{\"b\":2}", "{\"c\":3}" };
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    test_here_tracking_queue_push_str(&queue, samples[0]);
+    test_here_tracking_queue_push_str(&queue, samples[1]);
+    test_here_tracking_queue_push_str(&queue, samples[2]);
+    ck_assert_int_eq(here_tracking_queue_pop(&queue, 1), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_queue_pop(&queue, 1), HERE_TRACKING_OK);
+
+    /* Last header write interrupted, the previous header is used */
+    storage[(queue.generation & 1) * 32 + 12] ^= 0xff;
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    test_here_tracking_queue_check(&queue, samples + 1, 2);
+
+    /* Both headers lost, the queue is formatted again */
+    storage[0] ^= 0xff;
+    storage[32] ^= 0xff;
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    test_here_tracking_queue_check(&queue, samples, 0);
+
+    /* Queue memory of a different size is formatted again */
+    test_here_tracking_queue_push_str(&queue, samples[0]);
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage) - 4),
+                     HERE_TRACKING_OK);
+    test_here_tracking_queue_check(&queue, samples, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_send_batches)
+{
+    here_tracking_client client;
+    here_tracking_queue queue;
+    const char* samples[] = { "{\"a\":1}", "{\"b\":2}", "{\"c\":3}" };
+    uint32_t sent = 0;
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_queue_send(NULL, &queue, 0, NULL, NULL, &sent),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_queue_send(&client, &queue, 0, NULL, NULL, NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+
+    /* Nothing to send */
+    ck_assert_int_eq(here_tracking_queue_send(&client, &queue, 0, NULL, NULL, &sent),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(sent, 0);
+    ck_assert_uint_eq(here_tracking_send_stream_fake.call_count, 0);
+
+    test_here_tracking_queue_push_str(&queue, samples[0]);
+    test_here_tracking_queue_push_str(&queue, samples[1]);
+    test_here_tracking_queue_push_str(&queue, samples[2]);
+    ck_assert_int_eq(here_tracking_queue_send(&client, &queue, 2, NULL, NULL, &sent),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(sent, 3);
+    ck_assert_uint_eq(queue.count, 0);
+    ck_assert_uint_eq(here_tracking_send_stream_fake.call_count, 2);
+    ck_assert_ptr_eq(here_tracking_send_stream_fake.arg0_history[0], &client);
+    ck_assert_int_eq(here_tracking_send_stream_fake.arg3_history[0], HERE_TRACKING_REQ_DATA_JSON);
+    ck_assert_int_eq(here_tracking_send_stream_fake.arg4_history[0],
+                     HERE_TRACKING_RESP_STATUS_ONLY);
+    ck_assert_str_eq(test_body, "[{\"c\":3}]");
+
+    /* Whole queue in one request, responses passed to the callback */
+    test_here_tracking_queue_push_str(&queue, samples[0]);
+    test_here_tracking_queue_push_str(&queue, samples[1]);
+    ck_assert_int_eq(here_tracking_queue_send(&client,
+                                              &queue,
+                                              0,
+                                              test_here_tracking_queue_recv_cb,
+                                              &test_recv_cb_called,
+                                              &sent),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(sent, 2);
+    ck_assert_uint_eq(test_recv_cb_called, 1);
+    ck_assert_uint_eq(here_tracking_send_stream_fake.call_count, 3);
+    ck_assert_int_eq(here_tracking_send_stream_fake.arg4_history[2],
+                     HERE_TRACKING_RESP_WITH_DATA_JSON);
+    ck_assert_str_eq(test_body, "[{\"a\":1},{\"b\":2}]");
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_queue_send_errors)
+{
+    here_tracking_client client;
+    here_tracking_queue queue;
+    const char* samples[] = { "{\"a\":1}", "{\"b\":2}", "{\"c\":3}" };
+    uint32_t sent = 0;
+    ck_assert_int_eq(here_tracking_queue_open(&queue, storage, sizeof(test_storage)),
+                     HERE_TRACKING_OK);
+    test_here_tracking_queue_push_str(&queue, samples[0]);
+    test_here_tracking_queue_push_str(&queue, samples[1]);
+    test_here_tracking_queue_push_str(&queue, samples[2]);
+
+    /* Rejected batch is dropped, rate limited batch is kept */
+    test_resp_status[0] = HERE_TRACKING_ERROR_BAD_REQUEST;
+    test_resp_status[1] = HERE_TRACKING_ERROR_TOO_MANY_REQUESTS;
+    ck_assert_int_eq(here_tracking_queue_send(&client, &queue, 1, NULL, NULL, &sent),
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(sent, 1);
+    test_here_tracking_queue_check(&queue, samples + 1, 2);
+
+    /* Request failed before a response */
+    here_tracking_send_stream_fake.custom_fake = NULL;
+    here_tracking_send_stream_fake.return_val = HERE_TRACKING_ERROR_TIMEOUT;
+    ck_assert_int_eq(here_tracking_queue_send(&client, &queue, 0, NULL, NULL, &sent),
+                     HERE_TRACKING_ERROR_TIMEOUT);
+    ck_assert_uint_eq(sent, 0);
+    test_here_tracking_queue_check(&queue, samples + 1, 2);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+TEST_SUITE_BEGIN(TEST_NAME)
+    TEST_SUITE_ADD_SETUP_TEARDOWN_FN(test_here_tracking_queue_tc_setup,
+                                     test_here_tracking_queue_tc_teardown)
+    TEST_SUITE_ADD_TEST(test_here_tracking_queue_open_invalid)
+    TEST_SUITE_ADD_TEST(test_here_tracking_queue_push_pop)
+    TEST_SUITE_ADD_TEST(test_here_tracking_queue_full_and_wrap)
+    TEST_SUITE_ADD_TEST(test_here_tracking_queue_recover_torn_record)
+    TEST_SUITE_ADD_TEST(test_here_tracking_queue_recover_torn_header)
+    TEST_SUITE_ADD_TEST(test_here_tracking_queue_send_batches)
+    TEST_SUITE_ADD_TEST(test_here_tracking_queue_send_errors)
+TEST_SUITE_END
+
+/**************************************************************************************************/
+
+TEST_MAIN(TEST_NAME)
@@ -0,0 +1,217 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <check.h>
+#include <fff.h>
+
+#include "here_tracking_rate_limiter.h"
+#include "here_tracking_test.h"
+
+#include "mock_here_tracking_time.h"
+
+#define TEST_NAME "here_tracking_rate_limiter"
+
+/**************************************************************************************************/
+
+DEFINE_FFF_GLOBALS;
+
+#define TEST_HERE_TRACKING_RATE_LIMITER_FAKE_LIST(FAKE) \
+    MOCK_HERE_TRACKING_TIME_FAKE_LIST(FAKE)
+
+/**************************************************************************************************/
+
+static here_tracking_rate_limiter limiter;
+
+/**************************************************************************************************/
+
+void test_here_tracking_rate_limiter_tc_setup(void)
+{
+    TEST_HERE_TRACKING_RATE_LIMITER_FAKE_LIST(RESET_FAKE);
+    FFF_RESET_HISTORY();
+    here_tracking_get_monotonic_ms_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_get_monotonic_ms_fake.custom_fake = mock_here_tracking_get_monotonic_ms_custom;
+    mock_here_tracking_get_monotonic_ms_set_result(1000);
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&limiter, 1000, 3), HERE_TRACKING_OK);
+}
+
+/**************************************************************************************************/
+
+void test_here_tracking_rate_limiter_tc_teardown(void)
+{
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_rate_limiter_init_invalid)
+{
+    ck_assert_int_eq(here_tracking_rate_limiter_init(NULL, 1000, 1),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&limiter, 0, 1),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&limiter, 1000, 0),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&limiter, 0x7fffffff, 1),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(NULL, 1, NULL),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_rate_limiter_update(NULL, HERE_TRACKING_OK),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_rate_limiter_pause(NULL, 1), HERE_TRACKING_ERROR_INVALID_INPUT);
+    here_tracking_rate_limiter_take(NULL, 1);
+
+    /* No time */
+    here_tracking_get_monotonic_ms_fake.custom_fake = NULL;
+    here_tracking_get_monotonic_ms_fake.return_val = HERE_TRACKING_ERROR;
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&limiter, 1000, 1), HERE_TRACKING_ERROR);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 1, NULL), HERE_TRACKING_ERROR);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_rate_limiter_tokens)
+{
+    uint32_t wait_ms = 1, i;
+
+    for(i = 0; i < 3; ++i)
+    {
+        ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 1, &wait_ms),
+                         HERE_TRACKING_OK);
+        ck_assert_uint_eq(wait_ms, 0);
+        here_tracking_rate_limiter_take(&limiter, 1);
+    }
+
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 1, &wait_ms),
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(wait_ms, 1000);
+    mock_here_tracking_get_monotonic_ms_set_result(1400);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 1, &wait_ms),
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(wait_ms, 600);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 0, &wait_ms), HERE_TRACKING_OK);
+
+    /* Tokens come back one interval after another */
+    mock_here_tracking_get_monotonic_ms_set_result(3500);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 1, NULL), HERE_TRACKING_OK);
+    ck_assert_uint_eq(limiter.tokens, 2);
+    ck_assert_uint_eq(limiter.refill_ms, 3000);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 3, &wait_ms),
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(wait_ms, 500);
+
+    /* Full bucket doesn't collect more tokens, more requests than the burst need a full one */
+    mock_here_tracking_get_monotonic_ms_set_result(60000);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 10, NULL), HERE_TRACKING_OK);
+    ck_assert_uint_eq(limiter.tokens, 3);
+    here_tracking_rate_limiter_take(&limiter, 10);
+    ck_assert_uint_eq(limiter.tokens, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_rate_limiter_adapt)
+{
+    uint32_t wait_ms = 0, i;
+
+    /* Each rate limited response halves the rate */
+    ck_assert_int_eq(here_tracking_rate_limiter_update(&limiter,
+                                                       HERE_TRACKING_ERROR_TOO_MANY_REQUESTS),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(limiter.interval_ms, 2000);
+    ck_assert_uint_eq(limiter.tokens, 0);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 1, &wait_ms),
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(wait_ms, 2000);
+
+    for(i = 0; i < 10; ++i)
+    {
+        ck_assert_int_eq(here_tracking_rate_limiter_update(&limiter,
+                                                           HERE_TRACKING_ERROR_TOO_MANY_REQUESTS),
+                         HERE_TRACKING_OK);
+    }
+
+    ck_assert_uint_eq(limiter.interval_ms, 1000 * HERE_TRACKING_RATE_LIMITER_MAX_BACKOFF);
+
+    /* Accepted requests bring it back step by step, other errors don't change it */
+    ck_assert_int_eq(here_tracking_rate_limiter_update(&limiter, HERE_TRACKING_ERROR),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(limiter.interval_ms, 64000);
+    ck_assert_int_eq(here_tracking_rate_limiter_update(&limiter, HERE_TRACKING_OK),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(limiter.interval_ms, 56125);
+
+    for(i = 0; i < 100; ++i)
+    {
+        ck_assert_int_eq(here_tracking_rate_limiter_update(&limiter, HERE_TRACKING_OK),
+                         HERE_TRACKING_OK);
+    }
+
+    ck_assert_uint_eq(limiter.interval_ms, 1000);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_rate_limiter_retry_after)
+{
+    uint32_t wait_ms = 0;
+    ck_assert_int_eq(here_tracking_rate_limiter_pause(&limiter, 10), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_rate_limiter_update(&limiter,
+                                                       HERE_TRACKING_ERROR_TOO_MANY_REQUESTS),
+                     HERE_TRACKING_OK);
+    ck_assert(limiter.paused);
+    ck_assert_uint_eq(limiter.refill_ms, 11000);
+
+    /* Paused even for connecting without a request */
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 0, &wait_ms),
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(wait_ms, 10000);
+    mock_here_tracking_get_monotonic_ms_set_result(11000);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 0, &wait_ms), HERE_TRACKING_OK);
+    ck_assert(!limiter.paused);
+
+    /* No tokens were collected during the pause */
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 1, &wait_ms),
+                     HERE_TRACKING_ERROR_TOO_MANY_REQUESTS);
+    ck_assert_uint_eq(wait_ms, 2000);
+    mock_here_tracking_get_monotonic_ms_set_result(13000);
+    ck_assert_int_eq(here_tracking_rate_limiter_check(&limiter, 1, &wait_ms), HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+TEST_SUITE_BEGIN(TEST_NAME)
+    TEST_SUITE_ADD_SETUP_TEARDOWN_FN(test_here_tracking_rate_limiter_tc_setup,
+                                     test_here_tracking_rate_limiter_tc_teardown)
+    TEST_SUITE_ADD_TEST(test_here_tracking_rate_limiter_init_invalid)
+    TEST_SUITE_ADD_TEST(test_here_tracking_rate_limiter_tokens)
+    TEST_SUITE_ADD_TEST(test_here_tracking_rate_limiter_adapt)
+    TEST_SUITE_ADD_TEST(test_here_tracking_rate_limiter_retry_after)
+TEST_SUITE_END
+
+/**************************************************************************************************/
+
+TEST_MAIN(TEST_NAME)
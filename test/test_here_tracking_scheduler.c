@@ -0,0 +1,286 @@
+/**************************************************************************************************
+ * Copyright (C) 2017-2018 HERE Europe B.V.                                                       *
+ * All rights reserved.                                                                           *
+ *                                                                                                *
+ * MIT License                                                                                    *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include <string.h>
+
+#include <check.h>
+#include <fff.h>
+
+#include "here_tracking_scheduler.h"
+#include "here_tracking_test.h"
+
+#include "mock_here_tracking_time.h"
+
+#define TEST_NAME "here_tracking_scheduler"
+
+/**************************************************************************************************/
+
+DEFINE_FFF_GLOBALS;
+
+#define TEST_HERE_TRACKING_SCHEDULER_FAKE_LIST(FAKE) \
+    MOCK_HERE_TRACKING_TIME_FAKE_LIST(FAKE)
+
+#define TEST_HERE_TRACKING_SCHEDULER_NOW_MS 1000
+#define TEST_HERE_TRACKING_SCHEDULER_NOW_S  1500000000
+
+/**************************************************************************************************/
+
+static here_tracking_client client;
+static here_tracking_scheduler scheduler;
+
+/**************************************************************************************************/
+
+static void test_here_tracking_scheduler_set_device_id(here_tracking_client* c, const char* id)
+{
+    memset(c, 0, sizeof(*c));
+    memcpy(c->device_id, id, strlen(id));
+}
+
+/**************************************************************************************************/
+
+void test_here_tracking_scheduler_tc_setup(void)
+{
+    TEST_HERE_TRACKING_SCHEDULER_FAKE_LIST(RESET_FAKE);
+    FFF_RESET_HISTORY();
+    here_tracking_get_monotonic_ms_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_get_monotonic_ms_fake.custom_fake = mock_here_tracking_get_monotonic_ms_custom;
+    mock_here_tracking_get_monotonic_ms_set_result(TEST_HERE_TRACKING_SCHEDULER_NOW_MS);
+    here_tracking_get_unixtime_fake.return_val = HERE_TRACKING_OK;
+    here_tracking_get_unixtime_fake.custom_fake = mock_here_tracking_get_unixtime_custom;
+    mock_here_tracking_get_unixtime_set_result(TEST_HERE_TRACKING_SCHEDULER_NOW_S);
+    test_here_tracking_scheduler_set_device_id(&client, "b4b3bd9e-2d7f-4c26-9e5a-5d5e0c0b7b4c");
+    ck_assert_int_eq(here_tracking_scheduler_init(&scheduler, &client, 1000, 8000, 0),
+                     HERE_TRACKING_OK);
+}
+
+/**************************************************************************************************/
+
+void test_here_tracking_scheduler_tc_teardown(void)
+{
+}
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_scheduler_init_invalid)
+{
+    ck_assert_int_eq(here_tracking_scheduler_init(NULL, &client, 0, 0, 0),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_scheduler_init(&scheduler, NULL, 0, 0, 0),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_scheduler_ready(NULL, NULL), HERE_TRACKING_ERROR_INVALID_INPUT);
+    ck_assert_int_eq(here_tracking_scheduler_update(NULL, HERE_TRACKING_OK),
+                     HERE_TRACKING_ERROR_INVALID_INPUT);
+
+    /* Defaults */
+    ck_assert_int_eq(here_tracking_scheduler_init(&scheduler, &client, 0, 0, 0), HERE_TRACKING_OK);
+    ck_assert_uint_eq(scheduler.base_delay_ms, HERE_TRACKING_SCHEDULER_DEFAULT_BASE_DELAY_MS);
+    ck_assert_uint_eq(scheduler.max_delay_ms, HERE_TRACKING_SCHEDULER_DEFAULT_MAX_DELAY_MS);
+    ck_assert_uint_eq(scheduler.spread_ms, 0);
+    ck_assert_uint_ne(scheduler.rand_state, 0);
+
+    /* No time */
+    here_tracking_get_monotonic_ms_fake.custom_fake = NULL;
+    here_tracking_get_monotonic_ms_fake.return_val = HERE_TRACKING_ERROR;
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, NULL), HERE_TRACKING_ERROR);
+    ck_assert_int_eq(here_tracking_scheduler_update(&scheduler, HERE_TRACKING_ERROR),
+                     HERE_TRACKING_ERROR);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_scheduler_backoff)
+{
+    uint32_t wait_ms = 1, ceiling = 1000, i;
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms), HERE_TRACKING_OK);
+    ck_assert_uint_eq(wait_ms, 0);
+
+    for(i = 0; i < 6; ++i)
+    {
+        ck_assert_int_eq(here_tracking_scheduler_update(&scheduler, HERE_TRACKING_ERROR_TIMEOUT),
+                         HERE_TRACKING_OK);
+        ck_assert_uint_eq(scheduler.failures, i + 1);
+        ck_assert_uint_le(scheduler.next_ms - TEST_HERE_TRACKING_SCHEDULER_NOW_MS, ceiling);
+        ceiling = (ceiling * 2 > 8000) ? 8000 : ceiling * 2;
+    }
+
+    /* Wait until the last delay is over */
+    wait_ms = 0;
+    scheduler.next_ms = TEST_HERE_TRACKING_SCHEDULER_NOW_MS + 3000;
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms),
+                     HERE_TRACKING_ERROR_WOULD_BLOCK);
+    ck_assert_uint_eq(wait_ms, 3000);
+    mock_here_tracking_get_monotonic_ms_set_result(TEST_HERE_TRACKING_SCHEDULER_NOW_MS + 2999);
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms),
+                     HERE_TRACKING_ERROR_WOULD_BLOCK);
+    ck_assert_uint_eq(wait_ms, 1);
+    mock_here_tracking_get_monotonic_ms_set_result(TEST_HERE_TRACKING_SCHEDULER_NOW_MS + 3000);
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms), HERE_TRACKING_OK);
+    ck_assert_uint_eq(wait_ms, 0);
+    ck_assert(!scheduler.waiting);
+
+    /* Server errors back off too, success resets */
+    ck_assert_int_eq(here_tracking_scheduler_update(&scheduler, HERE_TRACKING_ERROR),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(scheduler.failures, 7);
+    ck_assert_int_eq(here_tracking_scheduler_update(&scheduler, HERE_TRACKING_OK),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(scheduler.failures, 0);
+    ck_assert(!scheduler.waiting);
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, NULL), HERE_TRACKING_OK);
+
+    /* Rejected requests are not retried, so they don't back off */
+    ck_assert_int_eq(here_tracking_scheduler_update(&scheduler, HERE_TRACKING_ERROR_BAD_REQUEST),
+                     HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, NULL), HERE_TRACKING_OK);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_scheduler_retry_after)
+{
+    uint32_t wait_ms = 0, i;
+
+    /* Exactly at the time given by the server */
+    client.retry_after = TEST_HERE_TRACKING_SCHEDULER_NOW_S + 10;
+    ck_assert_int_eq(here_tracking_scheduler_update(&scheduler,
+                                                    HERE_TRACKING_ERROR_TOO_MANY_REQUESTS),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(scheduler.failures, 0);
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms),
+                     HERE_TRACKING_ERROR_WOULD_BLOCK);
+    ck_assert_uint_eq(wait_ms, 10000);
+
+    /* Spread over the given time */
+    ck_assert_int_eq(here_tracking_scheduler_init(&scheduler, &client, 0, 0, 5000),
+                     HERE_TRACKING_OK);
+
+    for(i = 0; i < 100; ++i)
+    {
+        ck_assert_int_eq(here_tracking_scheduler_update(&scheduler,
+                                                        HERE_TRACKING_ERROR_TOO_MANY_REQUESTS),
+                         HERE_TRACKING_OK);
+        ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms),
+                         HERE_TRACKING_ERROR_WOULD_BLOCK);
+        ck_assert_uint_ge(wait_ms, 10000);
+        ck_assert_uint_le(wait_ms, 15000);
+    }
+
+    /* Without Retry-After the client backs off */
+    client.retry_after = 0;
+    ck_assert_int_eq(here_tracking_scheduler_update(&scheduler,
+                                                    HERE_TRACKING_ERROR_TOO_MANY_REQUESTS),
+                     HERE_TRACKING_OK);
+    ck_assert_uint_eq(scheduler.failures, 1);
+    ck_assert_uint_le(scheduler.next_ms - TEST_HERE_TRACKING_SCHEDULER_NOW_MS,
+                      HERE_TRACKING_SCHEDULER_DEFAULT_BASE_DELAY_MS);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_scheduler_client_retry_after)
+{
+    uint32_t wait_ms = 0;
+
+    /* Rate limited by a request that was sent without the scheduler */
+    client.retry_after = TEST_HERE_TRACKING_SCHEDULER_NOW_S + 3;
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms),
+                     HERE_TRACKING_ERROR_WOULD_BLOCK);
+    ck_assert_uint_eq(wait_ms, 3000);
+    mock_here_tracking_get_unixtime_set_result(TEST_HERE_TRACKING_SCHEDULER_NOW_S + 3);
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms), HERE_TRACKING_OK);
+    ck_assert_uint_eq(wait_ms, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_scheduler_rate_limiters)
+{
+    here_tracking_rate_limiter limiter, gateway_limiter;
+    uint32_t wait_ms = 0;
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&limiter, 1000, 1), HERE_TRACKING_OK);
+    ck_assert_int_eq(here_tracking_rate_limiter_init(&gateway_limiter, 3000, 1), HERE_TRACKING_OK);
+    client.rate_limiter = &limiter;
+    client.gateway_rate_limiter = &gateway_limiter;
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms), HERE_TRACKING_OK);
+
+    /* Waits for the limiter that has a token last, without taking tokens */
+    here_tracking_rate_limiter_take(&limiter, 1);
+    here_tracking_rate_limiter_take(&gateway_limiter, 1);
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms),
+                     HERE_TRACKING_ERROR_WOULD_BLOCK);
+    ck_assert_uint_eq(wait_ms, 3000);
+    mock_here_tracking_get_monotonic_ms_set_result(TEST_HERE_TRACKING_SCHEDULER_NOW_MS + 3000);
+    ck_assert_int_eq(here_tracking_scheduler_ready(&scheduler, &wait_ms), HERE_TRACKING_OK);
+    ck_assert_uint_eq(limiter.tokens, 1);
+    ck_assert_uint_eq(gateway_limiter.tokens, 1);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_scheduler_devices_differ)
+{
+    here_tracking_client client2;
+    here_tracking_scheduler scheduler2;
+    uint32_t i, same = 0;
+    test_here_tracking_scheduler_set_device_id(&client2, "0d6c4a38-6a9e-4b8e-8f5a-0a7f3b3f1d2e");
+    ck_assert_int_eq(here_tracking_scheduler_init(&scheduler2, &client2, 1000, 8000, 0),
+                     HERE_TRACKING_OK);
+
+    /* Devices that fail together retry at different times */
+    for(i = 0; i < 10; ++i)
+    {
+        scheduler.failures = 3;
+        scheduler2.failures = 3;
+        ck_assert_int_eq(here_tracking_scheduler_update(&scheduler, HERE_TRACKING_ERROR),
+                         HERE_TRACKING_OK);
+        ck_assert_int_eq(here_tracking_scheduler_update(&scheduler2, HERE_TRACKING_ERROR),
+                         HERE_TRACKING_OK);
+        same += (scheduler.next_ms == scheduler2.next_ms) ? 1 : 0;
+    }
+
+    ck_assert_uint_lt(same, 10);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+TEST_SUITE_BEGIN(TEST_NAME)
+    TEST_SUITE_ADD_SETUP_TEARDOWN_FN(test_here_tracking_scheduler_tc_setup,
+                                     test_here_tracking_scheduler_tc_teardown)
+    TEST_SUITE_ADD_TEST(test_here_tracking_scheduler_init_invalid)
+    TEST_SUITE_ADD_TEST(test_here_tracking_scheduler_backoff)
+    TEST_SUITE_ADD_TEST(test_here_tracking_scheduler_retry_after)
+    TEST_SUITE_ADD_TEST(test_here_tracking_scheduler_client_retry_after)
+    TEST_SUITE_ADD_TEST(test_here_tracking_scheduler_rate_limiters)
+    TEST_SUITE_ADD_TEST(test_here_tracking_scheduler_devices_differ)
+TEST_SUITE_END
+
+/**************************************************************************************************/
+
+TEST_MAIN(TEST_NAME)
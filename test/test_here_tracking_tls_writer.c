@@ -43,7 +43,7 @@ DEFINE_FFF_GLOBALS;
 /**************************************************************************************************/
 
 #define TEST_HERE_TRACKING_TLS_WRITER_INIT_OK(WRITER, TLS, BUFFER, BUFFER_SIZE) \
-    err = here_tracking_tls_init(&(TLS)); \
+    err = here_tracking_tls_init(&(TLS), NULL); \
     ck_assert(err == HERE_TRACKING_OK); \
     err = here_tracking_tls_writer_init((WRITER), (TLS), (BUFFER), (BUFFER_SIZE)); \
     ck_assert(err == HERE_TRACKING_OK);
@@ -120,6 +120,40 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_tls_writer_write_data_large_ok)
+{
+    here_tracking_error err;
+    here_tracking_tls_writer tls_writer;
+    here_tracking_tls tls_ctx;
+    static const uint8_t buffer_size = 10;
+    uint8_t buffer[buffer_size];
+    static const uint8_t data_size = 35;
+    uint8_t data[data_size];
+    here_tracking_error add_data_res[3] =
+    {
+        HERE_TRACKING_OK,
+        HERE_TRACKING_ERROR_BUFFER_TOO_SMALL,
+        HERE_TRACKING_OK
+    };
+
+    TEST_HERE_TRACKING_TLS_WRITER_INIT_OK(&tls_writer, tls_ctx, buffer, buffer_size);
+    SET_RETURN_SEQ(here_tracking_data_buffer_add_data, add_data_res, 3);
+    err = here_tracking_tls_writer_write_data(&tls_writer, data, 4);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    ck_assert_uint_eq(here_tracking_tls_write_fake.call_count, 0);
+    err = here_tracking_tls_writer_write_data(&tls_writer, data, data_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+
+    /* Buffered data is topped up with the start of the data, rest is written without copying */
+    ck_assert_uint_eq(here_tracking_tls_write_fake.call_count, 2);
+    ck_assert_ptr_eq(here_tracking_tls_write_fake.arg1_history[0], buffer);
+    ck_assert_ptr_eq(here_tracking_tls_write_fake.arg1_history[1], data + 6);
+    ck_assert_uint_eq(tls_writer.data_buffer.buffer_size, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 START_TEST(test_here_tracking_tls_writer_init_invalid_input)
 {
     here_tracking_error err;
@@ -127,7 +161,7 @@ START_TEST(test_here_tracking_tls_writer_init_invalid_input)
     here_tracking_tls tls_ctx;
     uint8_t buffer[10];
 
-    err = here_tracking_tls_init(&tls_ctx);
+    err = here_tracking_tls_init(&tls_ctx, NULL);
     ck_assert(err == HERE_TRACKING_OK);
     err = here_tracking_tls_writer_init(NULL, tls_ctx, buffer, 10);
     ck_assert(err == HERE_TRACKING_ERROR_INVALID_INPUT);
@@ -336,11 +370,70 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_tls_writer_buffered_ok)
+{
+    here_tracking_error err;
+    here_tracking_tls_writer tls_writer;
+    static const uint8_t buffer_size = 10;
+    uint8_t buffer[buffer_size];
+    uint8_t data[buffer_size];
+
+    err = here_tracking_tls_writer_init_buffered(&tls_writer, buffer, buffer_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    err = here_tracking_tls_writer_write_data(&tls_writer, data, buffer_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    /* Buffer is not flushed when full */
+    ck_assert_uint_eq(tls_writer.data_buffer.buffer_size, buffer_size);
+    ck_assert_uint_eq(here_tracking_tls_write_fake.call_count, 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_writer_buffered_too_small)
+{
+    here_tracking_error err;
+    here_tracking_tls_writer tls_writer;
+    static const uint8_t buffer_size = 10;
+    uint8_t buffer[buffer_size];
+    uint8_t data[buffer_size + 1];
+
+    err = here_tracking_tls_writer_init_buffered(&tls_writer, buffer, buffer_size);
+    ck_assert_int_eq(err, HERE_TRACKING_OK);
+    here_tracking_data_buffer_add_data_fake.return_val = HERE_TRACKING_ERROR_BUFFER_TOO_SMALL;
+    err = here_tracking_tls_writer_write_data(&tls_writer, data, buffer_size + 1);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_BUFFER_TOO_SMALL);
+    ck_assert_uint_eq(here_tracking_tls_write_fake.call_count, 0);
+    err = here_tracking_tls_writer_flush(&tls_writer);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_tls_writer_buffered_invalid_input)
+{
+    here_tracking_error err;
+    here_tracking_tls_writer tls_writer;
+    uint8_t buffer[10];
+
+    err = here_tracking_tls_writer_init_buffered(NULL, buffer, 10);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+    err = here_tracking_tls_writer_init_buffered(&tls_writer, NULL, 10);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+    err = here_tracking_tls_writer_init_buffered(&tls_writer, buffer, 0);
+    ck_assert_int_eq(err, HERE_TRACKING_ERROR_INVALID_INPUT);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_SETUP_TEARDOWN_FN(test_here_tracking_tls_writer_tc_setup, NULL)
     TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_init_ok)
     TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_init_invalid_input)
     TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_write_data_chunks_ok)
+    TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_write_data_large_ok)
     TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_write_data_invalid_input)
     TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_write_data_add_data_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_write_data_add_data_fail2)
@@ -352,6 +445,9 @@ TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_write_utoa_write_data_fail)
     TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_flush_invalid_input)
     TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_flush_write_fail)
+    TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_buffered_ok)
+    TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_buffered_too_small)
+    TEST_SUITE_ADD_TEST(test_here_tracking_tls_writer_buffered_invalid_input)
 TEST_SUITE_END
 
 /**************************************************************************************************/
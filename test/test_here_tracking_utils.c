@@ -190,6 +190,55 @@ END_TEST
 
 /**************************************************************************************************/
 
+START_TEST(test_here_tracking_utils_isxdigit)
+{
+    ck_assert(here_tracking_utils_isxdigit('0'));
+    ck_assert(here_tracking_utils_isxdigit('9'));
+    ck_assert(here_tracking_utils_isxdigit('a'));
+    ck_assert(here_tracking_utils_isxdigit('F'));
+    ck_assert(!here_tracking_utils_isxdigit('g'));
+    ck_assert(!here_tracking_utils_isxdigit('G'));
+    ck_assert(!here_tracking_utils_isxdigit(';'));
+    ck_assert(!here_tracking_utils_isxdigit('\r'));
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_utils_xtou)
+{
+    static char* str1 = "7fffffff";
+    static char* str2 = "1A2b";
+    static char* str3 = "0";
+    static char* str4 = "10;ext=1";
+    static char* str5 = "xyz";
+    ck_assert_uint_eq(here_tracking_utils_xtou(str1, strlen(str1)), 0x7fffffff);
+    ck_assert_uint_eq(here_tracking_utils_xtou(str2, strlen(str2)), 0x1a2b);
+    ck_assert_uint_eq(here_tracking_utils_xtou(str3, strlen(str3)), 0);
+    ck_assert_uint_eq(here_tracking_utils_xtou(str4, strlen(str4)), 16);
+    ck_assert_uint_eq(here_tracking_utils_xtou(str5, strlen(str5)), 0);
+    ck_assert_uint_eq(here_tracking_utils_xtou(str1, 2), 0x7f);
+    ck_assert_uint_eq(here_tracking_utils_xtou(NULL, strlen(str1)), 0);
+    ck_assert_uint_eq(here_tracking_utils_xtou(str1, 0), 0);
+}
+END_TEST
+
+/**************************************************************************************************/
+
+START_TEST(test_here_tracking_utils_crc32)
+{
+    static char* str = "123456789";
+    uint32_t crc;
+    ck_assert_uint_eq(here_tracking_utils_crc32(0, (const uint8_t*)str, strlen(str)), 0xcbf43926);
+    ck_assert_uint_eq(here_tracking_utils_crc32(0, NULL, 0), 0);
+    crc = here_tracking_utils_crc32(0, (const uint8_t*)str, 4);
+    crc = here_tracking_utils_crc32(crc, (const uint8_t*)str + 4, strlen(str) - 4);
+    ck_assert_uint_eq(crc, 0xcbf43926);
+}
+END_TEST
+
+/**************************************************************************************************/
+
 TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_TEST(test_here_tracking_utils_memcasecmp_lc)
     TEST_SUITE_ADD_TEST(test_here_tracking_utils_memcasecmp_uc)
@@ -200,6 +249,9 @@ TEST_SUITE_BEGIN(TEST_NAME)
     TEST_SUITE_ADD_TEST(test_here_tracking_utils_strcasecmp)
     TEST_SUITE_ADD_TEST(test_here_tracking_utils_atoi)
     TEST_SUITE_ADD_TEST(test_here_tracking_utils_atou)
+    TEST_SUITE_ADD_TEST(test_here_tracking_utils_isxdigit)
+    TEST_SUITE_ADD_TEST(test_here_tracking_utils_xtou)
+    TEST_SUITE_ADD_TEST(test_here_tracking_utils_crc32)
 TEST_SUITE_END
 
 /**************************************************************************************************/